@@ -242,6 +242,119 @@ extern bt_graph_add_interrupter_status bt_graph_add_interrupter(bt_graph *graph,
 
 extern bt_interrupter *bt_graph_borrow_default_interrupter(bt_graph *graph);
 
+/**
+@brief	Sets the initial and maximum sizes of the message batches which
+	the message iterators of the graph \p graph get from their
+	upstream components to \p size and \p max_size.
+
+The batch size of a message iterator is the maximum number of messages
+which its upstream message iterator may return at once from its
+"next" method. A message iterator starts with batches of \p size
+messages. When its upstream message iterator fills a whole batch, the
+message iterator doubles its batch size, up to \p max_size. When its
+upstream message iterator returns
+#BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN, the message
+iterator goes back to batches of \p size messages.
+
+Make \p max_size equal to \p size to keep the batch size constant.
+
+The default initial and maximum sizes are both 15.
+
+@param[in] graph	Graph of which to set the message batch sizes.
+@param[in] size		Initial message batch size of the message
+			iterators of \p graph.
+@param[in] max_size	Maximum message batch size of the message
+			iterators of \p graph.
+
+@pre \p graph is not \c NULL.
+@pre \p graph is in the configuration phase (you didn't call
+	bt_graph_run() or bt_graph_run_once() yet).
+@pre \p size is greater than 0.
+@pre \p max_size is greater than or equal to \p size.
+@pre \p max_size is less than or equal to \c UINT_MAX.
+*/
+extern void bt_graph_set_message_batch_size(bt_graph *graph,
+		uint64_t size, uint64_t max_size);
+
+/**
+@brief	Cuts the connection \p connection of the graph \p graph so
+	that its upstream and downstream components run in parallel,
+	with a queue of \p queue_size message batches between them.
+
+Each message iterator which a downstream component creates on
+\p connection runs the "next" method of its upstream message iterator
+in a dedicated thread. This thread gets message batches ahead of time
+and puts them into a queue, and bt_message_iterator_next() takes the
+batches from this queue. The thread waits when the queue contains
+\p queue_size batches, and bt_message_iterator_next() waits when the
+queue is empty.
+
+The message iterators which the upstream message iterator creates
+also run in this thread.
+
+Seeking the message iterator, querying whether or not it can seek, and
+finalizing it first stop its thread. Seeking and finalizing it also
+discard the queued message batches.
+
+The components on both sides of \p connection, and the ones upstream
+of it, must not share state without synchronizing it. The
+initialization of a message iterator on \p connection fails if its
+upstream message iterator or one of the message iterators it creates
+belongs to a Python component.
+
+@param[in] graph	Graph of which to cut the connection
+			\p connection.
+@param[in] connection	Connection to cut.
+@param[in] queue_size	Maximum number of message batches which the
+			thread of a message iterator on \p connection
+			gets ahead of time.
+
+@pre \p graph is not \c NULL.
+@pre \p connection is not \c NULL.
+@pre \p graph is in the configuration phase (you didn't call
+	bt_graph_run() or bt_graph_run_once() yet).
+@pre \p connection is a connection of \p graph.
+@pre No message iterator exists on \p connection.
+@pre \p queue_size is greater than 0 and less than or equal to
+	<code>UINT_MAX / 2</code>.
+
+@sa bt_self_message_iterator_configuration_set_stage_queue_size():
+	Makes a message iterator run its "next" method in a dedicated
+	thread.
+*/
+extern void bt_graph_cut_connection(bt_graph *graph,
+		const bt_connection *connection, uint64_t queue_size);
+
+/**
+@brief	Sets the maximum number of recycled messages which each message
+	pool of the graph \p graph keeps to \p max_size.
+
+The graph recycles the event, packet beginning, and packet end messages
+which its message iterators create, each type in its own pool. When a
+pool already contains \p max_size recycled messages, it destroys the
+message to recycle instead. This function destroys the recycled
+messages beyond \p max_size immediately.
+
+The default maximum size is unlimited, unless the
+\c LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE environment variable is set.
+
+Regardless of their maximum size, the pools periodically destroy the
+recycled messages which the graph didn't need recently, but only while
+the graph creates or recycles messages: an idle graph keeps them.
+
+@param[in] graph	Graph of which to set the maximum size of the
+			message pools.
+@param[in] max_size	New maximum size of each message pool of
+			\p graph.
+
+@pre \p graph is not \c NULL.
+
+@sa bt_util_get_object_pool_statistics(): Returns the statistics of the
+	object pools of the library.
+*/
+extern void bt_graph_set_message_pool_max_size(bt_graph *graph,
+		uint64_t max_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,6 +55,43 @@ extern void bt_self_message_iterator_configuration_set_can_seek_forward(
 		bt_self_message_iterator_configuration *config,
 		bt_bool can_seek_forward);
 
+/**
+@brief	Makes the message iterator of the configuration \p config run
+	its "next" method in a dedicated thread, with a queue of
+	\p queue_size message batches.
+
+Call this function from the initialization method of a message
+iterator to make it decode or produce its messages in parallel with
+its downstream message iterator, as if the connection it's created on
+was cut with bt_graph_cut_connection(). When this connection is cut,
+its queue size takes precedence over \p queue_size.
+
+If \p queue_size is 0, the message iterator runs its "next" method in
+the thread of its downstream message iterator (default).
+
+The message iterators which the message iterator creates also run in
+its dedicated thread: they must not belong to Python components, and
+they must not share state with other message iterators without
+synchronizing it.
+
+@param[in] config	Configuration of the message iterator to run
+			in a dedicated thread.
+@param[in] queue_size	Maximum number of message batches which the
+			thread of the message iterator gets ahead of
+			time, or 0 to run it in the thread of its
+			downstream message iterator.
+
+@pre \p config is not \c NULL.
+@pre \p config is not frozen (you call this function from the
+	initialization method of the message iterator).
+@pre \p queue_size is less than or equal to <code>UINT_MAX / 2</code>.
+
+@sa bt_graph_cut_connection(): Cuts a connection of a graph.
+*/
+extern void bt_self_message_iterator_configuration_set_stage_queue_size(
+		bt_self_message_iterator_configuration *config,
+		uint64_t queue_size);
+
 #ifdef __cplusplus
 }
 #endif
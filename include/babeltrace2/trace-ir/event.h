@@ -47,6 +47,52 @@ bt_event_borrow_specific_context_field(bt_event *event);
 
 extern bt_field *bt_event_borrow_payload_field(bt_event *event);
 
+typedef void (*bt_event_payload_field_materialize_func)(
+		bt_field *payload_field, void *data);
+
+typedef void (*bt_event_payload_field_materializer_finalize_func)(
+		void *data);
+
+/**
+@brief	Makes the library set the payload field of the event \p event
+	with \p materialize_func when it's first borrowed.
+
+The first time you or another component borrow the payload field of
+\p event (with bt_event_borrow_payload_field() or
+bt_event_borrow_payload_field_const()), the library calls
+\p materialize_func with the payload field and \p data, and then
+\p finalize_func (if not \c NULL) with \p data. \p materialize_func
+can set the payload field, even if \p event is frozen, and cannot
+fail.
+
+The library calls \p finalize_func without calling
+\p materialize_func if \p event is recycled or destroyed before its
+payload field is borrowed, or if you call this function again.
+
+Many threads can borrow the payload field of the same const event:
+the library calls \p materialize_func once, under a global lock.
+Therefore, \p materialize_func must not borrow the payload field of
+an event itself.
+
+@param[in] event		Event of which to set the payload field
+				materializer.
+@param[in] materialize_func	Function which sets the payload field
+				of \p event.
+@param[in] finalize_func	Function which finalizes \p data, or
+				\c NULL.
+@param[in] data			User data of \p materialize_func and
+				\p finalize_func.
+
+@pre \p event is not \c NULL.
+@pre \p materialize_func is not \c NULL.
+@pre \p event is not frozen.
+@pre \p event has a payload field.
+*/
+extern void bt_event_set_payload_field_materializer(bt_event *event,
+		bt_event_payload_field_materialize_func materialize_func,
+		bt_event_payload_field_materializer_finalize_func finalize_func,
+		void *data);
+
 #ifdef __cplusplus
 }
 #endif
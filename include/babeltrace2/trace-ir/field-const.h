@@ -89,6 +89,69 @@ extern const bt_field *
 bt_field_array_borrow_element_field_by_index_const(
 		const bt_field *field, uint64_t index);
 
+/**
+@brief	Borrows the element values of the const array field \p field,
+	of which the element field class is a boolean field class.
+
+The returned array contains bt_field_array_get_length() values. It
+remains valid as long as \p field exists and is not modified.
+
+Borrowing the values of a const array field, or one of its element
+fields with bt_field_array_borrow_element_field_by_index_const(), can
+convert the internal representation of its values the first time. This
+conversion is thread-safe: many threads can borrow the values and the
+element fields of the same const array field concurrently, for example
+when a message crosses message iterator stage threads (see
+bt_self_message_iterator_configuration_set_stage_queue_size()).
+
+@param[in] field	Array field of which to borrow the element
+			values.
+
+@returns		Element values of \p field.
+
+@pre \p field is not \c NULL.
+@pre \p field is a static or dynamic array field of which the
+	element field class is a boolean field class.
+
+@sa bt_field_array_borrow_bool_values(): Borrows the element values of
+	an array field for writing.
+*/
+extern const bt_bool *bt_field_array_borrow_bool_values_const(
+		const bt_field *field);
+
+/**
+@brief	Borrows the element values of the const array field \p field,
+	of which the element field class is an unsigned integer or
+	unsigned enumeration field class.
+
+See bt_field_array_borrow_bool_values_const() for the validity of the
+returned array, its thread safety, and the preconditions.
+*/
+extern const uint64_t *bt_field_array_borrow_unsigned_integer_values_const(
+		const bt_field *field);
+
+/**
+@brief	Borrows the element values of the const array field \p field,
+	of which the element field class is a signed integer or signed
+	enumeration field class.
+
+See bt_field_array_borrow_bool_values_const() for the validity of the
+returned array, its thread safety, and the preconditions.
+*/
+extern const int64_t *bt_field_array_borrow_signed_integer_values_const(
+		const bt_field *field);
+
+/**
+@brief	Borrows the element values of the const array field \p field,
+	of which the element field class is a single or double
+	precision real field class.
+
+See bt_field_array_borrow_bool_values_const() for the validity of the
+returned array, its thread safety, and the preconditions.
+*/
+extern const double *bt_field_array_borrow_real_values_const(
+		const bt_field *field);
+
 extern const bt_field *
 bt_field_option_borrow_field_const(const bt_field *field);
 
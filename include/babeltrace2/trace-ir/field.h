@@ -84,6 +84,71 @@ extern bt_field *bt_field_structure_borrow_member_field_by_name(
 extern bt_field *bt_field_array_borrow_element_field_by_index(
 		bt_field *field, uint64_t index);
 
+/**
+@brief	Borrows the element values of the array field \p field, of
+	which the element field class is a boolean field class, for
+	writing.
+
+The returned array contains bt_field_array_get_length() values. You
+can read and write them until you change the length of \p field, reset
+it, or borrow one of its element fields.
+
+Setting the values with the returned array is equivalent to setting the
+value of each element field: borrowing an element field afterwards
+gives a field which contains the written value.
+
+Borrowing the values marks all the element fields as set.
+
+@param[in] field	Array field of which to borrow the element
+			values.
+
+@returns		Element values of \p field.
+
+@pre \p field is not \c NULL.
+@pre \p field is a static or dynamic array field of which the
+	element field class is a boolean field class.
+@pre \p field is not frozen.
+
+@sa bt_field_array_borrow_bool_values_const(): Borrows the element
+	values of a const array field.
+*/
+extern bt_bool *bt_field_array_borrow_bool_values(bt_field *field);
+
+/**
+@brief	Borrows the element values of the array field \p field, of
+	which the element field class is an unsigned integer or
+	unsigned enumeration field class, for writing.
+
+See bt_field_array_borrow_bool_values() for the validity of the
+returned array and the preconditions.
+*/
+extern uint64_t *bt_field_array_borrow_unsigned_integer_values(
+		bt_field *field);
+
+/**
+@brief	Borrows the element values of the array field \p field, of
+	which the element field class is a signed integer or signed
+	enumeration field class, for writing.
+
+See bt_field_array_borrow_bool_values() for the validity of the
+returned array and the preconditions.
+*/
+extern int64_t *bt_field_array_borrow_signed_integer_values(
+		bt_field *field);
+
+/**
+@brief	Borrows the element values of the array field \p field, of
+	which the element field class is a single or double precision
+	real field class, for writing.
+
+The values of a single precision real array field are stored as
+\c double values.
+
+See bt_field_array_borrow_bool_values() for the validity of the
+returned array and the preconditions.
+*/
+extern double *bt_field_array_borrow_real_values(bt_field *field);
+
 typedef enum bt_field_array_dynamic_set_length_status {
 	BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_MEMORY_ERROR	= __BT_FUNC_STATUS_MEMORY_ERROR,
 	BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK		= __BT_FUNC_STATUS_OK,
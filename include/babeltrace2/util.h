@@ -43,6 +43,79 @@ bt_util_clock_cycles_to_ns_from_origin(uint64_t cycles,
 		uint64_t frequency, int64_t offset_seconds,
 		uint64_t offset_cycles, int64_t *ns);
 
+/**
+@brief	Object pool types.
+*/
+typedef enum bt_util_object_pool_type {
+	/// Event, packet beginning, and packet end message pools of
+	/// the graphs.
+	BT_UTIL_OBJECT_POOL_TYPE_MESSAGE		= 0,
+
+	/// Event pools of the event classes.
+	BT_UTIL_OBJECT_POOL_TYPE_EVENT			= 1,
+
+	/// Packet pools of the streams.
+	BT_UTIL_OBJECT_POOL_TYPE_PACKET			= 2,
+
+	/// Packet context field pools of the stream classes.
+	BT_UTIL_OBJECT_POOL_TYPE_PACKET_CONTEXT_FIELD	= 3,
+
+	/// Clock snapshot pools of the clock classes.
+	BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT		= 4,
+} bt_util_object_pool_type;
+
+/**
+@brief	Returns the statistics of all the object pools of type \p type
+	of the library.
+
+The library recycles some objects instead of destroying them, keeping
+them in object pools. This function sets the following counts, each
+one being the sum for all the pools of type \p type since the library
+was loaded, including the pools which don't exist anymore:
+
+- <code>*alloc_count</code>: Number of objects which the library
+  requested from the pools, whether the pools provided a recycled
+  object or a new one.
+- <code>*recycle_count</code>: Number of objects which the pools kept
+  to provide them again.
+- <code>*miss_count</code>: Number of new objects which the pools
+  allocated because they were empty.
+- <code>*discard_count</code>: Number of recycled objects which the
+  pools destroyed because they were full or because the library
+  didn't need them recently.
+
+The ratio of <code>*miss_count</code> to <code>*alloc_count</code> is
+the proportion of the requested objects which the pools couldn't
+provide from their recycled objects. A large
+<code>*discard_count</code> compared to <code>*recycle_count</code>
+indicates that the pools are too small (see
+bt_graph_set_message_pool_max_size()).
+
+You can call this function from any thread, even while graphs run in
+other threads; in that case, the counts don't form a consistent
+snapshot.
+
+@param[in] type			Type of the object pools of which to get
+				the statistics.
+@param[out] alloc_count		Number of objects which the library
+				requested from the pools.
+@param[out] recycle_count	Number of objects which the pools kept.
+@param[out] miss_count		Number of new objects which the pools
+				allocated.
+@param[out] discard_count	Number of recycled objects which the
+				pools destroyed.
+
+@pre \p type is a value of #bt_util_object_pool_type.
+@pre \p alloc_count is not \c NULL.
+@pre \p recycle_count is not \c NULL.
+@pre \p miss_count is not \c NULL.
+@pre \p discard_count is not \c NULL.
+*/
+extern void bt_util_get_object_pool_statistics(
+		bt_util_object_pool_type type, uint64_t *alloc_count,
+		uint64_t *recycle_count, uint64_t *miss_count,
+		uint64_t *discard_count);
+
 #ifdef __cplusplus
 }
 #endif
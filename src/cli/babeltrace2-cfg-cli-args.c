@@ -370,6 +370,8 @@ void bt_config_destroy(bt_object *obj)
 			g_ptr_array_free(cfg->cmd_data.run.connections,
 				TRUE);
 		}
+
+		BT_VALUE_PUT_REF_AND_RESET(cfg->cmd_data.run.stage_comp_names);
 		break;
 	case BT_CONFIG_COMMAND_LIST_PLUGINS:
 		break;
@@ -790,6 +792,8 @@ enum {
 	OPT_INPUT_FORMAT,
 	OPT_LIST,
 	OPT_LOG_LEVEL,
+	OPT_MAX_MSG_BATCH_SIZE,
+	OPT_MSG_BATCH_SIZE,
 	OPT_NAMES,
 	OPT_NO_DELTA,
 	OPT_OMIT_HOME_PLUGIN_PATH,
@@ -802,6 +806,7 @@ enum {
 	OPT_RETRY_DURATION,
 	OPT_RUN_ARGS,
 	OPT_RUN_ARGS_0,
+	OPT_STAGE,
 	OPT_STREAM_INTERSECTION,
 	OPT_TIMERANGE,
 	OPT_VERBOSE,
@@ -1021,6 +1026,12 @@ struct bt_config *bt_config_run_create(const bt_value *plugin_paths)
 		goto error;
 	}
 
+	cfg->cmd_data.run.stage_comp_names = bt_value_map_create();
+	if (!cfg->cmd_data.run.stage_comp_names) {
+		BT_CLI_LOGE_APPEND_CAUSE_OOM();
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -1668,6 +1679,11 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "                                    expected format of CONNECTION below)\n");
 	fprintf(fp, "  -l, --log-level=LVL               Set the log level of the current component to LVL\n");
 	fprintf(fp, "                                    (`N`, `T`, `D`, `I`, `W`, `E`, or `F`)\n");
+	fprintf(fp, "      --max-message-batch-size=SIZE Let message batches grow up to SIZE\n");
+	fprintf(fp, "                                    messages while upstream components fill\n");
+	fprintf(fp, "                                    them (default: --message-batch-size)\n");
+	fprintf(fp, "      --message-batch-size=SIZE     Ask upstream components for batches of\n");
+	fprintf(fp, "                                    SIZE messages (default: 15)\n");
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
@@ -1676,6 +1692,8 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
 	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
 	fprintf(fp, "                                    (default: 100000)\n");
+	fprintf(fp, "      --stage=NAME                  Run the message iterators of the component\n");
+	fprintf(fp, "                                    named NAME in their own threads\n");
 	fprintf(fp, "  -h, --help                        Show this help and quit\n");
 	fprintf(fp, "\n");
 	fprintf(fp, "See `babeltrace2 --help` for the list of general options.\n");
@@ -1717,6 +1735,66 @@ void print_run_usage(FILE *fp)
 	print_expected_params_format(fp);
 }
 
+/*
+ * Parses the argument `arg` of the message batch size option named
+ * `opt_name` into `*size`.
+ *
+ * Returns a negative value on error.
+ */
+static
+int parse_msg_batch_size_opt_arg(const char *opt_name, const char *arg,
+		uint64_t *size)
+{
+	int ret = 0;
+	gchar *end;
+	size_t arg_len = strlen(arg);
+
+	*size = g_ascii_strtoull(arg, &end, 10);
+	if (arg_len == 0 || end != (arg + arg_len) || arg[0] == '-') {
+		BT_CLI_LOGE_APPEND_CAUSE(
+			"Could not parse --%s option's argument as an unsigned integer: `%s`",
+			opt_name, arg);
+		goto error;
+	}
+
+	if (*size == 0 || *size > G_MAXUINT) {
+		BT_CLI_LOGE_APPEND_CAUSE(
+			"--%s option's argument must be between 1 and %u: %" PRIu64,
+			opt_name, G_MAXUINT, *size);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	return ret;
+}
+
+/*
+ * Checks that the component name `name` of a --stage option is the
+ * name of a component of the map `data` of instance names.
+ */
+static
+bt_value_map_foreach_entry_const_func_status check_stage_comp_name(
+		const char *name, const bt_value *object, void *data)
+{
+	bt_value_map_foreach_entry_const_func_status status =
+		BT_VALUE_MAP_FOREACH_ENTRY_CONST_FUNC_STATUS_OK;
+	const bt_value *instance_names = data;
+
+	if (!bt_value_map_has_entry(instance_names, name)) {
+		BT_CLI_LOGE_APPEND_CAUSE(
+			"Unknown component name in --stage option: `%s`",
+			name);
+		status = BT_VALUE_MAP_FOREACH_ENTRY_CONST_FUNC_STATUS_ERROR;
+	}
+
+	return status;
+}
+
 /*
  * Creates a Babeltrace config object from the arguments of a run
  * command.
@@ -1747,9 +1825,12 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 		{ OPT_CONNECT, 'x', "connect", true },
 		{ OPT_HELP, 'h', "help", false },
 		{ OPT_LOG_LEVEL, 'l', "log-level", true },
+		{ OPT_MAX_MSG_BATCH_SIZE, '\0', "max-message-batch-size", true },
+		{ OPT_MSG_BATCH_SIZE, '\0', "message-batch-size", true },
 		{ OPT_PARAMS, 'p', "params", true },
 		{ OPT_RESET_BASE_PARAMS, 'r', "reset-base-params", false },
 		{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
+		{ OPT_STAGE, '\0', "stage", true },
 		ARGPAR_OPT_DESCR_SENTINEL
 	};
 
@@ -1773,6 +1854,7 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 	}
 
 	cfg->cmd_data.run.retry_duration_us = 100000;
+	cfg->cmd_data.run.msg_batch_size = 15;
 	cur_base_params = bt_value_map_create();
 	if (!cur_base_params) {
 		BT_CLI_LOGE_APPEND_CAUSE_OOM();
@@ -1965,6 +2047,28 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 				(uint64_t) retry_duration;
 			break;
 		}
+		case OPT_MSG_BATCH_SIZE:
+			if (parse_msg_batch_size_opt_arg("message-batch-size",
+					argpar_item_opt->arg,
+					&cfg->cmd_data.run.msg_batch_size)) {
+				goto error;
+			}
+			break;
+		case OPT_MAX_MSG_BATCH_SIZE:
+			if (parse_msg_batch_size_opt_arg("max-message-batch-size",
+					argpar_item_opt->arg,
+					&cfg->cmd_data.run.max_msg_batch_size)) {
+				goto error;
+			}
+			break;
+		case OPT_STAGE:
+			if (bt_value_map_insert_entry(
+					cfg->cmd_data.run.stage_comp_names,
+					argpar_item_opt->arg, bt_value_null)) {
+				BT_CLI_LOGE_APPEND_CAUSE_OOM();
+				goto error;
+			}
+			break;
 		default:
 			BT_CLI_LOGE_APPEND_CAUSE("Unknown command-line option specified (option code %d).",
 				argpar_item_opt->descr->id);
@@ -1974,6 +2078,27 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 
 	BT_OBJECT_PUT_REF_AND_RESET(cur_cfg_comp);
 
+	if (cfg->cmd_data.run.max_msg_batch_size == 0) {
+		/* Fixed message batch size */
+		cfg->cmd_data.run.max_msg_batch_size =
+			cfg->cmd_data.run.msg_batch_size;
+	} else if (cfg->cmd_data.run.max_msg_batch_size <
+			cfg->cmd_data.run.msg_batch_size) {
+		BT_CLI_LOGE_APPEND_CAUSE(
+			"--max-message-batch-size option's argument must be greater than or equal to the message batch size: "
+			"max-size=%" PRIu64 ", size=%" PRIu64,
+			cfg->cmd_data.run.max_msg_batch_size,
+			cfg->cmd_data.run.msg_batch_size);
+		goto error;
+	}
+
+	if (bt_value_map_foreach_entry_const(
+			cfg->cmd_data.run.stage_comp_names,
+			check_stage_comp_name, instance_names) !=
+			BT_VALUE_MAP_FOREACH_ENTRY_CONST_STATUS_OK) {
+		goto error;
+	}
+
 	if (cfg->cmd_data.run.sources->len == 0) {
 		BT_CLI_LOGE_APPEND_CAUSE("Incomplete graph: no source component.");
 		goto error;
@@ -2064,12 +2189,19 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "                                    NAME\n");
 	fprintf(fp, "  -l, --log-level=LVL               Set the log level of the current component to LVL\n");
 	fprintf(fp, "                                    (`N`, `T`, `D`, `I`, `W`, `E`, or `F`)\n");
+	fprintf(fp, "      --max-message-batch-size=SIZE Let message batches grow up to SIZE\n");
+	fprintf(fp, "                                    messages while upstream components fill\n");
+	fprintf(fp, "                                    them (default: --message-batch-size)\n");
+	fprintf(fp, "      --message-batch-size=SIZE     Ask upstream components for batches of\n");
+	fprintf(fp, "                                    SIZE messages (default: 15)\n");
 	fprintf(fp, "  -p, --params=PARAMS               Add initialization parameters PARAMS to the\n");
 	fprintf(fp, "                                    current component (see the expected format\n");
 	fprintf(fp, "                                    of PARAMS below)\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace2(1) needs to retry to run\n");
 	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
 	fprintf(fp, "                                    (default: 100000)\n");
+	fprintf(fp, "      --stage=NAME                  Run the message iterators of the component\n");
+	fprintf(fp, "                                    named NAME in their own threads\n");
 	fprintf(fp, "                                    dynamic plugins can be loaded\n");
 	fprintf(fp, "      --run-args                    Print the equivalent arguments for the\n");
 	fprintf(fp, "                                    `run` command to the standard output,\n");
@@ -2191,6 +2323,8 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_HELP, 'h', "help", false },
 	{ OPT_INPUT_FORMAT, 'i', "input-format", true },
 	{ OPT_LOG_LEVEL, 'l', "log-level", true },
+	{ OPT_MAX_MSG_BATCH_SIZE, '\0', "max-message-batch-size", true },
+	{ OPT_MSG_BATCH_SIZE, '\0', "message-batch-size", true },
 	{ OPT_NAMES, 'n', "names", true },
 	{ OPT_DEBUG_INFO, '\0', "debug-info", false },
 	{ OPT_NO_DELTA, '\0', "no-delta", false },
@@ -2203,6 +2337,7 @@ const struct argpar_opt_descr convert_options[] = {
 	{ OPT_RETRY_DURATION, '\0', "retry-duration", true },
 	{ OPT_RUN_ARGS, '\0', "run-args", false },
 	{ OPT_RUN_ARGS_0, '\0', "run-args-0", false },
+	{ OPT_STAGE, '\0', "stage", true },
 	{ OPT_STREAM_INTERSECTION, '\0', "stream-intersection", false },
 	{ OPT_TIMERANGE, '\0', "timerange", true },
 	{ OPT_VERBOSE, 'v', "verbose", false },
@@ -3472,6 +3607,33 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 					goto error;
 				}
 
+				if (bt_value_array_append_string_element(run_args, arg)) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_STAGE:
+				if (bt_value_array_append_string_element(run_args,
+						"--stage")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+
+				if (bt_value_array_append_string_element(run_args, arg)) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+				break;
+			case OPT_MSG_BATCH_SIZE:
+			case OPT_MAX_MSG_BATCH_SIZE:
+				if (bt_value_array_append_string_element(run_args,
+						argpar_item_opt->descr->id == OPT_MSG_BATCH_SIZE ?
+							"--message-batch-size" :
+							"--max-message-batch-size")) {
+					BT_CLI_LOGE_APPEND_CAUSE_OOM();
+					goto error;
+				}
+
 				if (bt_value_array_append_string_element(run_args, arg)) {
 					BT_CLI_LOGE_APPEND_CAUSE_OOM();
 					goto error;
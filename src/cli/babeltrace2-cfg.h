@@ -91,6 +91,20 @@ struct bt_config {
 			 */
 			uint64_t retry_duration_us;
 
+			/*
+			 * Initial and maximum sizes of the message
+			 * batches (see bt_graph_set_message_batch_size()).
+			 */
+			uint64_t msg_batch_size;
+			uint64_t max_msg_batch_size;
+
+			/*
+			 * Map of the names of the components of which
+			 * to cut the output connections (see
+			 * bt_graph_cut_connection()) to `null` values.
+			 */
+			bt_value *stage_comp_names;
+
 			/*
 			 * Whether or not to trim the source trace to the
 			 * intersection of its streams.
@@ -47,6 +47,9 @@
 #define ENV_BABELTRACE_WARN_COMMAND_NAME_DIRECTORY_CLASH "BABELTRACE_CLI_WARN_COMMAND_NAME_DIRECTORY_CLASH"
 #define NSEC_PER_SEC	1000000000LL
 
+/* Size of the message batch queue of a cut connection (see --stage) */
+#define STAGE_QUEUE_SIZE	4
+
 enum bt_cmd_status {
 	BT_CMD_STATUS_OK	    = 0,
 	BT_CMD_STATUS_ERROR	    = -1,
@@ -1208,6 +1211,12 @@ struct cmd_run_ctx {
 
 	bool connect_ports;
 
+	/*
+	 * True until the graph runs: connections can only be cut
+	 * (see --stage) before.
+	 */
+	bool graph_is_configuring;
+
 	bool stream_intersection_mode;
 
 	/*
@@ -1283,6 +1292,7 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 	borrow_input_port_by_index_func_t port_by_index_fn;
 	bt_graph_connect_ports_status connect_ports_status =
 		BT_GRAPH_CONNECT_PORTS_STATUS_OK;
+	const bt_connection *connection = NULL;
 	bool insert_trimmer = false;
 	bt_value *trimmer_params = NULL;
 	char *intersection_begin = NULL;
@@ -1477,7 +1487,7 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 
 		/* We have a winner! */
 		connect_ports_status = bt_graph_connect_ports(ctx->graph,
-			out_upstream_port, in_downstream_port, NULL);
+			out_upstream_port, in_downstream_port, &connection);
 		downstream_port = NULL;
 		switch (connect_ports_status) {
 		case BT_GRAPH_CONNECT_PORTS_STATUS_OK:
@@ -1510,6 +1520,19 @@ int cmd_run_ctx_connect_upstream_port_to_downstream_component(
 			downstream_port, downstream_port_name,
 			cfg_conn->arg->str);
 
+		if (ctx->graph_is_configuring &&
+				bt_value_map_has_entry(
+					ctx->cfg->cmd_data.run.stage_comp_names,
+					bt_component_get_name(upstream_comp))) {
+			bt_graph_cut_connection(ctx->graph, connection,
+				STAGE_QUEUE_SIZE);
+			BT_LOGI("Cut connection: upstream-comp-name=\"%s\", "
+				"upstream-port-name=\"%s\", queue-size=%d",
+				bt_component_get_name(upstream_comp),
+				bt_port_get_name(upstream_port),
+				STAGE_QUEUE_SIZE);
+		}
+
 		if (insert_trimmer) {
 			/*
 			 * The first connection, from the source to the trimmer,
@@ -1839,6 +1862,7 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 
 	ctx->cfg = cfg;
 	ctx->connect_ports = false;
+	ctx->graph_is_configuring = true;
 	ctx->src_components = g_hash_table_new_full(g_direct_hash,
 		g_direct_equal, NULL, (GDestroyNotify) bt_object_put_ref);
 	if (!ctx->src_components) {
@@ -1897,6 +1921,9 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 	}
 
 	bt_graph_add_interrupter(ctx->graph, the_interrupter);
+	bt_graph_set_message_batch_size(ctx->graph,
+		cfg->cmd_data.run.msg_batch_size,
+		cfg->cmd_data.run.max_msg_batch_size);
 	add_listener_status = bt_graph_add_source_component_output_port_added_listener(
 		ctx->graph, graph_source_output_port_added_listener, ctx,
 		NULL);
@@ -2454,6 +2481,39 @@ end:
 	return ret;
 }
 
+/*
+ * Logs the statistics of the finalized object pools of the library.
+ */
+static
+void log_object_pool_statistics(void)
+{
+	static const struct {
+		bt_util_object_pool_type type;
+		const char *name;
+	} types[] = {
+		{ BT_UTIL_OBJECT_POOL_TYPE_MESSAGE, "message" },
+		{ BT_UTIL_OBJECT_POOL_TYPE_EVENT, "event" },
+		{ BT_UTIL_OBJECT_POOL_TYPE_PACKET, "packet" },
+		{ BT_UTIL_OBJECT_POOL_TYPE_PACKET_CONTEXT_FIELD,
+			"packet context field" },
+		{ BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT, "clock snapshot" },
+	};
+	size_t i;
+
+	for (i = 0; i < G_N_ELEMENTS(types); i++) {
+		uint64_t alloc_count, recycle_count, miss_count, discard_count;
+
+		bt_util_get_object_pool_statistics(types[i].type,
+			&alloc_count, &recycle_count, &miss_count,
+			&discard_count);
+		BT_LOGI("Object pool statistics: type=%s, "
+			"alloc-count=%" PRIu64 ", recycle-count=%" PRIu64 ", "
+			"miss-count=%" PRIu64 ", discard-count=%" PRIu64,
+			types[i].name, alloc_count, recycle_count,
+			miss_count, discard_count);
+	}
+}
+
 static
 enum bt_cmd_status cmd_run(struct bt_config *cfg)
 {
@@ -2497,6 +2557,7 @@ enum bt_cmd_status cmd_run(struct bt_config *cfg)
 	}
 
 	BT_LOGI_STR("Running the graph.");
+	ctx.graph_is_configuring = false;
 
 	/* Run the graph */
 	while (true) {
@@ -2554,6 +2615,9 @@ error:
 
 end:
 	cmd_run_ctx_destroy(&ctx);
+
+	/* Destroying the graph finalized its object pools */
+	log_object_pool_statistics();
 	return cmd_status;
 }
 
@@ -23,6 +23,17 @@
  * SOFTWARE.
  */
 
+/*
+ * Expected access pattern of a memory mapping, for bt_madvise().
+ */
+enum bt_madvise_advice {
+	/* Sequential access: read ahead aggressively */
+	BT_MADV_SEQUENTIAL,
+
+	/* Access in the near future: start reading now */
+	BT_MADV_WILLNEED,
+};
+
 #ifdef __MINGW32__
 
 #include <sys/types.h>
@@ -56,6 +67,15 @@ int bt_munmap(void *addr, size_t length);
  */
 size_t bt_mmap_get_offset_align_size(int log_level);
 
+/*
+ * Not supported on Windows: the advice is only a hint.
+ */
+static inline
+int bt_madvise(void *addr, size_t length, enum bt_madvise_advice advice)
+{
+	return 0;
+}
+
 #else /* __MINGW32__ */
 
 #include <sys/mman.h>
@@ -83,6 +103,36 @@ size_t bt_mmap_get_offset_align_size(int log_level)
 {
 	return bt_common_get_page_size(log_level);
 }
+
+/*
+ * Advises the system about the expected access pattern of the mapped
+ * memory range of `length` bytes at the page-aligned address `addr`.
+ *
+ * The advice is only a hint: this function does nothing on platforms
+ * which don't support it.
+ */
+static inline
+int bt_madvise(void *addr, size_t length, enum bt_madvise_advice advice)
+{
+#ifdef POSIX_MADV_SEQUENTIAL
+	int posix_advice;
+
+	switch (advice) {
+	case BT_MADV_SEQUENTIAL:
+		posix_advice = POSIX_MADV_SEQUENTIAL;
+		break;
+	case BT_MADV_WILLNEED:
+		posix_advice = POSIX_MADV_WILLNEED;
+		break;
+	default:
+		return -1;
+	}
+
+	return posix_madvise(addr, length, posix_advice);
+#else
+	return 0;
+#endif
+}
 #endif /* __MINGW32__ */
 
 #ifndef MAP_ANONYMOUS
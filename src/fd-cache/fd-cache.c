@@ -30,7 +30,10 @@
 #define BT_LOG_TAG "FD-CACHE"
 #include "logging/log.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -48,6 +51,9 @@ struct fd_handle_internal {
 	struct bt_fd_cache_handle fd_handle;
 	uint64_t ref_count;
 	struct file_key *key;
+
+	/* Link within `idle_handles` of the cache, or `NULL` if in use */
+	GList *idle_link;
 };
 
 static
@@ -102,15 +108,94 @@ void file_key_destroy(gpointer data)
 	g_free(fk);
 }
 
+/*
+ * Closes the file descriptor of `fd_internal` and removes it from
+ * `fdc`, destroying it.
+ *
+ * Call with the lock of `fdc` held.
+ */
+static
+void close_and_remove_handle(struct bt_fd_cache *fdc,
+		struct fd_handle_internal *fd_internal)
+{
+	gboolean ret;
+
+	BT_ASSERT(fd_internal->ref_count == 0);
+	BT_ASSERT(!fd_internal->idle_link);
+
+	if (close(fd_internal->fd_handle.fd) == -1) {
+		BT_LOGE_ERRNO("Failed to close file descriptor",
+			": fd=%d", fd_internal->fd_handle.fd);
+	}
+
+	fd_internal->fd_handle.fd = -1;
+	BT_ASSERT(fdc->open_fds > 0);
+	fdc->open_fds--;
+	ret = g_hash_table_remove(fdc->cache, fd_internal->key);
+	BT_ASSERT(ret);
+}
+
+/*
+ * Closes the least recently used idle file descriptor of `fdc`.
+ *
+ * Returns `false` if there's no idle file descriptor.
+ *
+ * Call with the lock of `fdc` held.
+ */
+static
+bool evict_idle_handle(struct bt_fd_cache *fdc)
+{
+	struct fd_handle_internal *fd_internal =
+		g_queue_pop_head(&fdc->idle_handles);
+
+	if (!fd_internal) {
+		return false;
+	}
+
+	BT_LOGD("Evicting idle file descriptor: fd=%d, open-fds=%" PRIu64
+		", max-open-fds=%" PRIu64, fd_internal->fd_handle.fd,
+		fdc->open_fds, fdc->max_open_fds);
+	fd_internal->idle_link = NULL;
+	close_and_remove_handle(fdc, fd_internal);
+	fdc->evictions++;
+	return true;
+}
+
+/*
+ * Evicts idle file descriptors until there's room for `room` more of
+ * them within the limit of `fdc`, or until there's no more idle file
+ * descriptor.
+ *
+ * Call with the lock of `fdc` held.
+ */
+static
+void make_room(struct bt_fd_cache *fdc, uint64_t room)
+{
+	if (fdc->max_open_fds == 0) {
+		return;
+	}
+
+	while (fdc->open_fds + room > fdc->max_open_fds &&
+			evict_idle_handle(fdc)) {
+		continue;
+	}
+}
+
 BT_HIDDEN
 int bt_fd_cache_init(struct bt_fd_cache *fdc, int log_level)
 {
 	int ret = 0;
 
 	fdc->log_level = log_level;
+	fdc->max_open_fds = 0;
+	fdc->open_fds = 0;
+	fdc->evictions = 0;
+	g_queue_init(&fdc->idle_handles);
+	g_mutex_init(&fdc->lock);
 	fdc->cache = g_hash_table_new_full(file_key_hash, file_key_equal,
 		file_key_destroy, (GDestroyNotify) fd_cache_handle_internal_destroy);
 	if (!fdc->cache) {
+		g_mutex_clear(&fdc->lock);
 		ret = -1;
 	}
 
@@ -124,21 +209,54 @@ void bt_fd_cache_fini(struct bt_fd_cache *fdc)
 		goto end;
 	}
 
+	if (fdc->evictions > 0) {
+		BT_LOGI("File descriptor cache statistics: "
+			"max-open-fds=%" PRIu64 ", evictions=%" PRIu64,
+			fdc->max_open_fds, fdc->evictions);
+	}
+
+	/* Close the remaining idle file descriptors. */
+	while (evict_idle_handle(fdc)) {
+		continue;
+	}
+
 	/*
 	 * All handle should have been removed for the hashtable at this point.
 	 */
 	BT_ASSERT(g_hash_table_size(fdc->cache) == 0);
 	g_hash_table_destroy(fdc->cache);
+	fdc->cache = NULL;
+	g_mutex_clear(&fdc->lock);
 
 end:
 	return;
 }
 
+BT_HIDDEN
+void bt_fd_cache_set_max_open_fds(struct bt_fd_cache *fdc,
+		uint64_t max_open_fds)
+{
+	g_mutex_lock(&fdc->lock);
+	fdc->max_open_fds = max_open_fds;
+
+	if (max_open_fds == 0) {
+		/* Without a limit, idle file descriptors are closed. */
+		while (evict_idle_handle(fdc)) {
+			continue;
+		}
+	} else {
+		make_room(fdc, 0);
+	}
+
+	g_mutex_unlock(&fdc->lock);
+}
+
 BT_HIDDEN
 struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		const char *path)
 {
 	struct fd_handle_internal *fd_internal = NULL;
+	struct file_key *file_key = NULL;
 	struct stat statbuf;
 	struct file_key fk;
 	int ret, fd = -1;
@@ -163,11 +281,34 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 	fk.dev = statbuf.st_dev;
 	fk.ino = statbuf.st_ino;
 
+	g_mutex_lock(&fdc->lock);
 	fd_internal = g_hash_table_lookup(fdc->cache, &fk);
-	if (!fd_internal) {
-		struct file_key *file_key;
+	if (fd_internal) {
+		if (fd_internal->idle_link) {
+			/* Reuse an idle file descriptor. */
+			g_queue_delete_link(&fdc->idle_handles,
+				fd_internal->idle_link);
+			fd_internal->idle_link = NULL;
+		}
+	} else {
+		make_room(fdc, 1);
+
+		if (fdc->max_open_fds > 0 &&
+				fdc->open_fds >= fdc->max_open_fds) {
+			BT_LOGD("All open file descriptors are in use: "
+				"exceeding the maximum: path=%s, "
+				"open-fds=%" PRIu64 ", max-open-fds=%" PRIu64,
+				path, fdc->open_fds, fdc->max_open_fds);
+		}
+
+		while (true) {
+			fd = open(path, O_RDONLY);
+			if (fd >= 0 || errno != EMFILE ||
+					!evict_idle_handle(fdc)) {
+				break;
+			}
+		}
 
-		fd = open(path, O_RDONLY);
 		if (fd < 0) {
 			BT_LOGE_ERRNO("Failed to open file", "path=%s", path);
 			goto error;
@@ -180,7 +321,7 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		}
 
 		file_key = g_new0(struct file_key, 1);
-		if (!fd_internal) {
+		if (!file_key) {
 			BT_LOGE_STR("Failed to allocate file key.");
 			goto error;
 		}
@@ -193,12 +334,16 @@ struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 
 		/* Insert the newly created fd handle. */
 		g_hash_table_insert(fdc->cache, fd_internal->key, fd_internal);
+		fdc->open_fds++;
 	}
 
 	fd_internal->ref_count++;
+	g_mutex_unlock(&fdc->lock);
 	goto end;
 
 error:
+	g_mutex_unlock(&fdc->lock);
+
 	/*
 	 * Close file descriptor if it was open() and we are currently on error
 	 * path.
@@ -211,7 +356,8 @@ error:
 		}
 	}
 
-	fd_cache_handle_internal_destroy(fd_internal);
+	g_free(file_key);
+	g_free(fd_internal);
 	fd_internal = NULL;
 end:
 	return (struct bt_fd_cache_handle *) fd_internal;
@@ -229,23 +375,24 @@ void bt_fd_cache_put_handle(struct bt_fd_cache *fdc,
 
 	fd_internal = (struct fd_handle_internal *) handle;
 
+	g_mutex_lock(&fdc->lock);
 	BT_ASSERT(fd_internal->ref_count > 0);
-
-	if (fd_internal->ref_count > 1) {
-		fd_internal->ref_count--;
-	} else {
-		gboolean ret;
-		int close_ret;
-
-		close_ret = close(fd_internal->fd_handle.fd);
-		if (close_ret == -1) {
-			BT_LOGE_ERRNO("Failed to close file descriptor",
-				": fd=%d", fd_internal->fd_handle.fd);
+	fd_internal->ref_count--;
+
+	if (fd_internal->ref_count == 0) {
+		if (fdc->max_open_fds == 0) {
+			close_and_remove_handle(fdc, fd_internal);
+		} else {
+			/* Keep it open until it needs to be evicted. */
+			g_queue_push_tail(&fdc->idle_handles, fd_internal);
+			fd_internal->idle_link =
+				g_queue_peek_tail_link(&fdc->idle_handles);
+			make_room(fdc, 0);
 		}
-		ret = g_hash_table_remove(fdc->cache, fd_internal->key);
-		BT_ASSERT(ret);
 	}
 
+	g_mutex_unlock(&fdc->lock);
+
 end:
 	return;
 }
@@ -28,6 +28,9 @@
  * SOFTWARE.
  */
 
+#include <stdint.h>
+#include <glib.h>
+
 #include "common/macros.h"
 
 struct bt_fd_cache_handle {
@@ -37,6 +40,31 @@ struct bt_fd_cache_handle {
 struct bt_fd_cache {
 	int log_level;
 	GHashTable *cache;
+
+	/*
+	 * Maximum number of file descriptors to keep open, or 0 for no
+	 * limit.
+	 *
+	 * Without a limit, a file descriptor is closed as soon as its
+	 * last handle is put. With a limit, it stays open (idle) until
+	 * it needs to be evicted to make room for another one.
+	 */
+	uint64_t max_open_fds;
+
+	/* Number of open file descriptors, idle ones included */
+	uint64_t open_fds;
+
+	/*
+	 * Idle handles (no references), least recently used first.
+	 * Weak: the handles belong to `cache`.
+	 */
+	GQueue idle_handles;
+
+	/* Number of file descriptors closed to honor `max_open_fds` */
+	uint64_t evictions;
+
+	/* Protects all the above: handles are shared between threads */
+	GMutex lock;
 };
 
 static inline
@@ -51,6 +79,18 @@ int bt_fd_cache_init(struct bt_fd_cache *fdc, int log_level);
 BT_HIDDEN
 void bt_fd_cache_fini(struct bt_fd_cache *fdc);
 
+/*
+ * Sets the maximum number of file descriptors that `fdc` keeps open
+ * (0 means no limit).
+ *
+ * This is a soft limit: bt_fd_cache_get_handle() only evicts idle file
+ * descriptors, so it still opens a file when all the open ones are in
+ * use.
+ */
+BT_HIDDEN
+void bt_fd_cache_set_max_open_fds(struct bt_fd_cache *fdc,
+		uint64_t max_open_fds);
+
 BT_HIDDEN
 struct bt_fd_cache_handle *bt_fd_cache_get_handle(struct bt_fd_cache *fdc,
 		const char *path);
@@ -62,6 +62,14 @@ struct bt_component_class {
 	bool frozen;
 	struct bt_list_head node;
 	struct bt_plugin_so_shared_lib_handle *so_handle;
+
+	/*
+	 * True if this component class comes from a Python plugin: the
+	 * methods of its message iterators must run in the thread which
+	 * holds the Python GIL, therefore never in a stage thread (see
+	 * bt_graph_cut_connection()).
+	 */
+	bool is_python;
 };
 
 struct bt_component_class_with_iterator_class {
@@ -56,6 +56,13 @@ struct bt_connection {
 	 */
 	GPtrArray *iterators;
 
+	/*
+	 * Size of the message batch queue of the stage of each message
+	 * iterator created on this connection, or 0 if this connection
+	 * is not cut (see bt_graph_cut_connection()).
+	 */
+	uint64_t stage_queue_size;
+
 	bool notified_upstream_port_connected;
 	bool notified_downstream_port_connected;
 	bool notified_graph_ports_connected;
@@ -112,6 +112,8 @@ void destroy_graph(struct bt_object *obj)
 		graph->messages = NULL;
 	}
 
+	g_mutex_clear(&graph->messages_lock);
+
 	if (graph->connections) {
 		BT_LOGD_STR("Destroying connections.");
 		g_ptr_array_free(graph->connections, TRUE);
@@ -163,10 +165,46 @@ void destroy_graph(struct bt_object *obj)
 	g_free(graph);
 }
 
+/*
+ * Removes the message `msg`, which one of the pools of `graph` is
+ * about to destroy, from the messages of `graph`.
+ */
+static
+void remove_pooled_message(struct bt_graph *graph, struct bt_message *msg)
+{
+	bool locked = bt_object_is_concurrent();
+
+	if (locked) {
+		g_mutex_lock(&graph->messages_lock);
+	}
+
+	/* `messages` is already freed when destroying the graph */
+	if (graph->messages) {
+		guint index = msg->graph_msgs_index;
+
+		BT_ASSERT(index < graph->messages->len);
+		BT_ASSERT(graph->messages->pdata[index] == msg);
+		g_ptr_array_remove_index_fast(graph->messages, index);
+
+		/* The last message moved to `index` */
+		if (index < graph->messages->len) {
+			struct bt_message *moved_msg =
+				graph->messages->pdata[index];
+
+			moved_msg->graph_msgs_index = index;
+		}
+	}
+
+	if (locked) {
+		g_mutex_unlock(&graph->messages_lock);
+	}
+}
+
 static
 void destroy_message_event(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	remove_pooled_message(graph, msg);
 	bt_message_event_destroy(msg);
 }
 
@@ -174,6 +212,7 @@ static
 void destroy_message_packet_begin(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	remove_pooled_message(graph, msg);
 	bt_message_packet_destroy(msg);
 }
 
@@ -181,6 +220,7 @@ static
 void destroy_message_packet_end(struct bt_message *msg,
 		struct bt_graph *graph)
 {
+	remove_pooled_message(graph, msg);
 	bt_message_packet_destroy(msg);
 }
 
@@ -208,6 +248,7 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 	}
 
 	bt_object_init_shared(&graph->base, destroy_graph);
+	g_mutex_init(&graph->messages_lock);
 	graph->mip_version = mip_version;
 	graph->connections = g_ptr_array_new_with_free_func(
 		(GDestroyNotify) bt_object_try_spec_release);
@@ -228,6 +269,8 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 	}
 
 	bt_graph_set_can_consume(graph, true);
+	graph->msg_batch.size = BT_GRAPH_DEFAULT_MSG_BATCH_SIZE;
+	graph->msg_batch.max_size = BT_GRAPH_DEFAULT_MSG_BATCH_SIZE;
 	INIT_LISTENERS_ARRAY(struct bt_graph_listener_port_added,
 		graph->listeners.source_output_port_added);
 
@@ -272,6 +315,7 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 
 	bt_graph_add_interrupter(graph, graph->default_interrupter);
 	ret = bt_object_pool_initialize(&graph->event_msg_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_MESSAGE,
 		(bt_object_pool_new_object_func) bt_message_event_new,
 		(bt_object_pool_destroy_object_func) destroy_message_event,
 		graph);
@@ -283,6 +327,7 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 	}
 
 	ret = bt_object_pool_initialize(&graph->packet_begin_msg_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_MESSAGE,
 		(bt_object_pool_new_object_func) bt_message_packet_beginning_new,
 		(bt_object_pool_destroy_object_func) destroy_message_packet_begin,
 		graph);
@@ -294,6 +339,7 @@ struct bt_graph *bt_graph_create(uint64_t mip_version)
 	}
 
 	ret = bt_object_pool_initialize(&graph->packet_end_msg_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_MESSAGE,
 		(bt_object_pool_new_object_func) bt_message_packet_end_new,
 		(bt_object_pool_destroy_object_func) destroy_message_packet_end,
 		graph);
@@ -1169,7 +1215,15 @@ void bt_graph_add_message(struct bt_graph *graph,
 	 * * It is destroyed because it doesn't have any link to any
 	 *   graph, which means the original graph is already destroyed.
 	 */
-	g_ptr_array_add(graph->messages, msg);
+	if (bt_object_is_concurrent()) {
+		g_mutex_lock(&graph->messages_lock);
+		msg->graph_msgs_index = graph->messages->len;
+		g_ptr_array_add(graph->messages, msg);
+		g_mutex_unlock(&graph->messages_lock);
+	} else {
+		msg->graph_msgs_index = graph->messages->len;
+		g_ptr_array_add(graph->messages, msg);
+	}
 }
 
 BT_HIDDEN
@@ -1192,6 +1246,64 @@ enum bt_graph_add_interrupter_status bt_graph_add_interrupter(
 	return BT_FUNC_STATUS_OK;
 }
 
+void bt_graph_set_message_batch_size(struct bt_graph *graph, uint64_t size,
+		uint64_t max_size)
+{
+	BT_ASSERT_PRE_NON_NULL(graph, "Graph");
+	BT_ASSERT_PRE(
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	BT_ASSERT_PRE(size > 0, "Message batch size is 0: %!+g", graph);
+	BT_ASSERT_PRE(max_size >= size,
+		"Maximum message batch size is less than the message batch size: "
+		"%![graph-]+g, size=%" PRIu64 ", max-size=%" PRIu64,
+		graph, size, max_size);
+	BT_ASSERT_PRE(max_size <= G_MAXUINT,
+		"Maximum message batch size is too large: "
+		"%![graph-]+g, max-size=%" PRIu64, graph, max_size);
+	graph->msg_batch.size = size;
+	graph->msg_batch.max_size = max_size;
+	BT_LIB_LOGD("Set graph's message batch size: %!+g", graph);
+}
+
+void bt_graph_cut_connection(struct bt_graph *graph,
+		const struct bt_connection *connection, uint64_t queue_size)
+{
+	struct bt_connection *conn = (void *) connection;
+
+	BT_ASSERT_PRE_NON_NULL(graph, "Graph");
+	BT_ASSERT_PRE_NON_NULL(conn, "Connection");
+	BT_ASSERT_PRE(
+		graph->config_state == BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not in the \"configuring\" state: %!+g", graph);
+	BT_ASSERT_PRE(bt_connection_borrow_graph(conn) == graph,
+		"Connection is not part of graph: %![graph-]+g, %![conn-]+x",
+		graph, conn);
+	BT_ASSERT_PRE(conn->iterators->len == 0,
+		"Connection already has message iterators: %!+x", conn);
+	BT_ASSERT_PRE(queue_size > 0 && queue_size <= G_MAXUINT / 2,
+		"Invalid message batch queue size: %![conn-]+x, "
+		"queue-size=%" PRIu64, conn, queue_size);
+	conn->stage_queue_size = queue_size;
+	BT_LIB_LOGI("Cut graph's connection: %![graph-]+g, %![conn-]+x, "
+		"queue-size=%" PRIu64, graph, conn, queue_size);
+}
+
+void bt_graph_set_message_pool_max_size(struct bt_graph *graph,
+		uint64_t max_size)
+{
+	size_t pool_max_size = (size_t) MIN(max_size, (uint64_t) SIZE_MAX);
+
+	BT_ASSERT_PRE_NON_NULL(graph, "Graph");
+	bt_object_pool_set_max_size(&graph->event_msg_pool, pool_max_size);
+	bt_object_pool_set_max_size(&graph->packet_begin_msg_pool,
+		pool_max_size);
+	bt_object_pool_set_max_size(&graph->packet_end_msg_pool,
+		pool_max_size);
+	BT_LIB_LOGD("Set graph's message pool maximum size: "
+		"%![graph-]+g, max-size=%" PRIu64, graph, max_size);
+}
+
 struct bt_interrupter *bt_graph_borrow_default_interrupter(bt_graph *graph)
 {
 	BT_ASSERT_PRE_NON_NULL(graph, "Graph");
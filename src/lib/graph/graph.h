@@ -45,6 +45,9 @@
 #include "connection.h"
 #include "lib/func-status.h"
 
+/* Default size of the message batches of the message iterators */
+#define BT_GRAPH_DEFAULT_MSG_BATCH_SIZE	15
+
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
 #ifndef BT_LIB_LOG_SUPPORTED
 # error Please include "lib/logging.h" before including this file.
@@ -121,6 +124,16 @@ struct bt_graph {
 
 	enum bt_graph_configuration_state config_state;
 
+	/*
+	 * Initial and maximum sizes of the message batches of the
+	 * message iterators of this graph (see
+	 * bt_graph_set_message_batch_size()).
+	 */
+	struct {
+		uint64_t size;
+		uint64_t max_size;
+	} msg_batch;
+
 	struct {
 		GArray *source_output_port_added;
 		GArray *filter_output_port_added;
@@ -147,11 +160,18 @@ struct bt_graph {
 	 * notify each message that the graph is gone on graph
 	 * destruction.
 	 *
-	 * TODO: When we support a maximum size for object pools,
-	 * add a way for a message to remove itself from this
-	 * array (on destruction).
+	 * A message which one of the pools above destroys (because
+	 * it's full or when trimming it) removes itself from this
+	 * array, at the index which it keeps
+	 * (`graph_msgs_index` member).
 	 */
 	GPtrArray *messages;
+
+	/*
+	 * Protects `messages` when other threads share objects (see
+	 * bt_object_is_concurrent()).
+	 */
+	GMutex messages_lock;
 };
 
 static inline
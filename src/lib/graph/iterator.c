@@ -69,6 +69,7 @@
 #include "connection.h"
 #include "graph.h"
 #include "message-iterator-class.h"
+#include "message-iterator-stage.h"
 #include "message/discarded-items.h"
 #include "message/event.h"
 #include "message/iterator.h"
@@ -78,11 +79,8 @@
 #include "message/packet.h"
 #include "lib/func-status.h"
 
-/*
- * TODO: Use graph's state (number of active iterators, etc.) and
- * possibly system specifications to make a better guess than this.
- */
-#define MSG_BATCH_SIZE	15
+/* Size of the message batches when fast-forwarding to auto-seek */
+#define MSG_BATCH_SIZE	BT_GRAPH_DEFAULT_MSG_BATCH_SIZE
 
 #define BT_ASSERT_PRE_ITER_HAS_STATE_TO_SEEK(_iter)			\
 	BT_ASSERT_PRE((_iter)->state == BT_MESSAGE_ITERATOR_STATE_ACTIVE || \
@@ -155,6 +153,11 @@ void bt_message_iterator_destroy(struct bt_object *obj)
 		iterator->upstream_msg_iters = NULL;
 	}
 
+	if (iterator->stage) {
+		bt_message_iterator_stage_destroy(iterator->stage);
+		iterator->stage = NULL;
+	}
+
 	if (iterator->msgs) {
 		g_ptr_array_free(iterator->msgs, TRUE);
 		iterator->msgs = NULL;
@@ -205,6 +208,16 @@ void bt_message_iterator_try_finalize(
 		BT_MESSAGE_ITERATOR_STATE_FINALIZING);
 	BT_ASSERT(iterator->upstream_component);
 
+	/*
+	 * Stop the stage's thread and put the messages it queued before
+	 * the user finalization method makes the upstream component
+	 * forget about them.
+	 */
+	if (iterator->stage) {
+		bt_message_iterator_stage_pause(iterator->stage);
+		bt_message_iterator_stage_discard(iterator->stage);
+	}
+
 	/* Call user-defined destroy method */
 	if (call_user_finalize) {
 		typedef void (*method_t)(void *);
@@ -295,6 +308,30 @@ enum bt_message_iterator_can_seek_beginning_status can_seek_beginning_true(
 	return BT_FUNC_STATUS_OK;
 }
 
+/*
+ * Marks `iterator` and all its upstream message iterators as running in
+ * a stage thread.
+ *
+ * Returns whether or not one of them belongs to a Python component.
+ */
+static
+bool mark_msg_iter_tree_runs_in_stage(struct bt_message_iterator *iterator)
+{
+	bool has_python = iterator->upstream_component->class->is_python;
+	guint i;
+
+	iterator->runs_in_stage = true;
+
+	for (i = 0; i < iterator->upstream_msg_iters->len; i++) {
+		if (mark_msg_iter_tree_runs_in_stage(
+				iterator->upstream_msg_iters->pdata[i])) {
+			has_python = true;
+		}
+	}
+
+	return has_python;
+}
+
 static
 int create_self_component_input_port_message_iterator(
 		struct bt_self_message_iterator *self_downstream_msg_iter,
@@ -312,6 +349,7 @@ int create_self_component_input_port_message_iterator(
 	struct bt_component *upstream_comp;
 	struct bt_component_class *upstream_comp_cls;
 	struct bt_component_class_with_iterator_class *upstream_comp_cls_with_iter_cls;
+	uint64_t stage_queue_size;
 	int status;
 
 	BT_ASSERT_PRE_NON_NULL(message_iterator, "Created message iterator");
@@ -340,6 +378,19 @@ int create_self_component_input_port_message_iterator(
 		BT_COMPONENT_CLASS_TYPE_FILTER);
 	BT_LIB_LOGI("Creating message iterator on self component input port: "
 		"%![up-comp-]+c, %![up-port-]+p", upstream_comp, upstream_port);
+
+	if (upstream_comp_cls->is_python &&
+			(port->connection->stage_queue_size > 0 ||
+			(downstream_msg_iter &&
+				downstream_msg_iter->runs_in_stage))) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Cannot run the message iterator of a Python component "
+			"in a stage thread: %![up-comp-]+c, %![up-port-]+p",
+			upstream_comp, upstream_port);
+		status = BT_FUNC_STATUS_ERROR;
+		goto error;
+	}
+
 	iterator = g_new0(
 		struct bt_message_iterator, 1);
 	if (!iterator) {
@@ -359,7 +410,12 @@ int create_self_component_input_port_message_iterator(
 		goto error;
 	}
 
-	g_ptr_array_set_size(iterator->msgs, MSG_BATCH_SIZE);
+	iterator->batch.min_size =
+		bt_component_borrow_graph(upstream_comp)->msg_batch.size;
+	iterator->batch.max_size =
+		bt_component_borrow_graph(upstream_comp)->msg_batch.max_size;
+	iterator->batch.size = iterator->batch.min_size;
+	g_ptr_array_set_size(iterator->msgs, iterator->batch.size);
 	iterator->last_ns_from_origin = INT64_MIN;
 	iterator->auto_seek.msgs = g_queue_new();
 	if (!iterator->auto_seek.msgs) {
@@ -379,6 +435,8 @@ int create_self_component_input_port_message_iterator(
 	iterator->upstream_port = upstream_port;
 	iterator->connection = iterator->upstream_port->connection;
 	iterator->graph = bt_component_borrow_graph(upstream_comp);
+	iterator->runs_in_stage = iterator->connection->stage_queue_size > 0 ||
+		(downstream_msg_iter && downstream_msg_iter->runs_in_stage);
 	set_msg_iterator_state(iterator,
 		BT_MESSAGE_ITERATOR_STATE_NON_INITIALIZED);
 
@@ -444,6 +502,54 @@ int create_self_component_input_port_message_iterator(
 		iterator->config.frozen = true;
 	}
 
+	/*
+	 * A cut connection or the iterator's configuration makes the
+	 * "next" method run in a dedicated thread.
+	 */
+	stage_queue_size = iterator->connection->stage_queue_size;
+	if (stage_queue_size == 0) {
+		stage_queue_size = iterator->config.stage_queue_size;
+	}
+
+	if (stage_queue_size > 0) {
+		/*
+		 * The initialization method could have created upstream
+		 * message iterators which will also run in the stage
+		 * thread.
+		 */
+		if (mark_msg_iter_tree_runs_in_stage(iterator)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot run the message iterator of a Python "
+				"component in a stage thread: %!+i", iterator);
+			status = BT_FUNC_STATUS_ERROR;
+			set_msg_iterator_state(iterator,
+				BT_MESSAGE_ITERATOR_STATE_ACTIVE);
+			goto error;
+		}
+
+		/*
+		 * The messages of any batch, whatever its size, go
+		 * through `msgs`.
+		 */
+		g_ptr_array_set_size(iterator->msgs, iterator->batch.max_size);
+		iterator->stage = bt_message_iterator_stage_create(iterator,
+			stage_queue_size);
+		if (!iterator->stage) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot create message iterator stage: %!+i",
+				iterator);
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+
+			/*
+			 * Initialized: make the iterator's destruction
+			 * call the user's finalization method.
+			 */
+			set_msg_iterator_state(iterator,
+				BT_MESSAGE_ITERATOR_STATE_ACTIVE);
+			goto error;
+		}
+	}
+
 	if (downstream_msg_iter) {
 		/* Set this message iterator's downstream message iterator */
 		iterator->downstream_msg_iter = downstream_msg_iter;
@@ -530,6 +636,18 @@ void bt_self_message_iterator_configuration_set_can_seek_forward(
 	config->can_seek_forward = can_seek_forward;
 }
 
+void bt_self_message_iterator_configuration_set_stage_queue_size(
+		bt_self_message_iterator_configuration *config,
+		uint64_t queue_size)
+{
+	BT_ASSERT_PRE_NON_NULL(config, "Message iterator configuration");
+	BT_ASSERT_PRE_DEV_HOT(config, "Message iterator configuration", "");
+	BT_ASSERT_PRE(queue_size <= G_MAXUINT / 2,
+		"Invalid message batch queue size: queue-size=%" PRIu64,
+		queue_size);
+	config->stage_queue_size = queue_size;
+}
+
 /*
  * Validate that the default clock snapshot in `msg` doesn't make us go back in
  * time.
@@ -830,42 +948,19 @@ call_iterator_next_method(
 	return status;
 }
 
-enum bt_message_iterator_next_status
-bt_message_iterator_next(
-		struct bt_message_iterator *iterator,
-		bt_message_array_const *msgs, uint64_t *user_count)
+BT_HIDDEN
+int bt_message_iterator_call_next(struct bt_message_iterator *iterator,
+		bt_message_array_const msgs, uint64_t *count)
 {
-	enum bt_message_iterator_next_status status = BT_FUNC_STATUS_OK;
-
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_NON_NULL(iterator, "Message iterator");
-	BT_ASSERT_PRE_DEV_NON_NULL(msgs, "Message array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL(user_count, "Message count (output)");
-	BT_ASSERT_PRE_DEV(iterator->state ==
-		BT_MESSAGE_ITERATOR_STATE_ACTIVE,
-		"Message iterator's \"next\" called, but "
-		"message iterator is in the wrong state: %!+i", iterator);
-	BT_ASSERT_DBG(iterator->upstream_component);
-	BT_ASSERT_DBG(iterator->upstream_component->class);
-	BT_ASSERT_PRE_DEV(
-		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
-			BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
-		"Graph is not configured: %!+g",
-		bt_component_borrow_graph(iterator->upstream_component));
-	BT_LIB_LOGD("Getting next self component input port "
-		"message iterator's messages: %!+i, batch-size=%u",
-		iterator, MSG_BATCH_SIZE);
+	int status;
 
 	/*
 	 * Call the user's "next" method to get the next messages
 	 * and status.
 	 */
-	*user_count = 0;
-	status = (int) call_iterator_next_method(iterator,
-		(void *) iterator->msgs->pdata, MSG_BATCH_SIZE,
-		user_count);
-	BT_LOGD("User method returned: status=%s, msg-count=%" PRIu64,
-		bt_common_func_status_string(status), *user_count);
+	*count = 0;
+	status = (int) call_iterator_next_method(iterator, msgs,
+		iterator->batch.size, count);
 	if (status < 0) {
 		BT_LIB_LOGW_APPEND_CAUSE(
 			"Component input port message iterator's \"next\" method failed: "
@@ -888,18 +983,28 @@ bt_message_iterator_next(
 
 	switch (status) {
 	case BT_FUNC_STATUS_OK:
-		BT_ASSERT_POST_DEV(*user_count <= MSG_BATCH_SIZE,
+		BT_ASSERT_POST_DEV(*count <= iterator->batch.size,
 			"Invalid returned message count: greater than "
-			"batch size: count=%" PRIu64 ", batch-size=%u",
-			*user_count, MSG_BATCH_SIZE);
-		*msgs = (void *) iterator->msgs->pdata;
+			"batch size: count=%" PRIu64 ", batch-size=%" PRIu64,
+			*count, iterator->batch.size);
+
+		if (*count == iterator->batch.size &&
+				iterator->batch.size < iterator->batch.max_size) {
+			/* Upstream keeps up: try a larger batch next time */
+			iterator->batch.size = MIN(iterator->batch.size * 2,
+				iterator->batch.max_size);
+			BT_LIB_LOGD("Increased message iterator's batch size: "
+				"%!+i, batch-size=%" PRIu64,
+				iterator, iterator->batch.size);
+		}
+
 		break;
 	case BT_FUNC_STATUS_AGAIN:
-		goto end;
+		/* Upstream cannot keep up: go back to the initial size */
+		iterator->batch.size = iterator->batch.min_size;
+		break;
 	case BT_FUNC_STATUS_END:
-		set_msg_iterator_state(iterator,
-			BT_MESSAGE_ITERATOR_STATE_ENDED);
-		goto end;
+		break;
 	default:
 		/* Unknown non-error status */
 		bt_common_abort();
@@ -909,6 +1014,73 @@ end:
 	return status;
 }
 
+enum bt_message_iterator_next_status
+bt_message_iterator_next(
+		struct bt_message_iterator *iterator,
+		bt_message_array_const *msgs, uint64_t *user_count)
+{
+	enum bt_message_iterator_next_status status = BT_FUNC_STATUS_OK;
+
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_NON_NULL(iterator, "Message iterator");
+	BT_ASSERT_PRE_DEV_NON_NULL(msgs, "Message array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL(user_count, "Message count (output)");
+	BT_ASSERT_PRE_DEV(iterator->state ==
+		BT_MESSAGE_ITERATOR_STATE_ACTIVE,
+		"Message iterator's \"next\" called, but "
+		"message iterator is in the wrong state: %!+i", iterator);
+	BT_ASSERT_DBG(iterator->upstream_component);
+	BT_ASSERT_DBG(iterator->upstream_component->class);
+	BT_ASSERT_PRE_DEV(
+		bt_component_borrow_graph(iterator->upstream_component)->config_state !=
+			BT_GRAPH_CONFIGURATION_STATE_CONFIGURING,
+		"Graph is not configured: %!+g",
+		bt_component_borrow_graph(iterator->upstream_component));
+
+	if (iterator->stage) {
+		/*
+		 * The stage's thread calls the "next" method: `msgs`
+		 * already contains `batch.max_size` elements.
+		 */
+		BT_LIB_LOGD("Getting next self component input port "
+			"message iterator's messages from its stage: %!+i",
+			iterator);
+		status = bt_message_iterator_stage_next(iterator->stage,
+			(void *) iterator->msgs->pdata, user_count);
+	} else {
+		BT_LIB_LOGD("Getting next self component input port "
+			"message iterator's messages: %!+i, batch-size=%" PRIu64,
+			iterator, iterator->batch.size);
+
+		/*
+		 * Grow the message array now, if needed, as the
+		 * downstream component is done with the messages of the
+		 * previous batch.
+		 */
+		if (G_UNLIKELY(iterator->msgs->len < iterator->batch.size)) {
+			g_ptr_array_set_size(iterator->msgs,
+				iterator->batch.size);
+		}
+
+		status = bt_message_iterator_call_next(iterator,
+			(void *) iterator->msgs->pdata, user_count);
+	}
+
+	switch (status) {
+	case BT_FUNC_STATUS_OK:
+		*msgs = (void *) iterator->msgs->pdata;
+		break;
+	case BT_FUNC_STATUS_END:
+		set_msg_iterator_state(iterator,
+			BT_MESSAGE_ITERATOR_STATE_ENDED);
+		break;
+	default:
+		break;
+	}
+
+	return status;
+}
+
 struct bt_component *
 bt_message_iterator_borrow_component(
 		struct bt_message_iterator *iterator)
@@ -954,6 +1126,11 @@ bt_message_iterator_can_seek_ns_from_origin(
 		"Graph is not configured: %!+g",
 		bt_component_borrow_graph(iterator->upstream_component));
 
+	/* The user method cannot run concurrently with the "next" method */
+	if (iterator->stage) {
+		bt_message_iterator_stage_pause(iterator->stage);
+	}
+
 	if (iterator->methods.can_seek_ns_from_origin) {
 		/*
 		 * Initialize to an invalid value, so we can post-assert that
@@ -1025,6 +1202,11 @@ bt_message_iterator_can_seek_beginning(
 		"Graph is not configured: %!+g",
 		bt_component_borrow_graph(iterator->upstream_component));
 
+	/* The user method cannot run concurrently with the "next" method */
+	if (iterator->stage) {
+		bt_message_iterator_stage_pause(iterator->stage);
+	}
+
 	if (iterator->methods.can_seek_beginning) {
 		/*
 		 * Initialize to an invalid value, so we can post-assert that
@@ -1119,6 +1301,12 @@ bt_message_iterator_seek_beginning(
 	BT_ASSERT_PRE(message_iterator_can_seek_beginning(iterator),
 		"Message iterator cannot seek beginning: %!+i", iterator);
 
+	/* Forget what the stage's thread got before seeking */
+	if (iterator->stage) {
+		bt_message_iterator_stage_pause(iterator->stage);
+		bt_message_iterator_stage_discard(iterator->stage);
+	}
+
 	/*
 	 * We are seeking, reset our expectations about how the following
 	 * messages should look like.
@@ -1686,6 +1874,13 @@ bt_message_iterator_seek_ns_from_origin(
 		message_iterator_can_seek_ns_from_origin(iterator, ns_from_origin),
 		"Message iterator cannot seek nanoseconds from origin: %!+i, "
 		"ns-from-origin=%" PRId64, iterator, ns_from_origin);
+
+	/* Forget what the stage's thread got before seeking */
+	if (iterator->stage) {
+		bt_message_iterator_stage_pause(iterator->stage);
+		bt_message_iterator_stage_discard(iterator->stage);
+	}
+
 	set_msg_iterator_state(iterator,
 		BT_MESSAGE_ITERATOR_STATE_SEEKING);
 
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc. and Linux Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "LIB/MSG-ITER-STAGE"
+#include "lib/logging.h"
+
+#include <babeltrace2/current-thread.h>
+#include <babeltrace2/error-const.h>
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/assert.h"
+#include "common/common.h"
+#include "lib/func-status.h"
+#include "lib/object.h"
+
+#include "message/iterator.h"
+#include "message-iterator-stage.h"
+
+/* Time to wait before calling a "next" method which returned "again" */
+#define AGAIN_SLEEP_US	1000
+
+struct stage_batch {
+	/* Owned by this batch until consumed */
+	const struct bt_message **msgs;
+	uint64_t count;
+	int status;
+
+	/* Error of the producing thread when `status` < 0 (owned) */
+	const struct bt_error *error;
+};
+
+struct bt_message_iterator_stage {
+	/* Weak: the iterator owns this stage */
+	struct bt_message_iterator *iterator;
+
+	/* `NULL` when paused or when not started yet */
+	GThread *thread;
+
+	/*
+	 * Ring of `capacity` batches, `capacity` being a power of two.
+	 *
+	 * `head` (written by the consumer) and `tail` (written by the
+	 * producing thread) are free-running: the batches to consume
+	 * are the ones from `head` (included) to `tail` (excluded),
+	 * masked with `mask`.
+	 */
+	struct stage_batch *batches;
+	guint capacity;
+	guint mask;
+	guint head;
+	guint tail;
+
+	/* Set by the consumer to request the producing thread to stop */
+	gint stop;
+
+	/*
+	 * Set by the producing thread when it queues an "end" or error
+	 * batch, reset when the consumer takes it.
+	 */
+	gint ended;
+
+	/*
+	 * The queue itself is lock-free: a side only locks `lock` to
+	 * wait on `cond` when the queue is full (producer) or empty
+	 * (consumer), after setting its waiting flag, and the other side
+	 * only locks it to wake it up when this flag is set.
+	 */
+	gint producer_waiting;
+	gint consumer_waiting;
+	GMutex lock;
+	GCond cond;
+};
+
+static inline
+guint queue_length(struct bt_message_iterator_stage *stage)
+{
+	return g_atomic_int_get(&stage->tail) - g_atomic_int_get(&stage->head);
+}
+
+static
+void wake_up(struct bt_message_iterator_stage *stage, gint *waiting)
+{
+	if (g_atomic_int_get(waiting)) {
+		g_mutex_lock(&stage->lock);
+		g_cond_broadcast(&stage->cond);
+		g_mutex_unlock(&stage->lock);
+	}
+}
+
+/*
+ * Waits until the queue has some free space or the producing thread
+ * must stop, returning false in the latter case.
+ */
+static
+bool producer_wait_space(struct bt_message_iterator_stage *stage)
+{
+	if (G_LIKELY(queue_length(stage) < stage->capacity)) {
+		goto end;
+	}
+
+	g_mutex_lock(&stage->lock);
+	g_atomic_int_set(&stage->producer_waiting, 1);
+
+	while (queue_length(stage) == stage->capacity &&
+			!g_atomic_int_get(&stage->stop)) {
+		g_cond_wait(&stage->cond, &stage->lock);
+	}
+
+	g_atomic_int_set(&stage->producer_waiting, 0);
+	g_mutex_unlock(&stage->lock);
+
+end:
+	return !g_atomic_int_get(&stage->stop);
+}
+
+static
+void producer_publish(struct bt_message_iterator_stage *stage)
+{
+	g_atomic_int_set(&stage->tail, stage->tail + 1);
+	wake_up(stage, &stage->consumer_waiting);
+}
+
+static
+gpointer producer_thread_func(gpointer data)
+{
+	struct bt_message_iterator_stage *stage = data;
+
+	BT_LIB_LOGD("Message iterator stage's thread started: %!+i",
+		stage->iterator);
+
+	while (producer_wait_space(stage)) {
+		struct stage_batch *batch =
+			&stage->batches[stage->tail & stage->mask];
+
+		batch->count = 0;
+		batch->status = bt_message_iterator_call_next(stage->iterator,
+			batch->msgs, &batch->count);
+		if (batch->status != BT_FUNC_STATUS_OK) {
+			batch->count = 0;
+		}
+
+		switch (batch->status) {
+		case BT_FUNC_STATUS_OK:
+			producer_publish(stage);
+			break;
+		case BT_FUNC_STATUS_AGAIN:
+			/*
+			 * Only let the consumer know if it has nothing
+			 * else to consume, then give upstream some time.
+			 */
+			if (queue_length(stage) == 0) {
+				producer_publish(stage);
+			}
+
+			g_usleep(AGAIN_SLEEP_US);
+			break;
+		default:
+			if (batch->status < 0) {
+				batch->error = bt_current_thread_take_error();
+			}
+
+			g_atomic_int_set(&stage->ended, 1);
+			producer_publish(stage);
+			goto end;
+		}
+	}
+
+end:
+	BT_LIB_LOGD("Message iterator stage's thread stopped: %!+i",
+		stage->iterator);
+	return NULL;
+}
+
+static
+void join_thread(struct bt_message_iterator_stage *stage)
+{
+	BT_ASSERT(stage->thread);
+	g_thread_join(stage->thread);
+	stage->thread = NULL;
+	g_atomic_int_set(&stage->stop, 0);
+	bt_object_end_concurrency();
+}
+
+static
+int start_thread(struct bt_message_iterator_stage *stage)
+{
+	int status = BT_FUNC_STATUS_OK;
+	GError *error = NULL;
+
+	BT_ASSERT(!stage->thread);
+	BT_LIB_LOGD("Starting message iterator stage's thread: %!+i",
+		stage->iterator);
+
+	/*
+	 * Switch to thread-safe reference counting before the thread
+	 * exists: its creation is a memory barrier.
+	 */
+	bt_object_begin_concurrency();
+	stage->thread = g_thread_try_new("bt-msg-iter-stage",
+		producer_thread_func, stage, &error);
+	if (!stage->thread) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Cannot create message iterator stage's thread: "
+			"%![iter-]+i, error=\"%s\"", stage->iterator,
+			error->message);
+		g_error_free(error);
+		bt_object_end_concurrency();
+		status = BT_FUNC_STATUS_ERROR;
+	}
+
+	return status;
+}
+
+BT_HIDDEN
+struct bt_message_iterator_stage *bt_message_iterator_stage_create(
+		struct bt_message_iterator *iterator, uint64_t queue_size)
+{
+	struct bt_message_iterator_stage *stage;
+	guint i;
+
+	BT_ASSERT(iterator);
+	BT_ASSERT(queue_size > 0);
+	BT_LIB_LOGD("Creating message iterator stage: %![iter-]+i, "
+		"queue-size=%" PRIu64, iterator, queue_size);
+	stage = g_new0(struct bt_message_iterator_stage, 1);
+	if (!stage) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one message iterator stage.");
+		goto error;
+	}
+
+	stage->iterator = iterator;
+	g_mutex_init(&stage->lock);
+	g_cond_init(&stage->cond);
+
+	for (stage->capacity = 1; stage->capacity < queue_size;
+			stage->capacity *= 2) {}
+
+	stage->mask = stage->capacity - 1;
+	stage->batches = g_new0(struct stage_batch, stage->capacity);
+	if (!stage->batches) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate message iterator stage's batches.");
+		goto error;
+	}
+
+	for (i = 0; i < stage->capacity; i++) {
+		stage->batches[i].msgs = g_new0(const struct bt_message *,
+			iterator->batch.max_size);
+		if (!stage->batches[i].msgs) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Failed to allocate a message array.");
+			goto error;
+		}
+	}
+
+	BT_LIB_LOGD("Created message iterator stage: %![iter-]+i, "
+		"capacity=%u", iterator, stage->capacity);
+	goto end;
+
+error:
+	bt_message_iterator_stage_destroy(stage);
+	stage = NULL;
+
+end:
+	return stage;
+}
+
+BT_HIDDEN
+void bt_message_iterator_stage_destroy(
+		struct bt_message_iterator_stage *stage)
+{
+	guint i;
+
+	if (!stage) {
+		goto end;
+	}
+
+	BT_LOGD("Destroying message iterator stage: addr=%p", stage);
+	bt_message_iterator_stage_pause(stage);
+
+	if (stage->batches) {
+		bt_message_iterator_stage_discard(stage);
+
+		for (i = 0; i < stage->capacity; i++) {
+			g_free(stage->batches[i].msgs);
+		}
+
+		g_free(stage->batches);
+	}
+
+	g_mutex_clear(&stage->lock);
+	g_cond_clear(&stage->cond);
+	g_free(stage);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+int bt_message_iterator_stage_next(struct bt_message_iterator_stage *stage,
+		bt_message_array_const msgs, uint64_t *count)
+{
+	struct stage_batch *batch;
+	int status;
+
+	BT_ASSERT_DBG(stage);
+
+	if (G_UNLIKELY(!stage->thread && !g_atomic_int_get(&stage->ended))) {
+		status = start_thread(stage);
+		if (status) {
+			goto end;
+		}
+	}
+
+	if (G_UNLIKELY(queue_length(stage) == 0)) {
+		g_mutex_lock(&stage->lock);
+		g_atomic_int_set(&stage->consumer_waiting, 1);
+
+		while (queue_length(stage) == 0) {
+			g_cond_wait(&stage->cond, &stage->lock);
+		}
+
+		g_atomic_int_set(&stage->consumer_waiting, 0);
+		g_mutex_unlock(&stage->lock);
+	}
+
+	batch = &stage->batches[stage->head & stage->mask];
+	status = batch->status;
+	*count = batch->count;
+
+	if (batch->count > 0) {
+		memcpy(msgs, batch->msgs, sizeof(*msgs) * batch->count);
+	}
+
+	if (batch->error) {
+		BT_CURRENT_THREAD_MOVE_ERROR_AND_RESET(batch->error);
+	}
+
+	g_atomic_int_set(&stage->head, stage->head + 1);
+	wake_up(stage, &stage->producer_waiting);
+
+	if (status != BT_FUNC_STATUS_OK && status != BT_FUNC_STATUS_AGAIN) {
+		/* The thread exited after queueing this batch */
+		join_thread(stage);
+		g_atomic_int_set(&stage->ended, 0);
+	}
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+void bt_message_iterator_stage_pause(struct bt_message_iterator_stage *stage)
+{
+	BT_ASSERT(stage);
+
+	if (!stage->thread) {
+		goto end;
+	}
+
+	BT_LIB_LOGD("Pausing message iterator stage: %!+i", stage->iterator);
+	g_atomic_int_set(&stage->stop, 1);
+	g_mutex_lock(&stage->lock);
+	g_cond_broadcast(&stage->cond);
+	g_mutex_unlock(&stage->lock);
+	join_thread(stage);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void bt_message_iterator_stage_discard(
+		struct bt_message_iterator_stage *stage)
+{
+	BT_ASSERT(stage);
+	BT_ASSERT(!stage->thread);
+	BT_LOGD("Discarding message iterator stage's batches: "
+		"addr=%p, count=%u", stage, queue_length(stage));
+
+	for (; stage->head != stage->tail; stage->head++) {
+		struct stage_batch *batch =
+			&stage->batches[stage->head & stage->mask];
+		uint64_t i;
+
+		for (i = 0; i < batch->count; i++) {
+			bt_object_put_ref_no_null_check(batch->msgs[i]);
+		}
+
+		batch->count = 0;
+
+		if (batch->error) {
+			bt_error_release(batch->error);
+			batch->error = NULL;
+		}
+	}
+
+	stage->ended = 0;
+}
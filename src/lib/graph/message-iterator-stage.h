@@ -0,0 +1,83 @@
+#ifndef BABELTRACE_GRAPH_MESSAGE_ITERATOR_STAGE_INTERNAL_H
+#define BABELTRACE_GRAPH_MESSAGE_ITERATOR_STAGE_INTERNAL_H
+
+/*
+ * Copyright (c) 2020 EfficiOS Inc. and Linux Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <babeltrace2/graph/message-const.h>
+#include "common/macros.h"
+
+struct bt_message_iterator;
+
+/*
+ * A message iterator stage runs the "next" method of a message
+ * iterator created on a cut connection (see bt_graph_cut_connection())
+ * in a dedicated thread.
+ *
+ * This thread puts the message batches into a bounded single-producer,
+ * single-consumer queue from which bt_message_iterator_next() takes
+ * them. The thread only waits when the queue is full, and the consumer
+ * only waits when it's empty.
+ *
+ * The thread starts on the first call to
+ * bt_message_iterator_stage_next(). Anything else which needs to
+ * access the message iterator, like seeking or finalizing it, must
+ * first call bt_message_iterator_stage_pause().
+ */
+struct bt_message_iterator_stage;
+
+BT_HIDDEN
+struct bt_message_iterator_stage *bt_message_iterator_stage_create(
+		struct bt_message_iterator *iterator, uint64_t queue_size);
+
+BT_HIDDEN
+void bt_message_iterator_stage_destroy(
+		struct bt_message_iterator_stage *stage);
+
+/*
+ * Takes the next message batch of the stage, copying its messages to
+ * `msgs`, which must contain at least as many elements as the maximum
+ * message batch size of the message iterator.
+ *
+ * Returns the status of the "next" method which produced this batch.
+ */
+BT_HIDDEN
+int bt_message_iterator_stage_next(struct bt_message_iterator_stage *stage,
+		bt_message_array_const msgs, uint64_t *count);
+
+/*
+ * Stops the thread of `stage`, if running, keeping the queued message
+ * batches.
+ */
+BT_HIDDEN
+void bt_message_iterator_stage_pause(struct bt_message_iterator_stage *stage);
+
+/*
+ * Discards the queued message batches of `stage`, which must be
+ * paused.
+ */
+BT_HIDDEN
+void bt_message_iterator_stage_discard(
+		struct bt_message_iterator_stage *stage);
+
+#endif /* BABELTRACE_GRAPH_MESSAGE_ITERATOR_STAGE_INTERNAL_H */
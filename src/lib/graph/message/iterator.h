@@ -35,6 +35,7 @@
 
 struct bt_port;
 struct bt_graph;
+struct bt_message_iterator_stage;
 
 enum bt_message_iterator_state {
 	/* Iterator is not initialized */
@@ -88,6 +89,13 @@ typedef enum bt_message_iterator_class_can_seek_beginning_method_status
 struct bt_self_message_iterator_configuration {
 	bool frozen;
 	bool can_seek_forward;
+
+	/*
+	 * Size of the message batch queue of the stage which runs the
+	 * "next" method in a dedicated thread, or 0 to run it on the
+	 * consumer's thread (unless the connection is cut).
+	 */
+	uint64_t stage_queue_size;
 };
 
 struct bt_message_iterator {
@@ -99,6 +107,26 @@ struct bt_message_iterator {
 	struct bt_graph *graph; /* Weak */
 	struct bt_self_message_iterator_configuration config;
 
+	/*
+	 * Current, initial, and maximum sizes of the message batches,
+	 * copied from the graph's configuration when creating this
+	 * iterator.
+	 *
+	 * `size` is the capacity passed to the "next" method: `msgs`
+	 * contains at least `size` elements.
+	 *
+	 * When `max_size` is greater than `min_size`, the batch size is
+	 * adaptive: it doubles, up to `max_size`, each time the "next"
+	 * method fills the whole batch, and it goes back to `min_size`
+	 * each time the "next" method returns
+	 * `BT_FUNC_STATUS_AGAIN`.
+	 */
+	struct {
+		uint64_t size;
+		uint64_t min_size;
+		uint64_t max_size;
+	} batch;
+
 	/*
 	 * Array of
 	 * `struct bt_message_iterator *`
@@ -120,6 +148,12 @@ struct bt_message_iterator {
 	 */
 	struct bt_message_iterator *downstream_msg_iter;
 
+	/*
+	 * True if the "next" method of this iterator runs in a stage
+	 * thread, either its own or the one of a downstream iterator.
+	 */
+	bool runs_in_stage;
+
 	struct {
 		bt_message_iterator_next_method next;
 
@@ -196,6 +230,13 @@ struct bt_message_iterator {
 		void *original_next_callback;
 	} auto_seek;
 
+	/*
+	 * Stage running the "next" method of this iterator in another
+	 * thread (owned by this iterator), or `NULL` if this iterator's
+	 * connection is not cut.
+	 */
+	struct bt_message_iterator_stage *stage;
+
 	void *user_data;
 };
 
@@ -203,6 +244,15 @@ BT_HIDDEN
 void bt_message_iterator_try_finalize(
 		struct bt_message_iterator *iterator);
 
+/*
+ * Calls the "next" method of `iterator` directly, without going
+ * through its stage, if any, to fill `msgs`, which must contain at
+ * least `iterator->batch.size` elements, and updates the batch size.
+ */
+BT_HIDDEN
+int bt_message_iterator_call_next(struct bt_message_iterator *iterator,
+		bt_message_array_const msgs, uint64_t *count);
+
 BT_HIDDEN
 void bt_message_iterator_set_connection(
 		struct bt_message_iterator *iterator,
@@ -53,6 +53,12 @@ struct bt_message {
 
 	/* Owned by this; keeps the graph alive while the msg. is alive */
 	struct bt_graph *graph;
+
+	/*
+	 * Index of this message within the graph's array of messages,
+	 * if `graph` is set, so that removing it is O(1).
+	 */
+	guint graph_msgs_index;
 };
 
 #define _BT_ASSERT_PRE_MSG_IS_TYPE_COND(_msg, _type)			\
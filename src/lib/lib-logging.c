@@ -146,11 +146,28 @@ static inline void format_uuid(char **buf_ch, bt_uuid uuid)
 static inline void format_object_pool(char **buf_ch, bool extended,
 		const char *prefix, const struct bt_object_pool *pool)
 {
-	BUF_APPEND(", %ssize=%zu", PRFIELD(pool->size));
+	BUF_APPEND(", %stype=%s, %ssize=%zu",
+		PRFIELD(bt_object_pool_type_string(pool->type)),
+		PRFIELD(pool->size));
 
 	if (pool->objects) {
 		BUF_APPEND(", %scap=%u", PRFIELD(pool->objects->len));
 	}
+
+	if (!extended) {
+		return;
+	}
+
+	BUF_APPEND(", %smax-size=%zu, %sout-count=%zu, "
+		"%sout-high-water-mark=%zu, %salloc-count=%" PRIu64 ", "
+		"%srecycle-count=%" PRIu64 ", %smiss-count=%" PRIu64 ", "
+		"%sdiscard-count=%" PRIu64,
+		PRFIELD(pool->max_size), PRFIELD(pool->out_count),
+		PRFIELD(pool->out_high_water_mark),
+		PRFIELD(pool->stats.alloc_count),
+		PRFIELD(pool->stats.recycle_count),
+		PRFIELD(pool->stats.miss_count),
+		PRFIELD(pool->stats.discard_count));
 }
 
 static inline void format_integer_field_class(char **buf_ch,
@@ -437,10 +454,11 @@ static inline void format_field(char **buf_ch, bool extended,
 
 		BUF_APPEND(", %slength=%" PRIu64, PRFIELD(array_field->length));
 
-		if (array_field->fields) {
-			BUF_APPEND(", %sallocated-length=%u",
-				PRFIELD(array_field->fields->len));
-		}
+		BUF_APPEND(", %sallocated-length=%" PRIu64,
+			PRFIELD(array_field->capacity));
+		BUF_APPEND(", %spacked-value-size=%zu, %svalues-state=%d",
+			PRFIELD(array_field->packed_value_size),
+			PRFIELD((int) array_field->values_state));
 
 		break;
 	}
@@ -752,11 +770,13 @@ static inline void format_event(char **buf_ch, bool extended,
 	BUF_APPEND(", %sis-frozen=%d, "
 		"%scommon-context-field-addr=%p, "
 		"%sspecific-context-field-addr=%p, "
-		"%spayload-field-addr=%p, ",
+		"%spayload-field-addr=%p, "
+		"%sis-payload-field-materialized=%d, ",
 		PRFIELD(event->frozen),
 		PRFIELD(event->common_context_field),
 		PRFIELD(event->specific_context_field),
-		PRFIELD(event->payload_field));
+		PRFIELD(event->payload_field),
+		PRFIELD(!event->payload_field_materializer.materialize_func));
 	BUF_APPEND(", %sevent-class-addr=%p", PRFIELD(event->class));
 
 	if (!event->class) {
@@ -1084,7 +1104,8 @@ static inline void format_component_class(char **buf_ch, bool extended,
 		return;
 	}
 
-	BUF_APPEND(", %sis-frozen=%d", PRFIELD(comp_class->frozen));
+	BUF_APPEND(", %sis-frozen=%d, %sis-python=%d",
+		PRFIELD(comp_class->frozen), PRFIELD(comp_class->is_python));
 
 	if (comp_class->so_handle) {
 		SET_TMP_PREFIX("so-handle-");
@@ -1151,6 +1172,9 @@ static inline void format_connection(char **buf_ch, bool extended,
 		return;
 	}
 
+	BUF_APPEND(", %sstage-queue-size=%" PRIu64,
+		PRFIELD(connection->stage_queue_size));
+
 	if (connection->upstream_port) {
 		SET_TMP_PREFIX("upstream-port-");
 		format_port(buf_ch, false, tmp_prefix,
@@ -1177,6 +1201,10 @@ static inline void format_graph(char **buf_ch, bool extended,
 		return;
 	}
 
+	BUF_APPEND(", %smsg-batch-size=%" PRIu64 ", %smsg-batch-max-size=%" PRIu64,
+		PRFIELD(graph->msg_batch.size),
+		PRFIELD(graph->msg_batch.max_size));
+
 	if (graph->components) {
 		BUF_APPEND(", %scomp-count=%u",
 			PRFIELD(graph->components->len));
@@ -1223,6 +1251,12 @@ static inline void format_message_iterator(char **buf_ch,
 		goto end;
 	}
 
+	BUF_APPEND(", %sbatch-size=%" PRIu64 ", %sbatch-min-size=%" PRIu64
+		", %sbatch-max-size=%" PRIu64,
+		PRFIELD(port_in_iter->batch.size),
+		PRFIELD(port_in_iter->batch.min_size),
+		PRFIELD(port_in_iter->batch.max_size));
+
 	if (port_in_iter->upstream_port) {
 		SET_TMP_PREFIX("upstream-port-");
 		format_port(buf_ch, false, tmp_prefix,
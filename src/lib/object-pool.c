@@ -24,11 +24,65 @@
 #include "lib/logging.h"
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "common/assert.h"
 #include "lib/assert-pre.h"
 #include "lib/object-pool.h"
 
+/*
+ * Default maximum size of an object pool, from the
+ * `LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE` environment variable.
+ */
+static size_t default_max_size = SIZE_MAX;
+
+/*
+ * Statistics of all the finalized object pools, per object pool type
+ * (see bt_util_get_object_pool_statistics()).
+ */
+static struct {
+	uint64_t alloc_count;
+	uint64_t recycle_count;
+	uint64_t miss_count;
+	uint64_t discard_count;
+} total_stats[BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT + 1];
+
+/* Registry of the initialized object pools (`struct bt_object_pool *`) */
+static GQueue pools = G_QUEUE_INIT;
+
+/*
+ * Protects `total_stats` and `pools`: pools can be initialized and
+ * finalized in any thread.
+ */
+static GMutex pools_lock;
+
+static
+void __attribute__((constructor)) bt_object_pool_ctor(void)
+{
+	const char *val = getenv("LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE");
+	guint64 max_size;
+	gchar *endptr;
+
+	if (!val) {
+		goto end;
+	}
+
+	max_size = g_ascii_strtoull(val, &endptr, 10);
+	if (val[0] == '\0' || val[0] == '-' || *endptr != '\0' ||
+			max_size > SIZE_MAX) {
+		BT_LOGW("Invalid `LIBBABELTRACE2_OBJECT_POOL_MAX_SIZE` "
+			"environment variable value: value=\"%s\"", val);
+		goto end;
+	}
+
+	default_max_size = (size_t) max_size;
+
+end:
+	return;
+}
+
 int bt_object_pool_initialize(struct bt_object_pool *pool,
+		enum bt_util_object_pool_type type,
 		bt_object_pool_new_object_func new_object_func,
 		bt_object_pool_destroy_object_func destroy_object_func,
 		void *data)
@@ -38,8 +92,10 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 	BT_ASSERT(pool);
 	BT_ASSERT(new_object_func);
 	BT_ASSERT(destroy_object_func);
-	BT_LOGD("Initializing object pool: addr=%p, data-addr=%p",
-		pool, data);
+	BT_LOGD("Initializing object pool: addr=%p, type=%s, data-addr=%p",
+		pool, bt_object_pool_type_string(type), data);
+	pool->type = type;
+	pool->registry_link.data = NULL;
 	pool->objects = g_ptr_array_new();
 	if (!pool->objects) {
 		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
@@ -50,6 +106,17 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 	pool->funcs.destroy_object = destroy_object_func;
 	pool->data = data;
 	pool->size = 0;
+	pool->max_size = default_max_size;
+	pool->out_count = 0;
+	pool->out_high_water_mark = 0;
+	pool->prev_out_high_water_mark = 0;
+	pool->window_ops_left = BT_OBJECT_POOL_TRIM_WINDOW;
+	memset(&pool->stats, 0, sizeof(pool->stats));
+	g_mutex_init(&pool->lock);
+	pool->registry_link.data = pool;
+	g_mutex_lock(&pools_lock);
+	g_queue_push_tail_link(&pools, &pool->registry_link);
+	g_mutex_unlock(&pools_lock);
 	BT_LIB_LOGD("Initialized object pool: %!+o", pool);
 	goto end;
 
@@ -68,6 +135,28 @@ void bt_object_pool_finalize(struct bt_object_pool *pool)
 	BT_ASSERT(pool);
 	BT_LIB_LOGD("Finalizing object pool: %!+o", pool);
 
+	if (pool->stats.alloc_count > 0) {
+		BT_LIB_LOGI("Object pool statistics: %!+o", pool);
+	}
+
+	if (pool->registry_link.data) {
+		/*
+		 * Move the statistics of this pool to the totals,
+		 * atomically for bt_util_get_object_pool_statistics().
+		 */
+		BT_ASSERT(pool->type < G_N_ELEMENTS(total_stats));
+		g_mutex_lock(&pools_lock);
+		g_queue_unlink(&pools, &pool->registry_link);
+		total_stats[pool->type].alloc_count += pool->stats.alloc_count;
+		total_stats[pool->type].recycle_count +=
+			pool->stats.recycle_count;
+		total_stats[pool->type].miss_count += pool->stats.miss_count;
+		total_stats[pool->type].discard_count +=
+			pool->stats.discard_count;
+		g_mutex_unlock(&pools_lock);
+		pool->registry_link.data = NULL;
+	}
+
 	if (pool->objects) {
 		for (i = 0; i < pool->size; i++) {
 			void *obj = pool->objects->pdata[i];
@@ -79,5 +168,160 @@ void bt_object_pool_finalize(struct bt_object_pool *pool)
 
 		g_ptr_array_free(pool->objects, TRUE);
 		pool->objects = NULL;
+		g_mutex_clear(&pool->lock);
+	}
+}
+
+/*
+ * Removes the `count` least recently recycled objects of `pool`, which
+ * is locked if `locked` is true, and destroys them once `pool` is
+ * unlocked.
+ */
+static
+void remove_objects(struct bt_object_pool *pool, size_t count, bool locked)
+{
+	void **objs = NULL;
+	size_t i;
+
+	BT_ASSERT(count <= pool->size);
+
+	if (count > 0) {
+		objs = g_new(void *, count);
+		if (!objs) {
+			BT_LOGE("Failed to allocate an array of objects to destroy: "
+				"pool-addr=%p, count=%zu", pool, count);
+		} else {
+			/*
+			 * The least recently recycled objects are at
+			 * the bottom of the pool: removing them shrinks
+			 * the pool's capacity too.
+			 */
+			memcpy(objs, pool->objects->pdata,
+				sizeof(*objs) * count);
+			g_ptr_array_remove_range(pool->objects, 0, count);
+			pool->size -= count;
+			bt_object_pool_stats_add(&pool->stats.discard_count,
+				count);
+		}
+	}
+
+	if (locked) {
+		g_mutex_unlock(&pool->lock);
+	}
+
+	if (!objs) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		pool->funcs.destroy_object(objs[i], pool->data);
+	}
+
+	g_free(objs);
+	BT_LOGD("Destroyed recycled objects: pool-addr=%p, count=%zu",
+		pool, count);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size)
+{
+	bool locked = bt_object_is_concurrent();
+
+	BT_ASSERT(pool);
+
+	if (locked) {
+		g_mutex_lock(&pool->lock);
+	}
+
+	pool->max_size = max_size;
+	BT_LIB_LOGD("Set object pool's maximum size: %!+o", pool);
+	remove_objects(pool,
+		pool->size > max_size ? pool->size - max_size : 0, locked);
+}
+
+BT_HIDDEN
+void bt_object_pool_trim(struct bt_object_pool *pool)
+{
+	bool locked = bt_object_is_concurrent();
+	size_t total;
+	size_t high_water_mark;
+	size_t excess = 0;
+
+	BT_ASSERT(pool);
+
+	if (locked) {
+		g_mutex_lock(&pool->lock);
+	}
+
+	/*
+	 * The user needed at most `high_water_mark` objects at the same
+	 * time during the last two windows: the other recycled objects
+	 * are excess.
+	 */
+	high_water_mark = MAX(pool->out_high_water_mark,
+		pool->prev_out_high_water_mark);
+	total = pool->out_count + pool->size;
+
+	if (total > high_water_mark) {
+		excess = MIN(total - high_water_mark, pool->size);
+	}
+
+	BT_LOGD("Trimming object pool: pool-addr=%p, pool-size=%zu, "
+		"out-count=%zu, out-high-water-mark=%zu, "
+		"prev-out-high-water-mark=%zu, excess=%zu",
+		pool, pool->size, pool->out_count,
+		pool->out_high_water_mark, pool->prev_out_high_water_mark,
+		excess);
+	pool->prev_out_high_water_mark = pool->out_high_water_mark;
+	pool->out_high_water_mark = pool->out_count;
+
+	/* See the comment at the top of `object-pool.h` */
+	pool->window_ops_left = (unsigned int) MIN(
+		MAX((size_t) BT_OBJECT_POOL_TRIM_WINDOW, 2 * high_water_mark),
+		(size_t) G_MAXUINT);
+	remove_objects(pool, excess, locked);
+}
+
+void bt_util_get_object_pool_statistics(
+		enum bt_util_object_pool_type type, uint64_t *alloc_count,
+		uint64_t *recycle_count, uint64_t *miss_count,
+		uint64_t *discard_count)
+{
+	GList *link;
+
+	BT_ASSERT_PRE((unsigned int) type < G_N_ELEMENTS(total_stats),
+		"Invalid object pool type: type=%d", type);
+	BT_ASSERT_PRE_NON_NULL(alloc_count, "Allocation count (output)");
+	BT_ASSERT_PRE_NON_NULL(recycle_count, "Recycle count (output)");
+	BT_ASSERT_PRE_NON_NULL(miss_count, "Miss count (output)");
+	BT_ASSERT_PRE_NON_NULL(discard_count, "Discard count (output)");
+	g_mutex_lock(&pools_lock);
+	*alloc_count = total_stats[type].alloc_count;
+	*recycle_count = total_stats[type].recycle_count;
+	*miss_count = total_stats[type].miss_count;
+	*discard_count = total_stats[type].discard_count;
+
+	/* Add the current statistics of the live pools */
+	for (link = pools.head; link; link = link->next) {
+		const struct bt_object_pool *pool = link->data;
+
+		if (pool->type != type) {
+			continue;
+		}
+
+		*alloc_count += bt_object_pool_stats_get(
+			&pool->stats.alloc_count);
+		*recycle_count += bt_object_pool_stats_get(
+			&pool->stats.recycle_count);
+		*miss_count += bt_object_pool_stats_get(
+			&pool->stats.miss_count);
+		*discard_count += bt_object_pool_stats_get(
+			&pool->stats.discard_count);
 	}
+
+	g_mutex_unlock(&pools_lock);
 }
@@ -46,9 +46,38 @@
  *   bt_*_recycle() function which does the necessary before calling
  *   bt_object_pool_recycle_object() with an object ready to be reused
  *   at any time.
+ *
+ * An object pool never contains more than `max_size` recycled objects:
+ * bt_object_pool_recycle_object() destroys the object to recycle
+ * instead when the pool is full.
+ *
+ * Also, at the end of each trimming window, the object pool destroys
+ * the recycled objects which it didn't need during this window and the
+ * previous one, that is, the ones beyond the high-water mark of the
+ * number of objects which its user had at the same time. This releases
+ * the memory of a burst of objects once it's over.
+ *
+ * A trimming window lasts at least `BT_OBJECT_POOL_TRIM_WINDOW`
+ * operations, and at least twice the last high-water mark: a user
+ * which creates, and then recycles, a batch of N objects over and over
+ * needs 2N operations per cycle, and the pool must see the peak of a
+ * whole cycle not to destroy objects which the next cycle needs again.
+ *
+ * Trimming only happens on bt_object_pool_create_object() and
+ * bt_object_pool_recycle_object(): an idle pool keeps its recycled
+ * objects until its user creates or recycles objects again, or until
+ * it's finalized. bt_object_pool_set_max_size() destroys the excess
+ * recycled objects immediately.
+ *
+ * The library keeps a registry of the initialized object pools so that
+ * bt_util_get_object_pool_statistics() can add the statistics of the
+ * live pools to the ones of the finalized pools.
  */
 
+#include <babeltrace2/util.h>
 #include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "lib/object.h"
 
 /* Protection: this file uses BT_LIB_LOG*() macros directly */
@@ -56,6 +85,13 @@
 # error Please include "lib/logging.h" before including this file.
 #endif
 
+/*
+ * Minimum number of bt_object_pool_create_object() and
+ * bt_object_pool_recycle_object() calls between two trimming
+ * operations.
+ */
+#define BT_OBJECT_POOL_TRIM_WINDOW	4096
+
 typedef void *(*bt_object_pool_new_object_func)(void *data);
 typedef void (*bt_object_pool_destroy_object_func)(void *obj, void *data);
 
@@ -72,6 +108,56 @@ struct bt_object_pool {
 	 */
 	size_t size;
 
+	/*
+	 * Type of the objects of this pool, to add its statistics to
+	 * the totals of bt_util_get_object_pool_statistics() when
+	 * finalizing it
+	 */
+	enum bt_util_object_pool_type type;
+
+	/* Maximum pool size */
+	size_t max_size;
+
+	/*
+	 * Number of objects created from this pool and not recycled
+	 * yet, and its maximum value during the current trimming window.
+	 */
+	size_t out_count;
+	size_t out_high_water_mark;
+
+	/* Value of `out_high_water_mark` at the end of the last window */
+	size_t prev_out_high_water_mark;
+
+	/* Number of operations left before the next trimming */
+	unsigned int window_ops_left;
+
+	/*
+	 * Statistics of this pool.
+	 *
+	 * Only one thread modifies them at a time (see `lock` below),
+	 * but bt_util_get_object_pool_statistics() can read them from
+	 * any thread: use bt_object_pool_stats_add() to modify them.
+	 */
+	struct {
+		/* Number of created objects */
+		uint64_t alloc_count;
+
+		/* Number of recycled objects kept in this pool */
+		uint64_t recycle_count;
+
+		/*
+		 * Number of created objects for which this pool was
+		 * empty.
+		 */
+		uint64_t miss_count;
+
+		/*
+		 * Number of destroyed objects, because this pool was
+		 * full or when trimming it.
+		 */
+		uint64_t discard_count;
+	} stats;
+
 	/* User functions */
 	struct {
 		/* Allocate a new object in memory */
@@ -83,13 +169,70 @@ struct bt_object_pool {
 
 	/* User data passed to user functions */
 	void *data;
+
+	/*
+	 * Only locked when other threads share objects (see
+	 * bt_object_is_concurrent()).
+	 */
+	GMutex lock;
+
+	/*
+	 * Link within the registry of initialized object pools; `data`
+	 * is this pool once registered, `NULL` otherwise.
+	 */
+	GList registry_link;
 };
 
+/*
+ * Adds `value` to the statistics counter `counter` of an object pool.
+ *
+ * Relaxed atomic accesses make reading the counter from another thread
+ * well-defined without the cost of an atomic read-modify-write
+ * operation, as only one thread modifies it at a time.
+ */
+static inline
+void bt_object_pool_stats_add(uint64_t *counter, uint64_t value)
+{
+	__atomic_store_n(counter,
+		__atomic_load_n(counter, __ATOMIC_RELAXED) + value,
+		__ATOMIC_RELAXED);
+}
+
+/*
+ * Returns the value of the statistics counter `counter` of an object
+ * pool, which another thread can modify.
+ */
+static inline
+uint64_t bt_object_pool_stats_get(const uint64_t *counter)
+{
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static inline
+const char *bt_object_pool_type_string(enum bt_util_object_pool_type type)
+{
+	switch (type) {
+	case BT_UTIL_OBJECT_POOL_TYPE_MESSAGE:
+		return "MESSAGE";
+	case BT_UTIL_OBJECT_POOL_TYPE_EVENT:
+		return "EVENT";
+	case BT_UTIL_OBJECT_POOL_TYPE_PACKET:
+		return "PACKET";
+	case BT_UTIL_OBJECT_POOL_TYPE_PACKET_CONTEXT_FIELD:
+		return "PACKET_CONTEXT_FIELD";
+	case BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT:
+		return "CLOCK_SNAPSHOT";
+	default:
+		return "(unknown)";
+	}
+}
+
 /*
  * Initializes an object pool which is already allocated.
  */
 BT_HIDDEN
 int bt_object_pool_initialize(struct bt_object_pool *pool,
+		enum bt_util_object_pool_type type,
 		bt_object_pool_new_object_func new_object_func,
 		bt_object_pool_destroy_object_func destroy_object_func,
 		void *data);
@@ -100,6 +243,32 @@ int bt_object_pool_initialize(struct bt_object_pool *pool,
 BT_HIDDEN
 void bt_object_pool_finalize(struct bt_object_pool *pool);
 
+/*
+ * Sets the maximum size of an object pool, destroying its excess
+ * recycled objects.
+ */
+BT_HIDDEN
+void bt_object_pool_set_max_size(struct bt_object_pool *pool,
+		size_t max_size);
+
+/*
+ * Destroys the recycled objects of an object pool which its user
+ * didn't need during the last trimming window.
+ */
+BT_HIDDEN
+void bt_object_pool_trim(struct bt_object_pool *pool);
+
+/*
+ * Returns whether or not this operation ends the current trimming
+ * window of `pool`.
+ */
+static inline
+bool bt_object_pool_tick_window(struct bt_object_pool *pool)
+{
+	pool->window_ops_left--;
+	return G_UNLIKELY(pool->window_ops_left == 0);
+}
+
 /*
  * Creates an object from an object pool. If the pool is empty, this
  * function calls the "new" user function to allocate a new object
@@ -112,11 +281,27 @@ static inline
 void *bt_object_pool_create_object(struct bt_object_pool *pool)
 {
 	struct bt_object *obj;
+	bool locked = false;
+	bool trim;
 
 	BT_ASSERT_DBG(pool);
 	BT_LOGT("Creating object from pool: pool-addr=%p, pool-size=%zu, pool-cap=%u",
 		pool, pool->size, pool->objects->len);
 
+	if (bt_object_is_concurrent()) {
+		g_mutex_lock(&pool->lock);
+		locked = true;
+	}
+
+	bt_object_pool_stats_add(&pool->stats.alloc_count, 1);
+	pool->out_count++;
+
+	if (pool->out_count > pool->out_high_water_mark) {
+		pool->out_high_water_mark = pool->out_count;
+	}
+
+	trim = bt_object_pool_tick_window(pool);
+
 	if (pool->size > 0) {
 		/* Pick one from the pool */
 		pool->size--;
@@ -125,12 +310,28 @@ void *bt_object_pool_create_object(struct bt_object_pool *pool)
 		goto end;
 	}
 
+	bt_object_pool_stats_add(&pool->stats.miss_count, 1);
+
+	if (locked) {
+		/* Don't hold the lock while allocating */
+		g_mutex_unlock(&pool->lock);
+		locked = false;
+	}
+
 	/* Pool is empty: create a brand new object */
 	BT_LOGD("Pool is empty: allocating new object: pool-addr=%p",
 		pool);
 	obj = pool->funcs.new_object(pool->data);
 
 end:
+	if (locked) {
+		g_mutex_unlock(&pool->lock);
+	}
+
+	if (G_UNLIKELY(trim)) {
+		bt_object_pool_trim(pool);
+	}
+
 	BT_LOGT("Created one object from pool: pool-addr=%p, obj-addr=%p",
 		pool, obj);
 	return obj;
@@ -145,12 +346,33 @@ static inline
 void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 {
 	struct bt_object *bt_obj = obj;
+	bool locked = false;
+	bool trim;
+	bool discard = false;
 
 	BT_ASSERT_DBG(pool);
 	BT_ASSERT_DBG(obj);
 	BT_LOGT("Recycling object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
 		pool, pool->size, pool->objects->len, obj);
 
+	if (bt_object_is_concurrent()) {
+		g_mutex_lock(&pool->lock);
+		locked = true;
+	}
+
+	if (pool->out_count > 0) {
+		pool->out_count--;
+	}
+
+	trim = bt_object_pool_tick_window(pool);
+
+	if (G_UNLIKELY(pool->size >= pool->max_size)) {
+		/* Pool is full: destroy the object instead */
+		bt_object_pool_stats_add(&pool->stats.discard_count, 1);
+		discard = true;
+		goto end;
+	}
+
 	if (pool->size == pool->objects->len) {
 		/* Backing array is full: make place for recycled object */
 		BT_LOGD("Object pool is full: increasing object pool capacity: "
@@ -165,8 +387,26 @@ void bt_object_pool_recycle_object(struct bt_object_pool *pool, void *obj)
 	/* Back to the pool */
 	pool->objects->pdata[pool->size] = obj;
 	pool->size++;
-	BT_LOGT("Recycled object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
-		pool, pool->size, pool->objects->len, obj);
+	bt_object_pool_stats_add(&pool->stats.recycle_count, 1);
+
+end:
+	if (locked) {
+		g_mutex_unlock(&pool->lock);
+	}
+
+	if (G_UNLIKELY(discard)) {
+		BT_LOGD("Object pool is full: destroying object: "
+			"pool-addr=%p, pool-size=%zu, obj-addr=%p",
+			pool, pool->size, obj);
+		pool->funcs.destroy_object(obj, pool->data);
+	} else {
+		BT_LOGT("Recycled object: pool-addr=%p, pool-size=%zu, pool-cap=%u, obj-addr=%p",
+			pool, pool->size, pool->objects->len, obj);
+	}
+
+	if (G_UNLIKELY(trim)) {
+		bt_object_pool_trim(pool);
+	}
 }
 
 #endif /* BABELTRACE_OBJECT_POOL_INTERNAL_H */
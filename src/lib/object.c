@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc. and Linux Foundation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "LIB/OBJECT"
+#include "lib/logging.h"
+
+#include <glib.h>
+#include "common/assert.h"
+#include "lib/object.h"
+
+int bt_object_concurrency;
+
+void bt_object_begin_concurrency(void)
+{
+	g_atomic_int_inc(&bt_object_concurrency);
+	BT_LOGD("Began sharing objects with another thread: "
+		"concurrency=%d", g_atomic_int_get(&bt_object_concurrency));
+}
+
+void bt_object_end_concurrency(void)
+{
+	BT_ASSERT(g_atomic_int_get(&bt_object_concurrency) > 0);
+	(void) g_atomic_int_dec_and_test(&bt_object_concurrency);
+	BT_LOGD("Ended sharing objects with another thread: "
+		"concurrency=%d", g_atomic_int_get(&bt_object_concurrency));
+}
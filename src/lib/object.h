@@ -26,10 +26,44 @@
 
 #include "common/macros.h"
 #include "common/assert.h"
+#include <glib.h>
 #include <stdbool.h>
 
 struct bt_object;
 
+/*
+ * Number of threads, other than the main thread, which currently share
+ * library objects (see bt_object_begin_concurrency()).
+ *
+ * When this is greater than 0, the reference counts of all the objects,
+ * as well as the object pools, are modified atomically. Otherwise, they
+ * are modified with plain (cheaper) operations.
+ *
+ * Always access it with the g_atomic_int_*() functions. It only goes
+ * from 0 to 1 before a thread starts, and from 1 to 0 after the last
+ * thread is joined, so that the thread which changes it is then the
+ * only one using library objects.
+ */
+extern
+int bt_object_concurrency;
+
+/*
+ * Call this before starting a thread which is going to share library
+ * objects with the calling thread, and bt_object_end_concurrency()
+ * after joining it.
+ */
+BT_HIDDEN
+void bt_object_begin_concurrency(void);
+
+BT_HIDDEN
+void bt_object_end_concurrency(void);
+
+static inline
+bool bt_object_is_concurrent(void)
+{
+	return G_UNLIKELY(g_atomic_int_get(&bt_object_concurrency) > 0);
+}
+
 typedef void (*bt_object_release_func)(struct bt_object *);
 typedef void (*bt_object_parent_is_owner_listener_func)(
 		struct bt_object *);
@@ -251,7 +285,13 @@ void bt_object_inc_ref_count(const struct bt_object *c_obj)
 
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
-	obj->ref_count++;
+
+	if (bt_object_is_concurrent()) {
+		__atomic_add_fetch(&obj->ref_count, 1, __ATOMIC_RELAXED);
+	} else {
+		obj->ref_count++;
+	}
+
 	BT_ASSERT_DBG(obj->ref_count != 0);
 }
 
@@ -281,6 +321,19 @@ void bt_object_get_ref_no_null_check(const void *c_obj)
 	BT_ASSERT_DBG(obj);
 	BT_ASSERT_DBG(obj->is_shared);
 
+	if (bt_object_is_concurrent()) {
+		/*
+		 * Only the thread which brings the reference count from
+		 * 0 to 1 gets a reference on the parent.
+		 */
+		if (__atomic_fetch_add(&obj->ref_count, 1,
+				__ATOMIC_ACQ_REL) == 0 && obj->parent) {
+			bt_object_get_ref_no_null_check(obj->parent);
+		}
+
+		return;
+	}
+
 	if (G_UNLIKELY(obj->parent && bt_object_get_ref_count(obj) == 0)) {
 #ifdef BT_LOGT
 		BT_LOGT("Incrementing object's parent's reference count: "
@@ -316,12 +369,21 @@ void bt_object_put_ref_no_null_check(const void *c_obj)
 		obj, obj->ref_count, obj->ref_count - 1);
 #endif
 
-	obj->ref_count--;
+	if (bt_object_is_concurrent()) {
+		if (__atomic_sub_fetch(&obj->ref_count, 1,
+				__ATOMIC_ACQ_REL) != 0) {
+			return;
+		}
+	} else {
+		obj->ref_count--;
 
-	if (obj->ref_count == 0) {
-		BT_ASSERT_DBG(obj->release_func);
-		obj->release_func(obj);
+		if (obj->ref_count != 0) {
+			return;
+		}
 	}
+
+	BT_ASSERT_DBG(obj->release_func);
+	obj->release_func(obj);
 }
 
 static inline
@@ -367,6 +367,11 @@ int bt_plugin_add_component_class(
 		bt_plugin_so_on_add_component_class(plugin, comp_class);
 	}
 
+	/* Special case for a Python plugin */
+	if (plugin->type == BT_PLUGIN_TYPE_PYTHON) {
+		comp_class->is_python = true;
+	}
+
 	BT_LIB_LOGD("Added component class to plugin: "
 		"%![plugin-]+l, %![cc-]+C", plugin, comp_class);
 	return BT_FUNC_STATUS_OK;
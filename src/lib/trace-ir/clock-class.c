@@ -123,6 +123,7 @@ struct bt_clock_class *bt_clock_class_create(bt_self_component *self_comp)
 	clock_class->origin_is_unix_epoch = BT_TRUE;
 	set_base_offset(clock_class);
 	ret = bt_object_pool_initialize(&clock_class->cs_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT,
 		(bt_object_pool_new_object_func) bt_clock_snapshot_new,
 		(bt_object_pool_destroy_object_func)
 			free_clock_snapshot,
@@ -152,6 +152,7 @@ struct bt_event_class *create_event_class_with_id(
 	}
 
 	ret = bt_object_pool_initialize(&event_class->event_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_EVENT,
 		(bt_object_pool_new_object_func) bt_event_new,
 		(bt_object_pool_destroy_object_func) free_event,
 		event_class);
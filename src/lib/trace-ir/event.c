@@ -186,17 +186,89 @@ const struct bt_field *bt_event_borrow_specific_context_field_const(
 	return event->specific_context_field;
 }
 
+/*
+ * Protects the materialization of event payload fields: many threads
+ * can borrow the payload field of the same const event.
+ */
+static
+GMutex payload_field_materializer_lock;
+
+static
+void materialize_payload_field(struct bt_event *event)
+{
+	bt_event_payload_field_materialize_func materialize_func;
+	bt_event_payload_field_materializer_finalize_func finalize_func;
+	void *data;
+
+	g_mutex_lock(&payload_field_materializer_lock);
+	materialize_func = event->payload_field_materializer.materialize_func;
+	if (!materialize_func) {
+		/* Another thread materialized it meanwhile */
+		goto end;
+	}
+
+	finalize_func = event->payload_field_materializer.finalize_func;
+	data = event->payload_field_materializer.data;
+	BT_ASSERT_DBG(event->payload_field);
+	BT_LIB_LOGD("Materializing event's payload field: %!+e", event);
+
+	/*
+	 * The event is typically frozen at this point: let the function
+	 * set the payload field anyway.
+	 */
+	bt_field_set_is_frozen(event->payload_field, false);
+	materialize_func(event->payload_field, data);
+	bt_field_set_is_frozen(event->payload_field, event->frozen);
+
+	if (finalize_func) {
+		finalize_func(data);
+	}
+
+	event->payload_field_materializer.finalize_func = NULL;
+	event->payload_field_materializer.data = NULL;
+
+	/* Publish the set payload field to the other threads */
+	__atomic_store_n(&event->payload_field_materializer.materialize_func,
+		NULL, __ATOMIC_RELEASE);
+
+end:
+	g_mutex_unlock(&payload_field_materializer_lock);
+}
+
+void bt_event_set_payload_field_materializer(struct bt_event *event,
+		bt_event_payload_field_materialize_func materialize_func,
+		bt_event_payload_field_materializer_finalize_func finalize_func,
+		void *data)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(event, "Event");
+	BT_ASSERT_PRE_DEV_NON_NULL(materialize_func,
+		"Payload field materialize function");
+	BT_ASSERT_PRE_DEV_EVENT_HOT(event);
+	BT_ASSERT_PRE_DEV(event->payload_field,
+		"Event has no payload field: %!+e", event);
+	bt_event_finalize_payload_field_materializer(event);
+	event->payload_field_materializer.materialize_func = materialize_func;
+	event->payload_field_materializer.finalize_func = finalize_func;
+	event->payload_field_materializer.data = data;
+}
+
 struct bt_field *bt_event_borrow_payload_field(struct bt_event *event)
 {
 	BT_ASSERT_PRE_DEV_NON_NULL(event, "Event");
+
+	if (G_UNLIKELY(__atomic_load_n(
+			&event->payload_field_materializer.materialize_func,
+			__ATOMIC_ACQUIRE))) {
+		materialize_payload_field(event);
+	}
+
 	return event->payload_field;
 }
 
 const struct bt_field *bt_event_borrow_payload_field_const(
 		const struct bt_event *event)
 {
-	BT_ASSERT_PRE_DEV_NON_NULL(event, "Event");
-	return event->payload_field;
+	return bt_event_borrow_payload_field((void *) event);
 }
 
 BT_HIDDEN
@@ -217,6 +289,8 @@ void bt_event_destroy(struct bt_event *event)
 		event->specific_context_field = NULL;
 	}
 
+	bt_event_finalize_payload_field_materializer(event);
+
 	if (event->payload_field) {
 		BT_LOGD_STR("Destroying event's payload field.");
 		bt_field_destroy(event->payload_field);
@@ -66,6 +66,22 @@ struct bt_event {
 	struct bt_field *common_context_field;
 	struct bt_field *specific_context_field;
 	struct bt_field *payload_field;
+
+	/*
+	 * Function which sets the payload field on the first borrowing
+	 * of the latter (`materialize_func` is `NULL` if the payload
+	 * field is already set).
+	 *
+	 * bt_event_borrow_payload_field() reads `materialize_func`
+	 * atomically, and calls it under a global lock, as many threads
+	 * can borrow the payload field of the same const event.
+	 */
+	struct {
+		bt_event_payload_field_materialize_func materialize_func;
+		bt_event_payload_field_materializer_finalize_func finalize_func;
+		void *data;
+	} payload_field_materializer;
+
 	bool frozen;
 };
 
@@ -116,11 +132,31 @@ void _bt_event_reset_dev_mode(struct bt_event *event)
 # define bt_event_reset_dev_mode(_x)
 #endif
 
+static inline
+void bt_event_finalize_payload_field_materializer(struct bt_event *event)
+{
+	BT_ASSERT_DBG(event);
+
+	if (G_LIKELY(!event->payload_field_materializer.materialize_func)) {
+		return;
+	}
+
+	if (event->payload_field_materializer.finalize_func) {
+		event->payload_field_materializer.finalize_func(
+			event->payload_field_materializer.data);
+	}
+
+	event->payload_field_materializer.materialize_func = NULL;
+	event->payload_field_materializer.finalize_func = NULL;
+	event->payload_field_materializer.data = NULL;
+}
+
 static inline
 void bt_event_reset(struct bt_event *event)
 {
 	BT_ASSERT_DBG(event);
 	BT_LIB_LOGD("Resetting event: %!+e", event);
+	bt_event_finalize_payload_field_materializer(event);
 	bt_event_set_is_frozen(event, false);
 	bt_object_put_ref_no_null_check(&event->stream->base);
 	event->stream = NULL;
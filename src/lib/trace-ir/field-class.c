@@ -330,6 +330,323 @@ void finalize_enumeration_field_class_mapping(
 	BT_OBJECT_PUT_REF_AND_RESET(mapping->range_set);
 }
 
+/*
+ * Maximum length of the direct lookup table of an enumeration field
+ * class's label lookup index.
+ */
+#define ENUM_LOOKUP_TABLE_MAX_LEN	4096
+
+/*
+ * Maximum number of labels of an enumeration field class's label
+ * lookup index.
+ *
+ * Each segment of the index has the labels of all the mappings
+ * containing it: with many overlapping ranges, this is up to the
+ * number of segments times the number of mappings. Beyond this count,
+ * the field class doesn't have an index: a lookup checks each range of
+ * each mapping instead.
+ */
+#define ENUM_LOOKUP_MAX_LABEL_COUNT	65536
+
+/* Protects the lazy building of label lookup indexes */
+static
+GMutex enum_lookup_index_lock;
+
+static
+void destroy_enum_label_buf(gpointer data)
+{
+	g_ptr_array_free(data, TRUE);
+}
+
+/*
+ * Label buffer (`GPtrArray` of `const char *`) of the current thread
+ * for the lookups which don't use an index.
+ */
+static
+GPrivate enum_label_buf = G_PRIVATE_INIT(destroy_enum_label_buf);
+
+static inline
+uint64_t enum_key_from_value(bool is_signed, uint64_t value)
+{
+	return is_signed ? value ^ (UINT64_C(1) << 63) : value;
+}
+
+static
+void reset_enumeration_field_class_lookup_index(
+		struct bt_field_class_enumeration *enum_fc)
+{
+	g_free(enum_fc->lookup_index.seg_first_keys);
+	g_free(enum_fc->lookup_index.seg_label_offsets);
+	g_free(enum_fc->lookup_index.labels);
+	g_free(enum_fc->lookup_index.table);
+	memset(&enum_fc->lookup_index, 0, sizeof(enum_fc->lookup_index));
+}
+
+static
+int compare_enum_keys(const void *a, const void *b)
+{
+	uint64_t key_a = *(const uint64_t *) a;
+	uint64_t key_b = *(const uint64_t *) b;
+
+	return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+/*
+ * Returns the index of the segment of `key` within the label lookup
+ * index of `enum_fc`.
+ */
+static inline
+uint64_t find_enum_lookup_segment(
+		const struct bt_field_class_enumeration *enum_fc, uint64_t key)
+{
+	const uint64_t *first_keys = enum_fc->lookup_index.seg_first_keys;
+	uint64_t low = 0;
+	uint64_t high = enum_fc->lookup_index.seg_count - 1;
+
+	/* Find the last segment of which the first key is <= `key` */
+	BT_ASSERT_DBG(first_keys[0] == 0);
+
+	while (low < high) {
+		uint64_t mid = low + (high - low + 1) / 2;
+
+		if (first_keys[mid] <= key) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return low;
+}
+
+struct enum_lookup_range {
+	uint64_t mapping_index;
+	uint64_t first_key;
+	uint64_t last_key;
+};
+
+static
+int build_enumeration_field_class_lookup_index(
+		struct bt_field_class_enumeration *enum_fc)
+{
+	const bool is_signed = enum_fc->common.common.type ==
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION;
+	GArray *ranges = NULL;
+	uint64_t *first_keys;
+	uint64_t *last_mappings = NULL;
+	uint64_t *next_label_offsets = NULL;
+	uint64_t i, seg_i, seg_count;
+	uint64_t label_count = 0;
+	uint64_t min_key = UINT64_MAX, max_key = 0;
+	int ret = 0;
+
+	BT_ASSERT(!enum_fc->lookup_index.is_built);
+	BT_LIB_LOGD("Building enumeration field class's label lookup index: "
+		"%!+F", enum_fc);
+
+	/* Flatten the ranges of all the mappings, in mapping order */
+	ranges = g_array_new(FALSE, FALSE, sizeof(struct enum_lookup_range));
+	if (!ranges) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GArray.");
+		goto error;
+	}
+
+	for (i = 0; i < enum_fc->mappings->len; i++) {
+		const struct bt_field_class_enumeration_mapping *mapping =
+			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
+		uint64_t j;
+
+		for (j = 0; j < mapping->range_set->ranges->len; j++) {
+			const struct bt_integer_range *int_range =
+				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
+					mapping->range_set, j);
+			struct enum_lookup_range range = {
+				.mapping_index = i,
+				.first_key = enum_key_from_value(is_signed,
+					int_range->lower.u),
+				.last_key = enum_key_from_value(is_signed,
+					int_range->upper.u),
+			};
+
+			g_array_append_val(ranges, range);
+			min_key = MIN(min_key, range.first_key);
+			max_key = MAX(max_key, range.last_key);
+		}
+	}
+
+	/*
+	 * Segment boundaries: the value space's first key and, for each
+	 * range, its first key and the key following its last key.
+	 */
+	first_keys = g_new(uint64_t, 1 + 2 * ranges->len);
+	enum_fc->lookup_index.seg_first_keys = first_keys;
+	if (!first_keys) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate label lookup index.");
+		goto error;
+	}
+
+	seg_count = 0;
+	first_keys[seg_count++] = 0;
+
+	for (i = 0; i < ranges->len; i++) {
+		const struct enum_lookup_range *range =
+			&g_array_index(ranges, struct enum_lookup_range, i);
+
+		first_keys[seg_count++] = range->first_key;
+
+		if (range->last_key != UINT64_MAX) {
+			first_keys[seg_count++] = range->last_key + 1;
+		}
+	}
+
+	qsort(first_keys, seg_count, sizeof(*first_keys), compare_enum_keys);
+
+	for (i = 1, seg_i = 1; i < seg_count; i++) {
+		if (first_keys[i] != first_keys[seg_i - 1]) {
+			first_keys[seg_i++] = first_keys[i];
+		}
+	}
+
+	seg_count = seg_i;
+	enum_fc->lookup_index.seg_count = seg_count;
+
+	/*
+	 * Count the labels of each segment.
+	 *
+	 * `last_mappings[i]` is the index, plus one, of the last mapping
+	 * which got a label for segment `i`: a mapping gets a single
+	 * label for a given segment even if many of its ranges contain
+	 * this segment.
+	 */
+	enum_fc->lookup_index.seg_label_offsets = g_new0(uint64_t,
+		seg_count + 1);
+	last_mappings = g_new0(uint64_t, seg_count);
+	next_label_offsets = g_new(uint64_t, seg_count);
+	if (!enum_fc->lookup_index.seg_label_offsets || !last_mappings ||
+			!next_label_offsets) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate label lookup index.");
+		goto error;
+	}
+
+	for (i = 0; i < ranges->len; i++) {
+		const struct enum_lookup_range *range =
+			&g_array_index(ranges, struct enum_lookup_range, i);
+		uint64_t last_seg_i = find_enum_lookup_segment(enum_fc,
+			range->last_key);
+
+		for (seg_i = find_enum_lookup_segment(enum_fc, range->first_key);
+				seg_i <= last_seg_i; seg_i++) {
+			if (last_mappings[seg_i] != range->mapping_index + 1) {
+				last_mappings[seg_i] = range->mapping_index + 1;
+				enum_fc->lookup_index.seg_label_offsets[seg_i + 1]++;
+				label_count++;
+			}
+		}
+
+		if (label_count > ENUM_LOOKUP_MAX_LABEL_COUNT) {
+			BT_LIB_LOGD("Too many labels for enumeration field "
+				"class's label lookup index: using linear "
+				"lookups: %![fc-]+F, seg-count=%" PRIu64,
+				enum_fc, seg_count);
+			reset_enumeration_field_class_lookup_index(enum_fc);
+			enum_fc->lookup_index.is_linear = true;
+			__atomic_store_n(&enum_fc->lookup_index.is_built, true,
+				__ATOMIC_RELEASE);
+			goto end;
+		}
+	}
+
+	for (seg_i = 0; seg_i < seg_count; seg_i++) {
+		enum_fc->lookup_index.seg_label_offsets[seg_i + 1] +=
+			enum_fc->lookup_index.seg_label_offsets[seg_i];
+	}
+
+	/* Fill the labels of each segment */
+	enum_fc->lookup_index.labels = g_new(const char *,
+		enum_fc->lookup_index.seg_label_offsets[seg_count] + 1);
+	if (!enum_fc->lookup_index.labels) {
+		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate label lookup index.");
+		goto error;
+	}
+
+	memset(last_mappings, 0, seg_count * sizeof(*last_mappings));
+	memcpy(next_label_offsets, enum_fc->lookup_index.seg_label_offsets,
+		seg_count * sizeof(*next_label_offsets));
+
+	for (i = 0; i < ranges->len; i++) {
+		const struct enum_lookup_range *range =
+			&g_array_index(ranges, struct enum_lookup_range, i);
+		const struct bt_field_class_enumeration_mapping *mapping =
+			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc,
+				range->mapping_index);
+		uint64_t last_seg_i = find_enum_lookup_segment(enum_fc,
+			range->last_key);
+
+		for (seg_i = find_enum_lookup_segment(enum_fc, range->first_key);
+				seg_i <= last_seg_i; seg_i++) {
+			if (last_mappings[seg_i] != range->mapping_index + 1) {
+				last_mappings[seg_i] = range->mapping_index + 1;
+				enum_fc->lookup_index.labels[
+					next_label_offsets[seg_i]++] =
+						mapping->label->str;
+			}
+		}
+	}
+
+	/*
+	 * Direct table covering the keys of all the ranges when there
+	 * are few of them (typically many single-value ranges, like
+	 * system call numbers).
+	 */
+	if (ranges->len > 0 && max_key - min_key < ENUM_LOOKUP_TABLE_MAX_LEN) {
+		uint64_t key_i;
+
+		enum_fc->lookup_index.table_first_key = min_key;
+		enum_fc->lookup_index.table_len = max_key - min_key + 1;
+		enum_fc->lookup_index.table = g_new(uint32_t,
+			enum_fc->lookup_index.table_len);
+		if (!enum_fc->lookup_index.table) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Failed to allocate label lookup table.");
+			goto error;
+		}
+
+		seg_i = find_enum_lookup_segment(enum_fc, min_key);
+
+		for (key_i = 0; key_i < enum_fc->lookup_index.table_len;
+				key_i++) {
+			while (seg_i + 1 < seg_count &&
+					first_keys[seg_i + 1] <= min_key + key_i) {
+				seg_i++;
+			}
+
+			enum_fc->lookup_index.table[key_i] = (uint32_t) seg_i;
+		}
+	}
+
+	BT_LIB_LOGD("Built enumeration field class's label lookup index: "
+		"%![fc-]+F, seg-count=%" PRIu64 ", label-count=%" PRIu64 ", "
+		"table-len=%" PRIu64, enum_fc, seg_count,
+		enum_fc->lookup_index.seg_label_offsets[seg_count],
+		enum_fc->lookup_index.table_len);
+	__atomic_store_n(&enum_fc->lookup_index.is_built, true,
+		__ATOMIC_RELEASE);
+	goto end;
+
+error:
+	reset_enumeration_field_class_lookup_index(enum_fc);
+	ret = -1;
+
+end:
+	if (ranges) {
+		g_array_free(ranges, TRUE);
+	}
+
+	g_free(last_mappings);
+	g_free(next_label_offsets);
+	return ret;
+}
+
 static
 void destroy_enumeration_field_class(struct bt_object *obj)
 {
@@ -351,11 +668,7 @@ void destroy_enumeration_field_class(struct bt_object *obj)
 		fc->mappings = NULL;
 	}
 
-	if (fc->label_buf) {
-		g_ptr_array_free(fc->label_buf, TRUE);
-		fc->label_buf = NULL;
-	}
-
+	reset_enumeration_field_class_lookup_index(fc);
 	g_free(fc);
 }
 
@@ -387,12 +700,6 @@ struct bt_field_class *create_enumeration_field_class(
 		goto error;
 	}
 
-	enum_fc->label_buf = g_ptr_array_new();
-	if (!enum_fc->label_buf) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GArray.");
-		goto error;
-	}
-
 	BT_LIB_LOGD("Created enumeration field class object: %!+F", enum_fc);
 	goto end;
 
@@ -533,22 +840,40 @@ bt_field_class_enumeration_signed_mapping_borrow_ranges_const(
 	return (const void *) mapping->range_set;
 }
 
+/*
+ * Finds the labels of the mappings of `enum_fc` containing `key` by
+ * checking each range of each mapping.
+ *
+ * The returned label array belongs to the current thread: it remains
+ * valid until the next call to this function in the same thread.
+ */
+static
 enum bt_field_class_enumeration_get_mapping_labels_for_value_status
-bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
-		const struct bt_field_class *fc, uint64_t value,
+get_mapping_labels_for_key_linear(
+		const struct bt_field_class_enumeration *enum_fc,
+		uint64_t key,
 		bt_field_class_enumeration_mapping_label_array *label_array,
 		uint64_t *count)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
+	const bool is_signed = enum_fc->common.common.type ==
+		BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION;
+	enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+		status = BT_FUNC_STATUS_OK;
+	GPtrArray *label_buf = g_private_get(&enum_label_buf);
 	uint64_t i;
 
-	BT_ASSERT_PRE_DEV_NO_ERROR();
-	BT_ASSERT_PRE_DEV_NON_NULL(fc, "Field class");
-	BT_ASSERT_PRE_DEV_NON_NULL(label_array, "Label array (output)");
-	BT_ASSERT_PRE_DEV_NON_NULL(count, "Count (output)");
-	BT_ASSERT_PRE_DEV_FC_HAS_ID(fc, BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION,
-		"Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
+	if (G_UNLIKELY(!label_buf)) {
+		label_buf = g_ptr_array_new();
+		if (!label_buf) {
+			BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+
+		g_private_set(&enum_label_buf, label_buf);
+	}
+
+	g_ptr_array_set_size(label_buf, 0);
 
 	for (i = 0; i < enum_fc->mappings->len; i++) {
 		uint64_t j;
@@ -560,18 +885,95 @@ bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
 				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
 					mapping->range_set, j);
 
-			if (value >= range->lower.u &&
-					value <= range->upper.u) {
-				g_ptr_array_add(enum_fc->label_buf,
+			if (key >= enum_key_from_value(is_signed,
+						range->lower.u) &&
+					key <= enum_key_from_value(is_signed,
+						range->upper.u)) {
+				g_ptr_array_add(label_buf,
 					mapping->label->str);
 				break;
 			}
 		}
 	}
 
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
-	return BT_FUNC_STATUS_OK;
+	*label_array = (void *) label_buf->pdata;
+	*count = (uint64_t) label_buf->len;
+
+end:
+	return status;
+}
+
+static inline
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+get_mapping_labels_for_key(struct bt_field_class_enumeration *enum_fc,
+		uint64_t key,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+		status = BT_FUNC_STATUS_OK;
+	uint64_t seg_i;
+	uint64_t table_i;
+
+	if (G_UNLIKELY(!__atomic_load_n(&enum_fc->lookup_index.is_built,
+			__ATOMIC_ACQUIRE))) {
+		g_mutex_lock(&enum_lookup_index_lock);
+
+		if (!enum_fc->lookup_index.is_built &&
+				build_enumeration_field_class_lookup_index(
+					enum_fc)) {
+			BT_LIB_LOGE_APPEND_CAUSE(
+				"Cannot build enumeration field class's "
+				"label lookup index: %!+F", enum_fc);
+			status = BT_FUNC_STATUS_MEMORY_ERROR;
+		}
+
+		g_mutex_unlock(&enum_lookup_index_lock);
+
+		if (status) {
+			goto end;
+		}
+	}
+
+	if (G_UNLIKELY(enum_fc->lookup_index.is_linear)) {
+		status = get_mapping_labels_for_key_linear(enum_fc, key,
+			label_array, count);
+		goto end;
+	}
+
+	/* Wraps around (out of the table) if `key` is before the table */
+	table_i = key - enum_fc->lookup_index.table_first_key;
+
+	if (enum_fc->lookup_index.table &&
+			table_i < enum_fc->lookup_index.table_len) {
+		seg_i = enum_fc->lookup_index.table[table_i];
+	} else {
+		seg_i = find_enum_lookup_segment(enum_fc, key);
+	}
+
+	*label_array = (void *) &enum_fc->lookup_index.labels[
+		enum_fc->lookup_index.seg_label_offsets[seg_i]];
+	*count = enum_fc->lookup_index.seg_label_offsets[seg_i + 1] -
+		enum_fc->lookup_index.seg_label_offsets[seg_i];
+
+end:
+	return status;
+}
+
+enum bt_field_class_enumeration_get_mapping_labels_for_value_status
+bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+		const struct bt_field_class *fc, uint64_t value,
+		bt_field_class_enumeration_mapping_label_array *label_array,
+		uint64_t *count)
+{
+	BT_ASSERT_PRE_DEV_NO_ERROR();
+	BT_ASSERT_PRE_DEV_NON_NULL(fc, "Field class");
+	BT_ASSERT_PRE_DEV_NON_NULL(label_array, "Label array (output)");
+	BT_ASSERT_PRE_DEV_NON_NULL(count, "Count (output)");
+	BT_ASSERT_PRE_DEV_FC_HAS_ID(fc, BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION,
+		"Field class");
+	return get_mapping_labels_for_key((void *) fc,
+		enum_key_from_value(false, (uint64_t) value), label_array, count);
 }
 
 enum bt_field_class_enumeration_get_mapping_labels_for_value_status
@@ -580,39 +982,14 @@ bt_field_class_enumeration_signed_get_mapping_labels_for_value(
 		bt_field_class_enumeration_mapping_label_array *label_array,
 		uint64_t *count)
 {
-	const struct bt_field_class_enumeration *enum_fc = (const void *) fc;
-	uint64_t i;
-
 	BT_ASSERT_PRE_DEV_NO_ERROR();
 	BT_ASSERT_PRE_DEV_NON_NULL(fc, "Field class");
 	BT_ASSERT_PRE_DEV_NON_NULL(label_array, "Label array (output)");
 	BT_ASSERT_PRE_DEV_NON_NULL(count, "Count (output)");
 	BT_ASSERT_PRE_DEV_FC_HAS_ID(fc, BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION,
 		"Field class");
-	g_ptr_array_set_size(enum_fc->label_buf, 0);
-
-	for (i = 0; i < enum_fc->mappings->len; i++) {
-		uint64_t j;
-		const struct bt_field_class_enumeration_mapping *mapping =
-			BT_FIELD_CLASS_ENUM_MAPPING_AT_INDEX(enum_fc, i);
-
-		for (j = 0; j < mapping->range_set->ranges->len; j++) {
-			const struct bt_integer_range *range = (const void *)
-				BT_INTEGER_RANGE_SET_RANGE_AT_INDEX(
-					mapping->range_set, j);
-
-			if (value >= range->lower.i &&
-					value <= range->upper.i) {
-				g_ptr_array_add(enum_fc->label_buf,
-					mapping->label->str);
-				break;
-			}
-		}
-	}
-
-	*label_array = (void *) enum_fc->label_buf->pdata;
-	*count = (uint64_t) enum_fc->label_buf->len;
-	return BT_FUNC_STATUS_OK;
+	return get_mapping_labels_for_key((void *) fc,
+		enum_key_from_value(true, (uint64_t) value), label_array, count);
 }
 
 static
@@ -668,6 +1045,7 @@ add_mapping_to_enumeration_field_class(struct bt_field_class *fc,
 	}
 
 	g_array_append_val(enum_fc->mappings, mapping);
+	reset_enumeration_field_class_lookup_index(enum_fc);
 	BT_LIB_LOGD("Added mapping to enumeration field class: "
 		"%![fc-]+F, label=\"%s\"", fc, label);
 
@@ -237,6 +237,13 @@ struct bt_field_class {
 	 * of a trace class.
 	 */
 	bool part_of_trace_class;
+
+	/*
+	 * Size of the memory block which holds a field tree created
+	 * from this field class, or 0 if not computed yet (see
+	 * bt_field_create()).
+	 */
+	size_t field_block_size;
 };
 
 struct bt_field_class_bool {
@@ -281,15 +288,50 @@ struct bt_field_class_enumeration {
 	GArray *mappings;
 
 	/*
-	 * This is an array of `const char *` which acts as a temporary
-	 * (potentially growing) buffer for
+	 * Label lookup index for
 	 * bt_field_class_enumeration_unsigned_get_mapping_labels_for_value()
 	 * and
-	 * bt_field_class_enumeration_signed_get_mapping_labels_for_value().
+	 * bt_field_class_enumeration_signed_get_mapping_labels_for_value(),
+	 * built on the first lookup and reset when adding a mapping.
+	 *
+	 * The index splits the whole value space into `seg_count`
+	 * contiguous segments, each one having the same labels for all
+	 * its values. Values are keys here: a signed value's key is the
+	 * value with its sign bit flipped, so that keys and values have
+	 * the same order.
 	 *
-	 * The actual strings are owned by the mappings above.
+	 * If `is_linear` is true, the index would need too many labels:
+	 * it's empty and a lookup checks each range of each mapping
+	 * instead, returning a label array which remains valid until
+	 * the next lookup in the same thread.
 	 */
-	GPtrArray *label_buf;
+	struct {
+		bool is_built;
+		bool is_linear;
+
+		/* Sorted first keys of the segments (first one is 0) */
+		uint64_t *seg_first_keys;
+
+		/*
+		 * Segment `i`'s labels are `labels[seg_label_offsets[i]]`
+		 * to `labels[seg_label_offsets[i + 1] - 1]`, in mapping
+		 * order.
+		 */
+		uint64_t *seg_label_offsets;
+		uint64_t seg_count;
+
+		/* Strings owned by the mappings above */
+		const char **labels;
+
+		/*
+		 * If not `NULL`: `table_len` segment indexes, where
+		 * `table[i]` is the index of the segment of the key
+		 * `table_first_key + i`.
+		 */
+		uint32_t *table;
+		uint64_t table_first_key;
+		uint64_t table_len;
+	} lookup_index;
 };
 
 struct bt_field_class_real {
@@ -146,63 +146,55 @@ struct bt_field_methods variant_field_methods = {
 	.is_set = variant_field_is_set,
 	.reset = reset_variant_field,
 };
+/*
+ * All the field objects of a field tree, except the elements of
+ * dynamic array fields, live in a single contiguous block: a compound
+ * field is immediately followed by its array of child field pointers,
+ * if any, and then by its child fields, recursively.
+ */
+#define FIELD_BLOCK_ALIGNMENT	8
 
-static
-struct bt_field *create_bool_field(struct bt_field_class *);
-
-static
-struct bt_field *create_bit_array_field(struct bt_field_class *);
-
-static
-struct bt_field *create_integer_field(struct bt_field_class *);
-
-static
-struct bt_field *create_real_field(struct bt_field_class *);
-
-static
-struct bt_field *create_string_field(struct bt_field_class *);
-
-static
-struct bt_field *create_structure_field(struct bt_field_class *);
+struct field_block {
+	/* Next free position within the block */
+	char *cur;
 
-static
-struct bt_field *create_static_array_field(struct bt_field_class *);
-
-static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *);
+	/* End of the block */
+	char *end;
+};
 
 static
-struct bt_field *create_option_field(struct bt_field_class *);
+struct bt_field *create_field_in_block(struct bt_field_class *,
+		struct field_block *);
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *);
+void finalize_field(struct bt_field *field);
 
 static
-void destroy_bool_field(struct bt_field *field);
+void finalize_bool_field(struct bt_field *field);
 
 static
-void destroy_bit_array_field(struct bt_field *field);
+void finalize_bit_array_field(struct bt_field *field);
 
 static
-void destroy_integer_field(struct bt_field *field);
+void finalize_integer_field(struct bt_field *field);
 
 static
-void destroy_real_field(struct bt_field *field);
+void finalize_real_field(struct bt_field *field);
 
 static
-void destroy_string_field(struct bt_field *field);
+void finalize_string_field(struct bt_field *field);
 
 static
-void destroy_structure_field(struct bt_field *field);
+void finalize_structure_field(struct bt_field *field);
 
 static
-void destroy_array_field(struct bt_field *field);
+void finalize_array_field(struct bt_field *field);
 
 static
-void destroy_option_field(struct bt_field *field);
+void finalize_option_field(struct bt_field *field);
 
 static
-void destroy_variant_field(struct bt_field *field);
+void finalize_variant_field(struct bt_field *field);
 
 struct bt_field_class *bt_field_borrow_class(struct bt_field *field)
 {
@@ -223,64 +215,203 @@ enum bt_field_class_type bt_field_get_class_type(const struct bt_field *field)
 	return field->class->type;
 }
 
-BT_HIDDEN
-struct bt_field *bt_field_create(struct bt_field_class *fc)
+static inline
+size_t field_block_obj_size(size_t size)
 {
-	struct bt_field *field = NULL;
+	return ALIGN(size, (size_t) FIELD_BLOCK_ALIGNMENT);
+}
 
-	BT_ASSERT(fc);
+static inline
+void *field_block_take(struct field_block *block, size_t size)
+{
+	void *mem = block->cur;
+
+	block->cur += field_block_obj_size(size);
+	BT_ASSERT(block->cur <= block->end);
+	return mem;
+}
+
+/*
+ * Returns the size of one packed element value of an array field of
+ * which the element field class is `elem_fc`, or 0 if such an array
+ * field has no packed element values.
+ */
+static inline
+size_t packed_value_size(const struct bt_field_class *elem_fc)
+{
+	size_t size;
+
+	switch (elem_fc->type) {
+	case BT_FIELD_CLASS_TYPE_BOOL:
+		size = sizeof(bt_bool);
+		break;
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		size = sizeof(uint64_t);
+		break;
+	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+		size = sizeof(double);
+		break;
+	default:
+		size = 0;
+	}
+
+	return size;
+}
+
+static
+size_t named_field_classes_block_size(
+		struct bt_field_class_named_field_class_container *fc);
+
+/*
+ * Returns the size of the block which holds a field tree created from
+ * the field class `fc`.
+ *
+ * The result is cached within `fc`: this is valid because a field
+ * class is frozen once fields can be created from it. Threads which
+ * create fields concurrently (message iterator stages) may all compute
+ * and store the same result, hence the atomic accesses.
+ */
+static
+size_t field_block_size(struct bt_field_class *fc)
+{
+	size_t size = __atomic_load_n(&fc->field_block_size, __ATOMIC_RELAXED);
+
+	if (G_LIKELY(size)) {
+		goto end;
+	}
 
 	switch (fc->type) {
 	case BT_FIELD_CLASS_TYPE_BOOL:
-		field = create_bool_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_bool));
 		break;
 	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
-		field = create_bit_array_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_bit_array));
 		break;
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		field = create_integer_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_integer));
 		break;
 	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
 	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
-		field = create_real_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_real));
 		break;
 	case BT_FIELD_CLASS_TYPE_STRING:
-		field = create_string_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_string));
 		break;
 	case BT_FIELD_CLASS_TYPE_STRUCTURE:
-		field = create_structure_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_structure)) +
+			named_field_classes_block_size((void *) fc);
 		break;
 	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
-		field = create_static_array_field(fc);
+	{
+		struct bt_field_class_array_static *array_fc = (void *) fc;
+		size_t value_size = packed_value_size(
+			array_fc->common.element_fc);
+
+		size = field_block_obj_size(sizeof(struct bt_field_array));
+
+		if (value_size > 0) {
+			/* Element fields are created on demand */
+			size += field_block_obj_size(array_fc->length *
+				value_size);
+		} else {
+			size += field_block_obj_size(array_fc->length *
+					sizeof(struct bt_field *)) +
+				array_fc->length *
+					field_block_size(array_fc->common.element_fc);
+		}
+
 		break;
+	}
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
-		field = create_dynamic_array_field(fc);
+		/* Element fields are created on demand */
+		size = field_block_obj_size(sizeof(struct bt_field_array));
 		break;
 	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_option_field(fc);
+	{
+		struct bt_field_class_option *opt_fc = (void *) fc;
+
+		size = field_block_obj_size(sizeof(struct bt_field_option)) +
+			field_block_size(opt_fc->content_fc);
 		break;
+	}
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		field = create_variant_field(fc);
+		size = field_block_obj_size(sizeof(struct bt_field_variant)) +
+			named_field_classes_block_size((void *) fc);
 		break;
 	default:
 		bt_common_abort();
 	}
 
+	__atomic_store_n(&fc->field_block_size, size, __ATOMIC_RELAXED);
+
+end:
+	return size;
+}
+
+static
+size_t named_field_classes_block_size(
+		struct bt_field_class_named_field_class_container *fc)
+{
+	size_t size;
+	uint64_t i;
+
+	size = field_block_obj_size(fc->named_fcs->len *
+		sizeof(struct bt_field *));
+
+	for (i = 0; i < fc->named_fcs->len; i++) {
+		struct bt_named_field_class *named_fc = fc->named_fcs->pdata[i];
+
+		size += field_block_size(named_fc->fc);
+	}
+
+	return size;
+}
+
+BT_HIDDEN
+struct bt_field *bt_field_create(struct bt_field_class *fc)
+{
+	struct bt_field *field = NULL;
+	struct field_block block;
+	size_t size;
+	void *mem;
+
+	BT_ASSERT(fc);
+	size = field_block_size(fc);
+	mem = g_malloc0(size);
+	if (!mem) {
+		BT_LIB_LOGE_APPEND_CAUSE(
+			"Failed to allocate one field block: size=%zu, %![fc-]+F",
+			size, fc);
+		goto end;
+	}
+
+	block.cur = mem;
+	block.end = block.cur + size;
+	field = create_field_in_block(fc, &block);
 	if (!field) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create field object from field class: "
 			"%![fc-]+F", fc);
+		g_free(mem);
 		goto end;
 	}
 
+	/* The root field is always at the beginning of its block */
+	BT_ASSERT((void *) field == mem);
+	BT_ASSERT(block.cur == block.end);
+
 end:
 	return field;
 }
@@ -298,103 +429,71 @@ void init_field(struct bt_field *field, struct bt_field_class *fc,
 }
 
 static
-struct bt_field *create_bool_field(struct bt_field_class *fc)
+struct bt_field *create_bool_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_bool *bool_field;
 
 	BT_LIB_LOGD("Creating boolean field object: %![fc-]+F", fc);
-	bool_field = g_new0(struct bt_field_bool, 1);
-	if (!bool_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one boolean field.");
-		goto end;
-	}
-
+	bool_field = field_block_take(block, sizeof(*bool_field));
 	init_field((void *) bool_field, fc, &bool_field_methods);
 	BT_LIB_LOGD("Created boolean field object: %!+f", bool_field);
-
-end:
 	return (void *) bool_field;
 }
 
 static
-struct bt_field *create_bit_array_field(struct bt_field_class *fc)
+struct bt_field *create_bit_array_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_bit_array *ba_field;
 
 	BT_LIB_LOGD("Creating bit array field object: %![fc-]+F", fc);
-	ba_field = g_new0(struct bt_field_bit_array, 1);
-	if (!ba_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one bit array field.");
-		goto end;
-	}
-
+	ba_field = field_block_take(block, sizeof(*ba_field));
 	init_field((void *) ba_field, fc, &bit_array_field_methods);
 	BT_LIB_LOGD("Created bit array field object: %!+f", ba_field);
-
-end:
 	return (void *) ba_field;
 }
 
 static
-struct bt_field *create_integer_field(struct bt_field_class *fc)
+struct bt_field *create_integer_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_integer *int_field;
 
 	BT_LIB_LOGD("Creating integer field object: %![fc-]+F", fc);
-	int_field = g_new0(struct bt_field_integer, 1);
-	if (!int_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one integer field.");
-		goto end;
-	}
-
+	int_field = field_block_take(block, sizeof(*int_field));
 	init_field((void *) int_field, fc, &integer_field_methods);
 	BT_LIB_LOGD("Created integer field object: %!+f", int_field);
-
-end:
 	return (void *) int_field;
 }
 
 static
-struct bt_field *create_real_field(struct bt_field_class *fc)
+struct bt_field *create_real_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_real *real_field;
 
 	BT_LIB_LOGD("Creating real field object: %![fc-]+F", fc);
-	real_field = g_new0(struct bt_field_real, 1);
-	if (!real_field) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate one real field.");
-		goto end;
-	}
-
+	real_field = field_block_take(block, sizeof(*real_field));
 	init_field((void *) real_field, fc, &real_field_methods);
 	BT_LIB_LOGD("Created real field object: %!+f", real_field);
-
-end:
 	return (void *) real_field;
 }
 
 static
-struct bt_field *create_string_field(struct bt_field_class *fc)
+struct bt_field *create_string_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_string *string_field;
 
 	BT_LIB_LOGD("Creating string field object: %![fc-]+F", fc);
-	string_field = g_new0(struct bt_field_string, 1);
-	if (!string_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one string field.");
-		goto end;
-	}
-
+	string_field = field_block_take(block, sizeof(*string_field));
 	init_field((void *) string_field, fc, &string_field_methods);
 	string_field->buf = g_array_sized_new(FALSE, FALSE,
 		sizeof(char), 1);
 	if (!string_field->buf) {
 		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GArray.");
-		bt_field_destroy((void *) string_field);
+		finalize_field((void *) string_field);
 		string_field = NULL;
 		goto end;
 	}
@@ -409,26 +508,21 @@ end:
 static inline
 int create_fields_from_named_field_classes(
 		struct bt_field_class_named_field_class_container *fc,
-		GPtrArray **fields)
+		struct field_block *block, struct bt_field ***fields,
+		uint64_t *field_count)
 {
 	int ret = 0;
 	uint64_t i;
 
-	*fields = g_ptr_array_new_with_free_func(
-		(GDestroyNotify) bt_field_destroy);
-	if (!*fields) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
-		ret = -1;
-		goto end;
-	}
-
-	g_ptr_array_set_size(*fields, fc->named_fcs->len);
+	*fields = field_block_take(block,
+		fc->named_fcs->len * sizeof(struct bt_field *));
+	*field_count = fc->named_fcs->len;
 
 	for (i = 0; i < fc->named_fcs->len; i++) {
 		struct bt_field *field;
 		struct bt_named_field_class *named_fc = fc->named_fcs->pdata[i];
 
-		field = bt_field_create(named_fc->fc);
+		field = create_field_in_block(named_fc->fc, block);
 		if (!field) {
 			BT_LIB_LOGE_APPEND_CAUSE(
 				"Failed to create structure member or variant option field: "
@@ -438,7 +532,7 @@ int create_fields_from_named_field_classes(
 			goto end;
 		}
 
-		g_ptr_array_index(*fields, i) = field;
+		(*fields)[i] = field;
 	}
 
 end:
@@ -446,25 +540,20 @@ end:
 }
 
 static
-struct bt_field *create_structure_field(struct bt_field_class *fc)
+struct bt_field *create_structure_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_structure *struct_field;
 
 	BT_LIB_LOGD("Creating structure field object: %![fc-]+F", fc);
-	struct_field = g_new0(struct bt_field_structure, 1);
-	if (!struct_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one structure field.");
-		goto end;
-	}
-
+	struct_field = field_block_take(block, sizeof(*struct_field));
 	init_field((void *) struct_field, fc, &structure_field_methods);
 
-	if (create_fields_from_named_field_classes((void *) fc,
-			&struct_field->fields)) {
+	if (create_fields_from_named_field_classes((void *) fc, block,
+			&struct_field->fields, &struct_field->field_count)) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Cannot create structure member fields: %![fc-]+F", fc);
-		bt_field_destroy((void *) struct_field);
+		finalize_field((void *) struct_field);
 		struct_field = NULL;
 		goto end;
 	}
@@ -476,27 +565,23 @@ end:
 }
 
 static
-struct bt_field *create_option_field(struct bt_field_class *fc)
+struct bt_field *create_option_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_option *opt_field;
 	struct bt_field_class_option *opt_fc = (void *) fc;
 
 	BT_LIB_LOGD("Creating option field object: %![fc-]+F", fc);
-	opt_field = g_new0(struct bt_field_option, 1);
-	if (!opt_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one option field.");
-		goto end;
-	}
-
+	opt_field = field_block_take(block, sizeof(*opt_field));
 	init_field((void *) opt_field, fc, &option_field_methods);
-	opt_field->content_field = bt_field_create(opt_fc->content_fc);
+	opt_field->content_field = create_field_in_block(opt_fc->content_fc,
+		block);
 	if (!opt_field->content_field) {
 		BT_LIB_LOGE_APPEND_CAUSE(
 			"Failed to create option field's content field: "
 			"%![opt-fc-]+F, %![content-fc-]+F",
 			opt_fc, opt_fc->content_fc);
-		bt_field_destroy((void *) opt_field);
+		finalize_field((void *) opt_field);
 		opt_field = NULL;
 		goto end;
 	}
@@ -508,25 +593,20 @@ end:
 }
 
 static
-struct bt_field *create_variant_field(struct bt_field_class *fc)
+struct bt_field *create_variant_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
 	struct bt_field_variant *var_field;
 
 	BT_LIB_LOGD("Creating variant field object: %![fc-]+F", fc);
-	var_field = g_new0(struct bt_field_variant, 1);
-	if (!var_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one variant field.");
-		goto end;
-	}
-
+	var_field = field_block_take(block, sizeof(*var_field));
 	init_field((void *) var_field, fc, &variant_field_methods);
 
-	if (create_fields_from_named_field_classes((void *) fc,
-			&var_field->fields)) {
+	if (create_fields_from_named_field_classes((void *) fc, block,
+			&var_field->fields, &var_field->field_count)) {
 		BT_LIB_LOGE_APPEND_CAUSE("Cannot create variant member fields: "
 			"%![fc-]+F", fc);
-		bt_field_destroy((void *) var_field);
+		finalize_field((void *) var_field);
 		var_field = NULL;
 		goto end;
 	}
@@ -537,100 +617,124 @@ end:
 	return (void *) var_field;
 }
 
-static inline
-int init_array_field_fields(struct bt_field_array *array_field)
+static
+struct bt_field *create_static_array_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
-	int ret = 0;
+	struct bt_field_class_array_static *array_fc = (void *) fc;
+	struct bt_field_array *array_field;
 	uint64_t i;
-	struct bt_field_class_array *array_fc;
-
-	BT_ASSERT(array_field);
-	array_fc = (void *) array_field->common.class;
-	array_field->fields = g_ptr_array_sized_new(array_field->length);
-	if (!array_field->fields) {
-		BT_LIB_LOGE_APPEND_CAUSE("Failed to allocate a GPtrArray.");
-		ret = -1;
-		goto end;
+
+	BT_LIB_LOGD("Creating static array field object: %![fc-]+F", fc);
+	array_field = field_block_take(block, sizeof(*array_field));
+	init_field((void *) array_field, fc, &array_field_methods);
+	array_field->length = array_fc->length;
+	array_field->packed_value_size = packed_value_size(
+		array_fc->common.element_fc);
+
+	if (array_field->packed_value_size > 0) {
+		array_field->packed_values = field_block_take(block,
+			array_fc->length * array_field->packed_value_size);
+		array_field->packed_capacity = array_fc->length;
+		goto created;
 	}
 
-	g_ptr_array_set_free_func(array_field->fields,
-		(GDestroyNotify) bt_field_destroy);
-	g_ptr_array_set_size(array_field->fields, array_field->length);
+	array_field->fields = field_block_take(block,
+		array_fc->length * sizeof(struct bt_field *));
 
-	for (i = 0; i < array_field->length; i++) {
-		array_field->fields->pdata[i] = bt_field_create(
-			array_fc->element_fc);
-		if (!array_field->fields->pdata[i]) {
+	for (i = 0; i < array_fc->length; i++) {
+		struct bt_field *elem_field = create_field_in_block(
+			array_fc->common.element_fc, block);
+
+		if (!elem_field) {
 			BT_LIB_LOGE_APPEND_CAUSE(
 				"Cannot create array field's element field: "
 				"index=%" PRIu64 ", %![fc-]+F", i, array_fc);
-			ret = -1;
+			finalize_field((void *) array_field);
+			array_field = NULL;
 			goto end;
 		}
+
+		array_field->fields[i] = elem_field;
+		array_field->capacity++;
 	}
 
+created:
+	BT_LIB_LOGD("Created static array field object: %!+f", array_field);
+
 end:
-	return ret;
+	return (void *) array_field;
 }
 
 static
-struct bt_field *create_static_array_field(struct bt_field_class *fc)
+struct bt_field *create_dynamic_array_field(struct bt_field_class *fc,
+		struct field_block *block)
 {
-	struct bt_field_class_array_static *array_fc = (void *) fc;
 	struct bt_field_array *array_field;
 
-	BT_LIB_LOGD("Creating static array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
-	if (!array_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one static array field.");
-		goto end;
-	}
-
+	BT_LIB_LOGD("Creating dynamic array field object: %![fc-]+F", fc);
+	array_field = field_block_take(block, sizeof(*array_field));
 	init_field((void *) array_field, fc, &array_field_methods);
-	array_field->length = array_fc->length;
-
-	if (init_array_field_fields(array_field)) {
-		BT_LIB_LOGE_APPEND_CAUSE("Cannot create static array fields: "
-			"%![fc-]+F", fc);
-		bt_field_destroy((void *) array_field);
-		array_field = NULL;
-		goto end;
-	}
-
-	BT_LIB_LOGD("Created static array field object: %!+f", array_field);
-
-end:
+	array_field->packed_value_size = packed_value_size(
+		((struct bt_field_class_array *) fc)->element_fc);
+	BT_LIB_LOGD("Created dynamic array field object: %!+f", array_field);
 	return (void *) array_field;
 }
 
 static
-struct bt_field *create_dynamic_array_field(struct bt_field_class *fc)
+struct bt_field *create_field_in_block(struct bt_field_class *fc,
+		struct field_block *block)
 {
-	struct bt_field_array *array_field;
-
-	BT_LIB_LOGD("Creating dynamic array field object: %![fc-]+F", fc);
-	array_field = g_new0(struct bt_field_array, 1);
-	if (!array_field) {
-		BT_LIB_LOGE_APPEND_CAUSE(
-			"Failed to allocate one dynamic array field.");
-		goto end;
-	}
+	struct bt_field *field = NULL;
 
-	init_field((void *) array_field, fc, &array_field_methods);
+	BT_ASSERT(fc);
 
-	if (init_array_field_fields(array_field)) {
-		BT_LIB_LOGE_APPEND_CAUSE("Cannot create dynamic array fields: "
-			"%![fc-]+F", fc);
-		bt_field_destroy((void *) array_field);
-		array_field = NULL;
-		goto end;
+	switch (fc->type) {
+	case BT_FIELD_CLASS_TYPE_BOOL:
+		field = create_bool_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
+		field = create_bit_array_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+		field = create_integer_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+		field = create_real_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRING:
+		field = create_string_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_STRUCTURE:
+		field = create_structure_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
+		field = create_static_array_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
+	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
+		field = create_dynamic_array_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+		field = create_option_field(fc, block);
+		break;
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
+	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
+		field = create_variant_field(fc, block);
+		break;
+	default:
+		bt_common_abort();
 	}
 
-	BT_LIB_LOGD("Created dynamic array field object: %!+f", array_field);
-
-end:
-	return (void *) array_field;
+	return field;
 }
 
 bt_bool bt_field_bool_get_value(const struct bt_field *field)
@@ -926,6 +1030,135 @@ void bt_field_string_clear(struct bt_field *field)
 	clear_string_field(field);
 }
 
+/*
+ * Protects the conversion of the values of an array field when the
+ * user borrows them from a const array field.
+ */
+static
+GMutex array_field_values_lock;
+
+static inline
+enum bt_field_array_values_state get_array_field_values_state(
+		const struct bt_field_array *array_field)
+{
+	return (enum bt_field_array_values_state) g_atomic_int_get(
+		&array_field->values_state);
+}
+
+static inline
+void set_array_field_values_state(struct bt_field_array *array_field,
+		enum bt_field_array_values_state state)
+{
+	g_atomic_int_set(&array_field->values_state, (gint) state);
+}
+
+/*
+ * Copies the packed element values of the array field `array_field` to
+ * its element fields, creating them as needed.
+ */
+static
+void unpack_array_field_values(struct bt_field_array *array_field)
+{
+	struct bt_field_class_array *array_fc =
+		(void *) array_field->common.class;
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_field->packed_value_size > 0);
+
+	if (array_field->length > array_field->capacity) {
+		array_field->fields = g_renew(struct bt_field *,
+			array_field->fields, array_field->length);
+
+		for (i = array_field->capacity; i < array_field->length; i++) {
+			/*
+			 * Creating a boolean, integer, or real field
+			 * only fails if the allocation fails, which
+			 * aborts anyway.
+			 */
+			struct bt_field *elem_field = bt_field_create(
+				array_fc->element_fc);
+
+			BT_ASSERT(elem_field);
+			bt_field_set_is_frozen(elem_field,
+				array_field->common.frozen);
+			array_field->fields[i] = elem_field;
+			array_field->capacity++;
+		}
+	}
+
+	for (i = 0; i < array_field->length; i++) {
+		struct bt_field *elem_field = array_field->fields[i];
+
+		switch (array_fc->element_fc->type) {
+		case BT_FIELD_CLASS_TYPE_BOOL:
+			((struct bt_field_bool *) elem_field)->value =
+				((const bt_bool *) array_field->packed_values)[i];
+			break;
+		case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+		case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+		case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+		case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+			((struct bt_field_integer *) elem_field)->value.u =
+				((const uint64_t *) array_field->packed_values)[i];
+			break;
+		case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+		case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+			((struct bt_field_real *) elem_field)->value =
+				((const double *) array_field->packed_values)[i];
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		bt_field_set_single(elem_field,
+			array_field->packed_values_set);
+	}
+}
+
+/*
+ * Copies the values of the element fields of the array field
+ * `array_field` to its packed element values.
+ */
+static
+void pack_array_field_values(struct bt_field_array *array_field)
+{
+	struct bt_field_class_array *array_fc =
+		(void *) array_field->common.class;
+	bool values_set = true;
+	uint64_t i;
+
+	BT_ASSERT_DBG(array_field->packed_value_size > 0);
+
+	for (i = 0; i < array_field->length; i++) {
+		struct bt_field *elem_field = array_field->fields[i];
+
+		switch (array_fc->element_fc->type) {
+		case BT_FIELD_CLASS_TYPE_BOOL:
+			((bt_bool *) array_field->packed_values)[i] =
+				((struct bt_field_bool *) elem_field)->value;
+			break;
+		case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
+		case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
+		case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
+		case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
+			((uint64_t *) array_field->packed_values)[i] =
+				((struct bt_field_integer *) elem_field)->value.u;
+			break;
+		case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
+		case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
+			((double *) array_field->packed_values)[i] =
+				((struct bt_field_real *) elem_field)->value;
+			break;
+		default:
+			bt_common_abort();
+		}
+
+		values_set = values_set && elem_field->is_set;
+	}
+
+	array_field->packed_values_set = values_set;
+}
+
 uint64_t bt_field_array_get_length(const struct bt_field *field)
 {
 	const struct bt_field_array *array_field = (const void *) field;
@@ -946,16 +1179,47 @@ enum bt_field_array_dynamic_set_length_status bt_field_array_dynamic_set_length(
 	BT_ASSERT_PRE_DEV_FIELD_IS_DYNAMIC_ARRAY(field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
 
-	if (G_UNLIKELY(length > array_field->fields->len)) {
+	if (array_field->packed_value_size > 0 &&
+			G_UNLIKELY(length > array_field->packed_capacity)) {
+		/* Make more room for packed values */
+		size_t value_size = array_field->packed_value_size;
+
+		array_field->packed_values = g_realloc(
+			array_field->packed_values, length * value_size);
+		memset((char *) array_field->packed_values +
+			array_field->packed_capacity * value_size, 0,
+			(length - array_field->packed_capacity) * value_size);
+		array_field->packed_capacity = length;
+	}
+
+	if (array_field->packed_value_size > 0 &&
+			array_field->values_state ==
+				BT_FIELD_ARRAY_VALUES_STATE_BOTH) {
+		/*
+		 * The new element values only exist in one
+		 * representation: keep the element fields current.
+		 */
+		set_array_field_values_state(array_field,
+			BT_FIELD_ARRAY_VALUES_STATE_FIELDS);
+	}
+
+	if ((array_field->packed_value_size == 0 ||
+			array_field->values_state !=
+				BT_FIELD_ARRAY_VALUES_STATE_PACKED) &&
+			G_UNLIKELY(length > array_field->capacity)) {
 		/* Make more room */
 		struct bt_field_class_array *array_fc;
-		uint64_t cur_len = array_field->fields->len;
 		uint64_t i;
 
-		g_ptr_array_set_size(array_field->fields, length);
+		array_field->fields = g_renew(struct bt_field *,
+			array_field->fields, length);
 		array_fc = (void *) field->class;
 
-		for (i = cur_len; i < array_field->fields->len; i++) {
+		/*
+		 * Each element field is the root of its own field
+		 * tree; `capacity` only counts the created ones.
+		 */
+		for (i = array_field->capacity; i < length; i++) {
 			struct bt_field *elem_field = bt_field_create(
 				array_fc->element_fc);
 
@@ -969,8 +1233,8 @@ enum bt_field_array_dynamic_set_length_status bt_field_array_dynamic_set_length(
 				goto end;
 			}
 
-			BT_ASSERT_DBG(!array_field->fields->pdata[i]);
-			array_field->fields->pdata[i] = elem_field;
+			array_field->fields[i] = elem_field;
+			array_field->capacity++;
 		}
 	}
 
@@ -980,8 +1244,44 @@ end:
 	return ret;
 }
 
-static inline
-struct bt_field *borrow_array_field_element_field_by_index(
+/*
+ * Makes sure that the representation of the values of the const array
+ * field `array_field` which is not `other_state` is current, converting
+ * them under a lock if needed.
+ *
+ * Other threads can borrow the values of the same const array field
+ * concurrently: only the first one converts them, and the others only
+ * read either representation once the state says it's current.
+ */
+static
+void settle_const_array_field_values(struct bt_field_array *array_field,
+		enum bt_field_array_values_state other_state)
+{
+	if (G_LIKELY(get_array_field_values_state(array_field) !=
+			other_state)) {
+		goto end;
+	}
+
+	g_mutex_lock(&array_field_values_lock);
+
+	if (get_array_field_values_state(array_field) == other_state) {
+		if (other_state == BT_FIELD_ARRAY_VALUES_STATE_PACKED) {
+			unpack_array_field_values(array_field);
+		} else {
+			pack_array_field_values(array_field);
+		}
+
+		set_array_field_values_state(array_field,
+			BT_FIELD_ARRAY_VALUES_STATE_BOTH);
+	}
+
+	g_mutex_unlock(&array_field_values_lock);
+
+end:
+	return;
+}
+
+struct bt_field *bt_field_array_borrow_element_field_by_index(
 		struct bt_field *field, uint64_t index)
 {
 	struct bt_field_array *array_field = (void *) field;
@@ -989,20 +1289,162 @@ struct bt_field *borrow_array_field_element_field_by_index(
 	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
 	BT_ASSERT_PRE_DEV_VALID_INDEX(index, array_field->length);
-	return array_field->fields->pdata[index];
-}
 
-struct bt_field *bt_field_array_borrow_element_field_by_index(
-		struct bt_field *field, uint64_t index)
-{
-	return borrow_array_field_element_field_by_index(field, index);
+	if (array_field->packed_value_size > 0) {
+		/*
+		 * The user can modify the borrowed element field: from
+		 * now on, only the element fields are current.
+		 */
+		if (array_field->values_state ==
+				BT_FIELD_ARRAY_VALUES_STATE_PACKED) {
+			unpack_array_field_values(array_field);
+		}
+
+		set_array_field_values_state(array_field,
+			BT_FIELD_ARRAY_VALUES_STATE_FIELDS);
+	}
+
+	return array_field->fields[index];
 }
 
 const struct bt_field *
 bt_field_array_borrow_element_field_by_index_const(
 		const struct bt_field *field, uint64_t index)
 {
-	return borrow_array_field_element_field_by_index((void *) field, index);
+	struct bt_field_array *array_field = (void *) field;
+
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_VALID_INDEX(index, array_field->length);
+
+	if (array_field->packed_value_size > 0) {
+		settle_const_array_field_values(array_field,
+			BT_FIELD_ARRAY_VALUES_STATE_PACKED);
+	}
+
+	return array_field->fields[index];
+}
+
+/*
+ * Borrows the packed element values of the array field `field` for
+ * writing.
+ *
+ * If the element fields hold the current values, copies them to the
+ * packed values first. The packed values become the only current
+ * values from then on, so that the element fields which the user
+ * borrowed before this call are not up to date anymore.
+ */
+static inline
+void *borrow_array_field_values(struct bt_field *field)
+{
+	struct bt_field_array *array_field = (void *) field;
+
+	BT_ASSERT_DBG(array_field->packed_value_size > 0);
+
+	if (array_field->values_state == BT_FIELD_ARRAY_VALUES_STATE_FIELDS) {
+		pack_array_field_values(array_field);
+	}
+
+	set_array_field_values_state(array_field,
+		BT_FIELD_ARRAY_VALUES_STATE_PACKED);
+	array_field->packed_values_set = true;
+	return array_field->packed_values;
+}
+
+/*
+ * Borrows the packed element values of the const array field `field`.
+ */
+static inline
+const void *borrow_array_field_values_const(const struct bt_field *field)
+{
+	struct bt_field_array *array_field = (void *) field;
+
+	BT_ASSERT_DBG(array_field->packed_value_size > 0);
+	settle_const_array_field_values(array_field,
+		BT_FIELD_ARRAY_VALUES_STATE_FIELDS);
+	return array_field->packed_values;
+}
+
+bt_bool *bt_field_array_borrow_bool_values(struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_BOOL, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
+	return borrow_array_field_values(field);
+}
+
+const bt_bool *bt_field_array_borrow_bool_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_BOOL, "Field");
+	return borrow_array_field_values_const(field);
+}
+
+uint64_t *bt_field_array_borrow_unsigned_integer_values(
+		struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
+	return borrow_array_field_values(field);
+}
+
+const uint64_t *bt_field_array_borrow_unsigned_integer_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER, "Field");
+	return borrow_array_field_values_const(field);
+}
+
+int64_t *bt_field_array_borrow_signed_integer_values(
+		struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_SIGNED_INTEGER, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
+	return borrow_array_field_values(field);
+}
+
+const int64_t *bt_field_array_borrow_signed_integer_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_SIGNED_INTEGER, "Field");
+	return borrow_array_field_values_const(field);
+}
+
+double *bt_field_array_borrow_real_values(struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_REAL, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
+	return borrow_array_field_values(field);
+}
+
+const double *bt_field_array_borrow_real_values_const(
+		const struct bt_field *field)
+{
+	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
+	BT_ASSERT_PRE_DEV_FIELD_IS_ARRAY(field, "Field");
+	BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(field,
+		BT_FIELD_CLASS_TYPE_REAL, "Field");
+	return borrow_array_field_values_const(field);
 }
 
 static inline
@@ -1014,8 +1456,8 @@ struct bt_field *borrow_structure_field_member_field_by_index(
 	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_HAS_CLASS_TYPE(field,
 		BT_FIELD_CLASS_TYPE_STRUCTURE, "Field");
-	BT_ASSERT_PRE_DEV_VALID_INDEX(index, struct_field->fields->len);
-	return struct_field->fields->pdata[index];
+	BT_ASSERT_PRE_DEV_VALID_INDEX(index, struct_field->field_count);
+	return struct_field->fields[index];
 }
 
 struct bt_field *bt_field_structure_borrow_member_field_by_index(
@@ -1054,7 +1496,7 @@ struct bt_field *borrow_structure_field_member_field_by_name(
 		goto end;
 	}
 
-	ret_field = struct_field->fields->pdata[GPOINTER_TO_UINT(index)];
+	ret_field = struct_field->fields[GPOINTER_TO_UINT(index)];
 	BT_ASSERT_DBG(ret_field);
 
 end:
@@ -1182,8 +1624,8 @@ bt_field_variant_select_option_by_index(
 	BT_ASSERT_PRE_DEV_NON_NULL(field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_IS_VARIANT(field, "Field");
 	BT_ASSERT_PRE_DEV_FIELD_HOT(field, "Field");
-	BT_ASSERT_PRE_DEV_VALID_INDEX(index, var_field->fields->len);
-	var_field->selected_field = var_field->fields->pdata[index];
+	BT_ASSERT_PRE_DEV_VALID_INDEX(index, var_field->field_count);
+	var_field->selected_field = var_field->fields[index];
 	var_field->selected_index = index;
 	return BT_FUNC_STATUS_OK;
 }
@@ -1199,7 +1641,6 @@ uint64_t bt_field_variant_get_selected_option_index(
 		"Variant field has no selected field: %!+f", field);
 	return var_field->selected_index;
 }
-
 static inline
 void bt_field_finalize(struct bt_field *field)
 {
@@ -1209,110 +1650,124 @@ void bt_field_finalize(struct bt_field *field)
 }
 
 static
-void destroy_bool_field(struct bt_field *field)
+void finalize_bool_field(struct bt_field *field)
 {
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying boolean field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
-void destroy_bit_array_field(struct bt_field *field)
+void finalize_bit_array_field(struct bt_field *field)
 {
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying bit array field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
-void destroy_integer_field(struct bt_field *field)
+void finalize_integer_field(struct bt_field *field)
 {
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying integer field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
-void destroy_real_field(struct bt_field *field)
+void finalize_real_field(struct bt_field *field)
 {
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying real field object: %!+f", field);
 	bt_field_finalize(field);
-	g_free(field);
 }
 
 static
-void destroy_structure_field(struct bt_field *field)
+void finalize_structure_field(struct bt_field *field)
 {
 	struct bt_field_structure *struct_field = (void *) field;
+	uint64_t i;
 
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying structure field object: %!+f", field);
-	bt_field_finalize(field);
 
-	if (struct_field->fields) {
-		g_ptr_array_free(struct_field->fields, TRUE);
-		struct_field->fields = NULL;
+	/* Member fields live in the same block: only finalize them */
+	for (i = 0; i < struct_field->field_count; i++) {
+		if (struct_field->fields[i]) {
+			finalize_field(struct_field->fields[i]);
+		}
 	}
 
-	g_free(field);
+	bt_field_finalize(field);
 }
 
 static
-void destroy_option_field(struct bt_field *field)
+void finalize_option_field(struct bt_field *field)
 {
 	struct bt_field_option *opt_field = (void *) field;
 
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying option field object: %!+f", field);
-	bt_field_finalize(field);
 
 	if (opt_field->content_field) {
-		bt_field_destroy(opt_field->content_field);
+		finalize_field(opt_field->content_field);
 	}
 
-	g_free(field);
+	bt_field_finalize(field);
 }
 
 static
-void destroy_variant_field(struct bt_field *field)
+void finalize_variant_field(struct bt_field *field)
 {
 	struct bt_field_variant *var_field = (void *) field;
+	uint64_t i;
 
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying variant field object: %!+f", field);
-	bt_field_finalize(field);
 
-	if (var_field->fields) {
-		g_ptr_array_free(var_field->fields, TRUE);
-		var_field->fields = NULL;
+	for (i = 0; i < var_field->field_count; i++) {
+		if (var_field->fields[i]) {
+			finalize_field(var_field->fields[i]);
+		}
 	}
 
-	g_free(field);
+	bt_field_finalize(field);
 }
 
 static
-void destroy_array_field(struct bt_field *field)
+void finalize_array_field(struct bt_field *field)
 {
 	struct bt_field_array *array_field = (void *) field;
+	uint64_t i;
 
 	BT_ASSERT(field);
 	BT_LIB_LOGD("Destroying array field object: %!+f", field);
-	bt_field_finalize(field);
 
-	if (array_field->fields) {
-		g_ptr_array_free(array_field->fields, TRUE);
-		array_field->fields = NULL;
+	if (field->class->type == BT_FIELD_CLASS_TYPE_STATIC_ARRAY &&
+			array_field->packed_value_size == 0) {
+		/* Element fields live in the same block */
+		for (i = 0; i < array_field->capacity; i++) {
+			finalize_field(array_field->fields[i]);
+		}
+	} else {
+		/* Element fields are their own field trees */
+		for (i = 0; i < array_field->capacity; i++) {
+			bt_field_destroy(array_field->fields[i]);
+		}
+
+		g_free(array_field->fields);
+
+		if (field->class->type != BT_FIELD_CLASS_TYPE_STATIC_ARRAY) {
+			g_free(array_field->packed_values);
+		}
 	}
 
-	g_free(field);
+	array_field->fields = NULL;
+	array_field->packed_values = NULL;
+	bt_field_finalize(field);
 }
 
 static
-void destroy_string_field(struct bt_field *field)
+void finalize_string_field(struct bt_field *field)
 {
 	struct bt_field_string *string_field = (void *) field;
 
@@ -1324,59 +1779,70 @@ void destroy_string_field(struct bt_field *field)
 		g_array_free(string_field->buf, TRUE);
 		string_field->buf = NULL;
 	}
-
-	g_free(field);
 }
 
-BT_HIDDEN
-void bt_field_destroy(struct bt_field *field)
+static
+void finalize_field(struct bt_field *field)
 {
 	BT_ASSERT(field);
 
 	switch (field->class->type) {
 	case BT_FIELD_CLASS_TYPE_BOOL:
-		destroy_bool_field(field);
+		finalize_bool_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_BIT_ARRAY:
-		destroy_bit_array_field(field);
+		finalize_bit_array_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_SIGNED_INTEGER:
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		destroy_integer_field(field);
+		finalize_integer_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL:
 	case BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL:
-		destroy_real_field(field);
+		finalize_real_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRING:
-		destroy_string_field(field);
+		finalize_string_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_STRUCTURE:
-		destroy_structure_field(field);
+		finalize_structure_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_STATIC_ARRAY:
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITHOUT_LENGTH_FIELD:
 	case BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD:
-		destroy_array_field(field);
+		finalize_array_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_BOOL_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_OPTION_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		destroy_option_field(field);
+		finalize_option_field(field);
 		break;
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITHOUT_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_UNSIGNED_INTEGER_SELECTOR_FIELD:
 	case BT_FIELD_CLASS_TYPE_VARIANT_WITH_SIGNED_INTEGER_SELECTOR_FIELD:
-		destroy_variant_field(field);
+		finalize_variant_field(field);
 		break;
 	default:
 		bt_common_abort();
 	}
 }
 
+BT_HIDDEN
+void bt_field_destroy(struct bt_field *field)
+{
+	BT_ASSERT(field);
+
+	/*
+	 * `field` is the root of its field tree, therefore at the
+	 * beginning of its block (see bt_field_create()).
+	 */
+	finalize_field(field);
+	g_free(field);
+}
+
 static
 void reset_single_field(struct bt_field *field)
 {
@@ -1392,8 +1858,8 @@ void reset_structure_field(struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
-	for (i = 0; i < struct_field->fields->len; i++) {
-		bt_field_reset(struct_field->fields->pdata[i]);
+	for (i = 0; i < struct_field->field_count; i++) {
+		bt_field_reset(struct_field->fields[i]);
 	}
 }
 
@@ -1415,8 +1881,8 @@ void reset_variant_field(struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
-	for (i = 0; i < var_field->fields->len; i++) {
-		bt_field_reset(var_field->fields->pdata[i]);
+	for (i = 0; i < var_field->field_count; i++) {
+		bt_field_reset(var_field->fields[i]);
 	}
 }
 
@@ -1428,9 +1894,24 @@ void reset_array_field(struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
-	for (i = 0; i < array_field->fields->len; i++) {
-		bt_field_reset(array_field->fields->pdata[i]);
+	if (array_field->packed_value_size > 0) {
+		/*
+		 * The next writer sets the packed values directly: the
+		 * element fields get their values (and their "is set"
+		 * state) from them when the user borrows one of them.
+		 */
+		set_array_field_values_state(array_field,
+			BT_FIELD_ARRAY_VALUES_STATE_PACKED);
+		array_field->packed_values_set = false;
+		goto end;
 	}
+
+	for (i = 0; i < array_field->capacity; i++) {
+		bt_field_reset(array_field->fields[i]);
+	}
+
+end:
+	return;
 }
 
 static
@@ -1448,8 +1929,8 @@ void set_structure_field_is_frozen(struct bt_field *field, bool is_frozen)
 	BT_LIB_LOGD("Setting structure field's frozen state: "
 		"%![field-]+f, is-frozen=%d", field, is_frozen);
 
-	for (i = 0; i < struct_field->fields->len; i++) {
-		struct bt_field *member_field = struct_field->fields->pdata[i];
+	for (i = 0; i < struct_field->field_count; i++) {
+		struct bt_field *member_field = struct_field->fields[i];
 
 		BT_LIB_LOGD("Setting structure field's member field's "
 			"frozen state: %![field-]+f, index=%" PRIu64,
@@ -1480,8 +1961,8 @@ void set_variant_field_is_frozen(struct bt_field *field, bool is_frozen)
 	BT_LIB_LOGD("Setting variant field's frozen state: "
 		"%![field-]+f, is-frozen=%d", field, is_frozen);
 
-	for (i = 0; i < var_field->fields->len; i++) {
-		struct bt_field *option_field = var_field->fields->pdata[i];
+	for (i = 0; i < var_field->field_count; i++) {
+		struct bt_field *option_field = var_field->fields[i];
 
 		BT_LIB_LOGD("Setting variant field's option field's "
 			"frozen state: %![field-]+f, index=%" PRIu64,
@@ -1501,8 +1982,8 @@ void set_array_field_is_frozen(struct bt_field *field, bool is_frozen)
 	BT_LIB_LOGD("Setting array field's frozen state: "
 		"%![field-]+f, is-frozen=%d", field, is_frozen);
 
-	for (i = 0; i < array_field->fields->len; i++) {
-		struct bt_field *elem_field = array_field->fields->pdata[i];
+	for (i = 0; i < array_field->capacity; i++) {
+		struct bt_field *elem_field = array_field->fields[i];
 
 		BT_LIB_LOGD("Setting array field's element field's "
 			"frozen state: %![field-]+f, index=%" PRIu64,
@@ -1540,8 +2021,8 @@ bool structure_field_is_set(const struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
-	for (i = 0; i < struct_field->fields->len; i++) {
-		is_set = bt_field_is_set(struct_field->fields->pdata[i]);
+	for (i = 0; i < struct_field->field_count; i++) {
+		is_set = bt_field_is_set(struct_field->fields[i]);
 		if (!is_set) {
 			goto end;
 		}
@@ -1590,8 +2071,16 @@ bool array_field_is_set(const struct bt_field *field)
 
 	BT_ASSERT_DBG(field);
 
+	if (array_field->packed_value_size > 0 &&
+			get_array_field_values_state(array_field) ==
+				BT_FIELD_ARRAY_VALUES_STATE_PACKED) {
+		is_set = array_field->length == 0 ||
+			array_field->packed_values_set;
+		goto end;
+	}
+
 	for (i = 0; i < array_field->length; i++) {
-		is_set = bt_field_is_set(array_field->fields->pdata[i]);
+		is_set = bt_field_is_set(array_field->fields[i]);
 		if (!is_set) {
 			goto end;
 		}
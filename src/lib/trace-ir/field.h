@@ -71,6 +71,15 @@
 		((const struct bt_field *) (_field))->class->type == BT_FIELD_CLASS_TYPE_DYNAMIC_ARRAY_WITH_LENGTH_FIELD, \
 		_name " is not a dynamic array field: %![field-]+f", (_field))
 
+#define BT_ASSERT_PRE_DEV_ARRAY_FIELD_HAS_ELEM_CLASS_TYPE(_field, _cls_type, _name) \
+	BT_ASSERT_PRE_DEV(bt_field_class_type_is(			\
+		((const struct bt_field_class_array *)			\
+			((const struct bt_field *) (_field))->class)->element_fc->type, \
+		(_cls_type)),						\
+		_name " has the wrong element field class type: "	\
+		"expected-class-type=%s, %![field-]+f",			\
+		bt_common_field_class_type_string(_cls_type), (_field))
+
 #define BT_ASSERT_PRE_DEV_FIELD_IS_OPTION(_field, _name)		\
 	BT_ASSERT_PRE_DEV(						\
 		((const struct bt_field *) (_field))->class->type == BT_FIELD_CLASS_TYPE_OPTION_WITHOUT_SELECTOR_FIELD || \
@@ -147,8 +156,12 @@ struct bt_field_real {
 struct bt_field_structure {
 	struct bt_field common;
 
-	/* Array of `struct bt_field *`, owned by this */
-	GPtrArray *fields;
+	/*
+	 * Array of `field_count` member fields, owned by this; the
+	 * array and the fields are within this field's block.
+	 */
+	struct bt_field **fields;
+	uint64_t field_count;
 };
 
 struct bt_field_option {
@@ -170,18 +183,75 @@ struct bt_field_variant {
 	/* Index of currently selected field */
 	uint64_t selected_index;
 
-	/* Array of `struct bt_field *`, owned by this */
-	GPtrArray *fields;
+	/*
+	 * Array of `field_count` option fields, owned by this; the
+	 * array and the fields are within this field's block.
+	 */
+	struct bt_field **fields;
+	uint64_t field_count;
+};
+
+enum bt_field_array_values_state {
+	/* Packed element values only (initial state, after a reset) */
+	BT_FIELD_ARRAY_VALUES_STATE_PACKED = 0,
+
+	/* Element fields only */
+	BT_FIELD_ARRAY_VALUES_STATE_FIELDS,
+
+	/* Both packed element values and element fields */
+	BT_FIELD_ARRAY_VALUES_STATE_BOTH,
 };
 
 struct bt_field_array {
 	struct bt_field common;
 
-	/* Array of `struct bt_field *`, owned by this */
-	GPtrArray *fields;
+	/*
+	 * Array of `capacity` element fields, owned by this.
+	 *
+	 * For a static array field, the array and the element fields
+	 * are within this field's block. For a dynamic array field,
+	 * the array is allocated on its own and each element field is
+	 * the root of its own field tree.
+	 */
+	struct bt_field **fields;
+	uint64_t capacity;
 
 	/* Current effective length */
 	uint64_t length;
+
+	/*
+	 * If the element field class is a boolean, integer, or real
+	 * field class: size of one packed element value (`bt_bool`,
+	 * `uint64_t`/`int64_t`, or `double`). 0 otherwise.
+	 */
+	size_t packed_value_size;
+
+	/*
+	 * Packed element values, with room for `packed_capacity`
+	 * values, owned by this (within this field's block for a
+	 * static array field).
+	 *
+	 * Element fields are only created when the user borrows one of
+	 * them: from then on, they hold the current values until the
+	 * user borrows the packed values for writing.
+	 */
+	void *packed_values;
+	uint64_t packed_capacity;
+
+	/*
+	 * Which representation holds the current values
+	 * (`enum bt_field_array_values_state`).
+	 *
+	 * Borrowing the values or an element field of a const array
+	 * field can convert them and make both representations
+	 * current. Other threads can read the same field meanwhile:
+	 * this member is accessed atomically and the conversion
+	 * happens under a lock.
+	 */
+	gint values_state;
+
+	/* True if the packed element values are set (developer mode) */
+	bool packed_values_set;
 };
 
 struct bt_field_string {
@@ -236,6 +306,9 @@ end:
 	return is_set;
 }
 
+/*
+ * Creates a field tree from `class` within a single memory block.
+ */
 BT_HIDDEN
 struct bt_field *bt_field_create(struct bt_field_class *class);
 
@@ -152,6 +152,7 @@ struct bt_stream_class *create_stream_class_with_id(
 	}
 
 	ret = bt_object_pool_initialize(&stream_class->packet_context_field_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_PACKET_CONTEXT_FIELD,
 		(bt_object_pool_new_object_func) bt_field_wrapper_new,
 		(bt_object_pool_destroy_object_func) free_field_wrapper,
 		stream_class);
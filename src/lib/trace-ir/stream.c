@@ -136,6 +136,7 @@ struct bt_stream *create_stream_with_id(struct bt_stream_class *stream_class,
 
 	stream->id = id;
 	ret = bt_object_pool_initialize(&stream->packet_pool,
+		BT_UTIL_OBJECT_POOL_TYPE_PACKET,
 		(bt_object_pool_new_object_func) bt_packet_new,
 		(bt_object_pool_destroy_object_func) bt_stream_free_packet,
 		stream);
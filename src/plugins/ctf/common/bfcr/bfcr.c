@@ -37,11 +37,18 @@
 #include "common/assert.h"
 #include <string.h>
 #include "compat/bitfield.h"
+#include "compat/endian.h"
 #include "common/common.h"
 #include <babeltrace2/babeltrace.h>
 #include "common/align.h"
 #include <glib.h>
 
+#if defined(__AVX2__)
+# include <immintrin.h>
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #include "bfcr.h"
 #include "../metadata/ctf-meta.h"
 
@@ -51,6 +58,9 @@
 #define BITS_TO_BYTES_CEIL(_x)		DIV8((_x) + 7)
 #define IN_BYTE_OFFSET(_at)		((_at) & 7)
 
+/* Maximum number of array/sequence integer elements to read at once */
+#define INT_ARRAY_RUN_MAX_LEN	256
+
 /* A visit stack entry */
 struct stack_entry {
 	/*
@@ -124,6 +134,12 @@ struct bt_bfcr {
 	/* Current byte order (copied to last_bo after a successful read) */
 	enum ctf_byte_order cur_bo;
 
+	/*
+	 * Decoded values of the current run of array/sequence integer
+	 * elements (signed values are sign-extended).
+	 */
+	uint64_t int_array_values[INT_ARRAY_RUN_MAX_LEN];
+
 	/* Stitch buffer infos */
 	struct {
 		/* Stitch buffer */
@@ -502,6 +518,174 @@ void read_signed_bitfield(struct bt_bfcr *bfcr, const uint8_t *buf, size_t at,
 		"bo=%d, val=%" PRId64, at, field_size, bo, *v);
 }
 
+/*
+ * Reads the 8-bit, 16-bit, 32-bit, or 64-bit word at the byte boundary
+ * `at` (bits) of `buf` with a single (possibly unaligned) load, swapping
+ * its bytes if `bo` is not the native byte order.
+ */
+static inline
+uint64_t read_aligned_word(const uint8_t *buf, size_t at,
+		unsigned int field_size, enum ctf_byte_order bo)
+{
+	const uint8_t *addr = buf + at / 8;
+
+	BT_ASSERT_DBG(at % 8 == 0);
+
+	switch (field_size) {
+	case 8:
+		return *addr;
+	case 16:
+	{
+		uint16_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return bo == CTF_BYTE_ORDER_LITTLE ?
+			le16toh(v) : be16toh(v);
+	}
+	case 32:
+	{
+		uint32_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return bo == CTF_BYTE_ORDER_LITTLE ?
+			le32toh(v) : be32toh(v);
+	}
+	case 64:
+	{
+		uint64_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return bo == CTF_BYTE_ORDER_LITTLE ?
+			le64toh(v) : be64toh(v);
+	}
+	default:
+		bt_common_abort();
+	}
+}
+
+static inline
+void read_unsigned_bit_array(struct bt_bfcr *bfcr, const uint8_t *buf,
+		size_t at, struct ctf_field_class_bit_array *fc, uint64_t *v)
+{
+	if (G_LIKELY(fc->is_aligned_word)) {
+		*v = read_aligned_word(buf, at, fc->size, fc->byte_order);
+		BT_COMP_LOGT("Read unsigned aligned word: cur=%zu, size=%u, "
+			"bo=%d, val=%" PRIu64, at, fc->size, fc->byte_order,
+			*v);
+	} else {
+		read_unsigned_bitfield(bfcr, buf, at, fc->size,
+			fc->byte_order, v);
+	}
+}
+
+static inline
+void read_signed_bit_array(struct bt_bfcr *bfcr, const uint8_t *buf,
+		size_t at, struct ctf_field_class_bit_array *fc, int64_t *v)
+{
+	if (G_LIKELY(fc->is_aligned_word)) {
+		uint64_t u = read_aligned_word(buf, at, fc->size,
+			fc->byte_order);
+
+		/* Sign-extend */
+		switch (fc->size) {
+		case 8:
+			*v = (int8_t) u;
+			break;
+		case 16:
+			*v = (int16_t) u;
+			break;
+		case 32:
+			*v = (int32_t) u;
+			break;
+		default:
+			*v = (int64_t) u;
+			break;
+		}
+
+		BT_COMP_LOGT("Read signed aligned word: cur=%zu, size=%u, "
+			"bo=%d, val=%" PRId64, at, fc->size, fc->byte_order,
+			*v);
+	} else {
+		read_signed_bitfield(bfcr, buf, at, fc->size, fc->byte_order,
+			v);
+	}
+}
+
+/*
+ * Reads `count` contiguous `field_size`-bit words of byte order `bo`
+ * from `addr` into `values`, sign-extending them if `is_signed` is
+ * true.
+ *
+ * Each loop only depends on the size and the byte order so that the
+ * compiler can vectorize it.
+ */
+static
+void read_aligned_words(const uint8_t *addr, size_t count,
+		unsigned int field_size, enum ctf_byte_order bo,
+		bool is_signed, uint64_t *values)
+{
+	size_t i;
+
+	switch (field_size) {
+	case 8:
+		if (is_signed) {
+			for (i = 0; i < count; i++) {
+				values[i] = (uint64_t) (int64_t) (int8_t) addr[i];
+			}
+		} else {
+			for (i = 0; i < count; i++) {
+				values[i] = addr[i];
+			}
+		}
+
+		break;
+	case 16:
+		for (i = 0; i < count; i++) {
+			uint16_t v;
+
+			memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+			v = bo == CTF_BYTE_ORDER_LITTLE ?
+				le16toh(v) : be16toh(v);
+			values[i] = is_signed ?
+				(uint64_t) (int64_t) (int16_t) v : v;
+		}
+
+		break;
+	case 32:
+		for (i = 0; i < count; i++) {
+			uint32_t v;
+
+			memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+			v = bo == CTF_BYTE_ORDER_LITTLE ?
+				le32toh(v) : be32toh(v);
+			values[i] = is_signed ?
+				(uint64_t) (int64_t) (int32_t) v : v;
+		}
+
+		break;
+	case 64:
+		if (bo == CTF_BYTE_ORDER_LITTLE) {
+			for (i = 0; i < count; i++) {
+				uint64_t v;
+
+				memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+				values[i] = le64toh(v);
+			}
+		} else {
+			for (i = 0; i < count; i++) {
+				uint64_t v;
+
+				memcpy(&v, &addr[i * sizeof(v)], sizeof(v));
+				values[i] = be64toh(v);
+			}
+		}
+
+		break;
+	default:
+		bt_common_abort();
+	}
+}
+
 typedef enum bt_bfcr_status (* read_basic_and_call_cb_t)(struct bt_bfcr *,
 		const uint8_t *, size_t);
 
@@ -576,7 +760,7 @@ enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
 			float f;
 		} f32;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_unsigned_bit_array(bfcr, buf, at, &fc->base, &v);
 		f32.u = (uint32_t) v;
 		dblval = (double) f32.f;
 		break;
@@ -588,7 +772,7 @@ enum bt_bfcr_status read_basic_float_and_call_cb(struct bt_bfcr *bfcr,
 			double d;
 		} f64;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &f64.u);
+		read_unsigned_bit_array(bfcr, buf, at, &fc->base, &f64.u);
 		dblval = f64.d;
 		break;
 	}
@@ -619,12 +803,10 @@ static inline
 enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
 		const uint8_t *buf, size_t at)
 {
-	unsigned int field_size;
 	enum ctf_byte_order bo;
 	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
 	struct ctf_field_class_int *fc = (void *) bfcr->cur_basic_field_class;
 
-	field_size = fc->base.size;
 	bo = fc->base.byte_order;
 
 	/*
@@ -637,7 +819,7 @@ enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
 	if (fc->is_signed) {
 		int64_t v;
 
-		read_signed_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_signed_bit_array(bfcr, buf, at, &fc->base, &v);
 
 		if (bfcr->user.cbs.classes.signed_int) {
 			BT_COMP_LOGT("Calling user function (signed integer).");
@@ -654,7 +836,7 @@ enum bt_bfcr_status read_basic_int_and_call_cb(struct bt_bfcr *bfcr,
 	} else {
 		uint64_t v;
 
-		read_unsigned_bitfield(bfcr, buf, at, field_size, bo, &v);
+		read_unsigned_bit_array(bfcr, buf, at, &fc->base, &v);
 
 		if (bfcr->user.cbs.classes.unsigned_int) {
 			BT_COMP_LOGT("Calling user function (unsigned integer).");
@@ -821,12 +1003,57 @@ enum bt_bfcr_status read_basic_float_class_and_call_continue(
 		read_basic_float_and_call_cb);
 }
 
+/*
+ * Returns the address of the first null character within the `len`
+ * bytes at `buf`, or `NULL` if there's none.
+ *
+ * Scans 32 (AVX2) or 16 (SSE2) bytes at a time when the compiler
+ * targets those instruction sets, falling back to memchr() otherwise
+ * and for the tail.
+ */
+static inline
+const uint8_t *find_null_char(const uint8_t *buf, size_t len)
+{
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	const __m256i zero32 = _mm256_setzero_si256();
+
+	for (; i + 32 <= len; i += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i *) &buf[i]);
+		unsigned int mask = (unsigned int) _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(chunk, zero32));
+
+		if (mask) {
+			return &buf[i + __builtin_ctz(mask)];
+		}
+	}
+#endif
+
+#if defined(__SSE2__)
+	const __m128i zero16 = _mm_setzero_si128();
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *) &buf[i]);
+		unsigned int mask = (unsigned int) _mm_movemask_epi8(
+			_mm_cmpeq_epi8(chunk, zero16));
+
+		if (mask) {
+			return &buf[i + __builtin_ctz(mask)];
+		}
+	}
+#endif
+
+	return memchr(&buf[i], '\0', len - i);
+}
+
 static inline
 enum bt_bfcr_status read_basic_string_class_and_call(
 		struct bt_bfcr *bfcr, bool begin)
 {
 	size_t buf_at_bytes;
 	const uint8_t *result;
+	size_t result_len;
 	size_t available_bytes;
 	const uint8_t *first_chr;
 	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
@@ -842,7 +1069,25 @@ enum bt_bfcr_status read_basic_string_class_and_call(
 	buf_at_bytes = BITS_TO_BYTES_FLOOR(buf_at_from_addr(bfcr));
 	BT_ASSERT_DBG(bfcr->buf.addr);
 	first_chr = &bfcr->buf.addr[buf_at_bytes];
-	result = memchr(first_chr, '\0', available_bytes);
+	result = find_null_char(first_chr, available_bytes);
+	result_len = result ? (size_t) (result - first_chr) : 0;
+
+	if (begin && result && bfcr->user.cbs.classes.complete_string) {
+		/* Whole string is in the current buffer: single call */
+		BT_COMP_LOGT("Calling user function (complete string).");
+		status = bfcr->user.cbs.classes.complete_string(
+			(const char *) first_chr, result_len,
+			bfcr->cur_basic_field_class, bfcr->user.data);
+		BT_COMP_LOGT("User function returned: status=%s",
+			bt_bfcr_status_string(status));
+		if (status != BT_BFCR_STATUS_OK) {
+			BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+				bfcr, bt_bfcr_status_string(status));
+			goto end;
+		}
+
+		goto string_done;
+	}
 
 	if (begin && bfcr->user.cbs.classes.string_begin) {
 		BT_COMP_LOGT("Calling user function (string, beginning).");
@@ -878,51 +1123,51 @@ enum bt_bfcr_status read_basic_string_class_and_call(
 		consume_bits(bfcr, BYTES_TO_BITS(available_bytes));
 		bfcr->state = BFCR_STATE_READ_BASIC_CONTINUE;
 		status = BT_BFCR_STATUS_EOF;
-	} else {
-		/* Found the null character */
-		size_t result_len = (size_t) (result - first_chr);
+		goto end;
+	}
 
-		if (bfcr->user.cbs.classes.string && result_len) {
-			BT_COMP_LOGT("Calling user function (substring).");
-			status = bfcr->user.cbs.classes.string(
-				(const char *) first_chr,
-				result_len, bfcr->cur_basic_field_class,
-				bfcr->user.data);
-			BT_COMP_LOGT("User function returned: status=%s",
-				bt_bfcr_status_string(status));
-			if (status != BT_BFCR_STATUS_OK) {
-				BT_COMP_LOGW("User function failed: "
-					"bfcr-addr=%p, status=%s",
-					bfcr, bt_bfcr_status_string(status));
-				goto end;
-			}
+	/* Found the null character */
+	if (bfcr->user.cbs.classes.string && result_len) {
+		BT_COMP_LOGT("Calling user function (substring).");
+		status = bfcr->user.cbs.classes.string(
+			(const char *) first_chr,
+			result_len, bfcr->cur_basic_field_class,
+			bfcr->user.data);
+		BT_COMP_LOGT("User function returned: status=%s",
+			bt_bfcr_status_string(status));
+		if (status != BT_BFCR_STATUS_OK) {
+			BT_COMP_LOGW("User function failed: "
+				"bfcr-addr=%p, status=%s",
+				bfcr, bt_bfcr_status_string(status));
+			goto end;
 		}
+	}
 
-		if (bfcr->user.cbs.classes.string_end) {
-			BT_COMP_LOGT("Calling user function (string, end).");
-			status = bfcr->user.cbs.classes.string_end(
-				bfcr->cur_basic_field_class, bfcr->user.data);
-			BT_COMP_LOGT("User function returned: status=%s",
-				bt_bfcr_status_string(status));
-			if (status != BT_BFCR_STATUS_OK) {
-				BT_COMP_LOGW("User function failed: "
-					"bfcr-addr=%p, status=%s",
-					bfcr, bt_bfcr_status_string(status));
-				goto end;
-			}
+	if (bfcr->user.cbs.classes.string_end) {
+		BT_COMP_LOGT("Calling user function (string, end).");
+		status = bfcr->user.cbs.classes.string_end(
+			bfcr->cur_basic_field_class, bfcr->user.data);
+		BT_COMP_LOGT("User function returned: status=%s",
+			bt_bfcr_status_string(status));
+		if (status != BT_BFCR_STATUS_OK) {
+			BT_COMP_LOGW("User function failed: "
+				"bfcr-addr=%p, status=%s",
+				bfcr, bt_bfcr_status_string(status));
+			goto end;
 		}
+	}
 
-		consume_bits(bfcr, BYTES_TO_BITS(result_len + 1));
+string_done:
+	consume_bits(bfcr, BYTES_TO_BITS(result_len + 1));
 
-		if (stack_empty(bfcr->stack)) {
-			/* Root is a basic class */
-			bfcr->state = BFCR_STATE_DONE;
-		} else {
-			/* Go to next field */
-			stack_top(bfcr->stack)->index++;
-			bfcr->state = BFCR_STATE_NEXT_FIELD;
-			bfcr->last_bo = bfcr->cur_bo;
-		}
+	if (stack_empty(bfcr->stack)) {
+		/* Root is a basic class */
+		bfcr->state = BFCR_STATE_DONE;
+	} else {
+		/* Go to next field */
+		stack_top(bfcr->stack)->index++;
+		bfcr->state = BFCR_STATE_NEXT_FIELD;
+		bfcr->last_bo = bfcr->cur_bo;
 	}
 
 end:
@@ -1039,6 +1284,93 @@ end:
 	return status;
 }
 
+/*
+ * Tries to read, in one go, as many of the remaining integer elements
+ * of the array/sequence field of `top` as the current buffer contains,
+ * and to pass them to the user with a single call.
+ *
+ * Sets `*count` to the number of read elements, possibly 0 if the
+ * elements are not eligible for bulk reading.
+ */
+static inline
+enum bt_bfcr_status read_int_array_run_and_call_cb(struct bt_bfcr *bfcr,
+		struct stack_entry *top, struct ctf_field_class *elem_fc,
+		size_t *count)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	struct ctf_field_class_array_base *array_fc = (void *) top->base_class;
+	struct ctf_field_class_int *int_fc = (void *) elem_fc;
+	size_t run_len;
+
+	*count = 0;
+
+	if (array_fc->is_text ||
+			(elem_fc->type != CTF_FIELD_CLASS_TYPE_INT &&
+			elem_fc->type != CTF_FIELD_CLASS_TYPE_ENUM) ||
+			!int_fc->base.is_aligned_word) {
+		goto end;
+	}
+
+	/*
+	 * Elements must be contiguous, and their values must not be
+	 * needed individually.
+	 */
+	if (elem_fc->alignment > int_fc->base.size ||
+			int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+			int_fc->mapped_clock_class ||
+			int_fc->storing_index >= 0) {
+		goto end;
+	}
+
+	if (int_fc->is_signed ? !bfcr->user.cbs.classes.signed_int_array :
+			!bfcr->user.cbs.classes.unsigned_int_array) {
+		goto end;
+	}
+
+	if (packet_at(bfcr) % elem_fc->alignment != 0) {
+		goto end;
+	}
+
+	run_len = MIN((size_t) (top->base_len - top->index),
+		available_bits(bfcr) / int_fc->base.size);
+	run_len = MIN(run_len, (size_t) INT_ARRAY_RUN_MAX_LEN);
+	if (run_len < 2) {
+		/* Not worth it */
+		goto end;
+	}
+
+	BT_ASSERT_DBG(buf_at_from_addr(bfcr) % 8 == 0);
+	read_aligned_words(&bfcr->buf.addr[buf_at_from_addr(bfcr) / 8],
+		run_len, int_fc->base.size, int_fc->base.byte_order,
+		int_fc->is_signed, bfcr->int_array_values);
+	BT_COMP_LOGT("Read integer array elements: bfcr-addr=%p, "
+		"elem-fc-addr=%p, index=%" PRId64 ", count=%zu",
+		bfcr, elem_fc, top->index, run_len);
+
+	if (int_fc->is_signed) {
+		status = bfcr->user.cbs.classes.signed_int_array(
+			(const int64_t *) bfcr->int_array_values, run_len,
+			elem_fc, bfcr->user.data);
+	} else {
+		status = bfcr->user.cbs.classes.unsigned_int_array(
+			bfcr->int_array_values, run_len, elem_fc,
+			bfcr->user.data);
+	}
+
+	if (status != BT_BFCR_STATUS_OK) {
+		BT_COMP_LOGW("User function failed: bfcr-addr=%p, status=%s",
+			bfcr, bt_bfcr_status_string(status));
+		goto end;
+	}
+
+	consume_bits(bfcr, run_len * int_fc->base.size);
+	bfcr->last_bo = int_fc->base.byte_order;
+	*count = run_len;
+
+end:
+	return status;
+}
+
 static inline
 enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 {
@@ -1092,7 +1424,21 @@ enum bt_bfcr_status next_field_state(struct bt_bfcr *bfcr)
 		struct ctf_field_class_array_base *array_fc =
 			(void *) top->base_class;
 
+		size_t count;
+
 		next_field_class = array_fc->elem_fc;
+		status = read_int_array_run_and_call_cb(bfcr, top,
+			next_field_class, &count);
+		if (status != BT_BFCR_STATUS_OK) {
+			goto end;
+		}
+
+		if (count > 0) {
+			/* Stay in this state for the next elements */
+			top->index += (int64_t) count;
+			goto end;
+		}
+
 		break;
 	}
 	case CTF_FIELD_CLASS_TYPE_VARIANT:
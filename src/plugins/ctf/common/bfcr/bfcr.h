@@ -144,6 +144,43 @@ struct bt_bfcr_cbs {
 		 */
 		bt_bfcr_unsigned_int_cb_func unsigned_int;
 
+		/**
+		 * Called when contiguous elements of an array or
+		 * sequence class, of which the element class is a
+		 * byte-aligned signed integer or enumeration class
+		 * without a special meaning, are completely decoded.
+		 *
+		 * This replaces as many calls to
+		 * bt_bfcr_cbs::classes::signed_int(). If this is
+		 * \c NULL, the class reader calls
+		 * bt_bfcr_cbs::classes::signed_int() for each element.
+		 *
+		 * @param values	Signed integer values
+		 * @param count		Number of values
+		 * @param class		Element class
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* signed_int_array)(const int64_t *values,
+				size_t count, struct ctf_field_class *cls,
+				void *data);
+
+		/**
+		 * Unsigned version of
+		 * bt_bfcr_cbs::classes::signed_int_array().
+		 *
+		 * @param values	Unsigned integer values
+		 * @param count		Number of values
+		 * @param class		Element class
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* unsigned_int_array)(
+				const uint64_t *values, size_t count,
+				struct ctf_field_class *cls, void *data);
+
 		/**
 		 * Called when a floating point number class is
 		 * completely decoded.
@@ -200,6 +237,28 @@ struct bt_bfcr_cbs {
 		enum bt_bfcr_status (* string_end)(
 				struct ctf_field_class *cls, void *data);
 
+		/**
+		 * Called when a string class is completely decoded from
+		 * a single buffer.
+		 *
+		 * This replaces the calls to
+		 * bt_bfcr_cbs::classes::string_begin(),
+		 * bt_bfcr_cbs::classes::string(), and
+		 * bt_bfcr_cbs::classes::string_end(). If this is
+		 * \c NULL, the class reader calls those functions
+		 * instead.
+		 *
+		 * @param value		String value (\em not null-terminated)
+		 * @param len		String value length
+		 * @param class		String class
+		 * @param data		User data
+		 * @returns		#BT_BFCR_STATUS_OK or
+		 *			#BT_BFCR_STATUS_ERROR
+		 */
+		enum bt_bfcr_status (* complete_string)(const char *value,
+				size_t len, struct ctf_field_class *cls,
+				void *data);
+
 		/**
 		 * Called when a compound class begins.
 		 *
@@ -337,6 +337,16 @@ BT_HIDDEN
 int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		struct ctf_node *node);
 
+/*
+ * Makes `visitor` use `tc` (owned by the visitor from now on), from
+ * ctf_trace_class_deserialize(), as if it had created it by visiting a
+ * complete metadata AST.
+ */
+BT_HIDDEN
+int ctf_visitor_generate_ir_load_ctf_trace_class(
+		struct ctf_visitor_generate_ir *visitor,
+		struct ctf_trace_class *tc);
+
 BT_HIDDEN
 int ctf_visitor_semantic_check(int depth, struct ctf_node *node,
 		struct meta_log_config *log_cfg);
@@ -0,0 +1,750 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/common.h"
+#include "common/uuid.h"
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ctf-meta-visitors.h"
+
+/*
+ * Only the properties which the metadata AST visitor sets are
+ * serialized: the ctf_trace_class_*() passes which the visitor runs
+ * afterwards compute all the others (field paths, meanings, storing
+ * indexes, decode plans, and so on) again when loading.
+ *
+ * Everything is in the native byte order: integers are written as is,
+ * and strings are written as a 32-bit length followed by the bytes
+ * without a terminating null character.
+ */
+
+/* Maximum nesting of field classes, to reject corrupted data */
+#define MAX_FC_DEPTH	4096
+
+#define NO_CLOCK_CLASS	UINT32_C(-1)
+
+struct reader {
+	const uint8_t *pos;
+	const uint8_t *end;
+
+	/* Sticky: true once reading failed */
+	bool failed;
+};
+
+static
+void write_bytes(GByteArray *buf, const void *data, size_t len)
+{
+	g_byte_array_append(buf, data, len);
+}
+
+static
+void write_u8(GByteArray *buf, uint8_t val)
+{
+	write_bytes(buf, &val, sizeof(val));
+}
+
+static
+void write_u32(GByteArray *buf, uint32_t val)
+{
+	write_bytes(buf, &val, sizeof(val));
+}
+
+static
+void write_u64(GByteArray *buf, uint64_t val)
+{
+	write_bytes(buf, &val, sizeof(val));
+}
+
+static
+void write_str(GByteArray *buf, const GString *str)
+{
+	write_u32(buf, (uint32_t) str->len);
+	write_bytes(buf, str->str, str->len);
+}
+
+static
+const uint8_t *read_bytes(struct reader *reader, size_t len)
+{
+	const uint8_t *data = NULL;
+
+	if (reader->failed || (size_t) (reader->end - reader->pos) < len) {
+		reader->failed = true;
+		goto end;
+	}
+
+	data = reader->pos;
+	reader->pos += len;
+
+end:
+	return data;
+}
+
+static
+uint8_t read_u8(struct reader *reader)
+{
+	const uint8_t *data = read_bytes(reader, sizeof(uint8_t));
+
+	return data ? *data : 0;
+}
+
+static
+uint32_t read_u32(struct reader *reader)
+{
+	uint32_t val = 0;
+	const uint8_t *data = read_bytes(reader, sizeof(val));
+
+	if (data) {
+		memcpy(&val, data, sizeof(val));
+	}
+
+	return val;
+}
+
+static
+uint64_t read_u64(struct reader *reader)
+{
+	uint64_t val = 0;
+	const uint8_t *data = read_bytes(reader, sizeof(val));
+
+	if (data) {
+		memcpy(&val, data, sizeof(val));
+	}
+
+	return val;
+}
+
+static
+bool read_bool(struct reader *reader)
+{
+	return read_u8(reader) != 0;
+}
+
+/*
+ * Reads a string into `str`.
+ */
+static
+void read_str(struct reader *reader, GString *str)
+{
+	uint32_t len = read_u32(reader);
+	const uint8_t *data = read_bytes(reader, len);
+
+	if (data) {
+		g_string_truncate(str, 0);
+		g_string_append_len(str, (const gchar *) data, len);
+	}
+}
+
+/*
+ * Reads an element count, failing if the remaining data cannot possibly
+ * contain that many elements of at least `min_elem_size` bytes.
+ */
+static
+uint32_t read_count(struct reader *reader, size_t min_elem_size)
+{
+	uint32_t count = read_u32(reader);
+
+	if (!reader->failed &&
+			(uint64_t) count * min_elem_size >
+				(uint64_t) (reader->end - reader->pos)) {
+		reader->failed = true;
+		count = 0;
+	}
+
+	return count;
+}
+
+static
+uint32_t clock_class_index(struct ctf_trace_class *tc,
+		struct ctf_clock_class *cc)
+{
+	uint32_t i;
+
+	if (!cc) {
+		goto no_cc;
+	}
+
+	for (i = 0; i < tc->clock_classes->len; i++) {
+		if (tc->clock_classes->pdata[i] == cc) {
+			return i;
+		}
+	}
+
+	/* A mapped clock class always belongs to the trace class. */
+	bt_common_abort();
+
+no_cc:
+	return NO_CLOCK_CLASS;
+}
+
+static
+void serialize_bit_array(GByteArray *buf,
+		struct ctf_field_class_bit_array *fc)
+{
+	write_u8(buf, fc->byte_order);
+	write_u32(buf, fc->size);
+	write_u8(buf, fc->is_aligned_word);
+}
+
+static
+void serialize_int(GByteArray *buf, struct ctf_trace_class *tc,
+		struct ctf_field_class_int *fc)
+{
+	serialize_bit_array(buf, &fc->base);
+	write_u8(buf, fc->is_signed);
+	write_u32(buf, fc->disp_base);
+	write_u8(buf, fc->encoding);
+	write_u32(buf, clock_class_index(tc, fc->mapped_clock_class));
+}
+
+static
+void serialize_fc(GByteArray *buf, struct ctf_trace_class *tc,
+		struct ctf_field_class *fc);
+
+static
+void serialize_named_fcs(GByteArray *buf, struct ctf_trace_class *tc,
+		GArray *named_fcs)
+{
+	guint i;
+
+	write_u32(buf, named_fcs->len);
+
+	for (i = 0; i < named_fcs->len; i++) {
+		struct ctf_named_field_class *named_fc = &g_array_index(
+			named_fcs, struct ctf_named_field_class, i);
+
+		write_str(buf, named_fc->orig_name);
+		serialize_fc(buf, tc, named_fc->fc);
+	}
+}
+
+/*
+ * Writes `fc`, which can be `NULL`.
+ */
+static
+void serialize_fc(GByteArray *buf, struct ctf_trace_class *tc,
+		struct ctf_field_class *fc)
+{
+	if (!fc) {
+		write_u8(buf, 0);
+		goto end;
+	}
+
+	write_u8(buf, 1);
+	write_u8(buf, fc->type);
+	write_u32(buf, fc->alignment);
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+		serialize_int(buf, tc, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_enum *enum_fc = (void *) fc;
+		guint i;
+
+		serialize_int(buf, tc, &enum_fc->base);
+		write_u32(buf, enum_fc->mappings->len);
+
+		for (i = 0; i < enum_fc->mappings->len; i++) {
+			struct ctf_field_class_enum_mapping *mapping =
+				ctf_field_class_enum_borrow_mapping_by_index(
+					enum_fc, i);
+			guint range_i;
+
+			write_str(buf, mapping->label);
+			write_u32(buf, mapping->ranges->len);
+
+			for (range_i = 0; range_i < mapping->ranges->len;
+					range_i++) {
+				struct ctf_range *range =
+					ctf_field_class_enum_mapping_borrow_range_by_index(
+						mapping, range_i);
+
+				write_u64(buf, range->lower.u);
+				write_u64(buf, range->upper.u);
+			}
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+		serialize_bit_array(buf, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_STRING:
+		write_u8(buf, ((struct ctf_field_class_string *) fc)->encoding);
+		break;
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+		serialize_named_fcs(buf, tc,
+			((struct ctf_field_class_struct *) fc)->members);
+		break;
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc = (void *) fc;
+
+		write_u64(buf, array_fc->length);
+		serialize_fc(buf, tc, array_fc->base.elem_fc);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_sequence *seq_fc = (void *) fc;
+
+		write_str(buf, seq_fc->length_ref);
+		serialize_fc(buf, tc, seq_fc->base.elem_fc);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc = (void *) fc;
+
+		write_str(buf, var_fc->tag_ref);
+		serialize_named_fcs(buf, tc, var_fc->options);
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void ctf_trace_class_serialize(struct ctf_trace_class *tc, GByteArray *buf)
+{
+	guint i;
+
+	BT_ASSERT(tc);
+	BT_ASSERT(buf);
+	write_u32(buf, tc->major);
+	write_u32(buf, tc->minor);
+	write_bytes(buf, tc->uuid, BT_UUID_LEN);
+	write_u8(buf, tc->is_uuid_set);
+	write_u8(buf, tc->default_byte_order);
+
+	write_u32(buf, tc->env_entries->len);
+
+	for (i = 0; i < tc->env_entries->len; i++) {
+		struct ctf_trace_class_env_entry *entry =
+			ctf_trace_class_borrow_env_entry_by_index(tc, i);
+
+		write_u8(buf, entry->type);
+		write_str(buf, entry->name);
+		write_str(buf, entry->value.str);
+		write_u64(buf, (uint64_t) entry->value.i);
+	}
+
+	write_u32(buf, tc->clock_classes->len);
+
+	for (i = 0; i < tc->clock_classes->len; i++) {
+		struct ctf_clock_class *cc = tc->clock_classes->pdata[i];
+
+		write_str(buf, cc->name);
+		write_str(buf, cc->description);
+		write_u64(buf, cc->frequency);
+		write_u64(buf, cc->precision);
+		write_u64(buf, (uint64_t) cc->offset_seconds);
+		write_u64(buf, cc->offset_cycles);
+		write_bytes(buf, cc->uuid, BT_UUID_LEN);
+		write_u8(buf, cc->has_uuid);
+		write_u8(buf, cc->is_absolute);
+	}
+
+	serialize_fc(buf, tc, tc->packet_header_fc);
+	write_u32(buf, tc->stream_classes->len);
+
+	for (i = 0; i < tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = tc->stream_classes->pdata[i];
+		guint ec_i;
+
+		write_u64(buf, sc->id);
+		serialize_fc(buf, tc, sc->packet_context_fc);
+		serialize_fc(buf, tc, sc->event_header_fc);
+		serialize_fc(buf, tc, sc->event_common_context_fc);
+		write_u32(buf, sc->event_classes->len);
+
+		for (ec_i = 0; ec_i < sc->event_classes->len; ec_i++) {
+			struct ctf_event_class *ec =
+				sc->event_classes->pdata[ec_i];
+
+			write_u64(buf, ec->id);
+			write_str(buf, ec->name);
+			write_str(buf, ec->emf_uri);
+			write_u8(buf, ec->is_log_level_set);
+			write_u32(buf, ec->log_level);
+			serialize_fc(buf, tc, ec->spec_context_fc);
+			serialize_fc(buf, tc, ec->payload_fc);
+		}
+	}
+}
+
+static
+void deserialize_bit_array(struct reader *reader,
+		struct ctf_field_class_bit_array *fc)
+{
+	fc->byte_order = read_u8(reader);
+	fc->size = read_u32(reader);
+	fc->is_aligned_word = read_bool(reader);
+
+	if (fc->byte_order != CTF_BYTE_ORDER_LITTLE &&
+			fc->byte_order != CTF_BYTE_ORDER_BIG) {
+		reader->failed = true;
+	}
+}
+
+static
+void deserialize_int(struct reader *reader, struct ctf_trace_class *tc,
+		struct ctf_field_class_int *fc)
+{
+	uint32_t cc_index;
+
+	deserialize_bit_array(reader, &fc->base);
+	fc->is_signed = read_bool(reader);
+	fc->disp_base = read_u32(reader);
+	fc->encoding = read_u8(reader);
+	cc_index = read_u32(reader);
+
+	if (fc->encoding > CTF_ENCODING_UTF8) {
+		reader->failed = true;
+	}
+
+	if (cc_index != NO_CLOCK_CLASS) {
+		if (cc_index < tc->clock_classes->len) {
+			fc->mapped_clock_class = tc->clock_classes->pdata[cc_index];
+		} else {
+			reader->failed = true;
+		}
+	}
+}
+
+static
+struct ctf_field_class *deserialize_fc(struct reader *reader,
+		struct ctf_trace_class *tc, unsigned int depth);
+
+/*
+ * Calls `append_func` for each named field class read from `reader`.
+ */
+static
+void deserialize_named_fcs(struct reader *reader, struct ctf_trace_class *tc,
+		unsigned int depth, struct ctf_field_class *compound_fc,
+		void (*append_func)(struct ctf_field_class *,
+			const char *, struct ctf_field_class *))
+{
+	uint32_t count = read_count(reader, sizeof(uint32_t) + 1);
+	GString *orig_name = g_string_new(NULL);
+	uint32_t i;
+
+	for (i = 0; i < count && !reader->failed; i++) {
+		struct ctf_field_class *fc;
+
+		read_str(reader, orig_name);
+		fc = deserialize_fc(reader, tc, depth + 1);
+		if (!fc) {
+			reader->failed = true;
+			break;
+		}
+
+		append_func(compound_fc, orig_name->str, fc);
+	}
+
+	g_string_free(orig_name, TRUE);
+}
+
+static
+void append_struct_member(struct ctf_field_class *fc, const char *orig_name,
+		struct ctf_field_class *member_fc)
+{
+	ctf_field_class_struct_append_member((void *) fc, orig_name,
+		member_fc);
+}
+
+static
+void append_variant_option(struct ctf_field_class *fc, const char *orig_name,
+		struct ctf_field_class *option_fc)
+{
+	ctf_field_class_variant_append_option((void *) fc, orig_name,
+		option_fc);
+}
+
+/*
+ * Reads a field class, which can be absent (returns `NULL` without
+ * failing `reader`).
+ */
+static
+struct ctf_field_class *deserialize_fc(struct reader *reader,
+		struct ctf_trace_class *tc, unsigned int depth)
+{
+	struct ctf_field_class *fc = NULL;
+	enum ctf_field_class_type type;
+	unsigned int alignment;
+
+	if (!read_bool(reader) || reader->failed) {
+		goto end;
+	}
+
+	if (depth > MAX_FC_DEPTH) {
+		reader->failed = true;
+		goto end;
+	}
+
+	type = read_u8(reader);
+	alignment = read_u32(reader);
+
+	switch (type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+		fc = (void *) ctf_field_class_int_create();
+		deserialize_int(reader, tc, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_enum *enum_fc =
+			ctf_field_class_enum_create();
+		GString *label = g_string_new(NULL);
+		uint32_t mapping_count;
+		uint32_t i;
+
+		fc = (void *) enum_fc;
+		deserialize_int(reader, tc, &enum_fc->base);
+		mapping_count = read_count(reader, 2 * sizeof(uint32_t));
+
+		for (i = 0; i < mapping_count && !reader->failed; i++) {
+			uint32_t range_count;
+			uint32_t range_i;
+
+			read_str(reader, label);
+			range_count = read_count(reader, 2 * sizeof(uint64_t));
+
+			for (range_i = 0; range_i < range_count; range_i++) {
+				uint64_t lower = read_u64(reader);
+				uint64_t upper = read_u64(reader);
+
+				ctf_field_class_enum_map_range(enum_fc,
+					label->str, lower, upper);
+			}
+		}
+
+		g_string_free(label, TRUE);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+		fc = (void *) ctf_field_class_float_create();
+		deserialize_bit_array(reader, (void *) fc);
+		break;
+	case CTF_FIELD_CLASS_TYPE_STRING:
+	{
+		struct ctf_field_class_string *string_fc =
+			ctf_field_class_string_create();
+
+		fc = (void *) string_fc;
+		string_fc->encoding = read_u8(reader);
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+		fc = (void *) ctf_field_class_struct_create();
+		deserialize_named_fcs(reader, tc, depth, fc,
+			append_struct_member);
+		break;
+	case CTF_FIELD_CLASS_TYPE_ARRAY:
+	{
+		struct ctf_field_class_array *array_fc =
+			ctf_field_class_array_create();
+
+		fc = (void *) array_fc;
+		array_fc->length = read_u64(reader);
+		array_fc->base.elem_fc = deserialize_fc(reader, tc, depth + 1);
+		if (!array_fc->base.elem_fc) {
+			reader->failed = true;
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_SEQUENCE:
+	{
+		struct ctf_field_class_sequence *seq_fc =
+			ctf_field_class_sequence_create();
+
+		fc = (void *) seq_fc;
+		read_str(reader, seq_fc->length_ref);
+		seq_fc->base.elem_fc = deserialize_fc(reader, tc, depth + 1);
+		if (!seq_fc->base.elem_fc) {
+			reader->failed = true;
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_VARIANT:
+	{
+		struct ctf_field_class_variant *var_fc =
+			ctf_field_class_variant_create();
+
+		fc = (void *) var_fc;
+		read_str(reader, var_fc->tag_ref);
+		deserialize_named_fcs(reader, tc, depth, fc,
+			append_variant_option);
+		break;
+	}
+	default:
+		reader->failed = true;
+		goto end;
+	}
+
+	/*
+	 * Set the alignment last: appending a structure member can
+	 * change it.
+	 */
+	fc->alignment = alignment;
+
+end:
+	if (reader->failed) {
+		ctf_field_class_destroy(fc);
+		fc = NULL;
+	}
+
+	return fc;
+}
+
+BT_HIDDEN
+struct ctf_trace_class *ctf_trace_class_deserialize(const uint8_t *data,
+		size_t len)
+{
+	struct reader reader = {
+		.pos = data,
+		.end = data + len,
+		.failed = false,
+	};
+	struct ctf_trace_class *tc = ctf_trace_class_create();
+	GString *name = g_string_new(NULL);
+	GString *str_value = g_string_new(NULL);
+	const uint8_t *uuid;
+	uint32_t count;
+	uint32_t i;
+
+	tc->major = read_u32(&reader);
+	tc->minor = read_u32(&reader);
+	uuid = read_bytes(&reader, BT_UUID_LEN);
+	if (uuid) {
+		bt_uuid_copy(tc->uuid, uuid);
+	}
+
+	tc->is_uuid_set = read_bool(&reader);
+	tc->default_byte_order = read_u8(&reader);
+	if (tc->default_byte_order != CTF_BYTE_ORDER_LITTLE &&
+			tc->default_byte_order != CTF_BYTE_ORDER_BIG) {
+		goto error;
+	}
+
+	/* Environment */
+	count = read_count(&reader, 1 + 2 * sizeof(uint32_t) +
+		sizeof(uint64_t));
+
+	for (i = 0; i < count && !reader.failed; i++) {
+		enum ctf_trace_class_env_entry_type type = read_u8(&reader);
+		int64_t i_value;
+
+		read_str(&reader, name);
+		read_str(&reader, str_value);
+		i_value = (int64_t) read_u64(&reader);
+
+		if (type != CTF_TRACE_CLASS_ENV_ENTRY_TYPE_INT &&
+				type != CTF_TRACE_CLASS_ENV_ENTRY_TYPE_STR) {
+			goto error;
+		}
+
+		ctf_trace_class_append_env_entry(tc, name->str, type,
+			str_value->str, i_value);
+	}
+
+	/* Clock classes */
+	count = read_count(&reader, 2 * sizeof(uint32_t) +
+		4 * sizeof(uint64_t) + BT_UUID_LEN + 2);
+
+	for (i = 0; i < count && !reader.failed; i++) {
+		struct ctf_clock_class *cc = ctf_clock_class_create();
+
+		g_ptr_array_add(tc->clock_classes, cc);
+		read_str(&reader, cc->name);
+		read_str(&reader, cc->description);
+		cc->frequency = read_u64(&reader);
+		cc->precision = read_u64(&reader);
+		cc->offset_seconds = (int64_t) read_u64(&reader);
+		cc->offset_cycles = read_u64(&reader);
+		uuid = read_bytes(&reader, BT_UUID_LEN);
+		if (uuid) {
+			bt_uuid_copy(cc->uuid, uuid);
+		}
+
+		cc->has_uuid = read_bool(&reader);
+		cc->is_absolute = read_bool(&reader);
+	}
+
+	tc->packet_header_fc = deserialize_fc(&reader, tc, 0);
+
+	/* Stream classes */
+	count = read_count(&reader, sizeof(uint64_t) + 3 + sizeof(uint32_t));
+
+	for (i = 0; i < count && !reader.failed; i++) {
+		struct ctf_stream_class *sc = ctf_stream_class_create();
+		uint32_t ec_count;
+		uint32_t ec_i;
+
+		g_ptr_array_add(tc->stream_classes, sc);
+		sc->id = read_u64(&reader);
+		sc->packet_context_fc = deserialize_fc(&reader, tc, 0);
+		sc->event_header_fc = deserialize_fc(&reader, tc, 0);
+		sc->event_common_context_fc = deserialize_fc(&reader, tc, 0);
+		ec_count = read_count(&reader, sizeof(uint64_t) +
+			3 * sizeof(uint32_t) + 3);
+
+		for (ec_i = 0; ec_i < ec_count && !reader.failed; ec_i++) {
+			struct ctf_event_class *ec = ctf_event_class_create();
+			bool is_log_level_set;
+			bt_event_class_log_level log_level;
+
+			ec->id = read_u64(&reader);
+			ctf_stream_class_append_event_class(sc, ec);
+			read_str(&reader, ec->name);
+			read_str(&reader, ec->emf_uri);
+			is_log_level_set = read_bool(&reader);
+			log_level = read_u32(&reader);
+
+			if (is_log_level_set) {
+				ctf_event_class_set_log_level(ec, log_level);
+			}
+
+			ec->spec_context_fc = deserialize_fc(&reader, tc, 0);
+			ec->payload_fc = deserialize_fc(&reader, tc, 0);
+		}
+	}
+
+	if (reader.failed || reader.pos != reader.end) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ctf_trace_class_destroy(tc);
+	tc = NULL;
+
+end:
+	g_string_free(name, TRUE);
+	g_string_free(str_value, TRUE);
+	return tc;
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/macros.h"
+#include "common/assert.h"
+#include "common/align.h"
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ctf-meta-visitors.h"
+
+struct compile_ctx {
+	struct ctf_decode_plan *plan;
+
+	/* Current offset (bits) from the beginning of the root field */
+	uint64_t offset;
+
+	/* Byte order of the last compiled bit array */
+	enum ctf_byte_order last_bo;
+};
+
+static
+void append_instr(struct compile_ctx *ctx,
+		enum ctf_decode_plan_instr_type type,
+		struct ctf_field_class *fc, int64_t ir_index)
+{
+	struct ctf_decode_plan_instr instr = {
+		.type = type,
+		.fc = fc,
+		.offset = ctx->offset,
+		.ir_index = ir_index,
+	};
+
+	g_array_append_val(ctx->plan->instrs, instr);
+}
+
+/*
+ * Returns 0 if `fc` is compiled, or -1 if its layout is not fixed, in
+ * which case the generic binary field class reader must decode it.
+ */
+static
+int compile_field_class(struct compile_ctx *ctx, struct ctf_field_class *fc,
+		int64_t ir_index, unsigned int depth)
+{
+	int ret = 0;
+	uint64_t i;
+	int64_t member_ir_index = 0;
+
+	/*
+	 * The offset of a field is only known at compile time if its
+	 * alignment divides the alignment of the root field.
+	 */
+	if (fc->alignment > ctx->plan->alignment) {
+		ret = -1;
+		goto end;
+	}
+
+	ctx->offset = ALIGN(ctx->offset, fc->alignment);
+
+	switch (fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct ctf_field_class_bit_array *ba_fc = (void *) fc;
+
+		if (fc->type == CTF_FIELD_CLASS_TYPE_FLOAT) {
+			if (ba_fc->size != 32 && ba_fc->size != 64) {
+				ret = -1;
+				goto end;
+			}
+		} else if (ba_fc->size > 64) {
+			ret = -1;
+			goto end;
+		}
+
+		if (ba_fc->byte_order != CTF_BYTE_ORDER_LITTLE &&
+				ba_fc->byte_order != CTF_BYTE_ORDER_BIG) {
+			ret = -1;
+			goto end;
+		}
+
+		/*
+		 * Let the binary field class reader report a byte order
+		 * change which is not at a byte boundary.
+		 */
+		if (ctx->offset % 8 != 0 &&
+				ctx->last_bo != CTF_BYTE_ORDER_UNKNOWN &&
+				ctx->last_bo != ba_fc->byte_order) {
+			ret = -1;
+			goto end;
+		}
+
+		append_instr(ctx, fc->type == CTF_FIELD_CLASS_TYPE_FLOAT ?
+			CTF_DECODE_PLAN_INSTR_TYPE_FLOAT :
+			CTF_DECODE_PLAN_INSTR_TYPE_INT, fc, ir_index);
+		ctx->offset += ba_fc->size;
+		ctx->last_bo = ba_fc->byte_order;
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_STRUCT:
+	{
+		struct ctf_field_class_struct *struct_fc = (void *) fc;
+
+		if (depth >= CTF_DECODE_PLAN_MAX_DEPTH) {
+			ret = -1;
+			goto end;
+		}
+
+		append_instr(ctx, CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_BEGIN, fc,
+			ir_index);
+
+		for (i = 0; i < struct_fc->members->len; i++) {
+			struct ctf_named_field_class *named_fc =
+				ctf_field_class_struct_borrow_member_by_index(
+					struct_fc, i);
+
+			ret = compile_field_class(ctx, named_fc->fc,
+				named_fc->fc->in_ir ? member_ir_index : -1,
+				depth + 1);
+			if (ret) {
+				goto end;
+			}
+
+			if (named_fc->fc->in_ir) {
+				member_ir_index++;
+			}
+		}
+
+		append_instr(ctx, CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_END, fc,
+			ir_index);
+		break;
+	}
+	default:
+		/* Strings, arrays, sequences, and variants */
+		ret = -1;
+		goto end;
+	}
+
+end:
+	return ret;
+}
+
+static
+struct ctf_decode_plan *compile_decode_plan(struct ctf_field_class *root_fc)
+{
+	struct compile_ctx ctx = {
+		.plan = NULL,
+		.offset = 0,
+		.last_bo = CTF_BYTE_ORDER_UNKNOWN,
+	};
+
+	if (!root_fc || root_fc->type != CTF_FIELD_CLASS_TYPE_STRUCT) {
+		goto end;
+	}
+
+	/*
+	 * The beginning of the root field must be at a byte boundary
+	 * to validate byte order changes at compile time.
+	 */
+	if (root_fc->alignment % 8 != 0) {
+		goto end;
+	}
+
+	ctx.plan = ctf_decode_plan_create();
+	ctx.plan->alignment = root_fc->alignment;
+
+	if (compile_field_class(&ctx, root_fc, -1, 0)) {
+		ctf_decode_plan_destroy(ctx.plan);
+		ctx.plan = NULL;
+		goto end;
+	}
+
+	ctx.plan->size = ctx.offset;
+
+end:
+	return ctx.plan;
+}
+
+/*
+ * Returns a lazy payload built from the compiled payload decode plan
+ * `plan`, or `NULL` if decoding the payload field has effects on the
+ * message iterator.
+ */
+static
+struct ctf_lazy_payload *create_lazy_payload(struct ctf_field_class *root_fc,
+		struct ctf_decode_plan *plan)
+{
+	struct ctf_lazy_payload *lazy_payload = NULL;
+	guint i;
+
+	if (!plan || !root_fc->in_ir) {
+		goto end;
+	}
+
+	for (i = 0; i < plan->instrs->len; i++) {
+		struct ctf_decode_plan_instr *instr = &g_array_index(
+			plan->instrs, struct ctf_decode_plan_instr, i);
+		struct ctf_field_class_int *int_fc = (void *) instr->fc;
+
+		if (instr->type != CTF_DECODE_PLAN_INSTR_TYPE_INT) {
+			continue;
+		}
+
+		if (int_fc->meaning != CTF_FIELD_CLASS_MEANING_NONE ||
+				int_fc->mapped_clock_class ||
+				int_fc->storing_index >= 0) {
+			goto end;
+		}
+	}
+
+	lazy_payload = ctf_lazy_payload_create();
+	lazy_payload->alignment = plan->alignment;
+	lazy_payload->size = plan->size;
+
+	for (i = 0; i < plan->instrs->len; i++) {
+		struct ctf_decode_plan_instr *instr = &g_array_index(
+			plan->instrs, struct ctf_decode_plan_instr, i);
+		struct ctf_lazy_payload_instr lazy_instr = {
+			.type = instr->type,
+			.offset = instr->offset,
+			.ir_index = instr->ir_index,
+		};
+
+		/* Only the IR fields need to be decoded */
+		if (!instr->fc->in_ir) {
+			continue;
+		}
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_INT ||
+				instr->type == CTF_DECODE_PLAN_INSTR_TYPE_FLOAT) {
+			struct ctf_field_class_bit_array *ba_fc =
+				(void *) instr->fc;
+
+			lazy_instr.size = ba_fc->size;
+			lazy_instr.byte_order = ba_fc->byte_order;
+		}
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_INT) {
+			struct ctf_field_class_int *int_fc = (void *) instr->fc;
+
+			lazy_instr.is_signed = int_fc->is_signed;
+		}
+
+		g_array_append_val(lazy_payload->instrs, lazy_instr);
+	}
+
+end:
+	return lazy_payload;
+}
+
+BT_HIDDEN
+int ctf_trace_class_update_decode_plans(struct ctf_trace_class *ctf_tc)
+{
+	uint64_t i;
+
+	if (!ctf_tc->decode_plans_are_compiled) {
+		ctf_tc->packet_header_decode_plan =
+			compile_decode_plan(ctf_tc->packet_header_fc);
+		ctf_tc->decode_plans_are_compiled = true;
+	}
+
+	for (i = 0; i < ctf_tc->stream_classes->len; i++) {
+		struct ctf_stream_class *sc = ctf_tc->stream_classes->pdata[i];
+		uint64_t j;
+
+		if (!sc->decode_plans_are_compiled) {
+			sc->packet_context_decode_plan =
+				compile_decode_plan(sc->packet_context_fc);
+			sc->event_header_decode_plan =
+				compile_decode_plan(sc->event_header_fc);
+			sc->event_common_context_decode_plan =
+				compile_decode_plan(sc->event_common_context_fc);
+			sc->decode_plans_are_compiled = true;
+		}
+
+		for (j = 0; j < sc->event_classes->len; j++) {
+			struct ctf_event_class *ec = sc->event_classes->pdata[j];
+
+			if (ec->decode_plans_are_compiled) {
+				continue;
+			}
+
+			ec->spec_context_decode_plan =
+				compile_decode_plan(ec->spec_context_fc);
+			ec->payload_decode_plan =
+				compile_decode_plan(ec->payload_fc);
+			ec->lazy_payload = create_lazy_payload(ec->payload_fc,
+				ec->payload_decode_plan);
+			ec->decode_plans_are_compiled = true;
+		}
+	}
+
+	return 0;
+}
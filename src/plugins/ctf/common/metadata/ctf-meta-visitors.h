@@ -35,6 +35,9 @@ int ctf_trace_class_update_default_clock_classes(
 		struct ctf_trace_class *ctf_tc,
 		struct meta_log_config *log_cfg);
 
+BT_HIDDEN
+int ctf_trace_class_update_decode_plans(struct ctf_trace_class *ctf_tc);
+
 BT_HIDDEN
 int ctf_trace_class_update_in_ir(struct ctf_trace_class *ctf_tc);
 
@@ -59,4 +62,23 @@ void ctf_trace_class_warn_meaningless_header_fields(
 		struct ctf_trace_class *ctf_tc,
 		struct meta_log_config *log_cfg);
 
+/*
+ * Appends to `buf` a compact binary form of what the metadata AST
+ * visitor created in `tc`, in the native byte order.
+ */
+BT_HIDDEN
+void ctf_trace_class_serialize(struct ctf_trace_class *tc, GByteArray *buf);
+
+/*
+ * Creates a CTF IR trace class from the `len` bytes of `data` which
+ * ctf_trace_class_serialize() wrote, or returns `NULL` if the data is
+ * invalid.
+ *
+ * Run the same ctf_trace_class_*() passes as after visiting a metadata
+ * AST on the returned trace class before using it.
+ */
+BT_HIDDEN
+struct ctf_trace_class *ctf_trace_class_deserialize(const uint8_t *data,
+		size_t len);
+
 #endif /* _CTF_META_VISITORS_H */
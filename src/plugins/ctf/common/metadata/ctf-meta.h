@@ -101,6 +101,14 @@ struct ctf_field_class_bit_array {
 	struct ctf_field_class base;
 	enum ctf_byte_order byte_order;
 	unsigned int size;
+
+	/*
+	 * True if a field of this class is always at a byte boundary
+	 * and its size is 8, 16, 32, or 64 bits: it can be read with a
+	 * single load. Set by
+	 * ctf_field_class_bit_array_update_is_aligned_word().
+	 */
+	bool is_aligned_word;
 };
 
 struct ctf_field_class_int {
@@ -180,6 +188,20 @@ struct ctf_field_class_variant_range {
 	uint64_t option_index;
 };
 
+/*
+ * Maximum length of a variant field class's direct option index table
+ * (see `struct ctf_field_class_variant`).
+ */
+#define CTF_FIELD_CLASS_VARIANT_OPTION_TABLE_MAX_LEN	1024
+
+struct ctf_field_class_variant_seg {
+	/* First tag key of this segment */
+	uint64_t first_key;
+
+	/* Index of the selected option, or -1 if none */
+	int64_t option_index;
+};
+
 struct ctf_field_class_variant {
 	struct ctf_field_class base;
 	GString *tag_ref;
@@ -192,6 +214,24 @@ struct ctf_field_class_variant {
 	/* Array of `struct ctf_field_class_variant_range` */
 	GArray *ranges;
 
+	/*
+	 * Sorted, disjoint tag key segments built from `ranges` (see
+	 * ctf_field_class_variant_build_option_index()): a segment spans
+	 * from its first key to the next segment's first key, exclusive.
+	 *
+	 * Array of `struct ctf_field_class_variant_seg`.
+	 */
+	GArray *segs;
+
+	/*
+	 * Option indexes of the tag keys `table_first_key` to
+	 * `table_first_key + table_len - 1` (-1 if none), or `NULL` if
+	 * the tag keys with a selected option are too far apart.
+	 */
+	int64_t *option_table;
+	uint64_t table_first_key;
+	uint64_t table_len;
+
 	/* Weak */
 	struct ctf_field_class_enum *tag_fc;
 };
@@ -218,6 +258,96 @@ struct ctf_field_class_sequence {
 	struct ctf_field_class_int *length_fc;
 };
 
+/* Maximum structure nesting level of a decode plan */
+#define CTF_DECODE_PLAN_MAX_DEPTH	16
+
+enum ctf_decode_plan_instr_type {
+	CTF_DECODE_PLAN_INSTR_TYPE_INT,
+	CTF_DECODE_PLAN_INSTR_TYPE_FLOAT,
+	CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_BEGIN,
+	CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_END,
+};
+
+struct ctf_decode_plan_instr {
+	enum ctf_decode_plan_instr_type type;
+
+	/* Weak */
+	struct ctf_field_class *fc;
+
+	/*
+	 * Offset (bits) of the field from the beginning of the (aligned)
+	 * root field.
+	 */
+	uint64_t offset;
+
+	/*
+	 * Index of the IR field within its parent IR structure field, or
+	 * -1 if the field is not part of the IR.
+	 */
+	int64_t ir_index;
+};
+
+/*
+ * A decode plan is a flat list of instructions to decode a scope field
+ * of which the layout is entirely known once the root field is aligned:
+ * it only contains structures, integers, enumerations, and
+ * floating point numbers.
+ */
+struct ctf_decode_plan {
+	/* Alignment (bits) of the root field */
+	unsigned int alignment;
+
+	/* Total size (bits) of the root field */
+	uint64_t size;
+
+	/* Array of `struct ctf_decode_plan_instr` */
+	GArray *instrs;
+};
+
+struct ctf_lazy_payload_instr {
+	enum ctf_decode_plan_instr_type type;
+
+	/*
+	 * Offset (bits) of the field from the beginning of the (aligned)
+	 * root field.
+	 */
+	uint64_t offset;
+
+	/* Size (bits), byte order, and signedness of a bit array field */
+	unsigned int size;
+	enum ctf_byte_order byte_order;
+	bool is_signed;
+
+	/*
+	 * Index of the IR field within its parent IR structure field, or
+	 * -1 for the root field.
+	 */
+	int64_t ir_index;
+};
+
+/*
+ * A lazy payload is a copy of the decode plan of an event payload field
+ * class which doesn't refer to any metadata object, so that the payload
+ * field of an event message can be decoded after the message iterator
+ * emitted it, possibly once the trace class doesn't exist anymore.
+ *
+ * It only exists when decoding the payload field has no effect on the
+ * message iterator (no stored value, no default clock update): it only
+ * contains the instructions to set IR fields.
+ *
+ * Each pending payload field holds a reference.
+ */
+struct ctf_lazy_payload {
+	gint ref_count;
+
+	/* Alignment and total size (bits) of the root field */
+	unsigned int alignment;
+	uint64_t size;
+
+	/* Array of `struct ctf_lazy_payload_instr` */
+	GArray *instrs;
+};
+
 struct ctf_event_class {
 	GString *name;
 	uint64_t id;
@@ -232,6 +362,20 @@ struct ctf_event_class {
 	/* Owned by this */
 	struct ctf_field_class *payload_fc;
 
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *spec_context_decode_plan;
+
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *payload_decode_plan;
+
+	/*
+	 * Owned by this, `NULL` if the payload field class has no decode
+	 * plan or if its decoding has effects on the message iterator.
+	 */
+	struct ctf_lazy_payload *lazy_payload;
+
+	bool decode_plans_are_compiled;
+
 	/* Weak, set during translation */
 	bt_event_class *ir_ec;
 };
@@ -255,6 +399,17 @@ struct ctf_stream_class {
 	/* Owned by this */
 	struct ctf_field_class *event_common_context_fc;
 
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *packet_context_decode_plan;
+
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *event_header_decode_plan;
+
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *event_common_context_decode_plan;
+
+	bool decode_plans_are_compiled;
+
 	/* Array of `struct ctf_event_class *`, owned by this */
 	GPtrArray *event_classes;
 
@@ -296,6 +451,11 @@ struct ctf_trace_class {
 	/* Owned by this */
 	struct ctf_field_class *packet_header_fc;
 
+	/* Owned by this, `NULL` if the scope has no fixed layout */
+	struct ctf_decode_plan *packet_header_decode_plan;
+
+	bool decode_plans_are_compiled;
+
 	uint64_t stored_value_count;
 
 	/* Array of `struct ctf_clock_class *` (owned by this) */
@@ -322,6 +482,79 @@ struct ctf_trace_class {
 static inline
 void ctf_field_class_destroy(struct ctf_field_class *fc);
 
+static inline
+struct ctf_decode_plan *ctf_decode_plan_create(void)
+{
+	struct ctf_decode_plan *plan = g_new0(struct ctf_decode_plan, 1);
+
+	BT_ASSERT(plan);
+	plan->alignment = 1;
+	plan->instrs = g_array_new(FALSE, TRUE,
+		sizeof(struct ctf_decode_plan_instr));
+	BT_ASSERT(plan->instrs);
+	return plan;
+}
+
+static inline
+void ctf_decode_plan_destroy(struct ctf_decode_plan *plan)
+{
+	if (!plan) {
+		return;
+	}
+
+	if (plan->instrs) {
+		g_array_free(plan->instrs, TRUE);
+	}
+
+	g_free(plan);
+}
+
+static inline
+struct ctf_lazy_payload *ctf_lazy_payload_create(void)
+{
+	struct ctf_lazy_payload *lazy_payload =
+		g_new0(struct ctf_lazy_payload, 1);
+
+	BT_ASSERT(lazy_payload);
+	lazy_payload->ref_count = 1;
+	lazy_payload->alignment = 1;
+	lazy_payload->instrs = g_array_new(FALSE, TRUE,
+		sizeof(struct ctf_lazy_payload_instr));
+	BT_ASSERT(lazy_payload->instrs);
+	return lazy_payload;
+}
+
+static inline
+struct ctf_lazy_payload *ctf_lazy_payload_get(
+		struct ctf_lazy_payload *lazy_payload)
+{
+	BT_ASSERT_DBG(lazy_payload);
+	g_atomic_int_inc(&lazy_payload->ref_count);
+	return lazy_payload;
+}
+
+/*
+ * Events can be destroyed on another thread than the one which decoded
+ * them, hence the atomic reference count.
+ */
+static inline
+void ctf_lazy_payload_put(struct ctf_lazy_payload *lazy_payload)
+{
+	if (!lazy_payload) {
+		return;
+	}
+
+	if (!g_atomic_int_dec_and_test(&lazy_payload->ref_count)) {
+		return;
+	}
+
+	if (lazy_payload->instrs) {
+		g_array_free(lazy_payload->instrs, TRUE);
+	}
+
+	g_free(lazy_payload);
+}
+
 static inline
 void _ctf_field_class_init(struct ctf_field_class *fc,
 		enum ctf_field_class_type type, unsigned int alignment)
@@ -492,6 +725,9 @@ struct ctf_field_class_variant *ctf_field_class_variant_create(void)
 	fc->ranges = g_array_new(FALSE, TRUE,
 		sizeof(struct ctf_field_class_variant_range));
 	BT_ASSERT(fc->ranges);
+	fc->segs = g_array_new(FALSE, TRUE,
+		sizeof(struct ctf_field_class_variant_seg));
+	BT_ASSERT(fc->segs);
 	fc->tag_ref = g_string_new(NULL);
 	BT_ASSERT(fc->tag_ref);
 	ctf_field_path_init(&fc->tag_path);
@@ -643,6 +879,12 @@ void _ctf_field_class_variant_destroy(struct ctf_field_class_variant *fc)
 		g_array_free(fc->ranges, TRUE);
 	}
 
+	if (fc->segs) {
+		g_array_free(fc->segs, TRUE);
+	}
+
+	g_free(fc->option_table);
+
 	if (fc->tag_ref) {
 		g_string_free(fc->tag_ref, TRUE);
 	}
@@ -947,6 +1189,244 @@ void ctf_field_class_variant_append_option(struct ctf_field_class_variant *fc,
 	named_fc->fc = option_fc;
 }
 
+/*
+ * Returns the key of the tag value `val`: flipping the sign bit of a
+ * signed value makes the unsigned order of the keys match the signed
+ * order of the values.
+ */
+static inline
+uint64_t ctf_field_class_variant_tag_key(struct ctf_field_class_variant *fc,
+		uint64_t val)
+{
+	return fc->tag_fc->base.is_signed ? val ^ (UINT64_C(1) << 63) : val;
+}
+
+static inline
+int ctf_field_class_variant_compare_keys(gconstpointer a, gconstpointer b)
+{
+	const uint64_t key_a = *(const uint64_t *) a;
+	const uint64_t key_b = *(const uint64_t *) b;
+
+	return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+/*
+ * Returns the index of the last segment of `fc` of which the first key
+ * is less than or equal to `key`, or -1 if there's none.
+ */
+static inline
+int64_t ctf_field_class_variant_find_seg(struct ctf_field_class_variant *fc,
+		uint64_t key)
+{
+	uint64_t low = 0;
+	uint64_t high = fc->segs->len;
+
+	while (low < high) {
+		uint64_t mid = low + (high - low) / 2;
+
+		if (g_array_index(fc->segs, struct ctf_field_class_variant_seg,
+				mid).first_key <= key) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return (int64_t) low - 1;
+}
+
+/*
+ * Builds the option index (segments and, if possible, direct table)
+ * of `fc` from its ranges.
+ *
+ * Ranges may overlap: like a linear scan of the ranges, the index
+ * selects the option of the first matching range.
+ */
+static inline
+void ctf_field_class_variant_build_option_index(
+		struct ctf_field_class_variant *fc)
+{
+	GArray *keys;
+	uint64_t i;
+	uint64_t out_i;
+	uint64_t last_key;
+
+	BT_ASSERT(fc);
+	BT_ASSERT(fc->tag_fc);
+	g_array_set_size(fc->segs, 0);
+	g_free(fc->option_table);
+	fc->option_table = NULL;
+	fc->table_first_key = 0;
+	fc->table_len = 0;
+
+	if (fc->ranges->len == 0) {
+		goto end;
+	}
+
+	/* Segment boundaries: each range's lower key and upper key + 1 */
+	keys = g_array_sized_new(FALSE, FALSE, sizeof(uint64_t),
+		fc->ranges->len * 2);
+	BT_ASSERT(keys);
+
+	for (i = 0; i < fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(fc, i);
+		uint64_t lower = ctf_field_class_variant_tag_key(fc,
+			range->range.lower.u);
+		uint64_t upper = ctf_field_class_variant_tag_key(fc,
+			range->range.upper.u);
+
+		g_array_append_val(keys, lower);
+
+		if (upper != UINT64_MAX) {
+			upper++;
+			g_array_append_val(keys, upper);
+		}
+	}
+
+	g_array_sort(keys, ctf_field_class_variant_compare_keys);
+
+	for (i = 0; i < keys->len; i++) {
+		struct ctf_field_class_variant_seg seg = {
+			.first_key = g_array_index(keys, uint64_t, i),
+			.option_index = -1,
+		};
+
+		if (fc->segs->len > 0 &&
+				g_array_index(fc->segs,
+					struct ctf_field_class_variant_seg,
+					fc->segs->len - 1).first_key ==
+					seg.first_key) {
+			continue;
+		}
+
+		g_array_append_val(fc->segs, seg);
+	}
+
+	g_array_free(keys, TRUE);
+
+	/*
+	 * Assign each range's option to the segments it covers, from
+	 * the last range to the first one so that the first matching
+	 * range wins.
+	 */
+	for (i = fc->ranges->len; i > 0; i--) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(fc, i - 1);
+		uint64_t lower = ctf_field_class_variant_tag_key(fc,
+			range->range.lower.u);
+		uint64_t upper = ctf_field_class_variant_tag_key(fc,
+			range->range.upper.u);
+		uint64_t seg_i = (uint64_t) ctf_field_class_variant_find_seg(
+			fc, lower);
+
+		for (; seg_i < fc->segs->len; seg_i++) {
+			struct ctf_field_class_variant_seg *seg =
+				&g_array_index(fc->segs,
+					struct ctf_field_class_variant_seg,
+					seg_i);
+
+			if (seg->first_key > upper) {
+				break;
+			}
+
+			seg->option_index = (int64_t) range->option_index;
+		}
+	}
+
+	/* Merge consecutive segments selecting the same option */
+	out_i = 0;
+
+	for (i = 1; i < fc->segs->len; i++) {
+		struct ctf_field_class_variant_seg *seg =
+			&g_array_index(fc->segs,
+				struct ctf_field_class_variant_seg, i);
+
+		if (seg->option_index != g_array_index(fc->segs,
+				struct ctf_field_class_variant_seg,
+				out_i).option_index) {
+			out_i++;
+			g_array_index(fc->segs,
+				struct ctf_field_class_variant_seg, out_i) =
+				*seg;
+		}
+	}
+
+	g_array_set_size(fc->segs, out_i + 1);
+
+	/*
+	 * The first segment always selects an option; the last one
+	 * selects none unless it reaches the maximum key.
+	 */
+	if (g_array_index(fc->segs, struct ctf_field_class_variant_seg,
+			fc->segs->len - 1).option_index >= 0) {
+		goto end;
+	}
+
+	fc->table_first_key = g_array_index(fc->segs,
+		struct ctf_field_class_variant_seg, 0).first_key;
+	last_key = g_array_index(fc->segs, struct ctf_field_class_variant_seg,
+		fc->segs->len - 1).first_key - 1;
+
+	if (last_key - fc->table_first_key >=
+			CTF_FIELD_CLASS_VARIANT_OPTION_TABLE_MAX_LEN) {
+		fc->table_first_key = 0;
+		goto end;
+	}
+
+	fc->table_len = last_key - fc->table_first_key + 1;
+	fc->option_table = g_new(int64_t, fc->table_len);
+	BT_ASSERT(fc->option_table);
+
+	for (i = 0; i < fc->segs->len - 1; i++) {
+		struct ctf_field_class_variant_seg *seg =
+			&g_array_index(fc->segs,
+				struct ctf_field_class_variant_seg, i);
+		uint64_t next_key = g_array_index(fc->segs,
+			struct ctf_field_class_variant_seg, i + 1).first_key;
+		uint64_t key;
+
+		for (key = seg->first_key; key < next_key; key++) {
+			fc->option_table[key - fc->table_first_key] =
+				seg->option_index;
+		}
+	}
+
+end:
+	return;
+}
+
+/*
+ * Returns the index of the option of `fc` which the tag value `val`
+ * selects, or -1 if there's none.
+ */
+static inline
+int64_t ctf_field_class_variant_find_option_index(
+		struct ctf_field_class_variant *fc, uint64_t val)
+{
+	uint64_t key;
+	int64_t seg_i;
+
+	BT_ASSERT_DBG(fc);
+	key = ctf_field_class_variant_tag_key(fc, val);
+
+	if (fc->option_table) {
+		/* Wraps around when `key` is less than the first key */
+		uint64_t table_i = key - fc->table_first_key;
+
+		return table_i < fc->table_len ?
+			fc->option_table[table_i] : -1;
+	}
+
+	seg_i = ctf_field_class_variant_find_seg(fc, key);
+	if (seg_i < 0) {
+		return -1;
+	}
+
+	return g_array_index(fc->segs, struct ctf_field_class_variant_seg,
+		seg_i).option_index;
+}
+
 static inline
 void ctf_field_class_variant_set_tag_field_class(
 		struct ctf_field_class_variant *fc,
@@ -983,6 +1463,7 @@ void ctf_field_class_variant_set_tag_field_class(
 			g_array_append_val(fc->ranges, var_range);
 		}
 	}
+	ctf_field_class_variant_build_option_index(fc);
 }
 
 static inline
@@ -1233,6 +1714,18 @@ struct ctf_field_class *ctf_field_path_borrow_field_class(
 static inline
 struct ctf_field_class *ctf_field_class_copy(struct ctf_field_class *fc);
 
+static inline
+void ctf_field_class_bit_array_update_is_aligned_word(
+		struct ctf_field_class_bit_array *fc)
+{
+	BT_ASSERT(fc);
+	fc->is_aligned_word = fc->base.alignment % 8 == 0 &&
+		(fc->size == 8 || fc->size == 16 || fc->size == 32 ||
+			fc->size == 64) &&
+		(fc->byte_order == CTF_BYTE_ORDER_LITTLE ||
+			fc->byte_order == CTF_BYTE_ORDER_BIG);
+}
+
 static inline
 void ctf_field_class_bit_array_copy_content(
 		struct ctf_field_class_bit_array *dst_fc,
@@ -1242,6 +1735,7 @@ void ctf_field_class_bit_array_copy_content(
 	BT_ASSERT(src_fc);
 	dst_fc->byte_order = src_fc->byte_order;
 	dst_fc->size = src_fc->size;
+	dst_fc->is_aligned_word = src_fc->is_aligned_word;
 }
 
 static inline
@@ -1525,6 +2019,9 @@ void ctf_event_class_destroy(struct ctf_event_class *ec)
 
 	ctf_field_class_destroy(ec->spec_context_fc);
 	ctf_field_class_destroy(ec->payload_fc);
+	ctf_decode_plan_destroy(ec->spec_context_decode_plan);
+	ctf_decode_plan_destroy(ec->payload_decode_plan);
+	ctf_lazy_payload_put(ec->lazy_payload);
 	g_free(ec);
 }
 
@@ -1561,6 +2058,9 @@ void ctf_stream_class_destroy(struct ctf_stream_class *sc)
 	ctf_field_class_destroy(sc->packet_context_fc);
 	ctf_field_class_destroy(sc->event_header_fc);
 	ctf_field_class_destroy(sc->event_common_context_fc);
+	ctf_decode_plan_destroy(sc->packet_context_decode_plan);
+	ctf_decode_plan_destroy(sc->event_header_decode_plan);
+	ctf_decode_plan_destroy(sc->event_common_context_decode_plan);
 	g_free(sc);
 }
 
@@ -1664,6 +2164,7 @@ void ctf_trace_class_destroy(struct ctf_trace_class *tc)
 	}
 
 	ctf_field_class_destroy(tc->packet_header_fc);
+	ctf_decode_plan_destroy(tc->packet_header_decode_plan);
 
 	if (tc->clock_classes) {
 		g_ptr_array_free(tc->clock_classes, TRUE);
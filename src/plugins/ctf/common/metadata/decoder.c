@@ -24,6 +24,7 @@
 #include <inttypes.h>
 #include "common/assert.h"
 #include "common/uuid.h"
+#include "common/version.h"
 #include "compat/memstream.h"
 #include <babeltrace2/babeltrace.h>
 #include <glib.h>
@@ -31,12 +32,17 @@
 
 #include "ast.h"
 #include "decoder.h"
+#include "ctf-meta-visitors.h"
 #include "scanner.h"
 #include "logging.h"
 #include "parser-wrap.h"
 
 #define TSDL_MAGIC	0x75d11d57
 
+#define TRACE_CLASS_CACHE_MAGIC		0xC1F1C7C5
+#define TRACE_CLASS_CACHE_VERSION	1
+#define TRACE_CLASS_CACHE_FILE_SUFFIX	".bt2tc"
+
 struct ctf_metadata_decoder {
 	struct ctf_scanner *scanner;
 	GString *text;
@@ -46,8 +52,31 @@ struct ctf_metadata_decoder {
 	int bo;
 	struct ctf_metadata_decoder_config config;
 	struct meta_log_config log_cfg;
+
+	/* True once ctf_metadata_decoder_append_content() was called */
+	bool has_content;
+
+	/* True if the trace class comes from the trace class cache */
+	bool is_trace_class_cached;
 };
 
+/*
+ * Header at the beginning of each trace class cache file, followed by
+ * the data which ctf_trace_class_serialize() writes.
+ *
+ * A cache file is named after the SHA-256 checksum of the complete
+ * metadata text and of the decoder's configuration options which affect
+ * the resulting trace class. Cache files are stored in the native byte
+ * order: they are not meant to be shared between systems.
+ */
+struct trace_class_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+
+	/* Length of the metadata text, to detect checksum collisions */
+	uint64_t text_len;
+} __attribute__((__packed__));
+
 struct packet_header {
 	uint32_t magic;
 	bt_uuid_t  uuid;
@@ -183,6 +212,168 @@ void ctf_metadata_decoder_destroy(struct ctf_metadata_decoder *mdec)
 	g_free(mdec);
 }
 
+/*
+ * Returns the path of the trace class cache file for the metadata text
+ * `text`.
+ */
+static
+gchar *get_trace_class_cache_file_path(struct ctf_metadata_decoder *mdec,
+		const GString *text)
+{
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	gchar *basename = NULL;
+	gchar *path = NULL;
+	struct {
+		int64_t clock_class_offset_s;
+		int64_t clock_class_offset_ns;
+		uint8_t force_clock_class_origin_unix_epoch;
+	} __attribute__((__packed__)) config = {
+		.clock_class_offset_s = mdec->config.clock_class_offset_s,
+		.clock_class_offset_ns = mdec->config.clock_class_offset_ns,
+		.force_clock_class_origin_unix_epoch =
+			mdec->config.force_clock_class_origin_unix_epoch,
+	};
+
+	if (!checksum) {
+		goto end;
+	}
+
+	/*
+	 * The clock class options change the resulting clock classes.
+	 *
+	 * Also include the Babeltrace version so that another build, which
+	 * could decode the same metadata text differently, doesn't load a
+	 * cache file which this one saved.
+	 */
+	g_checksum_update(checksum, (const guchar *) text->str, text->len);
+	g_checksum_update(checksum, (const guchar *) &config, sizeof(config));
+	g_checksum_update(checksum, (const guchar *) VERSION,
+		sizeof(VERSION));
+	g_checksum_update(checksum, (const guchar *) GIT_VERSION,
+		sizeof(GIT_VERSION));
+	basename = g_strconcat(g_checksum_get_string(checksum),
+		TRACE_CLASS_CACHE_FILE_SUFFIX, NULL);
+	path = g_build_filename(mdec->config.trace_class_cache_dir, basename,
+		NULL);
+
+end:
+	if (checksum) {
+		g_checksum_free(checksum);
+	}
+
+	g_free(basename);
+	return path;
+}
+
+/*
+ * Loads the trace class of the metadata text `text` from the cache file
+ * `cache_file_path`.
+ *
+ * Returns `NULL` if there's no valid cache file.
+ */
+static
+struct ctf_trace_class *load_cached_trace_class(
+		struct ctf_metadata_decoder *mdec, const char *cache_file_path,
+		const GString *text)
+{
+	gchar *contents = NULL;
+	gsize contents_len;
+	struct trace_class_cache_file_hdr hdr;
+	struct ctf_trace_class *tc = NULL;
+
+	if (!g_file_get_contents(cache_file_path, &contents, &contents_len,
+			NULL)) {
+		BT_COMP_LOGD("Cannot read trace class cache file: path=\"%s\"",
+			cache_file_path);
+		goto end;
+	}
+
+	if (contents_len < sizeof(hdr)) {
+		BT_COMP_LOGW("Invalid trace class cache file: "
+			"file size (%zu bytes) < header size (%zu bytes): "
+			"path=\"%s\"", (size_t) contents_len, sizeof(hdr),
+			cache_file_path);
+		goto end;
+	}
+
+	memcpy(&hdr, contents, sizeof(hdr));
+	if (hdr.magic != TRACE_CLASS_CACHE_MAGIC ||
+			hdr.version != TRACE_CLASS_CACHE_VERSION ||
+			hdr.text_len != text->len) {
+		BT_COMP_LOGI("Trace class cache file is stale or invalid: "
+			"path=\"%s\"", cache_file_path);
+		goto end;
+	}
+
+	tc = ctf_trace_class_deserialize(
+		(const uint8_t *) contents + sizeof(hdr),
+		contents_len - sizeof(hdr));
+	if (!tc) {
+		BT_COMP_LOGW("Invalid trace class cache file: "
+			"cannot read trace class: path=\"%s\"",
+			cache_file_path);
+		goto end;
+	}
+
+	BT_COMP_LOGI("Loaded trace class from trace class cache: "
+		"path=\"%s\"", cache_file_path);
+
+end:
+	g_free(contents);
+	return tc;
+}
+
+/*
+ * Saves the trace class of `mdec`, created from the metadata text
+ * `text`, to the cache file `cache_file_path`.
+ *
+ * Failing to save the cache file is not an error: the metadata text is
+ * parsed again next time.
+ */
+static
+void save_trace_class_to_cache(struct ctf_metadata_decoder *mdec,
+		const char *cache_file_path, const GString *text)
+{
+	GByteArray *contents = g_byte_array_new();
+	GError *error = NULL;
+	struct trace_class_cache_file_hdr hdr;
+
+	if (g_mkdir_with_parents(mdec->config.trace_class_cache_dir,
+			0755) != 0) {
+		BT_COMP_LOGW_ERRNO("Cannot create trace class cache directory",
+			": path=\"%s\"", mdec->config.trace_class_cache_dir);
+		goto end;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TRACE_CLASS_CACHE_MAGIC;
+	hdr.version = TRACE_CLASS_CACHE_VERSION;
+	hdr.text_len = text->len;
+	g_byte_array_append(contents, (const guint8 *) &hdr, sizeof(hdr));
+	ctf_trace_class_serialize(
+		ctf_visitor_generate_ir_borrow_ctf_trace_class(mdec->visitor),
+		contents);
+
+	/* g_file_set_contents() atomically replaces the file. */
+	if (!g_file_set_contents(cache_file_path,
+			(const gchar *) contents->data, contents->len, &error)) {
+		BT_COMP_LOGW("Cannot write trace class cache file: "
+			"path=\"%s\", error=\"%s\"", cache_file_path,
+			error->message);
+		goto end;
+	}
+
+	BT_COMP_LOGI("Saved trace class to trace class cache: "
+		"path=\"%s\", size=%u", cache_file_path, contents->len);
+
+end:
+	g_byte_array_free(contents, TRUE);
+
+	if (error) {
+		g_error_free(error);
+	}
+}
+
 BT_HIDDEN
 enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 		struct ctf_metadata_decoder *mdec, FILE *fp)
@@ -194,6 +385,8 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 	bool close_fp = false;
 	long start_pos = -1;
 	bool is_packetized;
+	GString *cache_text = NULL;
+	gchar *cache_file_path = NULL;
 
 	BT_ASSERT(mdec);
 	ret = ctf_metadata_decoder_is_packetized(fp, &is_packetized, &mdec->bo,
@@ -275,9 +468,76 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 	}
 #endif
 
-	/* Save the file's position: we'll seek back to append the plain text */
 	BT_ASSERT(fp);
 
+	/*
+	 * Only a complete metadata stream, that is, the first appended
+	 * content, can be cached.
+	 */
+	if (mdec->config.create_trace_class &&
+			mdec->config.trace_class_cache_dir &&
+			!mdec->has_content) {
+		struct ctf_trace_class *tc;
+
+		start_pos = ftell(fp);
+		if (start_pos < 0) {
+			BT_COMP_LOGE_ERRNO("Failed to get current file position", ".");
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+
+		cache_text = g_string_new(NULL);
+		if (!cache_text) {
+			BT_COMP_LOGE_STR("Failed to allocate a GString.");
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+
+		ret = bt_common_append_file_content_to_g_string(cache_text, fp);
+		if (ret) {
+			BT_COMP_LOGE("Failed to read metadata text: "
+				"ret=%d, mdec-addr=%p", ret, mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+
+		cache_file_path = get_trace_class_cache_file_path(mdec,
+			cache_text);
+		tc = cache_file_path ?
+			load_cached_trace_class(mdec, cache_file_path,
+				cache_text) : NULL;
+		if (tc) {
+			mdec->has_content = true;
+			ret = ctf_visitor_generate_ir_load_ctf_trace_class(
+				mdec->visitor, tc);
+			if (ret) {
+				BT_COMP_LOGE("Failed to create CTF IR objects from cached trace class: "
+					"mdec-addr=%p, ret=%d", mdec, ret);
+				status = CTF_METADATA_DECODER_STATUS_IR_VISITOR_ERROR;
+				goto end;
+			}
+
+			if (mdec->config.keep_plain_text) {
+				g_string_append_len(mdec->text, cache_text->str,
+					cache_text->len);
+			}
+
+			mdec->is_trace_class_cached = true;
+			goto end;
+		}
+
+		if (fseek(fp, start_pos, SEEK_SET)) {
+			BT_COMP_LOGE("Cannot seek metadata file stream to initial position: %s: "
+				"mdec-addr=%p", strerror(errno), mdec);
+			status = CTF_METADATA_DECODER_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	mdec->has_content = true;
+
+	/* Save the file's position: we'll seek back to append the plain text */
+
 	if (mdec->config.keep_plain_text) {
 		start_pos = ftell(fp);
 	}
@@ -338,6 +598,11 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_append_content(
 			status = CTF_METADATA_DECODER_STATUS_IR_VISITOR_ERROR;
 			goto end;
 		}
+
+		if (cache_file_path) {
+			save_trace_class_to_cache(mdec, cache_file_path,
+				cache_text);
+		}
 	}
 
 end:
@@ -353,6 +618,11 @@ end:
 	}
 
 	free(buf);
+	g_free(cache_file_path);
+
+	if (cache_text) {
+		g_string_free(cache_text, TRUE);
+	}
 
 	return status;
 }
@@ -467,6 +737,22 @@ enum ctf_metadata_decoder_status ctf_metadata_decoder_get_trace_class_uuid(
 	struct ctf_node *root_node = &mdec->scanner->ast->root;
 	struct ctf_node *trace_node;
 
+	if (mdec->is_trace_class_cached) {
+		/* There's no AST: use the cached trace class */
+		struct ctf_trace_class *tc =
+			ctf_visitor_generate_ir_borrow_ctf_trace_class(
+				mdec->visitor);
+
+		if (tc->is_uuid_set) {
+			bt_uuid_copy(uuid, tc->uuid);
+			status = CTF_METADATA_DECODER_STATUS_OK;
+		} else {
+			status = CTF_METADATA_DECODER_STATUS_NONE;
+		}
+
+		goto end;
+	}
+
 	if (!root_node) {
 		status = CTF_METADATA_DECODER_STATUS_INCOMPLETE;
 		goto end;
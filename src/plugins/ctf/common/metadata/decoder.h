@@ -59,6 +59,14 @@ struct ctf_metadata_decoder_config {
 	 * ctf_metadata_decoder_append_content().
 	 */
 	bool keep_plain_text;
+
+	/*
+	 * Directory in which to cache the trace classes which
+	 * ctf_metadata_decoder_append_content() creates from complete
+	 * metadata streams, or `NULL` to always parse the metadata
+	 * stream (weak).
+	 */
+	const char *trace_class_cache_dir;
 };
 
 /*
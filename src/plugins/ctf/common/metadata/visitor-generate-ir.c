@@ -2549,6 +2549,8 @@ int visit_integer_decl(struct ctx *ctx,
 	(*integer_decl)->disp_base = base;
 	(*integer_decl)->encoding = encoding;
 	(*integer_decl)->mapped_clock_class = mapped_clock_class;
+	ctf_field_class_bit_array_update_is_aligned_word(
+		&(*integer_decl)->base);
 	return 0;
 
 error:
@@ -2733,6 +2735,7 @@ int visit_floating_point_number_decl(struct ctx *ctx,
 	(*float_decl)->base.base.alignment = alignment;
 	(*float_decl)->base.byte_order = byte_order;
 	(*float_decl)->base.size = mant_dig + exp_dig;
+	ctf_field_class_bit_array_update_is_aligned_word(&(*float_decl)->base);
 	return 0;
 
 error:
@@ -4696,6 +4699,109 @@ struct ctf_trace_class *ctf_visitor_generate_ir_borrow_ctf_trace_class(
 	return ctx->ctf_tc;
 }
 
+/*
+ * Runs the passes which complete the CTF IR objects that visiting the
+ * metadata AST created, and translates them to trace IR.
+ */
+static
+int update_trace_class(struct ctx *ctx)
+{
+	int ret;
+
+	/* Update default clock classes */
+	ret = ctf_trace_class_update_default_clock_classes(ctx->ctf_tc,
+		&ctx->log_cfg);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Update trace class meanings */
+	ret = ctf_trace_class_update_meanings(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Update stream class configuration */
+	ret = ctf_trace_class_update_stream_class_config(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Update text arrays and sequences */
+	ret = ctf_trace_class_update_text_array_sequence(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Resolve sequence lengths and variant tags */
+	ret = ctf_trace_class_resolve_field_classes(ctx->ctf_tc, &ctx->log_cfg);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	if (ctx->trace_class) {
+		/*
+		 * Update "in IR" for field classes.
+		 *
+		 * If we have no IR trace class, then we'll have no way
+		 * to create IR fields anyway, so we leave all the
+		 * `in_ir` members false.
+		 */
+		ret = ctf_trace_class_update_in_ir(ctx->ctf_tc);
+		if (ret) {
+			ret = -EINVAL;
+			goto end;
+		}
+	}
+
+	/* Update saved value indexes */
+	ret = ctf_trace_class_update_value_storing_indexes(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/* Validate what we have so far */
+	ret = ctf_trace_class_validate(ctx->ctf_tc, &ctx->log_cfg);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	/*
+	 * If there are fields which are not related to the CTF format
+	 * itself in the packet header and in event header field
+	 * classes, warn about it because they are never translated.
+	 */
+	ctf_trace_class_warn_meaningless_header_fields(ctx->ctf_tc,
+		&ctx->log_cfg);
+
+	/* Compile the decode plans of the new fixed-layout scopes */
+	ret = ctf_trace_class_update_decode_plans(ctx->ctf_tc);
+	if (ret) {
+		ret = -EINVAL;
+		goto end;
+	}
+
+	if (ctx->trace_class) {
+		/* Copy new CTF metadata -> new IR metadata */
+		ret = ctf_trace_class_translate(ctx->log_cfg.self_comp,
+				ctx->trace_class, ctx->ctf_tc);
+		if (ret) {
+			ret = -EINVAL;
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		struct ctf_node *node)
@@ -4858,89 +4964,25 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
-	/* Update default clock classes */
-	ret = ctf_trace_class_update_default_clock_classes(ctx->ctf_tc,
-		&ctx->log_cfg);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/* Update trace class meanings */
-	ret = ctf_trace_class_update_meanings(ctx->ctf_tc);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/* Update stream class configuration */
-	ret = ctf_trace_class_update_stream_class_config(ctx->ctf_tc);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/* Update text arrays and sequences */
-	ret = ctf_trace_class_update_text_array_sequence(ctx->ctf_tc);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/* Resolve sequence lengths and variant tags */
-	ret = ctf_trace_class_resolve_field_classes(ctx->ctf_tc, &ctx->log_cfg);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	if (ctx->trace_class) {
-		/*
-		 * Update "in IR" for field classes.
-		 *
-		 * If we have no IR trace class, then we'll have no way
-		 * to create IR fields anyway, so we leave all the
-		 * `in_ir` members false.
-		 */
-		ret = ctf_trace_class_update_in_ir(ctx->ctf_tc);
-		if (ret) {
-			ret = -EINVAL;
-			goto end;
-		}
-	}
-
-	/* Update saved value indexes */
-	ret = ctf_trace_class_update_value_storing_indexes(ctx->ctf_tc);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/* Validate what we have so far */
-	ret = ctf_trace_class_validate(ctx->ctf_tc, &ctx->log_cfg);
-	if (ret) {
-		ret = -EINVAL;
-		goto end;
-	}
-
-	/*
-	 * If there are fields which are not related to the CTF format
-	 * itself in the packet header and in event header field
-	 * classes, warn about it because they are never translated.
-	 */
-	ctf_trace_class_warn_meaningless_header_fields(ctx->ctf_tc,
-		&ctx->log_cfg);
-
-	if (ctx->trace_class) {
-		/* Copy new CTF metadata -> new IR metadata */
-		ret = ctf_trace_class_translate(ctx->log_cfg.self_comp,
-				ctx->trace_class, ctx->ctf_tc);
-		if (ret) {
-			ret = -EINVAL;
-			goto end;
-		}
-	}
+	ret = update_trace_class(ctx);
 
 end:
 	return ret;
 }
+
+BT_HIDDEN
+int ctf_visitor_generate_ir_load_ctf_trace_class(
+		struct ctf_visitor_generate_ir *visitor,
+		struct ctf_trace_class *tc)
+{
+	struct ctx *ctx = (void *) visitor;
+
+	BT_ASSERT(ctx);
+	BT_ASSERT(tc);
+	BT_ASSERT(!ctx->is_trace_visited);
+	BT_COMP_LOGI_STR("Loading CTF IR objects instead of visiting metadata's AST.");
+	ctf_trace_class_destroy(ctx->ctf_tc);
+	ctx->ctf_tc = tc;
+	ctx->is_trace_visited = true;
+	return update_trace_class(ctx);
+}
@@ -37,6 +37,8 @@
 #include <string.h>
 #include <babeltrace2/babeltrace.h>
 #include "common/common.h"
+#include "common/align.h"
+#include "compat/bitfield.h"
 #include <glib.h>
 #include <stdlib.h>
 
@@ -62,6 +64,13 @@ struct stack_entry {
 
 	/* Index of next field to set */
 	size_t index;
+
+	/*
+	 * Packed element values of `base` if it's an array field of
+	 * which the element fields are integer or real fields, or
+	 * `NULL`: the element values are set there directly.
+	 */
+	void *values;
 };
 
 struct ctf_msg_iter;
@@ -133,6 +142,30 @@ struct ctf_msg_iter {
 	 */
 	bool dry_run;
 
+	/*
+	 * True to emit event messages of which the payload field is only
+	 * decoded when first borrowed, when possible.
+	 */
+	bool lazy_payloads;
+
+	/* Event class filter (weak, `NULL` to emit all the events) */
+	const struct ctf_event_class_filter *ec_filter;
+
+	/*
+	 * Whether or not `ec_filter` selects each event class, cached by
+	 * this message iterator so that the metadata, which other message
+	 * iterators share, stays read-only: `struct ctf_event_class *`
+	 * (weak) to `GUINT_TO_POINTER(bool)` (owned by this, `NULL` until
+	 * needed).
+	 */
+	GHashTable *ec_selection;
+
+	/*
+	 * True if the current event is not selected by `ec_filter`: its
+	 * fields are decoded in dry run mode and it's not emitted.
+	 */
+	bool skip_event;
+
 	/*
 	 * Current dynamic scope field pointer.
 	 *
@@ -395,6 +428,7 @@ void stack_push(struct stack *stack, bt_field *base)
 	entry = &g_array_index(stack->entries, struct stack_entry, stack->size);
 	entry->base = base;
 	entry->index = 0;
+	entry->values = NULL;
 	stack->size++;
 }
 
@@ -573,10 +607,292 @@ enum ctf_msg_iter_status buf_ensure_available_bits(
 	return status;
 }
 
+static
+void update_default_clock(struct ctf_msg_iter *msg_it, uint64_t new_val,
+		uint64_t new_val_size)
+{
+	uint64_t new_val_mask;
+	uint64_t cur_value_masked;
+
+	BT_ASSERT_DBG(new_val_size > 0);
+
+	/*
+	 * Special case for a 64-bit new value, which is the limit
+	 * of a clock value as of this version: overwrite the
+	 * current value directly.
+	 */
+	if (new_val_size == 64) {
+		msg_it->default_clock_snapshot = new_val;
+		goto end;
+	}
+
+	new_val_mask = (1ULL << new_val_size) - 1;
+	cur_value_masked = msg_it->default_clock_snapshot & new_val_mask;
+
+	if (new_val < cur_value_masked) {
+		/*
+		 * It looks like a wrap happened on the number of bits
+		 * of the requested new value. Assume that the clock
+		 * value wrapped only one time.
+		 */
+		msg_it->default_clock_snapshot += new_val_mask + 1;
+	}
+
+	/* Clear the low bits of the current clock value. */
+	msg_it->default_clock_snapshot &= ~new_val_mask;
+
+	/* Set the low bits of the current clock value. */
+	msg_it->default_clock_snapshot |= new_val;
+
+end:
+	BT_COMP_LOGT("Updated default clock's value from integer field's value: "
+		"value=%" PRIu64, msg_it->default_clock_snapshot);
+}
+
+/*
+ * Handles the meaning, the mapped clock class, and the storing index of
+ * the unsigned integer field class `int_fc` for the decoded `value`.
+ */
+static
+enum bt_bfcr_status handle_unsigned_int_value(struct ctf_msg_iter *msg_it,
+		struct ctf_field_class_int *int_fc, uint64_t value)
+{
+	bt_self_component *self_comp = msg_it->self_comp;
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+
+	if (G_LIKELY(int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE)) {
+		goto update_def_clock;
+	}
+
+	switch (int_fc->meaning) {
+	case CTF_FIELD_CLASS_MEANING_EVENT_CLASS_ID:
+		msg_it->cur_event_class_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_DATA_STREAM_ID:
+		msg_it->cur_data_stream_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_BEGINNING_TIME:
+		msg_it->snapshots.beginning_clock = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_END_TIME:
+		msg_it->snapshots.end_clock = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_STREAM_CLASS_ID:
+		msg_it->cur_stream_class_id = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_MAGIC:
+		if (value != 0xc1fc1fc1) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Invalid CTF magic number: msg-it-addr=%p, "
+				"magic=%" PRIx64, msg_it, value);
+			status = BT_BFCR_STATUS_ERROR;
+			goto end;
+		}
+
+		break;
+	case CTF_FIELD_CLASS_MEANING_PACKET_COUNTER_SNAPSHOT:
+		msg_it->snapshots.packets = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_DISC_EV_REC_COUNTER_SNAPSHOT:
+		msg_it->snapshots.discarded_events = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_TOTAL_SIZE:
+		msg_it->cur_exp_packet_total_size = value;
+		break;
+	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_CONTENT_SIZE:
+		msg_it->cur_exp_packet_content_size = value;
+		break;
+	default:
+		bt_common_abort();
+	}
+
+update_def_clock:
+	if (G_UNLIKELY(int_fc->mapped_clock_class)) {
+		update_default_clock(msg_it, value, int_fc->base.size);
+	}
+
+	if (G_UNLIKELY(int_fc->storing_index >= 0)) {
+		g_array_index(msg_it->stored_values, uint64_t,
+			(uint64_t) int_fc->storing_index) = value;
+	}
+
+end:
+	return status;
+}
+
+static inline
+uint64_t read_plan_unsigned_bitfield(const uint8_t *buf, size_t at,
+		struct ctf_field_class_bit_array *fc)
+{
+	uint64_t v;
+
+	if (fc->byte_order == CTF_BYTE_ORDER_LITTLE) {
+		bt_bitfield_read_le(buf, uint8_t, at, fc->size, &v);
+	} else {
+		bt_bitfield_read_be(buf, uint8_t, at, fc->size, &v);
+	}
+
+	return v;
+}
+
+static inline
+int64_t read_plan_signed_bitfield(const uint8_t *buf, size_t at,
+		struct ctf_field_class_bit_array *fc)
+{
+	int64_t v;
+
+	if (fc->byte_order == CTF_BYTE_ORDER_LITTLE) {
+		bt_bitfield_read_le(buf, uint8_t, at, fc->size, &v);
+	} else {
+		bt_bitfield_read_be(buf, uint8_t, at, fc->size, &v);
+	}
+
+	return v;
+}
+
+/*
+ * Decodes the current dynamic scope field, of which the root field
+ * begins at `at` (bits) within the current buffer, by executing its
+ * compiled decode plan `plan`.
+ *
+ * The current buffer must contain the whole root field.
+ */
+static
+enum ctf_msg_iter_status exec_decode_plan(struct ctf_msg_iter *msg_it,
+		struct ctf_decode_plan *plan, size_t at)
+{
+	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
+	bt_field *fields[CTF_DECODE_PLAN_MAX_DEPTH + 1];
+	int depth = -1;
+	guint i;
+
+	for (i = 0; i < plan->instrs->len; i++) {
+		struct ctf_decode_plan_instr *instr = &g_array_index(
+			plan->instrs, struct ctf_decode_plan_instr, i);
+		struct ctf_field_class *fc = instr->fc;
+		bool set_field = fc->in_ir && !msg_it->dry_run;
+		bt_field *field = NULL;
+
+		if (set_field && instr->ir_index >= 0) {
+			BT_ASSERT_DBG(depth >= 0);
+			field = bt_field_structure_borrow_member_field_by_index(
+				fields[depth], (uint64_t) instr->ir_index);
+			BT_ASSERT_DBG(bt_field_borrow_class_const(field) ==
+				fc->ir_fc);
+		}
+
+		switch (instr->type) {
+		case CTF_DECODE_PLAN_INSTR_TYPE_INT:
+		{
+			struct ctf_field_class_int *int_fc = (void *) fc;
+
+			if (int_fc->is_signed) {
+				int64_t v = read_plan_signed_bitfield(
+					msg_it->buf.addr, at + instr->offset,
+					&int_fc->base);
+
+				BT_ASSERT_DBG(int_fc->meaning ==
+					CTF_FIELD_CLASS_MEANING_NONE);
+
+				if (G_UNLIKELY(int_fc->storing_index >= 0)) {
+					g_array_index(msg_it->stored_values,
+						uint64_t,
+						(uint64_t) int_fc->storing_index) =
+						(uint64_t) v;
+				}
+
+				if (set_field) {
+					bt_field_integer_signed_set_value(field,
+						v);
+				}
+			} else {
+				uint64_t v = read_plan_unsigned_bitfield(
+					msg_it->buf.addr, at + instr->offset,
+					&int_fc->base);
+
+				if (handle_unsigned_int_value(msg_it, int_fc,
+						v) != BT_BFCR_STATUS_OK) {
+					status = CTF_MSG_ITER_STATUS_ERROR;
+					goto end;
+				}
+
+				if (set_field) {
+					bt_field_integer_unsigned_set_value(
+						field, v);
+				}
+			}
+
+			break;
+		}
+		case CTF_DECODE_PLAN_INSTR_TYPE_FLOAT:
+		{
+			struct ctf_field_class_float *float_fc = (void *) fc;
+			uint64_t v = read_plan_unsigned_bitfield(
+				msg_it->buf.addr, at + instr->offset,
+				&float_fc->base);
+
+			if (!set_field) {
+				break;
+			}
+
+			if (float_fc->base.size == 32) {
+				union {
+					uint32_t u;
+					float f;
+				} f32;
+
+				f32.u = (uint32_t) v;
+				bt_field_real_single_precision_set_value(field,
+					f32.f);
+			} else {
+				union {
+					uint64_t u;
+					double d;
+				} f64;
+
+				f64.u = v;
+				bt_field_real_double_precision_set_value(field,
+					f64.d);
+			}
+
+			break;
+		}
+		case CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_BEGIN:
+			if (!set_field) {
+				break;
+			}
+
+			if (depth < 0) {
+				/* Root: already set by read_dscope_begin_state() */
+				field = msg_it->cur_dscope_field;
+			}
+
+			BT_ASSERT_DBG(field);
+			BT_ASSERT_DBG(depth < CTF_DECODE_PLAN_MAX_DEPTH);
+			depth++;
+			fields[depth] = field;
+			break;
+		case CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_END:
+			if (set_field) {
+				BT_ASSERT_DBG(depth >= 0);
+				depth--;
+			}
+
+			break;
+		default:
+			bt_common_abort();
+		}
+	}
+
+end:
+	return status;
+}
+
 static
 enum ctf_msg_iter_status read_dscope_begin_state(
 		struct ctf_msg_iter *msg_it,
 		struct ctf_field_class *dscope_fc,
+		struct ctf_decode_plan *plan,
 		enum state done_state, enum state continue_state,
 		bt_field *dscope_field)
 {
@@ -586,6 +902,36 @@ enum ctf_msg_iter_status read_dscope_begin_state(
 	size_t consumed_bits;
 
 	msg_it->cur_dscope_field = dscope_field;
+
+	if (plan) {
+		size_t skip = ALIGN(packet_at(msg_it), plan->alignment) -
+			packet_at(msg_it);
+
+		/*
+		 * Execute the decode plan if the whole field is in the
+		 * current buffer; otherwise let BFCR decode it as it
+		 * can continue with the next buffer.
+		 */
+		if (buf_available_bits(msg_it) >= skip + plan->size) {
+			BT_COMP_LOGT("Executing decode plan: msg-it-addr=%p, "
+				"fc-addr=%p, size=%" PRIu64,
+				msg_it, dscope_fc, plan->size);
+			status = exec_decode_plan(msg_it, plan,
+				msg_it->buf.at + skip);
+			if (status != CTF_MSG_ITER_STATUS_OK) {
+				BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+					"Cannot decode field with decode plan: "
+					"msg-it-addr=%p, fc-addr=%p",
+					msg_it, dscope_fc);
+				goto end;
+			}
+
+			msg_it->state = done_state;
+			buf_consume_bits(msg_it, skip + plan->size);
+			goto end;
+		}
+	}
+
 	BT_COMP_LOGT("Starting BFCR: msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p",
 		msg_it, msg_it->bfcr, dscope_fc);
 	consumed_bits = bt_bfcr_start(msg_it->bfcr, dscope_fc,
@@ -823,6 +1169,7 @@ enum ctf_msg_iter_status read_packet_header_begin_state(
 		"msg-it-addr=%p, trace-class-addr=%p, fc-addr=%p",
 		msg_it, msg_it->meta.tc, packet_header_fc);
 	status = read_dscope_begin_state(msg_it, packet_header_fc,
+		msg_it->meta.tc->packet_header_decode_plan,
 		STATE_AFTER_TRACE_PACKET_HEADER,
 		STATE_DSCOPE_TRACE_PACKET_HEADER_CONTINUE, NULL);
 	if (status < 0) {
@@ -1053,6 +1400,7 @@ enum ctf_msg_iter_status read_packet_context_begin_state(
 		msg_it, msg_it->meta.sc,
 		msg_it->meta.sc->id, packet_context_fc);
 	status = read_dscope_begin_state(msg_it, packet_context_fc,
+		msg_it->meta.sc->packet_context_decode_plan,
 		STATE_AFTER_STREAM_PACKET_CONTEXT,
 		STATE_DSCOPE_STREAM_PACKET_CONTEXT_CONTINUE,
 		msg_it->dscopes.stream_packet_context);
@@ -1210,6 +1558,7 @@ enum ctf_msg_iter_status read_event_header_begin_state(struct ctf_msg_iter *msg_
 		msg_it->meta.sc->id,
 		event_header_fc);
 	status = read_dscope_begin_state(msg_it, event_header_fc,
+		msg_it->meta.sc->event_header_decode_plan,
 		STATE_AFTER_EVENT_HEADER,
 		STATE_DSCOPE_EVENT_HEADER_CONTINUE, NULL);
 	if (status < 0) {
@@ -1285,67 +1634,236 @@ end:
 	return status;
 }
 
-static inline
-enum ctf_msg_iter_status set_current_event_message(
-		struct ctf_msg_iter *msg_it)
-{
-	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
-	bt_self_component *self_comp = msg_it->self_comp;
-	bt_message *msg = NULL;
+struct ctf_event_class_filter {
+	/* Array of normalized star globbing patterns (`gchar *`) */
+	GPtrArray *patterns;
+};
 
-	BT_ASSERT_DBG(msg_it->meta.ec);
-	BT_ASSERT_DBG(msg_it->packet);
-	BT_COMP_LOGD("Creating event message from event class and packet: "
-		"msg-it-addr=%p, ec-addr=%p, ec-name=\"%s\", packet-addr=%p",
-		msg_it, msg_it->meta.ec,
-		msg_it->meta.ec->name->str,
-		msg_it->packet);
-	BT_ASSERT_DBG(msg_it->self_msg_iter);
-	BT_ASSERT_DBG(msg_it->meta.sc);
+BT_HIDDEN
+struct ctf_event_class_filter *ctf_event_class_filter_create(
+		const bt_value *patterns)
+{
+	struct ctf_event_class_filter *filter;
+	uint64_t i;
 
-	if (bt_stream_class_borrow_default_clock_class(msg_it->meta.sc->ir_sc)) {
-		msg = bt_message_event_create_with_packet_and_default_clock_snapshot(
-			msg_it->self_msg_iter, msg_it->meta.ec->ir_ec,
-			msg_it->packet, msg_it->default_clock_snapshot);
-	} else {
-		msg = bt_message_event_create_with_packet(msg_it->self_msg_iter,
-			msg_it->meta.ec->ir_ec, msg_it->packet);
+	BT_ASSERT(bt_value_is_array(patterns));
+	filter = g_new0(struct ctf_event_class_filter, 1);
+	if (!filter) {
+		goto error;
 	}
 
-	if (!msg) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-			"Cannot create event message: "
-			"msg-it-addr=%p, ec-addr=%p, ec-name=\"%s\", "
-			"packet-addr=%p",
-			msg_it, msg_it->meta.ec,
-			msg_it->meta.ec->name->str,
-			msg_it->packet);
+	filter->patterns = g_ptr_array_new_with_free_func(g_free);
+	if (!filter->patterns) {
 		goto error;
 	}
 
+	for (i = 0; i < bt_value_array_get_length(patterns); i++) {
+		const bt_value *pattern_value =
+			bt_value_array_borrow_element_by_index_const(
+				patterns, i);
+		gchar *pattern;
+
+		BT_ASSERT(bt_value_is_string(pattern_value));
+		pattern = g_strdup(bt_value_string_get(pattern_value));
+		if (!pattern) {
+			goto error;
+		}
+
+		bt_common_normalize_star_glob_pattern(pattern);
+		g_ptr_array_add(filter->patterns, pattern);
+	}
+
 	goto end;
 
 error:
-	BT_MESSAGE_PUT_REF_AND_RESET(msg);
-	status = CTF_MSG_ITER_STATUS_ERROR;
+	ctf_event_class_filter_destroy(filter);
+	filter = NULL;
 
 end:
-	BT_MESSAGE_MOVE_REF(msg_it->event_msg, msg);
-	return status;
+	return filter;
 }
 
-static
-enum ctf_msg_iter_status after_event_header_state(
-		struct ctf_msg_iter *msg_it)
+BT_HIDDEN
+void ctf_event_class_filter_destroy(struct ctf_event_class_filter *filter)
 {
-	enum ctf_msg_iter_status status;
+	if (!filter) {
+		return;
+	}
 
-	status = set_current_event_class(msg_it);
-	if (status != CTF_MSG_ITER_STATUS_OK) {
-		goto end;
+	if (filter->patterns) {
+		g_ptr_array_free(filter->patterns, TRUE);
 	}
 
-	if (G_UNLIKELY(msg_it->dry_run)) {
+	g_free(filter);
+}
+
+static
+bool pattern_is_event_class_id(const char *pattern, uint64_t id)
+{
+	const char *ch;
+	uint64_t pattern_id;
+
+	if (*pattern == '\0') {
+		return false;
+	}
+
+	for (ch = pattern; *ch != '\0'; ch++) {
+		if (!g_ascii_isdigit(*ch)) {
+			return false;
+		}
+	}
+
+	pattern_id = g_ascii_strtoull(pattern, NULL, 10);
+	return pattern_id == id;
+}
+
+static
+bool event_class_filter_selects(const struct ctf_event_class_filter *filter,
+		struct ctf_event_class *ec)
+{
+	guint i;
+
+	for (i = 0; i < filter->patterns->len; i++) {
+		const char *pattern = filter->patterns->pdata[i];
+
+		if (bt_common_star_glob_match(pattern, SIZE_MAX,
+				ec->name->str, ec->name->len) ||
+				pattern_is_event_class_id(pattern, ec->id)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Returns whether or not the message iterator must emit the event
+ * messages of the current event class, caching the result within the
+ * message iterator.
+ */
+static inline
+bool cur_event_class_is_selected(struct ctf_msg_iter *msg_it)
+{
+	struct ctf_event_class *ec = msg_it->meta.ec;
+	gpointer cached;
+	bool is_selected;
+
+	if (G_LIKELY(!msg_it->ec_filter)) {
+		return true;
+	}
+
+	if (G_LIKELY(msg_it->ec_selection &&
+			g_hash_table_lookup_extended(msg_it->ec_selection, ec,
+				NULL, &cached))) {
+		return (bool) GPOINTER_TO_UINT(cached);
+	}
+
+	is_selected = event_class_filter_selects(msg_it->ec_filter, ec);
+	BT_COMP_LOGD("Applied event class filter: "
+		"msg-it-addr=%p, event-class-addr=%p, "
+		"event-class-id=%" PRId64 ", "
+		"event-class-name=\"%s\", is-selected=%d",
+		msg_it, ec, ec->id, ec->name->str, is_selected);
+
+	if (!msg_it->ec_selection) {
+		msg_it->ec_selection = g_hash_table_new(g_direct_hash,
+			g_direct_equal);
+		if (!msg_it->ec_selection) {
+			goto end;
+		}
+	}
+
+	g_hash_table_insert(msg_it->ec_selection, ec,
+		GUINT_TO_POINTER(is_selected));
+
+end:
+	return is_selected;
+}
+
+/*
+ * Ends the dry run mode of a skipped event, if any.
+ */
+static inline
+void end_skipped_event(struct ctf_msg_iter *msg_it)
+{
+	if (G_UNLIKELY(msg_it->skip_event)) {
+		msg_it->skip_event = false;
+		msg_it->dry_run = false;
+	}
+}
+
+static inline
+enum ctf_msg_iter_status set_current_event_message(
+		struct ctf_msg_iter *msg_it)
+{
+	enum ctf_msg_iter_status status = CTF_MSG_ITER_STATUS_OK;
+	bt_self_component *self_comp = msg_it->self_comp;
+	bt_message *msg = NULL;
+
+	BT_ASSERT_DBG(msg_it->meta.ec);
+	BT_ASSERT_DBG(msg_it->packet);
+	BT_COMP_LOGD("Creating event message from event class and packet: "
+		"msg-it-addr=%p, ec-addr=%p, ec-name=\"%s\", packet-addr=%p",
+		msg_it, msg_it->meta.ec,
+		msg_it->meta.ec->name->str,
+		msg_it->packet);
+	BT_ASSERT_DBG(msg_it->self_msg_iter);
+	BT_ASSERT_DBG(msg_it->meta.sc);
+
+	if (bt_stream_class_borrow_default_clock_class(msg_it->meta.sc->ir_sc)) {
+		msg = bt_message_event_create_with_packet_and_default_clock_snapshot(
+			msg_it->self_msg_iter, msg_it->meta.ec->ir_ec,
+			msg_it->packet, msg_it->default_clock_snapshot);
+	} else {
+		msg = bt_message_event_create_with_packet(msg_it->self_msg_iter,
+			msg_it->meta.ec->ir_ec, msg_it->packet);
+	}
+
+	if (!msg) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot create event message: "
+			"msg-it-addr=%p, ec-addr=%p, ec-name=\"%s\", "
+			"packet-addr=%p",
+			msg_it, msg_it->meta.ec,
+			msg_it->meta.ec->name->str,
+			msg_it->packet);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_MESSAGE_PUT_REF_AND_RESET(msg);
+	status = CTF_MSG_ITER_STATUS_ERROR;
+
+end:
+	BT_MESSAGE_MOVE_REF(msg_it->event_msg, msg);
+	return status;
+}
+
+static
+enum ctf_msg_iter_status after_event_header_state(
+		struct ctf_msg_iter *msg_it)
+{
+	enum ctf_msg_iter_status status;
+
+	status = set_current_event_class(msg_it);
+	if (status != CTF_MSG_ITER_STATUS_OK) {
+		goto end;
+	}
+
+	if (G_UNLIKELY(msg_it->dry_run)) {
+		goto next_state;
+	}
+
+	if (G_UNLIKELY(!cur_event_class_is_selected(msg_it))) {
+		/*
+		 * Decode the rest of the event without creating any
+		 * library object, and don't emit it.
+		 */
+		msg_it->skip_event = true;
+		msg_it->dry_run = true;
+		msg_it->event = NULL;
 		goto next_state;
 	}
 
@@ -1395,6 +1913,7 @@ enum ctf_msg_iter_status read_event_common_context_begin_state(
 		msg_it->meta.sc->id,
 		event_common_context_fc);
 	status = read_dscope_begin_state(msg_it, event_common_context_fc,
+		msg_it->meta.sc->event_common_context_decode_plan,
 		STATE_DSCOPE_EVENT_SPEC_CONTEXT_BEGIN,
 		STATE_DSCOPE_EVENT_COMMON_CONTEXT_CONTINUE,
 		msg_it->dscopes.event_common_context);
@@ -1451,6 +1970,7 @@ enum ctf_msg_iter_status read_event_spec_context_begin_state(
 		msg_it->meta.ec->id,
 		event_spec_context_fc);
 	status = read_dscope_begin_state(msg_it, event_spec_context_fc,
+		msg_it->meta.ec->spec_context_decode_plan,
 		STATE_DSCOPE_EVENT_PAYLOAD_BEGIN,
 		STATE_DSCOPE_EVENT_SPEC_CONTEXT_CONTINUE,
 		msg_it->dscopes.event_spec_context);
@@ -1478,6 +1998,179 @@ enum ctf_msg_iter_status read_event_spec_context_continue_state(
 		STATE_DSCOPE_EVENT_PAYLOAD_BEGIN);
 }
 
+/*
+ * Copy of the bytes of an event payload field which is not decoded yet.
+ */
+struct lazy_payload_data {
+	/* Owned by this */
+	struct ctf_lazy_payload *lazy_payload;
+
+	/* Offset (bits) of the root field within `buf` */
+	unsigned int at;
+
+	uint8_t buf[];
+};
+
+static
+void materialize_lazy_payload(bt_field *payload_field, void *data)
+{
+	struct lazy_payload_data *lp_data = data;
+	struct ctf_lazy_payload *lazy_payload = lp_data->lazy_payload;
+	bt_field *fields[CTF_DECODE_PLAN_MAX_DEPTH + 1];
+	int depth = -1;
+	guint i;
+
+	for (i = 0; i < lazy_payload->instrs->len; i++) {
+		struct ctf_lazy_payload_instr *instr = &g_array_index(
+			lazy_payload->instrs, struct ctf_lazy_payload_instr, i);
+		size_t at = lp_data->at + instr->offset;
+		bt_field *field;
+		uint64_t v;
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_END) {
+			BT_ASSERT_DBG(depth >= 0);
+			depth--;
+			continue;
+		}
+
+		if (instr->ir_index >= 0) {
+			BT_ASSERT_DBG(depth >= 0);
+			field = bt_field_structure_borrow_member_field_by_index(
+				fields[depth], (uint64_t) instr->ir_index);
+		} else {
+			field = payload_field;
+		}
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_STRUCT_BEGIN) {
+			BT_ASSERT_DBG(depth < CTF_DECODE_PLAN_MAX_DEPTH);
+			depth++;
+			fields[depth] = field;
+			continue;
+		}
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_INT &&
+				instr->is_signed) {
+			int64_t sv;
+
+			if (instr->byte_order == CTF_BYTE_ORDER_LITTLE) {
+				bt_bitfield_read_le(lp_data->buf, uint8_t, at,
+					instr->size, &sv);
+			} else {
+				bt_bitfield_read_be(lp_data->buf, uint8_t, at,
+					instr->size, &sv);
+			}
+
+			bt_field_integer_signed_set_value(field, sv);
+			continue;
+		}
+
+		if (instr->byte_order == CTF_BYTE_ORDER_LITTLE) {
+			bt_bitfield_read_le(lp_data->buf, uint8_t, at,
+				instr->size, &v);
+		} else {
+			bt_bitfield_read_be(lp_data->buf, uint8_t, at,
+				instr->size, &v);
+		}
+
+		if (instr->type == CTF_DECODE_PLAN_INSTR_TYPE_INT) {
+			bt_field_integer_unsigned_set_value(field, v);
+		} else if (instr->size == 32) {
+			union {
+				uint32_t u;
+				float f;
+			} f32;
+
+			f32.u = (uint32_t) v;
+			bt_field_real_single_precision_set_value(field, f32.f);
+		} else {
+			union {
+				uint64_t u;
+				double d;
+			} f64;
+
+			f64.u = v;
+			bt_field_real_double_precision_set_value(field, f64.d);
+		}
+	}
+}
+
+static
+void destroy_lazy_payload_data(void *data)
+{
+	struct lazy_payload_data *lp_data = data;
+
+	ctf_lazy_payload_put(lp_data->lazy_payload);
+	g_free(lp_data);
+}
+
+/*
+ * Copies the bytes of the current event payload field, if the current
+ * buffer contains all of them, and makes the current event decode them
+ * when its payload field is first borrowed.
+ *
+ * Returns whether or not the payload field is deferred; the caller
+ * decodes it otherwise.
+ */
+static
+bool defer_event_payload(struct ctf_msg_iter *msg_it)
+{
+	struct ctf_lazy_payload *lazy_payload = msg_it->meta.ec->lazy_payload;
+	struct lazy_payload_data *lp_data;
+	size_t skip;
+	size_t at;
+	size_t byte_count;
+	bool deferred = false;
+
+	skip = ALIGN(packet_at(msg_it), lazy_payload->alignment) -
+		packet_at(msg_it);
+	if (buf_available_bits(msg_it) < skip + lazy_payload->size) {
+		goto end;
+	}
+
+	at = msg_it->buf.at + skip;
+	byte_count = (at % 8 + lazy_payload->size + 7) / 8;
+	lp_data = g_try_malloc(sizeof(*lp_data) + byte_count);
+	if (!lp_data) {
+		goto end;
+	}
+
+	lp_data->lazy_payload = ctf_lazy_payload_get(lazy_payload);
+	lp_data->at = at % 8;
+	memcpy(lp_data->buf, &msg_it->buf.addr[at / 8], byte_count);
+	bt_event_set_payload_field_materializer(msg_it->event,
+		materialize_lazy_payload, destroy_lazy_payload_data, lp_data);
+	buf_consume_bits(msg_it, skip + lazy_payload->size);
+	deferred = true;
+
+end:
+	return deferred;
+}
+
+/*
+ * Skips the current event payload field, of which the size is fixed and
+ * of which the decoding has no effect on the message iterator, if the
+ * current buffer contains all of it.
+ *
+ * Returns whether or not the payload field is skipped.
+ */
+static
+bool skip_event_payload(struct ctf_msg_iter *msg_it)
+{
+	struct ctf_lazy_payload *lazy_payload = msg_it->meta.ec->lazy_payload;
+	size_t skip = ALIGN(packet_at(msg_it), lazy_payload->alignment) -
+		packet_at(msg_it);
+
+	if (buf_available_bits(msg_it) < skip + lazy_payload->size) {
+		return false;
+	}
+
+	BT_COMP_LOGT("Skipping event payload field: "
+		"msg-it-addr=%p, event-class-addr=%p, size=%" PRIu64,
+		msg_it, msg_it->meta.ec, lazy_payload->size);
+	buf_consume_bits(msg_it, skip + lazy_payload->size);
+	return true;
+}
+
 static
 enum ctf_msg_iter_status read_event_payload_begin_state(
 		struct ctf_msg_iter *msg_it)
@@ -1492,6 +2185,24 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 		goto end;
 	}
 
+	if (msg_it->skip_event && msg_it->meta.ec->lazy_payload &&
+			skip_event_payload(msg_it)) {
+		msg_it->state = STATE_EMIT_MSG_EVENT;
+		goto end;
+	}
+
+	if (msg_it->lazy_payloads && msg_it->meta.ec->lazy_payload &&
+			!msg_it->dry_run && defer_event_payload(msg_it)) {
+		BT_COMP_LOGT("Deferred event payload field decoding: "
+			"msg-it-addr=%p, event-class-addr=%p, "
+			"event-class-name=\"%s\", event-class-id=%" PRId64,
+			msg_it, msg_it->meta.ec,
+			msg_it->meta.ec->name->str,
+			msg_it->meta.ec->id);
+		msg_it->state = STATE_EMIT_MSG_EVENT;
+		goto end;
+	}
+
 	if (event_payload_fc->in_ir && !msg_it->dry_run) {
 		BT_ASSERT_DBG(!msg_it->dscopes.event_payload);
 		msg_it->dscopes.event_payload =
@@ -1509,6 +2220,7 @@ enum ctf_msg_iter_status read_event_payload_begin_state(
 		msg_it->meta.ec->id,
 		event_payload_fc);
 	status = read_dscope_begin_state(msg_it, event_payload_fc,
+		msg_it->meta.ec->payload_decode_plan,
 		STATE_EMIT_MSG_EVENT,
 		STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE,
 		msg_it->dscopes.event_payload);
@@ -1738,6 +2450,7 @@ enum ctf_msg_iter_status handle_state(struct ctf_msg_iter *msg_it)
 		status = read_event_payload_continue_state(msg_it);
 		break;
 	case STATE_EMIT_MSG_EVENT:
+		end_skipped_event(msg_it);
 		msg_it->state = STATE_DSCOPE_EVENT_HEADER_BEGIN;
 		break;
 	case STATE_EMIT_QUEUED_MSG_EVENT:
@@ -1778,6 +2491,7 @@ void ctf_msg_iter_reset_for_next_stream_file(struct ctf_msg_iter *msg_it)
 {
 	BT_ASSERT(msg_it);
 	BT_COMP_LOGD("Resetting message iterator: addr=%p", msg_it);
+	end_skipped_event(msg_it);
 	stack_clear(msg_it->stack);
 	msg_it->meta.sc = NULL;
 	msg_it->meta.ec = NULL;
@@ -1819,6 +2533,48 @@ void ctf_msg_iter_reset(struct ctf_msg_iter *msg_it)
 	msg_it->emit_stream_beginning_message = true;
 }
 
+/*
+ * Borrows the packed element values of the array field `array_field`,
+ * of which the CTF class is `array_fc`, if its element fields are
+ * integer or real fields.
+ */
+static
+void *borrow_array_field_values(bt_field *array_field,
+		struct ctf_field_class_array_base *array_fc)
+{
+	void *values = NULL;
+
+	if (array_fc->is_text) {
+		goto end;
+	}
+
+	switch (array_fc->elem_fc->type) {
+	case CTF_FIELD_CLASS_TYPE_INT:
+	case CTF_FIELD_CLASS_TYPE_ENUM:
+	{
+		struct ctf_field_class_int *int_fc = (void *) array_fc->elem_fc;
+
+		if (int_fc->is_signed) {
+			values = bt_field_array_borrow_signed_integer_values(
+				array_field);
+		} else {
+			values = bt_field_array_borrow_unsigned_integer_values(
+				array_field);
+		}
+
+		break;
+	}
+	case CTF_FIELD_CLASS_TYPE_FLOAT:
+		values = bt_field_array_borrow_real_values(array_field);
+		break;
+	default:
+		break;
+	}
+
+end:
+	return values;
+}
+
 static
 bt_field *borrow_next_field(struct ctf_msg_iter *msg_it)
 {
@@ -1862,131 +2618,44 @@ bt_field *borrow_next_field(struct ctf_msg_iter *msg_it)
 	return next_field;
 }
 
-static
-void update_default_clock(struct ctf_msg_iter *msg_it, uint64_t new_val,
-		uint64_t new_val_size)
-{
-	uint64_t new_val_mask;
-	uint64_t cur_value_masked;
-
-	BT_ASSERT_DBG(new_val_size > 0);
-
-	/*
-	 * Special case for a 64-bit new value, which is the limit
-	 * of a clock value as of this version: overwrite the
-	 * current value directly.
-	 */
-	if (new_val_size == 64) {
-		msg_it->default_clock_snapshot = new_val;
-		goto end;
-	}
-
-	new_val_mask = (1ULL << new_val_size) - 1;
-	cur_value_masked = msg_it->default_clock_snapshot & new_val_mask;
-
-	if (new_val < cur_value_masked) {
-		/*
-		 * It looks like a wrap happened on the number of bits
-		 * of the requested new value. Assume that the clock
-		 * value wrapped only one time.
-		 */
-		msg_it->default_clock_snapshot += new_val_mask + 1;
-	}
-
-	/* Clear the low bits of the current clock value. */
-	msg_it->default_clock_snapshot &= ~new_val_mask;
-
-	/* Set the low bits of the current clock value. */
-	msg_it->default_clock_snapshot |= new_val;
-
-end:
-	BT_COMP_LOGT("Updated default clock's value from integer field's value: "
-		"value=%" PRIu64, msg_it->default_clock_snapshot);
-}
-
 static
 enum bt_bfcr_status bfcr_unsigned_int_cb(uint64_t value,
 		struct ctf_field_class *fc, void *data)
 {
 	struct ctf_msg_iter *msg_it = data;
-	bt_self_component *self_comp = msg_it->self_comp;
-	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
-
+	enum bt_bfcr_status status;
 	bt_field *field = NULL;
-	struct ctf_field_class_int *int_fc = (void *) fc;
+	struct stack_entry *top;
 
 	BT_COMP_LOGT("Unsigned integer function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
 		"fc-type=%d, fc-in-ir=%d, value=%" PRIu64,
 		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, value);
 
-	if (G_LIKELY(int_fc->meaning == CTF_FIELD_CLASS_MEANING_NONE)) {
-		goto update_def_clock;
-	}
-
-	switch (int_fc->meaning) {
-	case CTF_FIELD_CLASS_MEANING_EVENT_CLASS_ID:
-		msg_it->cur_event_class_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_DATA_STREAM_ID:
-		msg_it->cur_data_stream_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_BEGINNING_TIME:
-		msg_it->snapshots.beginning_clock = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_END_TIME:
-		msg_it->snapshots.end_clock = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_STREAM_CLASS_ID:
-		msg_it->cur_stream_class_id = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_MAGIC:
-		if (value != 0xc1fc1fc1) {
-			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
-				"Invalid CTF magic number: msg-it-addr=%p, "
-				"magic=%" PRIx64, msg_it, value);
-			status = BT_BFCR_STATUS_ERROR;
-			goto end;
-		}
-
-		break;
-	case CTF_FIELD_CLASS_MEANING_PACKET_COUNTER_SNAPSHOT:
-		msg_it->snapshots.packets = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_DISC_EV_REC_COUNTER_SNAPSHOT:
-		msg_it->snapshots.discarded_events = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_TOTAL_SIZE:
-		msg_it->cur_exp_packet_total_size = value;
-		break;
-	case CTF_FIELD_CLASS_MEANING_EXP_PACKET_CONTENT_SIZE:
-		msg_it->cur_exp_packet_content_size = value;
-		break;
-	default:
-		bt_common_abort();
+	status = handle_unsigned_int_value(msg_it, (void *) fc, value);
+	if (status != BT_BFCR_STATUS_OK) {
+		goto end;
 	}
 
-update_def_clock:
-	if (G_UNLIKELY(int_fc->mapped_clock_class)) {
-		update_default_clock(msg_it, value, int_fc->base.size);
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
 	}
 
-	if (G_UNLIKELY(int_fc->storing_index >= 0)) {
-		g_array_index(msg_it->stored_values, uint64_t,
-			(uint64_t) int_fc->storing_index) = value;
-	}
+	top = stack_top(msg_it->stack);
 
-	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
-		goto end;
+	if (top->values) {
+		((uint64_t *) top->values)[top->index] = value;
+	} else {
+		field = borrow_next_field(msg_it);
+		BT_ASSERT_DBG(field);
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		BT_ASSERT_DBG(bt_field_class_type_is(
+			bt_field_get_class_type(field),
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER));
+		bt_field_integer_unsigned_set_value(field, value);
 	}
 
-	field = borrow_next_field(msg_it);
-	BT_ASSERT_DBG(field);
-	BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
-	BT_ASSERT_DBG(bt_field_class_type_is(bt_field_get_class_type(field),
-		BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER));
-	bt_field_integer_unsigned_set_value(field, value);
-	stack_top(msg_it->stack)->index++;
+	top->index++;
 
 end:
 	return status;
@@ -2053,6 +2722,7 @@ enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 	bt_field *field = NULL;
 	struct ctf_msg_iter *msg_it = data;
 	struct ctf_field_class_int *int_fc = (void *) fc;
+	struct stack_entry *top;
 
 	BT_COMP_LOGT("Signed integer function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
@@ -2069,18 +2739,114 @@ enum bt_bfcr_status bfcr_signed_int_cb(int64_t value,
 		goto end;
 	}
 
-	field = borrow_next_field(msg_it);
-	BT_ASSERT_DBG(field);
-	BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
-	BT_ASSERT_DBG(bt_field_class_type_is(bt_field_get_class_type(field),
-		BT_FIELD_CLASS_TYPE_SIGNED_INTEGER));
-	bt_field_integer_signed_set_value(field, value);
-	stack_top(msg_it->stack)->index++;
+	top = stack_top(msg_it->stack);
+
+	if (top->values) {
+		((int64_t *) top->values)[top->index] = value;
+	} else {
+		field = borrow_next_field(msg_it);
+		BT_ASSERT_DBG(field);
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		BT_ASSERT_DBG(bt_field_class_type_is(
+			bt_field_get_class_type(field),
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER));
+		bt_field_integer_signed_set_value(field, value);
+	}
+
+	top->index++;
 
 end:
 	return status;
 }
 
+static
+enum bt_bfcr_status bfcr_signed_int_array_cb(const int64_t *values,
+		size_t count, struct ctf_field_class *fc, void *data)
+{
+	struct ctf_msg_iter *msg_it = data;
+	bt_field *array_field;
+	struct stack_entry *top;
+	size_t i;
+
+	BT_COMP_LOGT("Signed integer array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%zu",
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	top = stack_top(msg_it->stack);
+	array_field = top->base;
+	BT_ASSERT_DBG(top->index + count <=
+		bt_field_array_get_length(array_field));
+
+	if (top->values) {
+		memcpy((int64_t *) top->values + top->index, values,
+			count * sizeof(*values));
+		goto incr_index;
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_field *field = bt_field_array_borrow_element_field_by_index(
+			array_field, top->index + i);
+
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		bt_field_integer_signed_set_value(field, values[i]);
+	}
+
+incr_index:
+	top->index += count;
+
+end:
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status bfcr_unsigned_int_array_cb(const uint64_t *values,
+		size_t count, struct ctf_field_class *fc, void *data)
+{
+	struct ctf_msg_iter *msg_it = data;
+	bt_field *array_field;
+	struct stack_entry *top;
+	size_t i;
+
+	BT_COMP_LOGT("Unsigned integer array function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, count=%zu",
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir, count);
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	top = stack_top(msg_it->stack);
+	array_field = top->base;
+	BT_ASSERT_DBG(top->index + count <=
+		bt_field_array_get_length(array_field));
+
+	if (top->values) {
+		memcpy((uint64_t *) top->values + top->index, values,
+			count * sizeof(*values));
+		goto incr_index;
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_field *field = bt_field_array_borrow_element_field_by_index(
+			array_field, top->index + i);
+
+		BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+		bt_field_integer_unsigned_set_value(field, values[i]);
+	}
+
+incr_index:
+	top->index += count;
+
+end:
+	return BT_BFCR_STATUS_OK;
+}
+
 static
 enum bt_bfcr_status bfcr_floating_point_cb(double value,
 		struct ctf_field_class *fc, void *data)
@@ -2089,6 +2855,7 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 	bt_field *field = NULL;
 	struct ctf_msg_iter *msg_it = data;
 	bt_field_class_type type;
+	struct stack_entry *top;
 
 	BT_COMP_LOGT("Floating point number function called from BFCR: "
 		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
@@ -2099,6 +2866,19 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 		goto end;
 	}
 
+	top = stack_top(msg_it->stack);
+
+	if (top->values) {
+		struct ctf_field_class_float *float_fc = (void *) fc;
+
+		if (float_fc->base.size == 32) {
+			value = (double) (float) value;
+		}
+
+		((double *) top->values)[top->index] = value;
+		goto incr_index;
+	}
+
 	field = borrow_next_field(msg_it);
 	type = bt_field_get_class_type(field);
 	BT_ASSERT_DBG(field);
@@ -2110,7 +2890,9 @@ enum bt_bfcr_status bfcr_floating_point_cb(double value,
 	} else {
 		bt_field_real_double_precision_set_value(field, value);
 	}
-	stack_top(msg_it->stack)->index++;
+
+incr_index:
+	top->index++;
 
 end:
 	return status;
@@ -2213,6 +2995,48 @@ end:
 	return BT_BFCR_STATUS_OK;
 }
 
+static
+enum bt_bfcr_status bfcr_complete_string_cb(const char *value,
+		size_t len, struct ctf_field_class *fc, void *data)
+{
+	enum bt_bfcr_status status = BT_BFCR_STATUS_OK;
+	bt_field *field = NULL;
+	struct ctf_msg_iter *msg_it = data;
+	bt_self_component *self_comp = msg_it->self_comp;
+	int ret;
+
+	BT_COMP_LOGT("Complete string function called from BFCR: "
+		"msg-it-addr=%p, bfcr-addr=%p, fc-addr=%p, "
+		"fc-type=%d, fc-in-ir=%d, string-length=%zu",
+		msg_it, msg_it->bfcr, fc, fc->type, fc->in_ir,
+		len);
+
+	if (G_UNLIKELY(!fc->in_ir || msg_it->dry_run)) {
+		goto end;
+	}
+
+	field = borrow_next_field(msg_it);
+	BT_ASSERT_DBG(field);
+	BT_ASSERT_DBG(bt_field_borrow_class_const(field) == fc->ir_fc);
+	BT_ASSERT_DBG(bt_field_get_class_type(field) ==
+		  BT_FIELD_CLASS_TYPE_STRING);
+	bt_field_string_clear(field);
+	ret = bt_field_string_append_with_length(field, value, len);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot set string field's value: "
+			"msg-it-addr=%p, field-addr=%p, string-length=%zu, "
+			"ret=%d", msg_it, field, len, ret);
+		status = BT_BFCR_STATUS_ERROR;
+		goto end;
+	}
+
+	stack_top(msg_it->stack)->index++;
+
+end:
+	return status;
+}
+
 static
 enum bt_bfcr_status bfcr_compound_begin_cb(
 		struct ctf_field_class *fc, void *data)
@@ -2258,6 +3082,14 @@ enum bt_bfcr_status bfcr_compound_begin_cb(
 			bt_field_string_clear(field);
 			bt_bfcr_set_unsigned_int_cb(msg_it->bfcr,
 				bfcr_unsigned_int_char_cb);
+		} else if (fc->type == CTF_FIELD_CLASS_TYPE_ARRAY) {
+			/*
+			 * A sequence field's values are borrowed once
+			 * its length is set (see
+			 * bfcr_get_sequence_length_cb()).
+			 */
+			stack_top(msg_it->stack)->values =
+				borrow_array_field_values(field, array_fc);
 		}
 	}
 
@@ -2351,7 +3183,11 @@ int64_t bfcr_get_sequence_length_cb(struct ctf_field_class *fc, void *data)
 				"msg-it-addr=%p, field-addr=%p, "
 				"length=%" PRIu64, msg_it, seq_field, length);
 			length = -1;
+			goto end;
 		}
+
+		stack_top(msg_it->stack)->values =
+			borrow_array_field_values(seq_field, &seq_fc->base);
 	}
 
 end:
@@ -2363,8 +3199,7 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 		struct ctf_field_class *fc, void *data)
 {
 	int ret;
-	uint64_t i;
-	int64_t option_index = -1;
+	int64_t option_index;
 	struct ctf_msg_iter *msg_it = data;
 	struct ctf_field_class_variant *var_fc = (void *) fc;
 	struct ctf_named_field_class *selected_option = NULL;
@@ -2379,34 +3214,9 @@ struct ctf_field_class *bfcr_borrow_variant_selected_field_class_cb(
 	tag.u = g_array_index(msg_it->stored_values, uint64_t,
 		var_fc->stored_tag_index);
 
-	/*
-	 * Check each range to find the selected option's index.
-	 */
-	if (var_fc->tag_fc->base.is_signed) {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.i >= range->range.lower.i &&
-					tag.i <= range->range.upper.i) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	} else {
-		for (i = 0; i < var_fc->ranges->len; i++) {
-			struct ctf_field_class_variant_range *range =
-				ctf_field_class_variant_borrow_range_by_index(
-					var_fc, i);
-
-			if (tag.u >= range->range.lower.u &&
-					tag.u <= range->range.upper.u) {
-				option_index = (int64_t) range->option_index;
-				break;
-			}
-		}
-	}
+	/* Find the selected option's index */
+	option_index = ctf_field_class_variant_find_option_index(var_fc,
+		tag.u);
 
 	if (option_index < 0) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
@@ -2753,10 +3563,13 @@ struct ctf_msg_iter *ctf_msg_iter_create(
 		.classes = {
 			.signed_int = bfcr_signed_int_cb,
 			.unsigned_int = bfcr_unsigned_int_cb,
+			.signed_int_array = bfcr_signed_int_array_cb,
+			.unsigned_int_array = bfcr_unsigned_int_array_cb,
 			.floating_point = bfcr_floating_point_cb,
 			.string_begin = bfcr_string_begin_cb,
 			.string = bfcr_string_cb,
 			.string_end = bfcr_string_end_cb,
+			.complete_string = bfcr_complete_string_cb,
 			.compound_begin = bfcr_compound_begin_cb,
 			.compound_end = bfcr_compound_end_cb,
 		},
@@ -2845,6 +3658,10 @@ void ctf_msg_iter_destroy(struct ctf_msg_iter *msg_it)
 		g_array_free(msg_it->stored_values, TRUE);
 	}
 
+	if (msg_it->ec_selection) {
+		g_hash_table_destroy(msg_it->ec_selection);
+	}
+
 	g_free(msg_it);
 }
 
@@ -2873,6 +3690,11 @@ enum ctf_msg_iter_status ctf_msg_iter_get_next_message(
 
 		switch (msg_it->state) {
 		case STATE_EMIT_MSG_EVENT:
+			if (G_UNLIKELY(msg_it->skip_event)) {
+				/* Not selected: continue with the next event */
+				break;
+			}
+
 			BT_ASSERT_DBG(msg_it->event_msg);
 
 			/*
@@ -3170,3 +3992,21 @@ void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 {
 	msg_it->dry_run = val;
 }
+
+BT_HIDDEN
+void ctf_msg_iter_set_event_class_filter(struct ctf_msg_iter *msg_it,
+		const struct ctf_event_class_filter *filter)
+{
+	msg_it->ec_filter = filter;
+
+	if (msg_it->ec_selection) {
+		g_hash_table_remove_all(msg_it->ec_selection);
+	}
+}
+
+BT_HIDDEN
+void ctf_msg_iter_set_lazy_payloads(struct ctf_msg_iter *msg_it,
+		bool val)
+{
+	msg_it->lazy_payloads = val;
+}
@@ -333,6 +333,49 @@ BT_HIDDEN
 void ctf_msg_iter_set_dry_run(struct ctf_msg_iter *msg_it,
 		bool val);
 
+/*
+ * Set of event classes which a message iterator emits the event
+ * messages of.
+ */
+struct ctf_event_class_filter;
+
+/*
+ * Creates an event class filter which selects the event classes of
+ * which the name matches one of the star globbing patterns of the
+ * array value of strings `patterns`, or of which the ID is one of
+ * those patterns when it only contains decimal digits.
+ *
+ * Returns `NULL` on memory error.
+ */
+BT_HIDDEN
+struct ctf_event_class_filter *ctf_event_class_filter_create(
+		const bt_value *patterns);
+
+BT_HIDDEN
+void ctf_event_class_filter_destroy(struct ctf_event_class_filter *filter);
+
+/*
+ * Makes the message iterator skip the events of which the class is not
+ * selected by `filter` (not owned), or emit all the events if `filter`
+ * is `NULL`.
+ *
+ * The message iterator still decodes the fields of a skipped event,
+ * without creating any library object, to find the next event, unless
+ * its payload field has a fixed size.
+ */
+BT_HIDDEN
+void ctf_msg_iter_set_event_class_filter(struct ctf_msg_iter *msg_it,
+		const struct ctf_event_class_filter *filter);
+
+/*
+ * Makes the message iterator emit, when `val` is true, event messages
+ * of which the payload field is only decoded when first borrowed, when
+ * the payload field has a fixed layout.
+ */
+BT_HIDDEN
+void ctf_msg_iter_set_lazy_payloads(struct ctf_msg_iter *msg_it,
+		bool val);
+
 static inline
 const char *ctf_msg_iter_medium_status_string(
 		enum ctf_msg_iter_medium_status status)
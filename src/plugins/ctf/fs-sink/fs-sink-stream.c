@@ -273,6 +273,110 @@ int write_string_field(struct fs_sink_stream *stream,
 		bt_field_string_get_value(field));
 }
 
+/*
+ * Writes the `len` element values of the array field `field`, of which
+ * the element fields are boolean, integer, or real fields, without
+ * borrowing each element field.
+ */
+static inline
+int write_array_field_values(struct fs_sink_stream *stream,
+		struct fs_sink_ctf_field_class *elem_fc, const bt_field *field,
+		uint64_t len)
+{
+	uint64_t i;
+	int ret = 0;
+
+	if (len == 0) {
+		goto end;
+	}
+
+	switch (elem_fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_BOOL:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc = (void *) elem_fc;
+		const bt_bool *values =
+			bt_field_array_borrow_bool_values_const(field);
+
+		for (i = 0; i < len; i++) {
+			ret = bt_ctfser_write_unsigned_int(&stream->ctfser,
+				values[i] ? 1 : 0, int_fc->base.base.alignment,
+				int_fc->base.size, BYTE_ORDER);
+			if (G_UNLIKELY(ret)) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	{
+		struct fs_sink_ctf_field_class_int *int_fc = (void *) elem_fc;
+
+		if (int_fc->is_signed) {
+			const int64_t *values =
+				bt_field_array_borrow_signed_integer_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				ret = bt_ctfser_write_signed_int(
+					&stream->ctfser, values[i],
+					int_fc->base.base.alignment,
+					int_fc->base.size, BYTE_ORDER);
+				if (G_UNLIKELY(ret)) {
+					goto end;
+				}
+			}
+		} else {
+			const uint64_t *values =
+				bt_field_array_borrow_unsigned_integer_values_const(
+					field);
+
+			for (i = 0; i < len; i++) {
+				ret = bt_ctfser_write_unsigned_int(
+					&stream->ctfser, values[i],
+					int_fc->base.base.alignment,
+					int_fc->base.size, BYTE_ORDER);
+				if (G_UNLIKELY(ret)) {
+					goto end;
+				}
+			}
+		}
+
+		break;
+	}
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+	{
+		struct fs_sink_ctf_field_class_float *float_fc =
+			(void *) elem_fc;
+		const double *values =
+			bt_field_array_borrow_real_values_const(field);
+
+		for (i = 0; i < len; i++) {
+			if (float_fc->base.size == 32) {
+				ret = bt_ctfser_write_float32(&stream->ctfser,
+					values[i], float_fc->base.base.alignment,
+					BYTE_ORDER);
+			} else {
+				ret = bt_ctfser_write_float64(&stream->ctfser,
+					values[i], float_fc->base.base.alignment,
+					BYTE_ORDER);
+			}
+
+			if (G_UNLIKELY(ret)) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	default:
+		bt_common_abort();
+	}
+
+end:
+	return ret;
+}
+
 static inline
 int write_array_field_elements(struct fs_sink_stream *stream,
 		struct fs_sink_ctf_field_class_array_base *fc,
@@ -282,6 +386,16 @@ int write_array_field_elements(struct fs_sink_stream *stream,
 	uint64_t len = bt_field_array_get_length(field);
 	int ret = 0;
 
+	switch (fc->elem_fc->type) {
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_BOOL:
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_INT:
+	case FS_SINK_CTF_FIELD_CLASS_TYPE_FLOAT:
+		ret = write_array_field_values(stream, fc->elem_fc, field, len);
+		goto end;
+	default:
+		break;
+	}
+
 	for (i = 0; i < len; i++) {
 		const bt_field *elem_field =
 			bt_field_array_borrow_element_field_by_index_const(
@@ -36,12 +36,16 @@
 #include "compat/mman.h"
 #include "compat/endian.h"
 #include <babeltrace2/babeltrace.h>
+#include "common/align.h"
 #include "common/common.h"
 #include "file.h"
 #include "metadata.h"
 #include "../common/msg-iter/msg-iter.h"
 #include "common/assert.h"
 #include "data-stream-file.h"
+#include "index-cache.h"
+#include "read-ahead.h"
+#include "zstd-file.h"
 #include <string.h>
 
 static inline
@@ -77,12 +81,18 @@ enum ctf_msg_iter_medium_status ds_file_munmap(
 		goto end;
 	}
 
+	if (ds_file->zstd_file) {
+		/* The decompressed frame belongs to `ds_file->zstd_file`. */
+		ds_file->mmap_addr = NULL;
+		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+		goto end;
+	}
+
 	if (bt_munmap(ds_file->mmap_addr, ds_file->mmap_len)) {
 		BT_COMP_LOGE_ERRNO("Cannot memory-unmap file",
-			": address=%p, size=%zu, file_path=\"%s\", file=%p",
+			": address=%p, size=%zu, file_path=\"%s\"",
 			ds_file->mmap_addr, ds_file->mmap_len,
-			ds_file->file ? ds_file->file->path->str : "NULL",
-			ds_file->file ? ds_file->file->fp : NULL);
+			ds_file->file ? ds_file->file->path->str : "NULL");
 		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
 		goto end;
 	}
@@ -94,10 +104,80 @@ end:
 	return status;
 }
 
+/*
+ * Advises the system that the `len` bytes at offset `offset_in_file` of
+ * `ds_file` will be read soon, if they're in the current mapping.
+ */
+static
+void ds_file_advise_willneed(struct ctf_fs_ds_file *ds_file,
+		off_t offset_in_file, uint64_t len)
+{
+	const size_t page_size =
+		bt_mmap_get_offset_align_size(ds_file->log_level);
+	off_t begin_in_mapping;
+	off_t end_in_mapping;
+
+	if (!ds_file->mmap_addr || ds_file->zstd_file ||
+			!offset_ist_mapped(ds_file, offset_in_file)) {
+		goto end;
+	}
+
+	/* The address must be page-aligned. */
+	begin_in_mapping = offset_in_file - ds_file->mmap_offset_in_file;
+	begin_in_mapping -= begin_in_mapping % page_size;
+	end_in_mapping = MIN((uint64_t) (offset_in_file -
+		ds_file->mmap_offset_in_file) + len, ds_file->mmap_len);
+	(void) bt_madvise((uint8_t *) ds_file->mmap_addr + begin_in_mapping,
+		end_in_mapping - begin_in_mapping, BT_MADV_WILLNEED);
+
+end:
+	return;
+}
+
+/*
+ * Makes the decompressed frame of the compressed data stream file
+ * `ds_file` which contains `requested_offset_in_file` the current
+ * "mapping", and sets `ds_file->request_offset_in_mapping` accordingly.
+ */
+static
+enum ctf_msg_iter_medium_status ds_file_map_zstd_frame(
+		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file)
+{
+	enum ctf_msg_iter_medium_status status;
+	struct ctf_fs_zstd_file *zstd_file = ds_file->zstd_file;
+	const struct ctf_fs_zstd_frame *frame;
+	guint frame_index;
+
+	frame_index = ctf_fs_zstd_file_find_frame(zstd_file,
+		(uint64_t) requested_offset_in_file);
+	if (ctf_fs_zstd_file_decompress_frame(zstd_file, frame_index)) {
+		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+		goto end;
+	}
+
+	frame = &g_array_index(zstd_file->frames, struct ctf_fs_zstd_frame,
+		frame_index);
+	ds_file->mmap_addr = zstd_file->buf;
+	ds_file->mmap_offset_in_file = (off_t) frame->offset;
+	ds_file->mmap_len = (size_t) frame->size;
+	ds_file->request_offset_in_mapping =
+		requested_offset_in_file - ds_file->mmap_offset_in_file;
+	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+
+end:
+	return status;
+}
+
 /*
  * mmap a region of `ds_file` such that `requested_offset_in_file` is in the
  * mapping.  If the currently mmap-ed region already contains
- * `requested_offset_in_file`, the mapping is kept.
+ * `requested_offset_in_file`, and the `min_len` bytes which follow it
+ * when possible, the mapping is kept.
+ *
+ * The new mapping, if any, contains the `min_len` bytes from
+ * `requested_offset_in_file` (typically, a whole packet), or up to the
+ * end of the file, even if they exceed `ds_file->mmap_max_len`, so
+ * that reading them doesn't require another mapping.
  *
  * Set `ds_file->requested_offset_in_mapping` based on `request_offset_in_file`,
  * such that the next call to `request_bytes` will return bytes starting at that
@@ -107,21 +187,37 @@ end:
  */
 static
 enum ctf_msg_iter_medium_status ds_file_mmap(
-		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file)
+		struct ctf_fs_ds_file *ds_file, off_t requested_offset_in_file,
+		uint64_t min_len)
 {
 	enum ctf_msg_iter_medium_status status;
 	bt_self_component *self_comp = ds_file->self_comp;
 	bt_logging_level log_level = ds_file->log_level;
+	const size_t offset_align =
+		bt_mmap_get_offset_align_size(ds_file->log_level);
+	uint64_t wanted_end;
+	int fd;
 
 	/* Ensure the requested offset is in the file range. */
 	BT_ASSERT(requested_offset_in_file >= 0);
 	BT_ASSERT(requested_offset_in_file < ds_file->file->size);
 
+	if (ds_file->zstd_file) {
+		status = ds_file_map_zstd_frame(ds_file,
+			requested_offset_in_file);
+		goto end;
+	}
+
+	wanted_end = MIN((uint64_t) requested_offset_in_file + min_len,
+		(uint64_t) ds_file->file->size);
+
 	/*
-	 * If the mapping already contains the requested offset, just adjust
-	 * requested_offset_in_mapping.
+	 * If the mapping already contains the requested range, just
+	 * adjust requested_offset_in_mapping.
 	 */
-	if (offset_ist_mapped(ds_file, requested_offset_in_file)) {
+	if (offset_ist_mapped(ds_file, requested_offset_in_file) &&
+			wanted_end <= (uint64_t) ds_file->mmap_offset_in_file +
+				ds_file->mmap_len) {
 		ds_file->request_offset_in_mapping =
 			requested_offset_in_file - ds_file->mmap_offset_in_file;
 		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
@@ -139,26 +235,68 @@ enum ctf_msg_iter_medium_status ds_file_mmap(
 	 * contains `requested_offset_in_file`.
 	 */
 	ds_file->request_offset_in_mapping =
-		requested_offset_in_file % bt_mmap_get_offset_align_size(ds_file->log_level);
+		requested_offset_in_file % offset_align;
 	ds_file->mmap_offset_in_file =
 		requested_offset_in_file - ds_file->request_offset_in_mapping;
+
+	/*
+	 * The file descriptor is only needed to create the mapping: give
+	 * it back to the cache right after, so that it may be closed.
+	 */
+	fd = ctf_fs_file_acquire_fd(ds_file->file);
+	if (fd < 0) {
+		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+		goto end;
+	}
+
+retry:
 	ds_file->mmap_len = MIN(ds_file->file->size - ds_file->mmap_offset_in_file,
-		ds_file->mmap_max_len);
+		MAX(ds_file->mmap_max_len,
+			wanted_end - ds_file->mmap_offset_in_file));
 
 	BT_ASSERT(ds_file->mmap_len > 0);
 
 	ds_file->mmap_addr = bt_mmap((void *) 0, ds_file->mmap_len,
-			PROT_READ, MAP_PRIVATE, fileno(ds_file->file->fp),
+			PROT_READ, MAP_PRIVATE, fd,
 			ds_file->mmap_offset_in_file, ds_file->log_level);
+	if (ds_file->mmap_addr == MAP_FAILED && errno == ENOMEM &&
+			ds_file->mmap_max_len > offset_align * 2048) {
+		/*
+		 * Not enough address space for such a large window
+		 * (typically, a whole file): fall back to a smaller one.
+		 */
+		BT_COMP_LOGW("Cannot memory-map %zu bytes of file \"%s\": "
+			"retrying with a smaller window: window-size=%zu",
+			ds_file->mmap_len, ds_file->file->path->str,
+			offset_align * 2048);
+		ds_file->mmap_addr = NULL;
+		ds_file->mmap_max_len = offset_align * 2048;
+		goto retry;
+	}
+
 	if (ds_file->mmap_addr == MAP_FAILED) {
-		BT_COMP_LOGE("Cannot memory-map address (size %zu) of file \"%s\" (%p) at offset %jd: %s",
+		BT_COMP_LOGE("Cannot memory-map address (size %zu) of file \"%s\" at offset %jd: %s",
 				ds_file->mmap_len, ds_file->file->path->str,
-				ds_file->file->fp, (intmax_t) ds_file->mmap_offset_in_file,
+				(intmax_t) ds_file->mmap_offset_in_file,
 				strerror(errno));
+		ctf_fs_file_release_fd(ds_file->file);
+		ds_file->mmap_addr = NULL;
 		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
 		goto end;
 	}
 
+	ctf_fs_file_release_fd(ds_file->file);
+	ds_file->mmap_count++;
+	ds_file->mmap_total_len += ds_file->mmap_len;
+	BT_COMP_LOGD("Memory-mapped file region: path=\"%s\", "
+		"offset=%jd, size=%zu, map-count=%" PRIu64,
+		ds_file->file->path->str,
+		(intmax_t) ds_file->mmap_offset_in_file, ds_file->mmap_len,
+		ds_file->mmap_count);
+
+	/* The message iterator reads the mapping from start to end. */
+	(void) bt_madvise(ds_file->mmap_addr, ds_file->mmap_len,
+		BT_MADV_SEQUENTIAL);
 	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
 
 end:
@@ -198,7 +336,7 @@ enum ctf_msg_iter_medium_status ds_file_mmap_next(
 	}
 
 	status = ds_file_mmap(ds_file,
-		ds_file->mmap_offset_in_file + ds_file->mmap_len);
+		ds_file->mmap_offset_in_file + ds_file->mmap_len, 0);
 
 end:
 	return status;
@@ -224,8 +362,8 @@ enum ctf_msg_iter_medium_status medop_request_bytes(
 	if (remaining_mmap_bytes(ds_file) == 0) {
 		/* Are we at the end of the file? */
 		if (ds_file->mmap_offset_in_file >= ds_file->file->size) {
-			BT_COMP_LOGD("Reached end of file \"%s\" (%p)",
-				ds_file->file->path->str, ds_file->file->fp);
+			BT_COMP_LOGD("Reached end of file \"%s\"",
+				ds_file->file->path->str);
 			status = CTF_MSG_ITER_MEDIUM_STATUS_EOF;
 			goto end;
 		}
@@ -237,9 +375,8 @@ enum ctf_msg_iter_medium_status medop_request_bytes(
 		case CTF_MSG_ITER_MEDIUM_STATUS_EOF:
 			goto end;
 		default:
-			BT_COMP_LOGE("Cannot memory-map next region of file \"%s\" (%p)",
-					ds_file->file->path->str,
-					ds_file->file->fp);
+			BT_COMP_LOGE("Cannot memory-map next region of file \"%s\"",
+					ds_file->file->path->str);
 			goto error;
 		}
 	}
@@ -293,7 +430,7 @@ enum ctf_msg_iter_medium_status medop_seek(off_t offset, void *data)
 	BT_ASSERT(offset >= 0);
 	BT_ASSERT(offset < ds_file->file->size);
 
-	return ds_file_mmap(ds_file, offset);
+	return ds_file_mmap(ds_file, offset, 0);
 }
 
 BT_HIDDEN
@@ -322,11 +459,51 @@ struct ctf_fs_ds_group_medops_data {
 	 */
 	struct ctf_fs_ds_file *file;
 
+	/*
+	 * Maximum number of packets to read ahead with a dedicated
+	 * thread, or 0 to read the packets from `file` on demand.
+	 */
+	guint read_ahead_depth;
+
+	/* How the read-ahead thread reads the packets */
+	enum ctf_fs_read_ahead_method read_ahead_method;
+
+	/*
+	 * Read-ahead thread reading the packets from the index entry at
+	 * rank `next_index_entry_index` when it was created, or `NULL`
+	 * if not started yet.
+	 *
+	 * Owned by this.
+	 */
+	struct ctf_fs_read_ahead *read_ahead;
+
+	/*
+	 * Packet we are currently reading when reading ahead, and offset,
+	 * within this packet, of the bytes to return on the next request.
+	 *
+	 * Owned by `read_ahead`.
+	 */
+	const struct ctf_fs_read_ahead_packet *read_ahead_packet;
+	size_t read_ahead_packet_offset;
+
 	/* Weak, for context / logging / appending causes. */
 	bt_self_message_iterator *self_msg_iter;
 	bt_logging_level log_level;
 };
 
+/*
+ * Stops the read-ahead thread of `data`, if any, and discards the
+ * packets it read.
+ */
+static
+void stop_read_ahead(struct ctf_fs_ds_group_medops_data *data)
+{
+	ctf_fs_read_ahead_destroy(data->read_ahead);
+	data->read_ahead = NULL;
+	data->read_ahead_packet = NULL;
+	data->read_ahead_packet_offset = 0;
+}
+
 static
 enum ctf_msg_iter_medium_status medop_group_request_bytes(
 		size_t request_sz,
@@ -335,9 +512,35 @@ enum ctf_msg_iter_medium_status medop_group_request_bytes(
 		void *void_data)
 {
 	struct ctf_fs_ds_group_medops_data *data = void_data;
+	enum ctf_msg_iter_medium_status status;
+
+	if (data->read_ahead_depth == 0) {
+		/* Return bytes from the current file. */
+		status = medop_request_bytes(request_sz, buffer_addr,
+			buffer_sz, data->file);
+		goto end;
+	}
 
-	/* Return bytes from the current file. */
-	return medop_request_bytes(request_sz, buffer_addr, buffer_sz, data->file);
+	/*
+	 * Return bytes from the current packet: the packet's size is
+	 * known, therefore it's fine to report the end of the medium
+	 * at the end of the packet.
+	 */
+	if (!data->read_ahead_packet || data->read_ahead_packet_offset ==
+			data->read_ahead_packet->size) {
+		status = CTF_MSG_ITER_MEDIUM_STATUS_EOF;
+		goto end;
+	}
+
+	*buffer_sz = MIN(request_sz, data->read_ahead_packet->size -
+		data->read_ahead_packet_offset);
+	*buffer_addr = data->read_ahead_packet->buf +
+		data->read_ahead_packet_offset;
+	data->read_ahead_packet_offset += *buffer_sz;
+	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+
+end:
+	return status;
 }
 
 static
@@ -347,29 +550,42 @@ bt_stream *medop_group_borrow_stream(
 		void *void_data)
 {
 	struct ctf_fs_ds_group_medops_data *data = void_data;
+	bt_stream *stream = NULL;
+
+	if (stream_class != bt_stream_borrow_class(
+			data->ds_file_group->stream)) {
+		/*
+		 * Not supported: two packets described by two different
+		 * stream classes within the same data stream file group.
+		 */
+		goto end;
+	}
 
-	return medop_borrow_stream(stream_class, stream_id, data->file);
+	stream = data->ds_file_group->stream;
+
+end:
+	return stream;
 }
 
 /*
- * Set `data->file` to prepare it to read the packet described
- * by `index_entry`.
+ * Set `data->file` to prepare it to read the packet of `packet_size`
+ * bytes at offset `offset` of the data stream file `path`.
  */
 
 static
 enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_set_file(
 		struct ctf_fs_ds_group_medops_data *data,
-		struct ctf_fs_ds_index_entry *index_entry,
+		const char *path, uint64_t offset, uint64_t packet_size,
 		bt_self_message_iterator *self_msg_iter,
 		bt_logging_level log_level)
 {
 	enum ctf_msg_iter_medium_status status;
 
 	BT_ASSERT(data);
-	BT_ASSERT(index_entry);
+	BT_ASSERT(path);
 
 	/* Check if that file is already the one mapped. */
-	if (!data->file || strcmp(index_entry->path, data->file->file->path->str) != 0) {
+	if (!data->file || strcmp(path, data->file->file->path->str) != 0) {
 		/* Destroy the previously used file. */
 		ctf_fs_ds_file_destroy(data->file);
 
@@ -378,7 +594,7 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_set_file(
 			data->ds_file_group->ctf_fs_trace,
 			self_msg_iter,
 			data->ds_file_group->stream,
-			index_entry->path,
+			path,
 			log_level);
 		if (!data->file) {
 			BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
@@ -392,7 +608,7 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_set_file(
 	 * Ensure the right portion of the file will be returned on the next
 	 * request_bytes call.
 	 */
-	status = ds_file_mmap(data->file, index_entry->offset);
+	status = ds_file_mmap(data->file, offset, packet_size);
 	if (status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
 		goto end;
 	}
@@ -403,16 +619,62 @@ end:
 	return status;
 }
 
+static
+enum ctf_msg_iter_medium_status read_ahead_switch_packet(
+		struct ctf_fs_ds_group_medops_data *data)
+{
+	enum ctf_msg_iter_medium_status status;
+
+	if (!data->read_ahead) {
+		if (data->next_index_entry_index >=
+				data->ds_file_group->index->len) {
+			status = CTF_MSG_ITER_MEDIUM_STATUS_EOF;
+			goto end;
+		}
+
+		data->read_ahead = ctf_fs_read_ahead_create(
+			data->ds_file_group->index,
+			data->next_index_entry_index, data->read_ahead_depth,
+			data->read_ahead_method,
+			data->ds_file_group->ctf_fs_trace->fd_cache,
+			data->self_msg_iter, data->log_level);
+		if (!data->read_ahead) {
+			status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+	/* This also gives the current packet back to the read-ahead thread. */
+	data->read_ahead_packet = NULL;
+	data->read_ahead_packet_offset = 0;
+
+	status = ctf_fs_read_ahead_next_packet(data->read_ahead,
+		&data->read_ahead_packet);
+	if (status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
+		goto end;
+	}
+
+	data->next_index_entry_index++;
+
+end:
+	return status;
+}
+
 static
 enum ctf_msg_iter_medium_status medop_group_switch_packet(void *void_data)
 {
 	struct ctf_fs_ds_group_medops_data *data = void_data;
-	struct ctf_fs_ds_index_entry *index_entry;
+	struct ctf_fs_ds_index *index = data->ds_file_group->index;
 	enum ctf_msg_iter_medium_status status;
 
+	if (data->read_ahead_depth > 0) {
+		status = read_ahead_switch_packet(data);
+		goto end;
+	}
+
 	/* If we have gone through all index entries, we are done. */
 	if (data->next_index_entry_index >=
-		data->ds_file_group->index->entries->len) {
+		data->ds_file_group->index->len) {
 		status = CTF_MSG_ITER_MEDIUM_STATUS_EOF;
 		goto end;
 	}
@@ -421,18 +683,31 @@ enum ctf_msg_iter_medium_status medop_group_switch_packet(void *void_data)
 	 * Otherwise, look up the next index entry / packet and prepare it
 	 *  for reading.
 	 */
-	index_entry = g_ptr_array_index(
-		data->ds_file_group->index->entries,
-		data->next_index_entry_index);
-
-	status = ctf_fs_ds_group_medops_set_file(
-		data, index_entry, data->self_msg_iter, data->log_level);
+	status = ctf_fs_ds_group_medops_set_file(data,
+		ctf_fs_ds_index_get_path(index, data->next_index_entry_index),
+		index->offsets[data->next_index_entry_index],
+		index->packet_sizes[data->next_index_entry_index],
+		data->self_msg_iter, data->log_level);
 	if (status != CTF_MSG_ITER_MEDIUM_STATUS_OK) {
 		goto end;
 	}
 
 	data->next_index_entry_index++;
 
+	/*
+	 * Have the system start reading the next packet while the
+	 * message iterator decodes this one.
+	 */
+	if (data->next_index_entry_index < index->len &&
+			ctf_fs_ds_index_get_path(index,
+				data->next_index_entry_index) ==
+			ctf_fs_ds_index_get_path(index,
+				data->next_index_entry_index - 1)) {
+		ds_file_advise_willneed(data->file,
+			index->offsets[data->next_index_entry_index],
+			index->packet_sizes[data->next_index_entry_index]);
+	}
+
 	status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
 end:
 	return status;
@@ -446,6 +721,7 @@ void ctf_fs_ds_group_medops_data_destroy(
 		goto end;
 	}
 
+	stop_read_ahead(data);
 	ctf_fs_ds_file_destroy(data->file);
 
 	g_free(data);
@@ -457,6 +733,8 @@ end:
 enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 		struct ctf_fs_ds_file_group *ds_file_group,
 		bt_self_message_iterator *self_msg_iter,
+		guint read_ahead_depth,
+		enum ctf_fs_read_ahead_method read_ahead_method,
 		bt_logging_level log_level,
 		struct ctf_fs_ds_group_medops_data **out)
 {
@@ -466,7 +744,7 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 	BT_ASSERT(self_msg_iter);
 	BT_ASSERT(ds_file_group);
 	BT_ASSERT(ds_file_group->index);
-	BT_ASSERT(ds_file_group->index->entries->len > 0);
+	BT_ASSERT(ds_file_group->index->len > 0);
 
 	data = g_new0(struct ctf_fs_ds_group_medops_data, 1);
 	if (!data) {
@@ -478,6 +756,8 @@ enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 
 	data->ds_file_group = ds_file_group;
 	data->self_msg_iter = self_msg_iter;
+	data->read_ahead_depth = read_ahead_depth;
+	data->read_ahead_method = read_ahead_method;
 	data->log_level = log_level;
 
 	/*
@@ -499,9 +779,19 @@ end:
 
 void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data)
 {
+	stop_read_ahead(data);
 	data->next_index_entry_index = 0;
 }
 
+void ctf_fs_ds_group_medops_data_set_next_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index)
+{
+	BT_ASSERT(index_entry_index < data->ds_file_group->index->len);
+	stop_read_ahead(data);
+	data->next_index_entry_index = index_entry_index;
+}
+
 struct ctf_msg_iter_medium_ops ctf_fs_ds_group_medops = {
 	.request_bytes = medop_group_request_bytes,
 	.borrow_stream = medop_group_borrow_stream,
@@ -514,22 +804,11 @@ struct ctf_msg_iter_medium_ops ctf_fs_ds_group_medops = {
 	.seek = NULL,
 };
 
-static
-struct ctf_fs_ds_index_entry *ctf_fs_ds_index_entry_create(
-		bt_self_component *self_comp, bt_logging_level log_level)
+BT_HIDDEN
+void ctf_fs_ds_index_entry_init(struct ctf_fs_ds_index_entry *entry)
 {
-	struct ctf_fs_ds_index_entry *entry;
-
-	entry = g_new0(struct ctf_fs_ds_index_entry, 1);
-	if (!entry) {
-		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to allocate a ctf_fs_ds_index_entry.");
-		goto end;
-	}
-
+	memset(entry, 0, sizeof(*entry));
 	entry->packet_seq_num = UINT64_MAX;
-
-end:
-	return entry;
 }
 
 static
@@ -557,7 +836,7 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 	const char *mmap_begin = NULL, *file_pos = NULL;
 	const struct ctf_packet_index_file_hdr *header = NULL;
 	struct ctf_fs_ds_index *index = NULL;
-	struct ctf_fs_ds_index_entry *index_entry = NULL, *prev_index_entry = NULL;
+	struct ctf_fs_ds_index_entry index_entry;
 	uint64_t total_packets_size = 0;
 	size_t file_index_entry_size;
 	size_t file_entry_count;
@@ -605,6 +884,15 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 		goto error;
 	}
 
+	/*
+	 * The index of a compressed data stream file is the one of the
+	 * original file.
+	 */
+	if (ds_file->zstd_file) {
+		g_string_truncate(index_basename, index_basename->len -
+			strlen(CTF_FS_ZSTD_FILE_SUFFIX));
+	}
+
 	g_string_append(index_basename, ".idx");
 	index_file_path = g_build_filename(directory, "index",
 			index_basename->str, NULL);
@@ -672,67 +960,61 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 			goto error;
 		}
 
-		index_entry = ctf_fs_ds_index_entry_create(
-			ds_file->self_comp, ds_file->log_level);
-		if (!index_entry) {
-			BT_COMP_LOGE_APPEND_CAUSE(ds_file->self_comp,
-				"Failed to create a ctf_fs_ds_index_entry.");
-			goto error;
-		}
+		ctf_fs_ds_index_entry_init(&index_entry);
 
 		/* Set path to stream file. */
-		index_entry->path = file_info->path->str;
+		index_entry.path = file_info->path->str;
 
 		/* Convert size in bits to bytes. */
 		packet_size /= CHAR_BIT;
-		index_entry->packet_size = packet_size;
+		index_entry.packet_size = packet_size;
 
-		index_entry->offset = be64toh(file_index->offset);
-		if (i != 0 && index_entry->offset < prev_index_entry->offset) {
+		index_entry.offset = be64toh(file_index->offset);
+		if (i != 0 && index_entry.offset <
+				index->offsets[index->len - 1]) {
 			BT_COMP_LOGW("Invalid, non-monotonic, packet offset encountered in LTTng trace index file: "
 				"previous offset=%" PRIu64 ", current offset=%" PRIu64,
-				prev_index_entry->offset, index_entry->offset);
+				index->offsets[index->len - 1],
+				index_entry.offset);
 			goto error;
 		}
 
-		index_entry->timestamp_begin = be64toh(file_index->timestamp_begin);
-		index_entry->timestamp_end = be64toh(file_index->timestamp_end);
-		if (index_entry->timestamp_end < index_entry->timestamp_begin) {
+		index_entry.timestamp_begin = be64toh(file_index->timestamp_begin);
+		index_entry.timestamp_end = be64toh(file_index->timestamp_end);
+		index_entry.orig_timestamp_begin = index_entry.timestamp_begin;
+		index_entry.orig_timestamp_end = index_entry.timestamp_end;
+		if (index_entry.timestamp_end < index_entry.timestamp_begin) {
 			BT_COMP_LOGW("Invalid packet time bounds encountered in LTTng trace index file (begin > end): "
 				"timestamp_begin=%" PRIu64 "timestamp_end=%" PRIu64,
-				index_entry->timestamp_begin,
-				index_entry->timestamp_end);
+				index_entry.timestamp_begin,
+				index_entry.timestamp_end);
 			goto error;
 		}
 
 		/* Convert the packet's bound to nanoseconds since Epoch. */
 		ret = convert_cycles_to_ns(sc->default_clock_class,
-				index_entry->timestamp_begin,
-				&index_entry->timestamp_begin_ns);
+				index_entry.timestamp_begin,
+				&index_entry.timestamp_begin_ns);
 		if (ret) {
 			BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch during index parsing");
 			goto error;
 		}
 		ret = convert_cycles_to_ns(sc->default_clock_class,
-				index_entry->timestamp_end,
-				&index_entry->timestamp_end_ns);
+				index_entry.timestamp_end,
+				&index_entry.timestamp_end_ns);
 		if (ret) {
 			BT_COMP_LOGI_STR("Failed to convert raw timestamp to nanoseconds since Epoch during LTTng trace index parsing");
 			goto error;
 		}
 
 		if (version_minor >= 1) {
-			index_entry->packet_seq_num = be64toh(file_index->packet_seq_num);
+			index_entry.packet_seq_num = be64toh(file_index->packet_seq_num);
 		}
 
 		total_packets_size += packet_size;
 		file_pos += file_index_entry_size;
 
-		prev_index_entry = index_entry;
-
-		/* Give ownership of `index_entry` to `index->entries`. */
-		g_ptr_array_add(index->entries, index_entry);
-		index_entry = NULL;
+		ctf_fs_ds_index_append_entry(index, &index_entry);
 	}
 
 	/* Validate that the index addresses the complete stream. */
@@ -755,7 +1037,6 @@ end:
 	return index;
 error:
 	ctf_fs_ds_index_destroy(index);
-	g_free(index_entry);
 	index = NULL;
 	goto end;
 }
@@ -811,6 +1092,9 @@ int init_index_entry(struct ctf_fs_ds_index_entry *entry,
 		entry->timestamp_end_ns = UINT64_C(-1);
 	}
 
+	entry->orig_timestamp_begin = entry->timestamp_begin;
+	entry->orig_timestamp_end = entry->timestamp_end;
+
 end:
 	return ret;
 }
@@ -837,7 +1121,7 @@ struct ctf_fs_ds_index *build_index_from_stream_file(
 
 	while (true) {
 		off_t current_packet_size_bytes;
-		struct ctf_fs_ds_index_entry *index_entry;
+		struct ctf_fs_ds_index_entry index_entry;
 		struct ctf_msg_iter_packet_properties props;
 
 		if (current_packet_offset_bytes < 0) {
@@ -882,25 +1166,18 @@ struct ctf_fs_ds_index *build_index_from_stream_file(
 			goto error;
 		}
 
-		index_entry = ctf_fs_ds_index_entry_create(
-			ds_file->self_comp, ds_file->log_level);
-		if (!index_entry) {
-			BT_COMP_LOGE_APPEND_CAUSE(ds_file->self_comp,
-				"Failed to create a ctf_fs_ds_index_entry.");
-			goto error;
-		}
+		ctf_fs_ds_index_entry_init(&index_entry);
 
 		/* Set path to stream file. */
-		index_entry->path = file_info->path->str;
+		index_entry.path = file_info->path->str;
 
-		ret = init_index_entry(index_entry, ds_file, &props,
+		ret = init_index_entry(&index_entry, ds_file, &props,
 			current_packet_size_bytes, current_packet_offset_bytes);
 		if (ret) {
-			g_free(index_entry);
 			goto error;
 		}
 
-		g_ptr_array_add(index->entries, index_entry);
+		ctf_fs_ds_index_append_entry(index, &index_entry);
 
 		current_packet_offset_bytes += current_packet_size_bytes;
 		BT_COMP_LOGD("Seeking to next packet: current-packet-offset=%jd, "
@@ -945,12 +1222,35 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 	bt_stream_get_ref(ds_file->stream);
 	ds_file->metadata = ctf_fs_trace->metadata;
 	g_string_assign(ds_file->file->path, path);
-	ret = ctf_fs_file_open(ds_file->file, "rb");
+	ret = ctf_fs_file_open_from_cache(ds_file->file, ctf_fs_trace->fd_cache);
 	if (ret) {
 		goto error;
 	}
 
-	ds_file->mmap_max_len = offset_align * 2048;
+	if (ctf_fs_zstd_file_is_compressed_path(path)) {
+		ds_file->zstd_file = ctf_fs_zstd_file_create(
+			bt_fd_cache_handle_get_fd(ds_file->file->fd_handle),
+			path, ds_file->file->size, ds_file->self_comp,
+			log_level);
+		if (!ds_file->zstd_file) {
+			goto error;
+		}
+
+		/* From now on, read the decompressed data. */
+		ds_file->file->size = (off_t) ds_file->zstd_file->size;
+	}
+
+	/* ds_file_mmap() reacquires it on demand. */
+	ctf_fs_file_release_fd(ds_file->file);
+
+	if (ctf_fs_trace->mmap_window_size ==
+			CTF_FS_DS_FILE_MMAP_WINDOW_WHOLE_FILE) {
+		/* ds_file_mmap() limits the mapping to the file. */
+		ds_file->mmap_max_len = SIZE_MAX - offset_align + 1;
+	} else {
+		ds_file->mmap_max_len = ALIGN(ctf_fs_trace->mmap_window_size,
+			offset_align);
+	}
 
 	goto end;
 
@@ -963,11 +1263,74 @@ end:
 	return ds_file;
 }
 
+static
+struct ctf_fs_ds_index *build_index_from_index_cache(
+		struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_file_info *file_info,
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir)
+{
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_stream_class *sc;
+	struct ctf_msg_iter_packet_properties props;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	if (ctf_msg_iter_get_packet_properties(msg_iter, &props)) {
+		BT_COMP_LOGI_STR("Cannot read first packet's header and context fields.");
+		goto end;
+	}
+
+	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
+		props.stream_class_id);
+	BT_ASSERT(sc);
+	index = ctf_fs_index_cache_load(index_cache_dir, ds_file, file_info,
+		sc->default_clock_class);
+
+end:
+	return index;
+}
+
+/*
+ * Sets the frame offsets and sizes of the entries of `index`, the index
+ * of the compressed data stream file `ds_file`.
+ *
+ * Returns -1 if a packet doesn't begin and end at frame boundaries.
+ */
+static
+int ds_index_map_zstd_frames(struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_index *index)
+{
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+	guint i;
+	int ret = 0;
+
+	for (i = 0; i < index->len; i++) {
+		ret = ctf_fs_zstd_file_find_frames(ds_file->zstd_file,
+			index->offsets[i], index->packet_sizes[i],
+			&index->frame_offsets[i], &index->frame_sizes[i]);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Packet of compressed data stream file doesn't "
+				"begin and end at zstd frame boundaries: "
+				"path=\"%s\", packet-offset=%" PRIu64 ", "
+				"packet-size=%" PRIu64, ds_file->file->path->str,
+				index->offsets[i], index->packet_sizes[i]);
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *file_info,
-		struct ctf_msg_iter *msg_iter)
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir)
 {
 	struct ctf_fs_ds_index *index;
 	bt_self_component *self_comp = ds_file->self_comp;
@@ -978,10 +1341,31 @@ struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		goto end;
 	}
 
+	if (index_cache_dir) {
+		index = build_index_from_index_cache(ds_file, file_info,
+			msg_iter, index_cache_dir);
+		if (index) {
+			file_info->index_from_cache = true;
+			goto end;
+		}
+	}
+
 	BT_COMP_LOGI("Failed to build index from .index file; "
 		"falling back to stream indexing.");
 	index = build_index_from_stream_file(ds_file, file_info, msg_iter);
+	if (index && index_cache_dir) {
+		file_info->index_cache_entry_count = index->len;
+		file_info->size = ds_file->file->size;
+		file_info->mtime_ns = ds_file->file->mtime_ns;
+	}
+
 end:
+	if (index && ds_file->zstd_file &&
+			ds_index_map_zstd_frames(ds_file, index)) {
+		ctf_fs_ds_index_destroy(index);
+		index = NULL;
+	}
+
 	return index;
 }
 
@@ -997,10 +1381,10 @@ struct ctf_fs_ds_index *ctf_fs_ds_index_create(bt_logging_level log_level,
 		goto error;
 	}
 
-	index->entries = g_ptr_array_new_with_free_func((GDestroyNotify) g_free);
-	if (!index->entries) {
+	index->paths = g_ptr_array_new();
+	if (!index->paths) {
 		BT_COMP_LOG_CUR_LVL(BT_LOG_ERROR, log_level, self_comp,
-			"Failed to allocate index entries.");
+			"Failed to allocate index paths.");
 		goto error;
 	}
 
@@ -1013,6 +1397,330 @@ end:
 	return index;
 }
 
+static
+void ds_index_free_columns(struct ctf_fs_ds_index *index)
+{
+	g_free(index->path_ids);
+	g_free(index->offsets);
+	g_free(index->packet_sizes);
+	g_free(index->timestamps_begin);
+	g_free(index->timestamps_end);
+	g_free(index->timestamps_begin_ns);
+	g_free(index->timestamps_end_ns);
+	g_free(index->orig_timestamps_begin);
+	g_free(index->orig_timestamps_end);
+	g_free(index->packet_seq_nums);
+	g_free(index->frame_offsets);
+	g_free(index->frame_sizes);
+}
+
+/*
+ * Makes sure that each column of `index` can contain at least
+ * `capacity` elements.
+ */
+static
+void ds_index_reserve(struct ctf_fs_ds_index *index, guint capacity)
+{
+	if (capacity <= index->capacity) {
+		goto end;
+	}
+
+	capacity = MAX(capacity, MAX(index->capacity * 2, 16));
+	index->path_ids = g_renew(guint32, index->path_ids, capacity);
+	index->offsets = g_renew(uint64_t, index->offsets, capacity);
+	index->packet_sizes = g_renew(uint64_t, index->packet_sizes, capacity);
+	index->timestamps_begin = g_renew(uint64_t, index->timestamps_begin,
+		capacity);
+	index->timestamps_end = g_renew(uint64_t, index->timestamps_end,
+		capacity);
+	index->timestamps_begin_ns = g_renew(int64_t,
+		index->timestamps_begin_ns, capacity);
+	index->timestamps_end_ns = g_renew(int64_t, index->timestamps_end_ns,
+		capacity);
+	index->orig_timestamps_begin = g_renew(uint64_t,
+		index->orig_timestamps_begin, capacity);
+	index->orig_timestamps_end = g_renew(uint64_t,
+		index->orig_timestamps_end, capacity);
+	index->packet_seq_nums = g_renew(uint64_t, index->packet_seq_nums,
+		capacity);
+	index->frame_offsets = g_renew(uint64_t, index->frame_offsets,
+		capacity);
+	index->frame_sizes = g_renew(uint64_t, index->frame_sizes, capacity);
+	index->capacity = capacity;
+
+end:
+	return;
+}
+
+/*
+ * Returns the rank of `path` within the interned paths of `index`,
+ * adding it if needed.
+ */
+static
+guint32 ds_index_intern_path(struct ctf_fs_ds_index *index, const char *path)
+{
+	guint i;
+
+	BT_ASSERT(path);
+
+	/* Consecutive entries almost always share their path. */
+	if (index->len > 0 && ctf_fs_ds_index_get_path(index,
+			index->len - 1) == path) {
+		i = index->path_ids[index->len - 1];
+		goto end;
+	}
+
+	for (i = 0; i < index->paths->len; i++) {
+		if (g_ptr_array_index(index->paths, i) == path) {
+			goto end;
+		}
+	}
+
+	g_ptr_array_add(index->paths, (gpointer) path);
+
+end:
+	return (guint32) i;
+}
+
+/*
+ * Appends the entry at rank `src_i` of `src` to `dest`, setting its
+ * path ID to `path_id`, a path ID of `dest`.
+ */
+static
+void ds_index_append_entry_from_index(struct ctf_fs_ds_index *dest,
+		const struct ctf_fs_ds_index *src, guint src_i, guint32 path_id)
+{
+	const guint i = dest->len;
+
+	ds_index_reserve(dest, i + 1);
+	dest->path_ids[i] = path_id;
+	dest->offsets[i] = src->offsets[src_i];
+	dest->packet_sizes[i] = src->packet_sizes[src_i];
+	dest->timestamps_begin[i] = src->timestamps_begin[src_i];
+	dest->timestamps_end[i] = src->timestamps_end[src_i];
+	dest->timestamps_begin_ns[i] = src->timestamps_begin_ns[src_i];
+	dest->timestamps_end_ns[i] = src->timestamps_end_ns[src_i];
+	dest->orig_timestamps_begin[i] = src->orig_timestamps_begin[src_i];
+	dest->orig_timestamps_end[i] = src->orig_timestamps_end[src_i];
+	dest->packet_seq_nums[i] = src->packet_seq_nums[src_i];
+	dest->frame_offsets[i] = src->frame_offsets[src_i];
+	dest->frame_sizes[i] = src->frame_sizes[src_i];
+	dest->len++;
+}
+
+BT_HIDDEN
+void ctf_fs_ds_index_append_entry(struct ctf_fs_ds_index *index,
+		const struct ctf_fs_ds_index_entry *entry)
+{
+	const guint32 path_id = ds_index_intern_path(index, entry->path);
+	const guint i = index->len;
+
+	ds_index_reserve(index, i + 1);
+	index->path_ids[i] = path_id;
+	index->offsets[i] = entry->offset;
+	index->packet_sizes[i] = entry->packet_size;
+	index->timestamps_begin[i] = entry->timestamp_begin;
+	index->timestamps_end[i] = entry->timestamp_end;
+	index->timestamps_begin_ns[i] = entry->timestamp_begin_ns;
+	index->timestamps_end_ns[i] = entry->timestamp_end_ns;
+	index->orig_timestamps_begin[i] = entry->orig_timestamp_begin;
+	index->orig_timestamps_end[i] = entry->orig_timestamp_end;
+	index->packet_seq_nums[i] = entry->packet_seq_num;
+
+	/* See ds_index_map_zstd_frames() for compressed files. */
+	index->frame_offsets[i] = entry->offset;
+	index->frame_sizes[i] = entry->packet_size;
+	index->len++;
+}
+
+/*
+ * Returns whether or not the entry at rank `left_i` of `left` and the
+ * entry at rank `right_i` of `right` describe the same packet.
+ */
+static
+bool ds_index_entries_equal(const struct ctf_fs_ds_index *left, guint left_i,
+		const struct ctf_fs_ds_index *right, guint right_i)
+{
+	return left->packet_sizes[left_i] == right->packet_sizes[right_i] &&
+		left->orig_timestamps_begin[left_i] ==
+			right->orig_timestamps_begin[right_i] &&
+		left->orig_timestamps_end[left_i] ==
+			right->orig_timestamps_end[right_i] &&
+		left->packet_seq_nums[left_i] == right->packet_seq_nums[right_i];
+}
+
+BT_HIDDEN
+void ctf_fs_ds_index_merge(struct ctf_fs_ds_index *dest,
+		const struct ctf_fs_ds_index *src)
+{
+	struct ctf_fs_ds_index merged = { 0 };
+	guint32 *src_path_ids;
+	guint dest_i = 0;
+	guint src_i;
+
+	if (src->len == 0) {
+		goto end;
+	}
+
+	/* Map the path IDs of `src` to path IDs of `dest`. */
+	src_path_ids = g_new(guint32, src->paths->len);
+	for (src_i = 0; src_i < src->paths->len; src_i++) {
+		src_path_ids[src_i] = ds_index_intern_path(dest,
+			g_ptr_array_index(src->paths, src_i));
+	}
+
+	if (dest->len == 0 || dest->timestamps_begin_ns[dest->len - 1] <
+			src->timestamps_begin_ns[0]) {
+		/*
+		 * Common case: the packets of `src` come after the
+		 * packets of `dest` (for example, the next data stream
+		 * file of a rotated stream): append them.
+		 */
+		ds_index_reserve(dest, dest->len + src->len);
+
+		for (src_i = 0; src_i < src->len; src_i++) {
+			ds_index_append_entry_from_index(dest, src, src_i,
+				src_path_ids[src->path_ids[src_i]]);
+		}
+
+		goto free_src_path_ids;
+	}
+
+	/*
+	 * Merge both sorted runs into `merged`, keeping the entries of
+	 * `src` which begin at the same time as entries of `dest` before
+	 * them, then replace the columns of `dest` with the ones of
+	 * `merged`.
+	 */
+	ds_index_reserve(&merged, dest->len + src->len);
+	src_i = 0;
+
+	while (dest_i < dest->len || src_i < src->len) {
+		if (src_i == src->len || (dest_i < dest->len &&
+				dest->timestamps_begin_ns[dest_i] <
+				src->timestamps_begin_ns[src_i])) {
+			ds_index_append_entry_from_index(&merged, dest, dest_i,
+				dest->path_ids[dest_i]);
+			dest_i++;
+			continue;
+		}
+
+		/*
+		 * There can be duplicate packets if reading multiple
+		 * overlapping snapshots of the same trace. We then want
+		 * the index to contain a reference to only one copy of
+		 * that packet.
+		 */
+		if ((dest_i < dest->len && ds_index_entries_equal(src, src_i,
+					dest, dest_i)) ||
+				(merged.len > 0 && ds_index_entries_equal(src,
+					src_i, &merged, merged.len - 1))) {
+			src_i++;
+			continue;
+		}
+
+		ds_index_append_entry_from_index(&merged, src, src_i,
+			src_path_ids[src->path_ids[src_i]]);
+		src_i++;
+	}
+
+	ds_index_free_columns(dest);
+	merged.paths = dest->paths;
+	*dest = merged;
+
+free_src_path_ids:
+	g_free(src_path_ids);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+void ctf_fs_ds_index_keep_range(struct ctf_fs_ds_index *index, guint first,
+		guint count)
+{
+	BT_ASSERT(first + count <= index->len);
+
+	if (first > 0 && count > 0) {
+		memmove(index->path_ids, &index->path_ids[first],
+			count * sizeof(*index->path_ids));
+		memmove(index->offsets, &index->offsets[first],
+			count * sizeof(*index->offsets));
+		memmove(index->packet_sizes, &index->packet_sizes[first],
+			count * sizeof(*index->packet_sizes));
+		memmove(index->timestamps_begin,
+			&index->timestamps_begin[first],
+			count * sizeof(*index->timestamps_begin));
+		memmove(index->timestamps_end, &index->timestamps_end[first],
+			count * sizeof(*index->timestamps_end));
+		memmove(index->timestamps_begin_ns,
+			&index->timestamps_begin_ns[first],
+			count * sizeof(*index->timestamps_begin_ns));
+		memmove(index->timestamps_end_ns,
+			&index->timestamps_end_ns[first],
+			count * sizeof(*index->timestamps_end_ns));
+		memmove(index->orig_timestamps_begin,
+			&index->orig_timestamps_begin[first],
+			count * sizeof(*index->orig_timestamps_begin));
+		memmove(index->orig_timestamps_end,
+			&index->orig_timestamps_end[first],
+			count * sizeof(*index->orig_timestamps_end));
+		memmove(index->packet_seq_nums, &index->packet_seq_nums[first],
+			count * sizeof(*index->packet_seq_nums));
+		memmove(index->frame_offsets, &index->frame_offsets[first],
+			count * sizeof(*index->frame_offsets));
+		memmove(index->frame_sizes, &index->frame_sizes[first],
+			count * sizeof(*index->frame_sizes));
+	}
+
+	index->len = count;
+}
+
+BT_HIDDEN
+guint ctf_fs_ds_index_find_entry_index_by_ns(struct ctf_fs_ds_index *index,
+		int64_t ns_from_origin)
+{
+	guint low = 0;
+	guint high;
+	guint entry_index;
+
+	BT_ASSERT(index);
+	BT_ASSERT(index->len > 0);
+
+	/*
+	 * Entries are sorted by beginning time: find the rank of the
+	 * first entry which begins strictly after `ns_from_origin`.
+	 */
+	high = index->len;
+	while (low < high) {
+		const guint mid = low + (high - low) / 2;
+
+		if (index->timestamps_begin_ns[mid] <= ns_from_origin) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	/*
+	 * The entry before that one is the last one which begins at or
+	 * before `ns_from_origin`: it contains `ns_from_origin` unless it
+	 * ends before it, in which case the next packets are the
+	 * candidates.
+	 */
+	entry_index = low > 0 ? low - 1 : 0;
+
+	while (entry_index < index->len - 1) {
+		if (index->timestamps_end_ns[entry_index] >= ns_from_origin) {
+			break;
+		}
+
+		entry_index++;
+	}
+
+	return entry_index;
+}
+
 BT_HIDDEN
 void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 {
@@ -1020,8 +1728,20 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 		return;
 	}
 
+	if (ds_file->mmap_count > 0) {
+		bt_self_component *self_comp = ds_file->self_comp;
+		bt_logging_level log_level = ds_file->log_level;
+
+		BT_COMP_LOGI("Memory-mapping statistics of data stream file: "
+			"path=\"%s\", map-count=%" PRIu64 ", "
+			"total-mapped-size=%" PRIu64 ", window-size=%zu",
+			ds_file->file->path->str, ds_file->mmap_count,
+			ds_file->mmap_total_len, ds_file->mmap_max_len);
+	}
+
 	bt_stream_put_ref(ds_file->stream);
 	(void) ds_file_munmap(ds_file);
+	ctf_fs_zstd_file_destroy(ds_file->zstd_file);
 
 	if (ds_file->file) {
 		ctf_fs_file_destroy(ds_file->file);
@@ -1037,8 +1757,10 @@ void ctf_fs_ds_index_destroy(struct ctf_fs_ds_index *index)
 		return;
 	}
 
-	if (index->entries) {
-		g_ptr_array_free(index->entries, TRUE);
+	if (index->paths) {
+		g_ptr_array_free(index->paths, TRUE);
 	}
+
+	ds_index_free_columns(index);
 	g_free(index);
 }
@@ -25,12 +25,15 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 #include <glib.h>
 #include "common/macros.h"
 #include <babeltrace2/babeltrace.h>
 
 #include "../common/msg-iter/msg-iter.h"
 #include "lttng-index.h"
+#include "read-ahead.h"
 
 struct ctf_fs_component;
 struct ctf_fs_file;
@@ -38,6 +41,9 @@ struct ctf_fs_trace;
 struct ctf_fs_ds_file;
 struct ctf_fs_ds_file_group;
 struct ctf_fs_ds_group_medops_data;
+struct ctf_fs_ds_index;
+struct ctf_fs_zstd_file;
+struct ctf_fs_ds_index_entry;
 
 struct ctf_fs_ds_file_info {
 	/* Owned by this. */
@@ -45,6 +51,22 @@ struct ctf_fs_ds_file_info {
 
 	/* Guaranteed to be set, as opposed to the index. */
 	int64_t begin_ns;
+
+	/* True if the index entries of this file come from the index cache */
+	bool index_from_cache;
+
+	/*
+	 * Number of index entries built from this file to save to the
+	 * index cache, or 0 if there's nothing to save.
+	 */
+	guint index_cache_entry_count;
+
+	/*
+	 * Size and last modification time (nanoseconds since the Epoch)
+	 * of the file when indexed
+	 */
+	off_t size;
+	int64_t mtime_ns;
 };
 
 struct ctf_fs_metadata;
@@ -64,14 +86,25 @@ struct ctf_fs_ds_file {
 	/* Owned by this */
 	struct ctf_fs_file *file;
 
+	/*
+	 * Frames of a compressed data stream file, owned by this, or
+	 * `NULL` if the file is not compressed.
+	 *
+	 * For a compressed file, `file->size` is the size of the
+	 * decompressed data and the "mappings" below are decompressed
+	 * frames.
+	 */
+	struct ctf_fs_zstd_file *zstd_file;
+
 	/* Owned by this */
 	bt_stream *stream;
 
 	void *mmap_addr;
 
 	/*
-	 * Max length of chunk to mmap() when updating the current mapping.
-	 * This value must be page-aligned.
+	 * Max length of chunk to mmap() when updating the current mapping,
+	 * unless a whole packet needs more. This value must be
+	 * page-aligned.
 	 */
 	size_t mmap_max_len;
 
@@ -86,8 +119,29 @@ struct ctf_fs_ds_file {
 	 * request.
 	 */
 	off_t request_offset_in_mapping;
+
+	/* Number of mappings and total mapped length, for tuning */
+	uint64_t mmap_count;
+	uint64_t mmap_total_len;
 };
 
+/*
+ * Special maximum memory mapping window size: map whole data stream
+ * files.
+ */
+#define CTF_FS_DS_FILE_MMAP_WINDOW_WHOLE_FILE	0
+
+/*
+ * Default maximum memory mapping window size: whole data stream files
+ * when the address space is large enough.
+ */
+#if SIZE_MAX > UINT32_MAX
+# define CTF_FS_DS_FILE_MMAP_WINDOW_DEFAULT_SIZE \
+	CTF_FS_DS_FILE_MMAP_WINDOW_WHOLE_FILE
+#else
+# define CTF_FS_DS_FILE_MMAP_WINDOW_DEFAULT_SIZE	(8 * 1024 * 1024)
+#endif
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -98,11 +152,27 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 BT_HIDDEN
 void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *stream);
 
+/*
+ * Builds the index of `ds_file`.
+ *
+ * If `index_cache_dir` is not `NULL` and the data stream file has no
+ * LTTng index, this function tries to load the index from the index
+ * cache located in `index_cache_dir` first. If it builds the index
+ * from the data stream file instead, it marks `ds_file_info` as to be
+ * saved to the index cache.
+ */
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file,
 		struct ctf_fs_ds_file_info *ds_file_info,
-		struct ctf_msg_iter *msg_iter);
+		struct ctf_msg_iter *msg_iter,
+		const char *index_cache_dir);
+
+/*
+ * Initializes `entry` to an entry without any packet sequence number.
+ */
+BT_HIDDEN
+void ctf_fs_ds_index_entry_init(struct ctf_fs_ds_index_entry *entry);
 
 BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_index_create(bt_logging_level log_level,
@@ -111,6 +181,42 @@ struct ctf_fs_ds_index *ctf_fs_ds_index_create(bt_logging_level log_level,
 BT_HIDDEN
 void ctf_fs_ds_index_destroy(struct ctf_fs_ds_index *index);
 
+/*
+ * Appends a copy of `entry` to `index`.
+ */
+BT_HIDDEN
+void ctf_fs_ds_index_append_entry(struct ctf_fs_ds_index *index,
+		const struct ctf_fs_ds_index_entry *entry);
+
+/*
+ * Merges the entries of `src` into `dest`, keeping `dest` sorted, in
+ * linear time.
+ *
+ * This function doesn't add the entries of `src` which describe the
+ * same packet as an entry of `dest`. `src` is left unchanged.
+ */
+BT_HIDDEN
+void ctf_fs_ds_index_merge(struct ctf_fs_ds_index *dest,
+		const struct ctf_fs_ds_index *src);
+
+/*
+ * Only keeps the `count` entries of `index` starting at rank `first`.
+ */
+BT_HIDDEN
+void ctf_fs_ds_index_keep_range(struct ctf_fs_ds_index *index, guint first,
+		guint count);
+
+/*
+ * Returns the rank of the entry of `index` at which to start decoding to
+ * get the first message at or after `ns_from_origin`.
+ *
+ * This is the last entry if all the packets end before
+ * `ns_from_origin`. `index` must contain at least one entry.
+ */
+BT_HIDDEN
+guint ctf_fs_ds_index_find_entry_index_by_ns(struct ctf_fs_ds_index *index,
+		int64_t ns_from_origin);
+
 /*
  * Medium operations to iterate on a single ctf_fs_ds_file.
  *
@@ -129,16 +235,32 @@ extern struct ctf_msg_iter_medium_ops ctf_fs_ds_file_medops;
 BT_HIDDEN
 extern struct ctf_msg_iter_medium_ops ctf_fs_ds_group_medops;
 
+/*
+ * If `read_ahead_depth` is greater than 0, a dedicated thread reads up
+ * to `read_ahead_depth` packets ahead of the decoding into memory with
+ * `read_ahead_method`.
+ */
 BT_HIDDEN
 enum ctf_msg_iter_medium_status ctf_fs_ds_group_medops_data_create(
 		struct ctf_fs_ds_file_group *ds_file_group,
 		bt_self_message_iterator *self_msg_iter,
+		guint read_ahead_depth,
+		enum ctf_fs_read_ahead_method read_ahead_method,
 		bt_logging_level log_level,
 		struct ctf_fs_ds_group_medops_data **out);
 
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_reset(struct ctf_fs_ds_group_medops_data *data);
 
+/*
+ * Makes the next packet switch of `data` go to the packet described by
+ * the entry at rank `index_entry_index` of the group's index.
+ */
+BT_HIDDEN
+void ctf_fs_ds_group_medops_data_set_next_index_entry(
+		struct ctf_fs_ds_group_medops_data *data,
+		guint index_entry_index);
+
 BT_HIDDEN
 void ctf_fs_ds_group_medops_data_destroy(
 		struct ctf_fs_ds_group_medops_data *data);
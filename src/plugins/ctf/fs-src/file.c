@@ -30,8 +30,29 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <glib.h>
+#include "common/assert.h"
 #include "file.h"
 
+/*
+ * Returns the last modification time of `stat`, in nanoseconds since
+ * the Epoch, so that rewriting a file within the same second still
+ * changes it.
+ */
+static
+int64_t get_stat_mtime_ns(const struct stat *stat)
+{
+#if defined(__APPLE__)
+	return (int64_t) stat->st_mtimespec.tv_sec * INT64_C(1000000000) +
+		stat->st_mtimespec.tv_nsec;
+#elif defined(__MINGW32__)
+	/* No sub-second resolution */
+	return (int64_t) stat->st_mtime * INT64_C(1000000000);
+#else
+	return (int64_t) stat->st_mtim.tv_sec * INT64_C(1000000000) +
+		stat->st_mtim.tv_nsec;
+#endif
+}
+
 BT_HIDDEN
 void ctf_fs_file_destroy(struct ctf_fs_file *file)
 {
@@ -50,6 +71,8 @@ void ctf_fs_file_destroy(struct ctf_fs_file *file)
 		}
 	}
 
+	ctf_fs_file_release_fd(file);
+
 	if (file->path) {
 		g_string_free(file->path, TRUE);
 	}
@@ -109,6 +132,7 @@ int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode)
 	}
 
 	file->size = stat.st_size;
+	file->mtime_ns = get_stat_mtime_ns(&stat);
 	BT_COMP_LOGI("File is %jd bytes", (intmax_t) file->size);
 	goto end;
 
@@ -125,3 +149,74 @@ error:
 end:
 	return ret;
 }
+
+BT_HIDDEN
+int ctf_fs_file_open_from_cache(struct ctf_fs_file *file,
+		struct bt_fd_cache *fd_cache)
+{
+	int ret = 0;
+	int fd;
+	struct stat stat;
+
+	BT_ASSERT(!file->fp);
+	file->fd_cache = fd_cache;
+	fd = ctf_fs_file_acquire_fd(file);
+	if (fd < 0) {
+		BT_COMP_LOGE_APPEND_CAUSE(file->self_comp,
+			"Cannot open file: path=%s", file->path->str);
+		goto error;
+	}
+
+	if (fstat(fd, &stat)) {
+		BT_COMP_LOGE_APPEND_CAUSE_ERRNO(file->self_comp,
+			"Cannot get file information",
+			": path=%s", file->path->str);
+		goto error;
+	}
+
+	file->size = stat.st_size;
+	file->mtime_ns = get_stat_mtime_ns(&stat);
+	BT_COMP_LOGI("File is %jd bytes", (intmax_t) file->size);
+	goto end;
+
+error:
+	ret = -1;
+	ctf_fs_file_release_fd(file);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_file_acquire_fd(struct ctf_fs_file *file)
+{
+	int fd = -1;
+
+	BT_ASSERT(file->fd_cache);
+	BT_ASSERT(!file->fd_handle);
+	file->fd_handle = bt_fd_cache_get_handle(file->fd_cache,
+		file->path->str);
+	if (!file->fd_handle) {
+		BT_COMP_LOGE("Cannot get file descriptor from cache: "
+			"path=%s", file->path->str);
+		goto end;
+	}
+
+	fd = bt_fd_cache_handle_get_fd(file->fd_handle);
+	BT_COMP_LOGD("Acquired file descriptor: path=%s, fd=%d",
+		file->path->str, fd);
+
+end:
+	return fd;
+}
+
+BT_HIDDEN
+void ctf_fs_file_release_fd(struct ctf_fs_file *file)
+{
+	if (!file->fd_handle) {
+		return;
+	}
+
+	bt_fd_cache_put_handle(file->fd_cache, file->fd_handle);
+	file->fd_handle = NULL;
+}
@@ -38,4 +38,31 @@ struct ctf_fs_file *ctf_fs_file_create(bt_logging_level log_level,
 BT_HIDDEN
 int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode);
 
+/*
+ * Opens `file` for reading with a file descriptor from `fd_cache`
+ * instead of a `FILE` stream, keeping it acquired: call
+ * ctf_fs_file_release_fd() when you don't need it anymore.
+ */
+BT_HIDDEN
+int ctf_fs_file_open_from_cache(struct ctf_fs_file *file,
+		struct bt_fd_cache *fd_cache);
+
+/*
+ * Returns the file descriptor of `file`, opened with
+ * ctf_fs_file_open_from_cache(), reopening the file if needed, or -1
+ * on error.
+ *
+ * Every successful call must be followed by a call to
+ * ctf_fs_file_release_fd().
+ */
+BT_HIDDEN
+int ctf_fs_file_acquire_fd(struct ctf_fs_file *file);
+
+/*
+ * Gives the file descriptor of `file` back to its cache, which may
+ * close it.
+ */
+BT_HIDDEN
+void ctf_fs_file_release_fd(struct ctf_fs_file *file);
+
 #endif /* CTF_FS_FILE_H */
@@ -41,6 +41,9 @@
 #include "metadata.h"
 #include "data-stream-file.h"
 #include "file.h"
+#include "index-cache.h"
+#include "read-ahead.h"
+#include "worker-pool.h"
 #include "../common/metadata/decoder.h"
 #include "../common/metadata/ctf-meta-configure-ir-trace.h"
 #include "../common/msg-iter/msg-iter.h"
@@ -54,6 +57,16 @@ struct tracer_info {
 	int64_t patch;
 };
 
+static
+void ctf_fs_msg_iter_data_clear_pending_msgs(
+		struct ctf_fs_msg_iter_data *msg_iter_data)
+{
+	while (!g_queue_is_empty(msg_iter_data->pending_msgs)) {
+		bt_message_put_ref(
+			g_queue_pop_head(msg_iter_data->pending_msgs));
+	}
+}
+
 static
 void ctf_fs_msg_iter_data_destroy(
 		struct ctf_fs_msg_iter_data *msg_iter_data)
@@ -62,6 +75,11 @@ void ctf_fs_msg_iter_data_destroy(
 		return;
 	}
 
+	if (msg_iter_data->pending_msgs) {
+		ctf_fs_msg_iter_data_clear_pending_msgs(msg_iter_data);
+		g_queue_free(msg_iter_data->pending_msgs);
+	}
+
 	if (msg_iter_data->msg_iter) {
 		ctf_msg_iter_destroy(msg_iter_data->msg_iter);
 	}
@@ -129,7 +147,8 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		bt_message_array_const msgs, uint64_t capacity,
 		uint64_t *count)
 {
-	bt_message_iterator_class_next_method_status status;
+	bt_message_iterator_class_next_method_status status =
+		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 	struct ctf_fs_msg_iter_data *msg_iter_data =
 		bt_self_message_iterator_get_data(iterator);
 	uint64_t i = 0;
@@ -145,13 +164,19 @@ bt_message_iterator_class_next_method_status ctf_fs_iterator_next(
 		goto end;
 	}
 
-	do {
+	/* Return the messages queued by a previous seek operation first. */
+	while (i < capacity && !g_queue_is_empty(msg_iter_data->pending_msgs)) {
+		msgs[i] = g_queue_pop_head(msg_iter_data->pending_msgs);
+		i++;
+	}
+
+	while (i < capacity &&
+			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
 		status = ctf_fs_iterator_next_one(msg_iter_data, &msgs[i]);
 		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
 			i++;
 		}
-	} while (i < capacity &&
-			status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK);
+	}
 
 	if (i > 0) {
 		/*
@@ -194,12 +219,382 @@ ctf_fs_iterator_seek_beginning(bt_self_message_iterator *it)
 
 	BT_ASSERT(msg_iter_data);
 
+	ctf_fs_msg_iter_data_clear_pending_msgs(msg_iter_data);
 	ctf_msg_iter_reset(msg_iter_data->msg_iter);
 	ctf_fs_ds_group_medops_data_reset(msg_iter_data->msg_iter_medops_data);
 
 	return BT_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHOD_STATUS_OK;
 }
 
+/*
+ * Sets `*ns_from_origin` to the nanoseconds from origin of the default
+ * clock snapshot `cs`.
+ */
+static
+int clock_snapshot_get_ns_from_origin(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		const bt_clock_snapshot *cs, int64_t *ns_from_origin)
+{
+	int ret = 0;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+
+	if (bt_clock_snapshot_get_ns_from_origin(cs, ns_from_origin) !=
+			BT_CLOCK_SNAPSHOT_GET_NS_FROM_ORIGIN_STATUS_OK) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot get nanoseconds from origin of clock snapshot: "
+			"value=%" PRIu64, bt_clock_snapshot_get_value(cs));
+		ret = -1;
+	}
+
+	return ret;
+}
+
+/*
+ * Sets `*raw_value` to the value of the default clock of
+ * `msg_iter_data`'s stream class at `ns_from_origin`.
+ */
+static
+int ns_from_origin_to_default_clock_value(
+		struct ctf_fs_msg_iter_data *msg_iter_data,
+		int64_t ns_from_origin, uint64_t *raw_value)
+{
+	int ret = 0;
+	struct ctf_clock_class *default_cc =
+		msg_iter_data->ds_file_group->sc->default_clock_class;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+
+	BT_ASSERT(default_cc);
+
+	if (bt_common_clock_value_from_ns_from_origin(
+			default_cc->offset_seconds, default_cc->offset_cycles,
+			default_cc->frequency, ns_from_origin, raw_value)) {
+		BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+			"Cannot convert nanoseconds from origin to clock value: "
+			"ns-from-origin=%" PRId64, ns_from_origin);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+/*
+ * Decodes messages from the current position of `msg_iter_data`'s CTF
+ * message iterator until getting the first one which is at or after
+ * `ns_from_origin`, dropping the messages before it.
+ *
+ * The function queues, in `msg_iter_data->pending_msgs`, the stream
+ * beginning message, a packet beginning message at `ns_from_origin`
+ * if the first message is within a packet, the discarded items
+ * messages which contain `ns_from_origin`, and the first message.
+ */
+static
+int ctf_fs_iterator_fast_forward(struct ctf_fs_msg_iter_data *msg_iter_data,
+		int64_t ns_from_origin)
+{
+	int status;
+	const bt_message *msg = NULL;
+	const bt_message *stream_beg_msg = NULL;
+	const bt_message *packet_beg_msg = NULL;
+	bt_message *new_msg = NULL;
+	struct ctf_stream_class *sc = msg_iter_data->ds_file_group->sc;
+	bt_self_message_iterator *self_msg_iter = msg_iter_data->self_msg_iter;
+	bt_logging_level log_level = msg_iter_data->log_level;
+	bt_self_component *self_comp = msg_iter_data->self_comp;
+	uint64_t raw_value;
+	bool got_first = false;
+
+	/*
+	 * Only convert `ns_from_origin` to a clock value when a message
+	 * needs to begin at the seeking time: it's always after the
+	 * clock's origin then, while the seeking time itself may be
+	 * before it.
+	 */
+	while (!got_first) {
+		const bt_clock_snapshot *cs = NULL;
+		int64_t msg_ns_from_origin;
+
+		status = (int) ctf_fs_iterator_next_one(msg_iter_data, &msg);
+		if (status == BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END) {
+			/* Only possible if the stream end message was queued. */
+			status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+			break;
+		} else if (status != BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK) {
+			goto end;
+		}
+
+		switch (bt_message_get_type(msg)) {
+		case BT_MESSAGE_TYPE_STREAM_BEGINNING:
+			/* CTF stream beginning messages have no clock snapshot. */
+			BT_ASSERT(!stream_beg_msg);
+			BT_MESSAGE_MOVE_REF(stream_beg_msg, msg);
+			continue;
+		case BT_MESSAGE_TYPE_STREAM_END:
+			got_first = true;
+			continue;
+		case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+			if (sc->packets_have_ts_begin) {
+				cs = bt_message_packet_beginning_borrow_default_clock_snapshot_const(
+					msg);
+			}
+
+			break;
+		case BT_MESSAGE_TYPE_PACKET_END:
+			if (sc->packets_have_ts_end) {
+				cs = bt_message_packet_end_borrow_default_clock_snapshot_const(
+					msg);
+			}
+
+			break;
+		case BT_MESSAGE_TYPE_EVENT:
+			cs = bt_message_event_borrow_default_clock_snapshot_const(msg);
+			break;
+		case BT_MESSAGE_TYPE_DISCARDED_EVENTS:
+		case BT_MESSAGE_TYPE_DISCARDED_PACKETS:
+		{
+			const bt_clock_snapshot *end_cs;
+			bool is_events = bt_message_get_type(msg) ==
+				BT_MESSAGE_TYPE_DISCARDED_EVENTS;
+
+			if ((is_events && !sc->discarded_events_have_default_cs) ||
+					(!is_events && !sc->discarded_packets_have_default_cs)) {
+				break;
+			}
+
+			if (is_events) {
+				cs = bt_message_discarded_events_borrow_beginning_default_clock_snapshot_const(
+					msg);
+				end_cs = bt_message_discarded_events_borrow_end_default_clock_snapshot_const(
+					msg);
+			} else {
+				cs = bt_message_discarded_packets_borrow_beginning_default_clock_snapshot_const(
+					msg);
+				end_cs = bt_message_discarded_packets_borrow_end_default_clock_snapshot_const(
+					msg);
+			}
+
+			if (clock_snapshot_get_ns_from_origin(msg_iter_data, cs,
+					&msg_ns_from_origin)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (msg_ns_from_origin >= ns_from_origin) {
+				break;
+			}
+
+			if (clock_snapshot_get_ns_from_origin(msg_iter_data, end_cs,
+					&msg_ns_from_origin)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (msg_ns_from_origin < ns_from_origin) {
+				/* Completely before the seeking time: drop it. */
+				BT_MESSAGE_PUT_REF_AND_RESET(msg);
+				continue;
+			}
+
+			/*
+			 * The time range of the discarded items contains
+			 * the seeking time: replace the message with one
+			 * which begins at the seeking time, without a
+			 * count as we don't know how many items were
+			 * discarded within this new range, and keep
+			 * looking for the first message, as the library
+			 * does when it fast-forwards.
+			 */
+			if (ns_from_origin_to_default_clock_value(msg_iter_data,
+					ns_from_origin, &raw_value)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (is_events) {
+				new_msg = bt_message_discarded_events_create_with_default_clock_snapshots(
+					self_msg_iter,
+					bt_message_discarded_events_borrow_stream_const(msg),
+					raw_value, bt_clock_snapshot_get_value(end_cs));
+			} else {
+				new_msg = bt_message_discarded_packets_create_with_default_clock_snapshots(
+					self_msg_iter,
+					bt_message_discarded_packets_borrow_stream_const(msg),
+					raw_value, bt_clock_snapshot_get_value(end_cs));
+			}
+
+			if (!new_msg) {
+				BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+					"Cannot create discarded items message.");
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_MEMORY_ERROR;
+				goto end;
+			}
+
+			BT_MESSAGE_PUT_REF_AND_RESET(msg);
+			g_queue_push_tail(msg_iter_data->pending_msgs, new_msg);
+			new_msg = NULL;
+			continue;
+		}
+		default:
+			bt_common_abort();
+		}
+
+		if (cs) {
+			if (clock_snapshot_get_ns_from_origin(msg_iter_data, cs,
+					&msg_ns_from_origin)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			if (msg_ns_from_origin >= ns_from_origin) {
+				got_first = true;
+				continue;
+			}
+		}
+
+		/* This message is before the seeking time: drop it. */
+		switch (bt_message_get_type(msg)) {
+		case BT_MESSAGE_TYPE_PACKET_BEGINNING:
+			BT_ASSERT(!packet_beg_msg);
+			BT_MESSAGE_MOVE_REF(packet_beg_msg, msg);
+			break;
+		case BT_MESSAGE_TYPE_PACKET_END:
+			BT_MESSAGE_PUT_REF_AND_RESET(packet_beg_msg);
+			BT_MESSAGE_PUT_REF_AND_RESET(msg);
+			break;
+		default:
+			BT_MESSAGE_PUT_REF_AND_RESET(msg);
+			break;
+		}
+	}
+
+	/*
+	 * Put, before the discarded items messages already queued, the
+	 * stream beginning message, then, if the first message at or
+	 * after the seeking time is within a packet of which we dropped
+	 * the beginning message, a new packet beginning message at the
+	 * seeking time.
+	 */
+	if (packet_beg_msg) {
+		const bt_packet *packet =
+			bt_message_packet_beginning_borrow_packet_const(
+				packet_beg_msg);
+
+		if (sc->packets_have_ts_begin) {
+			if (ns_from_origin_to_default_clock_value(msg_iter_data,
+					ns_from_origin, &raw_value)) {
+				status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			new_msg = bt_message_packet_beginning_create_with_default_clock_snapshot(
+				self_msg_iter, packet, raw_value);
+		} else {
+			new_msg = bt_message_packet_beginning_create(
+				self_msg_iter, packet);
+		}
+
+		if (!new_msg) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Cannot create packet beginning message.");
+			status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_MEMORY_ERROR;
+			goto end;
+		}
+
+		g_queue_push_head(msg_iter_data->pending_msgs, new_msg);
+		new_msg = NULL;
+	}
+
+	if (stream_beg_msg) {
+		g_queue_push_head(msg_iter_data->pending_msgs,
+			(void *) stream_beg_msg);
+		stream_beg_msg = NULL;
+	}
+
+	if (msg) {
+		g_queue_push_tail(msg_iter_data->pending_msgs, (void *) msg);
+		msg = NULL;
+	}
+
+	status = BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+
+end:
+	bt_message_put_ref(msg);
+	bt_message_put_ref(new_msg);
+	bt_message_put_ref(stream_beg_msg);
+	bt_message_put_ref(packet_beg_msg);
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status
+ctf_fs_iterator_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin)
+{
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+	bt_message_iterator_class_seek_ns_from_origin_method_status status;
+	bt_logging_level log_level;
+	bt_self_component *self_comp;
+	guint entry_index;
+
+	BT_ASSERT(msg_iter_data);
+	log_level = msg_iter_data->log_level;
+	self_comp = msg_iter_data->self_comp;
+
+	/*
+	 * Use the index to find the packet containing `ns_from_origin`
+	 * and make the medium start from there, so that we only decode
+	 * this packet to find the first message at or after the seeking
+	 * time.
+	 *
+	 * Resetting the CTF message iterator forgets the snapshots of
+	 * the previous packet, from which it computes the discarded
+	 * events and packets of the next one. Therefore start from the
+	 * previous packet, if any: fast-forwarding drops its messages.
+	 */
+	entry_index = ctf_fs_ds_index_find_entry_index_by_ns(
+		msg_iter_data->ds_file_group->index, ns_from_origin);
+	BT_COMP_LOGD("Seeking nanoseconds from origin using the index: "
+		"ns-from-origin=%" PRId64 ", index-entry-index=%u",
+		ns_from_origin, entry_index);
+	ctf_fs_msg_iter_data_clear_pending_msgs(msg_iter_data);
+	ctf_msg_iter_reset(msg_iter_data->msg_iter);
+	ctf_fs_ds_group_medops_data_set_next_index_entry(
+		msg_iter_data->msg_iter_medops_data,
+		entry_index > 0 ? entry_index - 1 : 0);
+	status = ctf_fs_iterator_fast_forward(msg_iter_data, ns_from_origin);
+	if (status != BT_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(it,
+			"Failed to seek nanoseconds from origin: "
+			"ns-from-origin=%" PRId64, ns_from_origin);
+	}
+
+	return status;
+}
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status
+ctf_fs_iterator_can_seek_ns_from_origin(bt_self_message_iterator *it,
+		int64_t ns_from_origin, bt_bool *can_seek)
+{
+	struct ctf_fs_msg_iter_data *msg_iter_data =
+		bt_self_message_iterator_get_data(it);
+	struct ctf_stream_class *sc;
+
+	BT_ASSERT(msg_iter_data);
+	sc = msg_iter_data->ds_file_group->sc;
+
+	/*
+	 * The index entries only have meaningful time bounds if the
+	 * packet contexts contain the packet's beginning and end times.
+	 * Otherwise, let the library seek the beginning and fast-forward.
+	 */
+	*can_seek = sc->default_clock_class && sc->packets_have_ts_begin &&
+		sc->packets_have_ts_end;
+	return BT_MESSAGE_ITERATOR_CLASS_CAN_SEEK_NS_FROM_ORIGIN_METHOD_STATUS_OK;
+}
+
 BT_HIDDEN
 void ctf_fs_iterator_finalize(bt_self_message_iterator *it)
 {
@@ -236,9 +631,18 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 	msg_iter_data->self_comp = self_comp;
 	msg_iter_data->self_msg_iter = self_msg_iter;
 	msg_iter_data->ds_file_group = port_data->ds_file_group;
+	msg_iter_data->pending_msgs = g_queue_new();
+	if (!msg_iter_data->pending_msgs) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"Failed to allocate a GQueue.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
 
 	medium_status = ctf_fs_ds_group_medops_data_create(
-		msg_iter_data->ds_file_group, self_msg_iter, log_level,
+		msg_iter_data->ds_file_group, self_msg_iter,
+		port_data->ctf_fs->read_ahead_packets,
+		port_data->ctf_fs->read_ahead_method, log_level,
 		&msg_iter_data->msg_iter_medops_data);
 	BT_ASSERT(
 		medium_status == CTF_MSG_ITER_MEDIUM_STATUS_OK ||
@@ -264,6 +668,22 @@ bt_message_iterator_class_initialize_method_status ctf_fs_iterator_init(
 		goto error;
 	}
 
+	ctf_msg_iter_set_lazy_payloads(msg_iter_data->msg_iter,
+		port_data->ctf_fs->lazy_event_payloads);
+	ctf_msg_iter_set_event_class_filter(msg_iter_data->msg_iter,
+		port_data->ctf_fs->ec_filter);
+
+	/*
+	 * Make the library call ctf_fs_iterator_next() in a dedicated
+	 * thread: the message iterators only share the trace's metadata,
+	 * which they don't modify, and the file descriptor cache, which is
+	 * thread-safe.
+	 */
+	if (port_data->ctf_fs->decode_threads) {
+		bt_self_message_iterator_configuration_set_stage_queue_size(
+			config, CTF_FS_DECODE_QUEUE_SIZE);
+	}
+
 	/*
 	 * This iterator can seek forward if its stream class has a default
 	 * clock class.
@@ -326,6 +746,16 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	if (ctf_fs->index_cache_dir) {
+		g_string_free(ctf_fs->index_cache_dir, TRUE);
+	}
+
+	if (ctf_fs->metadata_cache_dir) {
+		g_string_free(ctf_fs->metadata_cache_dir, TRUE);
+	}
+
+	ctf_event_class_filter_destroy(ctf_fs->ec_filter);
+	bt_fd_cache_fini(&ctf_fs->fd_cache);
 	g_free(ctf_fs);
 }
 
@@ -362,12 +792,21 @@ struct ctf_fs_component *ctf_fs_component_create(bt_logging_level log_level,
 	}
 
 	ctf_fs->log_level = log_level;
+	ctf_fs->indexing_threads = 1;
+	ctf_fs->mmap_window_size = CTF_FS_DS_FILE_MMAP_WINDOW_DEFAULT_SIZE;
+	ctf_fs->read_ahead_method = CTF_FS_READ_AHEAD_METHOD_AUTO;
+	ctf_fs->begin_ns = INT64_MIN;
+	ctf_fs->end_ns = INT64_MAX;
 	ctf_fs->port_data =
 		g_ptr_array_new_with_free_func(port_data_destroy_notifier);
 	if (!ctf_fs->port_data) {
 		goto error;
 	}
 
+	if (bt_fd_cache_init(&ctf_fs->fd_cache, log_level)) {
+		goto error;
+	}
+
 	goto end;
 
 error:
@@ -641,109 +1080,82 @@ void ds_file_group_insert_ds_file_info_sorted(
 	array_insert(ds_file_group->ds_file_infos, ds_file_info, i);
 }
 
-static
-bool ds_index_entries_equal(
-	const struct ctf_fs_ds_index_entry *left,
-	const struct ctf_fs_ds_index_entry *right)
-{
-	if (left->packet_size != right->packet_size) {
-		return false;
-	}
+/* Data of a job which indexes a single data stream file. */
+struct ds_file_index_job_data {
+	/* Weak */
+	struct ctf_fs_trace *ctf_fs_trace;
 
-	if (left->timestamp_begin != right->timestamp_begin) {
-		return false;
-	}
+	/* Owned by this */
+	gchar *path;
 
-	if (left->timestamp_end != right->timestamp_end) {
-		return false;
-	}
+	/* Weak, set by index_ds_file() */
+	struct ctf_stream_class *sc;
 
-	if (left->packet_seq_num != right->packet_seq_num) {
-		return false;
-	}
+	/* Set by index_ds_file() */
+	int64_t stream_instance_id;
+	int64_t begin_ns;
 
-	return true;
-}
+	/* Owned by this, set by index_ds_file() */
+	struct ctf_fs_ds_file_info *ds_file_info;
 
-/*
- * Insert `entry` into `index`, without duplication.
- *
- * The entry is inserted only if there isn't an identical entry already.
- *
- * In any case, the ownership of `entry` is transferred to this function.  So if
- * the entry is not inserted, it is freed.
- */
+	/* Owned by this, set by index_ds_file() */
+	struct ctf_fs_ds_index *index;
+};
 
 static
-void ds_index_insert_ds_index_entry_sorted(
-	struct ctf_fs_ds_index *index,
-	struct ctf_fs_ds_index_entry *entry)
+void ds_file_index_job_data_destroy(struct ds_file_index_job_data *job_data)
 {
-	guint i;
-	struct ctf_fs_ds_index_entry *other_entry;
-
-	/* Find the spot where to insert this index entry. */
-	for (i = 0; i < index->entries->len; i++) {
-		other_entry = g_ptr_array_index(index->entries, i);
-
-		if (entry->timestamp_begin_ns <= other_entry->timestamp_begin_ns) {
-			break;
-		}
+	if (!job_data) {
+		return;
 	}
 
-	/*
-	 * Insert the entry only if a duplicate doesn't already exist.
-	 *
-	 * There can be duplicate packets if reading multiple overlapping
-	 * snapshots of the same trace.  We then want the index to contain
-	 * a reference to only one copy of that packet.
-	 */
-	if (i == index->entries->len ||
-			!ds_index_entries_equal(entry, other_entry)) {
-		array_insert(index->entries, entry, i);
-	} else {
-		g_free(entry);
-	}
+	g_free(job_data->path);
+	ctf_fs_ds_file_info_destroy(job_data->ds_file_info);
+	ctf_fs_ds_index_destroy(job_data->index);
+	g_free(job_data);
 }
 
 static
-void merge_ctf_fs_ds_indexes(struct ctf_fs_ds_index *dest, struct ctf_fs_ds_index *src)
+void ds_file_index_job_data_destroy_notifier(void *data)
 {
-	guint i;
+	ds_file_index_job_data_destroy(data);
+}
 
-	for (i = 0; i < src->entries->len; i++) {
-		struct ctf_fs_ds_index_entry *entry =
-			g_ptr_array_index(src->entries, i);
+static
+gint compare_ds_file_index_job_data_by_path(gconstpointer a, gconstpointer b)
+{
+	const struct ds_file_index_job_data *job_data_a =
+		*((const struct ds_file_index_job_data **) a);
+	const struct ds_file_index_job_data *job_data_b =
+		*((const struct ds_file_index_job_data **) b);
 
-		/*
-		* Ownership of the ctf_fs_ds_index_entry is transferred to
-		* ds_index_insert_ds_index_entry_sorted.
-		*/
-		g_ptr_array_index(src->entries, i) = NULL;
-		ds_index_insert_ds_index_entry_sorted(dest, entry);
-	}
+	return strcmp(job_data_a->path, job_data_b->path);
 }
 
+/*
+ * Reads the properties of the first packet of a data stream file and
+ * builds its index.
+ *
+ * This function may run on a worker thread: it only reads the trace's
+ * metadata and only writes to `data`, a `struct ds_file_index_job_data`.
+ */
 static
-int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
-		const char *path)
+int index_ds_file(void *data)
 {
-	int64_t stream_instance_id = -1;
-	int64_t begin_ns = -1;
-	struct ctf_fs_ds_file_group *ds_file_group = NULL;
-	bool add_group = false;
+	struct ds_file_index_job_data *job_data = data;
+	struct ctf_fs_trace *ctf_fs_trace = job_data->ctf_fs_trace;
+	const char *path = job_data->path;
 	int ret;
-	size_t i;
 	struct ctf_fs_ds_file *ds_file = NULL;
-	struct ctf_fs_ds_file_info *ds_file_info = NULL;
-	struct ctf_fs_ds_index *index = NULL;
 	struct ctf_msg_iter *msg_iter = NULL;
-	struct ctf_stream_class *sc = NULL;
 	struct ctf_msg_iter_packet_properties props;
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 	bt_self_component *self_comp = ctf_fs_trace->self_comp;
 	bt_self_component_class *self_comp_class = ctf_fs_trace->self_comp_class;
 
+	job_data->stream_instance_id = -1;
+	job_data->begin_ns = -1;
+
 	/*
 	 * Create a temporary ds_file to read some properties about the data
 	 * stream file.
@@ -773,18 +1185,20 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
-	sc = ctf_trace_class_borrow_stream_class_by_id(ds_file->metadata->tc,
-		props.stream_class_id);
-	BT_ASSERT(sc);
-	stream_instance_id = props.data_stream_id;
+	job_data->sc = ctf_trace_class_borrow_stream_class_by_id(
+		ds_file->metadata->tc, props.stream_class_id);
+	BT_ASSERT(job_data->sc);
+	job_data->stream_instance_id = props.data_stream_id;
 
 	if (props.snapshots.beginning_clock != UINT64_C(-1)) {
-		BT_ASSERT(sc->default_clock_class);
+		struct ctf_clock_class *default_cc =
+			job_data->sc->default_clock_class;
+
+		BT_ASSERT(default_cc);
 		ret = bt_util_clock_cycles_to_ns_from_origin(
 			props.snapshots.beginning_clock,
-			sc->default_clock_class->frequency,
-			sc->default_clock_class->offset_seconds,
-			sc->default_clock_class->offset_cycles, &begin_ns);
+			default_cc->frequency, default_cc->offset_seconds,
+			default_cc->offset_cycles, &job_data->begin_ns);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 				"Cannot convert clock cycles to nanoseconds from origin (`%s`).",
@@ -793,13 +1207,16 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		}
 	}
 
-	ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
-	if (!ds_file_info) {
+	job_data->ds_file_info = ctf_fs_ds_file_info_create(path,
+		job_data->begin_ns);
+	if (!job_data->ds_file_info) {
 		goto error;
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file, ds_file_info, msg_iter);
-	if (!index) {
+	job_data->index = ctf_fs_ds_file_build_index(ds_file,
+		job_data->ds_file_info, msg_iter,
+		ctf_fs_trace->index_cache_dir);
+	if (!job_data->index) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 			self_comp, self_comp_class,
 			"Failed to index CTF stream file \'%s\'",
@@ -807,6 +1224,44 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
+	ret = 0;
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	ctf_fs_ds_file_destroy(ds_file);
+
+	if (msg_iter) {
+		ctf_msg_iter_destroy(msg_iter);
+	}
+
+	return ret;
+}
+
+/*
+ * Adds the data stream file which `job_data` indexed to its data
+ * stream file group within `ctf_fs_trace`, creating the group if
+ * needed.
+ *
+ * Steals `job_data->ds_file_info` and `job_data->index`.
+ */
+static
+int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
+		struct ds_file_index_job_data *job_data)
+{
+	int64_t stream_instance_id = job_data->stream_instance_id;
+	int64_t begin_ns = job_data->begin_ns;
+	struct ctf_fs_ds_file_group *ds_file_group = NULL;
+	bool add_group = false;
+	int ret = 0;
+	size_t i;
+	struct ctf_fs_ds_file_info *ds_file_info =
+		BT_MOVE_REF(job_data->ds_file_info);
+	struct ctf_fs_ds_index *index = BT_MOVE_REF(job_data->index);
+	struct ctf_stream_class *sc = job_data->sc;
+
 	if (begin_ns == -1) {
 		/*
 		 * No beginning timestamp to sort the stream files
@@ -868,7 +1323,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 
 		add_group = true;
 	} else {
-		merge_ctf_fs_ds_indexes(ds_file_group->index, index);
+		ctf_fs_ds_index_merge(ds_file_group->index, index);
 	}
 
 	ds_file_group_insert_ds_file_info_sorted(ds_file_group,
@@ -886,13 +1341,7 @@ end:
 		g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
 	}
 
-	ctf_fs_ds_file_destroy(ds_file);
 	ctf_fs_ds_file_info_destroy(ds_file_info);
-
-	if (msg_iter) {
-		ctf_msg_iter_destroy(msg_iter);
-	}
-
 	ctf_fs_ds_index_destroy(index);
 	return ret;
 }
@@ -904,12 +1353,23 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 	const char *basename;
 	GError *error = NULL;
 	GDir *dir = NULL;
+	GPtrArray *job_datas = NULL;
+	struct ctf_fs_worker_job *jobs = NULL;
+	guint i;
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 	bt_self_component *self_comp = ctf_fs_trace->self_comp;
 	bt_self_component_class *self_comp_class = ctf_fs_trace->self_comp_class;
 
-	/* Check each file in the path directory, except specific ones */
-	dir = g_dir_open(ctf_fs_trace->path->str, 0, &error);
+	job_datas = g_ptr_array_new_with_free_func(
+		ds_file_index_job_data_destroy_notifier);
+	if (!job_datas) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Failed to allocate a GPtrArray.");
+		goto error;
+	}
+
+	/* Check each file in the path directory, except specific ones */
+	dir = g_dir_open(ctf_fs_trace->path->str, 0, &error);
 	if (!dir) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 			"Cannot open directory `%s`: %s (code %d)",
@@ -920,6 +1380,7 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 
 	while ((basename = g_dir_read_name(dir))) {
 		struct ctf_fs_file *file;
+		struct ds_file_index_job_data *job_data;
 
 		if (strcmp(basename, CTF_FS_METADATA_FILENAME) == 0) {
 			/* Ignore the metadata stream. */
@@ -969,19 +1430,65 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			continue;
 		}
 
-		ret = add_ds_file_to_ds_file_group(ctf_fs_trace,
-			file->path->str);
-		if (ret) {
+		job_data = g_new0(struct ds_file_index_job_data, 1);
+		if (!job_data) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
-				"Cannot add stream file `%s` to stream file group",
-				file->path->str);
+				"Failed to allocate a ds_file_index_job_data.");
 			ctf_fs_file_destroy(file);
 			goto error;
 		}
 
+		job_data->ctf_fs_trace = ctf_fs_trace;
+		job_data->path = g_strdup(file->path->str);
+		g_ptr_array_add(job_datas, job_data);
 		ctf_fs_file_destroy(file);
 	}
 
+	/*
+	 * Index the data stream files, possibly in parallel, and then add
+	 * them to their groups in path order, whatever the order in which
+	 * the jobs complete and the directory order, so that the resulting
+	 * groups and indexes are deterministic.
+	 */
+	g_ptr_array_sort(job_datas, compare_ds_file_index_job_data_by_path);
+
+	if (job_datas->len > 0) {
+		jobs = g_new0(struct ctf_fs_worker_job, job_datas->len);
+		if (!jobs) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+				"Failed to allocate worker jobs.");
+			goto error;
+		}
+	}
+
+	for (i = 0; i < job_datas->len; i++) {
+		jobs[i].func = index_ds_file;
+		jobs[i].data = g_ptr_array_index(job_datas, i);
+	}
+
+	ret = ctf_fs_worker_pool_run_jobs(jobs, job_datas->len,
+		ctf_fs_trace->indexing_threads, log_level, self_comp,
+		self_comp_class);
+	if (ret) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Failed to index stream files of trace `%s`.",
+			ctf_fs_trace->path->str);
+		goto error;
+	}
+
+	for (i = 0; i < job_datas->len; i++) {
+		struct ds_file_index_job_data *job_data =
+			g_ptr_array_index(job_datas, i);
+
+		ret = add_ds_file_to_ds_file_group(ctf_fs_trace, job_data);
+		if (ret) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+				"Cannot add stream file `%s` to stream file group",
+				job_data->path);
+			goto error;
+		}
+	}
+
 	goto end;
 
 error:
@@ -997,6 +1504,12 @@ end:
 		g_error_free(error);
 	}
 
+	g_free(jobs);
+
+	if (job_datas) {
+		g_ptr_array_free(job_datas, TRUE);
+	}
+
 	return ret;
 }
 
@@ -1054,6 +1567,8 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 		bt_self_component_class *self_comp_class,
 		const char *path, const char *name,
 		struct ctf_fs_metadata_config *metadata_config,
+		const char *index_cache_dir, guint indexing_threads,
+		uint64_t mmap_window_size, struct bt_fd_cache *fd_cache,
 		bt_logging_level log_level)
 {
 	struct ctf_fs_trace *ctf_fs_trace;
@@ -1070,6 +1585,10 @@ struct ctf_fs_trace *ctf_fs_trace_create(
 	ctf_fs_trace->log_level = log_level;
 	ctf_fs_trace->self_comp = self_comp;
 	ctf_fs_trace->self_comp_class = self_comp_class;
+	ctf_fs_trace->index_cache_dir = index_cache_dir;
+	ctf_fs_trace->indexing_threads = indexing_threads;
+	ctf_fs_trace->mmap_window_size = mmap_window_size;
+	ctf_fs_trace->fd_cache = fd_cache;
 	ctf_fs_trace->path = g_string_new(path);
 	if (!ctf_fs_trace->path) {
 		goto error;
@@ -1199,7 +1718,10 @@ int ctf_fs_component_create_ctf_fs_trace_one_path(
 	}
 
 	ctf_fs_trace = ctf_fs_trace_create(self_comp, self_comp_class, norm_path->str,
-		trace_name, &ctf_fs->metadata_config, log_level);
+		trace_name, &ctf_fs->metadata_config,
+		ctf_fs->index_cache_dir ? ctf_fs->index_cache_dir->str : NULL,
+		ctf_fs->indexing_threads, ctf_fs->mmap_window_size,
+		&ctf_fs->fd_cache, log_level);
 	if (!ctf_fs_trace) {
 		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
 			"Cannot create trace for `%s`.",
@@ -1268,7 +1790,7 @@ void merge_ctf_fs_ds_file_groups(struct ctf_fs_ds_file_group *dest, struct ctf_f
 	}
 
 	/* Merge both indexes. */
-	merge_ctf_fs_ds_indexes(dest->index, src->index);
+	ctf_fs_ds_index_merge(dest->index, src->index);
 }
 /* Merge src_trace's data stream file groups into dest_trace's. */
 
@@ -1441,7 +1963,7 @@ enum target_event {
 static
 int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
 	struct ctf_clock_class *default_cc,
-	struct ctf_fs_ds_index_entry *index_entry,
+	struct ctf_fs_ds_index *index, guint entry_i,
 	enum target_event target_event, uint64_t *cs, int64_t *ts_ns)
 {
 	enum ctf_msg_iter_status iter_status = CTF_MSG_ITER_STATUS_OK;
@@ -1452,11 +1974,11 @@ int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
 	int ret = 0;
 
 	BT_ASSERT(ctf_fs_trace);
-	BT_ASSERT(index_entry);
-	BT_ASSERT(index_entry->path);
+	BT_ASSERT(index);
+	BT_ASSERT(entry_i < index->len);
 
 	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL,
-		NULL, index_entry->path, log_level);
+		NULL, ctf_fs_ds_index_get_path(index, entry_i), log_level);
 	if (!ds_file) {
 		BT_COMP_LOGE_APPEND_CAUSE(self_comp, "Failed to create a ctf_fs_ds_file");
 		ret = -1;
@@ -1482,7 +2004,7 @@ int decode_clock_snapshot_after_event(struct ctf_fs_trace *ctf_fs_trace,
 	ctf_msg_iter_set_dry_run(msg_iter, true);
 
 	/* Seek to the beginning of the target packet. */
-	iter_status = ctf_msg_iter_seek(msg_iter, index_entry->offset);
+	iter_status = ctf_msg_iter_seek(msg_iter, index->offsets[entry_i]);
 	if (iter_status) {
 		/* ctf_msg_iter_seek() logs errors. */
 		ret = -1;
@@ -1535,22 +2057,92 @@ end:
 
 static
 int decode_packet_first_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
-	struct ctf_clock_class *default_cc,
-	struct ctf_fs_ds_index_entry *index_entry, uint64_t *cs, int64_t *ts_ns)
+	struct ctf_clock_class *default_cc, struct ctf_fs_ds_index *index,
+	guint entry_i, uint64_t *cs, int64_t *ts_ns)
 {
 	return decode_clock_snapshot_after_event(ctf_fs_trace, default_cc,
-		index_entry, FIRST_EVENT, cs, ts_ns);
+		index, entry_i, FIRST_EVENT, cs, ts_ns);
 }
 
 static
 int decode_packet_last_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
-	struct ctf_clock_class *default_cc,
-	struct ctf_fs_ds_index_entry *index_entry, uint64_t *cs, int64_t *ts_ns)
+	struct ctf_clock_class *default_cc, struct ctf_fs_ds_index *index,
+	guint entry_i, uint64_t *cs, int64_t *ts_ns)
 {
 	return decode_clock_snapshot_after_event(ctf_fs_trace, default_cc,
-		index_entry, LAST_EVENT, cs, ts_ns);
+		index, entry_i, LAST_EVENT, cs, ts_ns);
+}
+
+typedef int (*fix_ds_file_group_index_func)(struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group);
+
+/* Data of a job which fixes up the index of a data stream file group. */
+struct fix_ds_file_group_index_job_data {
+	/* Weak */
+	struct ctf_fs_trace *trace;
+
+	/* Weak */
+	struct ctf_fs_ds_file_group *ds_file_group;
+
+	fix_ds_file_group_index_func func;
+};
+
+static
+int fix_ds_file_group_index(void *data)
+{
+	struct fix_ds_file_group_index_job_data *job_data = data;
+
+	return job_data->func(job_data->trace, job_data->ds_file_group);
 }
 
+/*
+ * Calls `func` for each data stream file group of `trace`, possibly in
+ * parallel: `func` must only modify the index of its group.
+ */
+static
+int fix_ds_file_group_indexes(struct ctf_fs_trace *trace,
+		fix_ds_file_group_index_func func)
+{
+	int ret;
+	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	struct fix_ds_file_group_index_job_data *job_datas = NULL;
+	struct ctf_fs_worker_job *jobs = NULL;
+	guint i;
+	bt_logging_level log_level = trace->log_level;
+
+	if (ds_file_groups->len == 0) {
+		ret = 0;
+		goto end;
+	}
+
+	job_datas = g_new0(struct fix_ds_file_group_index_job_data,
+		ds_file_groups->len);
+	jobs = g_new0(struct ctf_fs_worker_job, ds_file_groups->len);
+	if (!job_datas || !jobs) {
+		BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+			"Failed to allocate worker jobs.");
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < ds_file_groups->len; i++) {
+		job_datas[i].trace = trace;
+		job_datas[i].ds_file_group =
+			g_ptr_array_index(ds_file_groups, i);
+		job_datas[i].func = func;
+		jobs[i].func = fix_ds_file_group_index;
+		jobs[i].data = &job_datas[i];
+	}
+
+	ret = ctf_fs_worker_pool_run_jobs(jobs, ds_file_groups->len,
+		trace->indexing_threads, log_level, trace->self_comp,
+		trace->self_comp_class);
+
+end:
+	g_free(job_datas);
+	g_free(jobs);
+	return ret;
+}
 /*
  * Fix up packet index entries for lttng's "event-after-packet" bug.
  * Some buggy lttng tracer versions may emit events with a timestamp that is
@@ -1570,78 +2162,71 @@ int decode_packet_last_event_timestamp(struct ctf_fs_trace *ctf_fs_trace,
  *  - before lttng-module 2.9.13
  */
 static
-int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_event_after_packet_bug(
+		struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_i;
+	guint last_entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index *index;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	BT_ASSERT(ds_file_group);
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
-
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
-
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
+	BT_ASSERT(index);
+	BT_ASSERT(index->len > 0);
 
+	/*
+	 * Iterate over all entries but the last one. The last one is
+	 * fixed differently after.
+	 */
+	for (entry_i = 0; entry_i < index->len - 1; entry_i++) {
 		/*
-		 * Iterate over all entries but the last one. The last one is
-		 * fixed differently after.
+		 * 1. Set the current index entry `end` timestamp to
+		 * the next index entry `begin` timestamp.
 		 */
-		for (entry_i = 0; entry_i < index->entries->len - 1;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			next_entry = g_ptr_array_index(index->entries, entry_i + 1);
-
-			/*
-			 * 1. Set the current index entry `end` timestamp to
-			 * the next index entry `begin` timestamp.
-			 */
-			curr_entry->timestamp_end = next_entry->timestamp_begin;
-			curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-		}
+		index->timestamps_end[entry_i] =
+			index->timestamps_begin[entry_i + 1];
+		index->timestamps_end_ns[entry_i] =
+			index->timestamps_begin_ns[entry_i + 1];
+	}
 
-		/*
-		 * 2. Fix the last entry by decoding the last event of the last
-		 * packet.
-		 */
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	/*
+	 * 2. Fix the last entry by decoding the last event of the last
+	 * packet.
+	 */
+	last_entry_i = index->len - 1;
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		/*
-		 * Decode packet to read the timestamp of the last event of the
-		 * entry.
-		 */
-		ret = decode_packet_last_event_timestamp(trace, default_cc,
-			last_entry, &last_entry->timestamp_end,
-			&last_entry->timestamp_end_ns);
-		if (ret) {
-			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-				"Failed to decode stream's last packet to get its last event's clock snapshot.");
-			goto end;
-		}
+	/*
+	 * Decode packet to read the timestamp of the last event of the
+	 * entry.
+	 */
+	ret = decode_packet_last_event_timestamp(trace, default_cc,
+		index, last_entry_i, &index->timestamps_end[last_entry_i],
+		&index->timestamps_end_ns[last_entry_i]);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+			"Failed to decode stream's last packet to get its last event's clock snapshot.");
+		goto end;
 	}
 
 end:
 	return ret;
 }
 
+static
+int fix_index_lttng_event_after_packet_bug(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_lttng_event_after_packet_bug);
+}
+
 /*
  * Fix up packet index entries for barectf's "event-before-packet" bug.
  * Some buggy barectf tracer versions may emit events with a timestamp that is
@@ -1657,63 +2242,61 @@ end:
  *  - before barectf 2.3.1
  */
 static
-int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_barectf_event_before_packet_bug(
+		struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group)
 {
 	int ret = 0;
-	guint ds_file_group_i;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_i;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index *index = ds_file_group->index;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_i = 0; ds_file_group_i < ds_file_groups->len;
-			ds_file_group_i++) {
-		guint entry_i;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_i);
-
-		struct ctf_fs_ds_index *index = ds_file_group->index;
-
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
+	BT_ASSERT(index);
+	BT_ASSERT(index->len > 0);
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
+	/*
+	 * 1. Iterate over the index, starting from the second entry
+	 * (index = 1).
+	 */
+	for (entry_i = 1; entry_i < index->len; entry_i++) {
 		/*
-		 * 1. Iterate over the index, starting from the second entry
-		 * (index = 1).
+		 * 2. Set the current entry `begin` timestamp to the
+		 * timestamp of the first event of the current packet.
 		 */
-		for (entry_i = 1; entry_i < index->entries->len;
-				entry_i++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *prev_entry;
-			prev_entry = g_ptr_array_index(index->entries, entry_i - 1);
-			curr_entry = g_ptr_array_index(index->entries, entry_i);
-			/*
-			 * 2. Set the current entry `begin` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			ret = decode_packet_first_event_timestamp(trace, default_cc,
-				curr_entry, &curr_entry->timestamp_begin,
-				&curr_entry->timestamp_begin_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode first event's clock snapshot");
-				goto end;
-			}
-
-			/*
-			 * 3. Set the previous entry `end` timestamp to the
-			 * timestamp of the first event of the current packet.
-			 */
-			prev_entry->timestamp_end = curr_entry->timestamp_begin;
-			prev_entry->timestamp_end_ns = curr_entry->timestamp_begin_ns;
+		ret = decode_packet_first_event_timestamp(trace, default_cc,
+			index, entry_i, &index->timestamps_begin[entry_i],
+			&index->timestamps_begin_ns[entry_i]);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode first event's clock snapshot");
+			goto end;
 		}
+
+		/*
+		 * 3. Set the previous entry `end` timestamp to the
+		 * timestamp of the first event of the current packet.
+		 */
+		index->timestamps_end[entry_i - 1] =
+			index->timestamps_begin[entry_i];
+		index->timestamps_end_ns[entry_i - 1] =
+			index->timestamps_begin_ns[entry_i];
 	}
+
 end:
 	return ret;
 }
 
+static
+int fix_index_barectf_event_before_packet_bug(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_barectf_event_before_packet_bug);
+}
+
 /*
  * When using the lttng-crash feature it's likely that the last packets of each
  * stream have their timestamp_end set to zero. This is caused by the fact that
@@ -1732,72 +2315,57 @@ end:
  * - All current and future lttng-ust and lttng-modules versions.
  */
 static
-int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+int fix_ds_file_group_index_lttng_crash_quirk(struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_group *ds_file_group)
 {
 	int ret = 0;
-	guint ds_file_group_idx;
-	GPtrArray *ds_file_groups = trace->ds_file_groups;
+	guint entry_idx;
+	guint last_entry_idx;
+	struct ctf_clock_class *default_cc;
+	struct ctf_fs_ds_index *index;
 	bt_logging_level log_level = trace->log_level;
 
-	for (ds_file_group_idx = 0; ds_file_group_idx < ds_file_groups->len;
-			ds_file_group_idx++) {
-		guint entry_idx;
-		struct ctf_clock_class *default_cc;
-		struct ctf_fs_ds_index_entry *last_entry;
-		struct ctf_fs_ds_index *index;
+	BT_ASSERT(ds_file_group);
+	index = ds_file_group->index;
 
-		struct ctf_fs_ds_file_group *ds_file_group =
-			g_ptr_array_index(ds_file_groups, ds_file_group_idx);
-
-		BT_ASSERT(ds_file_group);
-		index = ds_file_group->index;
+	BT_ASSERT(ds_file_group->sc->default_clock_class);
+	default_cc = ds_file_group->sc->default_clock_class;
 
-		BT_ASSERT(ds_file_group->sc->default_clock_class);
-		default_cc = ds_file_group->sc->default_clock_class;
+	BT_ASSERT(index);
+	BT_ASSERT(index->len > 0);
 
-		BT_ASSERT(index);
-		BT_ASSERT(index->entries);
-		BT_ASSERT(index->entries->len > 0);
-
-		last_entry = g_ptr_array_index(index->entries,
-			index->entries->len - 1);
-		BT_ASSERT(last_entry);
+	last_entry_idx = index->len - 1;
 
+	/* 1. Fix the last entry first. */
+	if (index->timestamps_end[last_entry_idx] == 0 &&
+			index->timestamps_begin[last_entry_idx] != 0) {
+		/*
+		 * Decode packet to read the timestamp of the
+		 * last event of the stream file.
+		 */
+		ret = decode_packet_last_event_timestamp(trace,
+			default_cc, index, last_entry_idx,
+			&index->timestamps_end[last_entry_idx],
+			&index->timestamps_end_ns[last_entry_idx]);
+		if (ret) {
+			BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
+				"Failed to decode last event's clock snapshot");
+			goto end;
+		}
+	}
 
-		/* 1. Fix the last entry first. */
-		if (last_entry->timestamp_end == 0 &&
-				last_entry->timestamp_begin != 0) {
+	/* Iterate over all entries but the last one. */
+	for (entry_idx = 0; entry_idx < index->len - 1; entry_idx++) {
+		if (index->timestamps_end[entry_idx] == 0 &&
+				index->timestamps_begin[entry_idx] != 0) {
 			/*
-			 * Decode packet to read the timestamp of the
-			 * last event of the stream file.
+			 * 2. Set the current index entry `end` timestamp to
+			 * the next index entry `begin` timestamp.
 			 */
-			ret = decode_packet_last_event_timestamp(trace,
-				default_cc, last_entry,
-				&last_entry->timestamp_end,
-				&last_entry->timestamp_end_ns);
-			if (ret) {
-				BT_COMP_LOGE_APPEND_CAUSE(trace->self_comp,
-					"Failed to decode last event's clock snapshot");
-				goto end;
-			}
-		}
-
-		/* Iterate over all entries but the last one. */
-		for (entry_idx = 0; entry_idx < index->entries->len - 1;
-				entry_idx++) {
-			struct ctf_fs_ds_index_entry *curr_entry, *next_entry;
-			curr_entry = g_ptr_array_index(index->entries, entry_idx);
-			next_entry = g_ptr_array_index(index->entries, entry_idx + 1);
-
-			if (curr_entry->timestamp_end == 0 &&
-					curr_entry->timestamp_begin != 0) {
-				/*
-				 * 2. Set the current index entry `end` timestamp to
-				 * the next index entry `begin` timestamp.
-				 */
-				curr_entry->timestamp_end = next_entry->timestamp_begin;
-				curr_entry->timestamp_end_ns = next_entry->timestamp_begin_ns;
-			}
+			index->timestamps_end[entry_idx] =
+				index->timestamps_begin[entry_idx + 1];
+			index->timestamps_end_ns[entry_idx] =
+				index->timestamps_begin_ns[entry_idx + 1];
 		}
 	}
 
@@ -1805,6 +2373,13 @@ end:
 	return ret;
 }
 
+static
+int fix_index_lttng_crash_quirk(struct ctf_fs_trace *trace)
+{
+	return fix_ds_file_group_indexes(trace,
+		fix_ds_file_group_index_lttng_crash_quirk);
+}
+
 /*
  * Extract the tracer information necessary to compare versions.
  * Returns 0 on success, and -1 if the extraction is not successful because the
@@ -1958,6 +2533,35 @@ bool is_tracer_affected_by_lttng_crash_quirk(
 	return is_affected;
 }
 
+/*
+ * Returns whether or not the index entries of all the data stream files
+ * of `trace` come from the index cache, in which case they're already
+ * fixed up.
+ */
+static
+bool trace_index_is_from_cache(struct ctf_fs_trace *trace)
+{
+	guint group_i, info_i;
+
+	for (group_i = 0; group_i < trace->ds_file_groups->len; group_i++) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(trace->ds_file_groups, group_i);
+
+		for (info_i = 0; info_i < ds_file_group->ds_file_infos->len;
+				info_i++) {
+			struct ctf_fs_ds_file_info *ds_file_info =
+				g_ptr_array_index(ds_file_group->ds_file_infos,
+					info_i);
+
+			if (!ds_file_info->index_from_cache) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 /*
  * Looks for trace produced by known buggy tracers and fix up the index
  * produced earlier.
@@ -1970,6 +2574,7 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 	int ret = 0;
 	struct tracer_info current_tracer_info;
 	bt_logging_level log_level = ctf_fs->log_level;
+	bool index_is_fixed;
 
 	ret = extract_tracer_info(ctf_fs->trace, &current_tracer_info);
 	if (ret) {
@@ -1985,11 +2590,22 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 		goto end;;
 	}
 
+	/*
+	 * The index cache contains fixed up index entries. The fix ups
+	 * are idempotent, so it's still correct to apply them when only
+	 * some data stream files hit the index cache.
+	 */
+	index_is_fixed = trace_index_is_from_cache(ctf_fs->trace);
+	if (index_is_fixed) {
+		BT_LOGI_STR("Packet index comes from the index cache: not fixing it up.");
+	}
+
 	/* Check if the trace may be affected by old tracer bugs. */
 	if (is_tracer_affected_by_lttng_event_after_packet_bug(
 			&current_tracer_info)) {
 		BT_LOGI_STR("Trace may be affected by LTTng tracer packet timestamp bug. Fixing up.");
-		ret = fix_index_lttng_event_after_packet_bug(ctf_fs->trace);
+		ret = index_is_fixed ? 0 :
+			fix_index_lttng_event_after_packet_bug(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 				self_comp, self_comp_class,
@@ -2002,7 +2618,8 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 	if (is_tracer_affected_by_barectf_event_before_packet_bug(
 			&current_tracer_info)) {
 		BT_LOGI_STR("Trace may be affected by barectf tracer packet timestamp bug. Fixing up.");
-		ret = fix_index_barectf_event_before_packet_bug(ctf_fs->trace);
+		ret = index_is_fixed ? 0 :
+			fix_index_barectf_event_before_packet_bug(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 				self_comp, self_comp_class,
@@ -2014,7 +2631,8 @@ int fix_packet_index_tracer_bugs(struct ctf_fs_component *ctf_fs,
 
 	if (is_tracer_affected_by_lttng_crash_quirk(
 			&current_tracer_info)) {
-		ret = fix_index_lttng_crash_quirk(ctf_fs->trace);
+		ret = index_is_fixed ? 0 :
+			fix_index_lttng_crash_quirk(ctf_fs->trace);
 		if (ret) {
 			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(
 				self_comp, self_comp_class,
@@ -2178,6 +2796,11 @@ int ctf_fs_component_create_ctf_fs_trace(
 			"Failed to fix packet index tracer bugs.");
 	}
 
+	if (!ret && ctf_fs->index_cache_dir) {
+		ctf_fs_index_cache_save(ctf_fs->index_cache_dir->str,
+			ctf_fs->trace);
+	}
+
 	/*
 	 * Sort data stream file groups by first data stream file info
 	 * path to get a deterministic order. This order influences the
@@ -2309,10 +2932,106 @@ end:
 	return ret;
 }
 
+/*
+ * Removes, from the index of `ds_file_group`, the entries of the packets
+ * which are completely outside the [`begin_ns`, `end_ns`] time range,
+ * so that the message iterator doesn't decode them.
+ */
+static
+void prune_ds_file_group_index(struct ctf_fs_ds_file_group *ds_file_group,
+		int64_t begin_ns, int64_t end_ns, bt_logging_level log_level,
+		bt_self_component *self_comp)
+{
+	struct ctf_fs_ds_index *index = ds_file_group->index;
+	struct ctf_stream_class *sc = ds_file_group->sc;
+	guint first;
+	guint last;
+
+	if (!sc->default_clock_class || !sc->packets_have_ts_begin ||
+			!sc->packets_have_ts_end) {
+		/* The index entries have no meaningful time bounds. */
+		BT_COMP_LOGD("Not pruning index of data stream file group: "
+			"packets have no beginning or end times: "
+			"sc-id=%" PRIu64 ", stream-id=%" PRIu64,
+			sc->id, ds_file_group->stream_id);
+		return;
+	}
+
+	/* First packet which ends at or after `begin_ns` */
+	first = ctf_fs_ds_index_find_entry_index_by_ns(index, begin_ns);
+	if (index->timestamps_end_ns[first] < begin_ns) {
+		first = index->len;
+	} else if (first > 0 &&
+			(sc->has_discarded_events || sc->has_discarded_packets)) {
+		/*
+		 * The discarded events and packets of a packet are
+		 * computed from the counters of the previous packet:
+		 * keep it, otherwise the first packet would report all
+		 * the items discarded since the beginning of the stream.
+		 */
+		first--;
+	}
+
+	/* One past the last packet which begins at or before `end_ns` */
+	last = index->len;
+	while (last > first) {
+		if (index->timestamps_begin_ns[last - 1] <= end_ns) {
+			break;
+		}
+
+		last--;
+	}
+
+	BT_COMP_LOGD("Pruning index of data stream file group: "
+		"sc-id=%" PRIu64 ", stream-id=%" PRIu64 ", "
+		"begin=%" PRId64 ", end=%" PRId64 ", entry-count=%u, "
+		"first-kept-entry-index=%u, kept-entry-count=%u",
+		sc->id, ds_file_group->stream_id, begin_ns, end_ns,
+		index->len, first, last - first);
+	ctf_fs_ds_index_keep_range(index, first, last - first);
+}
+
+/*
+ * Prunes the index of each data stream file group of `ctf_fs`'s trace
+ * according to the `begin` and `end` parameters, removing the groups
+ * which have no packets left.
+ */
+static
+void prune_ds_file_groups(struct ctf_fs_component *ctf_fs)
+{
+	GPtrArray *ds_file_groups = ctf_fs->trace->ds_file_groups;
+	guint i = 0;
+
+	if (ctf_fs->begin_ns == INT64_MIN && ctf_fs->end_ns == INT64_MAX) {
+		return;
+	}
+
+	while (i < ds_file_groups->len) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(ds_file_groups, i);
+
+		prune_ds_file_group_index(ds_file_group, ctf_fs->begin_ns,
+			ctf_fs->end_ns, ctf_fs->log_level,
+			ctf_fs->trace->self_comp);
+
+		if (ds_file_group->index->len == 0) {
+			/* Keep the order of the ports */
+			g_ptr_array_remove_index(ds_file_groups, i);
+			continue;
+		}
+
+		i++;
+	}
+}
+
 static const struct bt_param_validation_value_descr inputs_elem_descr = {
 	.type = BT_VALUE_TYPE_STRING,
 };
 
+static const struct bt_param_validation_value_descr event_classes_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
 static const struct bt_param_validation_map_value_entry_descr fs_params_entries_descr[] = {
 	{ "inputs", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_MANDATORY, {
 		BT_VALUE_TYPE_ARRAY,
@@ -2325,7 +3044,26 @@ static const struct bt_param_validation_map_value_entry_descr fs_params_entries_
 	{ "trace-name", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "clock-class-offset-s", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
 	{ "clock-class-offset-ns", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
+	{ "decode-threads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
 	{ "force-clock-class-origin-unix-epoch", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "index-cache-directory", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "indexing-threads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "lazy-event-payloads", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "read-ahead-packets", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "read-ahead-method", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "metadata-cache-directory", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
+	{ "max-open-files", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "mmap-window-size", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
+	{ "begin", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
+	{ "end", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_SIGNED_INTEGER } },
+	{ "event-classes", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, {
+		BT_VALUE_TYPE_ARRAY,
+		.array = {
+			.min_length = 0,
+			.max_length = BT_PARAM_VALIDATION_INFINITE,
+			.element_type = &event_classes_elem_descr,
+		}
+	}},
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -2378,6 +3116,188 @@ bool read_src_fs_parameters(const bt_value *params,
 			bt_value_bool_get(value);
 	}
 
+	/* index-cache-directory parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"index-cache-directory");
+	if (value) {
+		ctf_fs->index_cache_dir = g_string_new(
+			bt_value_string_get(value));
+		if (!ctf_fs->index_cache_dir) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class, "Failed to allocate a GString.");
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* event-classes parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"event-classes");
+	if (value) {
+		ctf_fs->ec_filter = ctf_event_class_filter_create(value);
+		if (!ctf_fs->ec_filter) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Failed to create an event class filter.");
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* decode-threads parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"decode-threads");
+	if (value) {
+		ctf_fs->decode_threads = bt_value_bool_get(value);
+	}
+
+	/* lazy-event-payloads parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"lazy-event-payloads");
+	if (value) {
+		ctf_fs->lazy_event_payloads = bt_value_bool_get(value);
+	}
+
+	/* indexing-threads parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"indexing-threads");
+	if (value) {
+		uint64_t indexing_threads = bt_value_integer_unsigned_get(value);
+
+		if (indexing_threads == 0 || indexing_threads > G_MAXINT) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `indexing-threads` parameter: "
+				"expecting a value between 1 and %d: "
+				"value=%" PRIu64, G_MAXINT, indexing_threads);
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->indexing_threads = (guint) indexing_threads;
+	}
+
+	/* read-ahead-packets parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"read-ahead-packets");
+	if (value) {
+		uint64_t read_ahead_packets = bt_value_integer_unsigned_get(value);
+
+		if (read_ahead_packets > CTF_FS_MAX_READ_AHEAD_PACKETS) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `read-ahead-packets` parameter: "
+				"expecting a value between 0 and %d: "
+				"value=%" PRIu64, CTF_FS_MAX_READ_AHEAD_PACKETS,
+				read_ahead_packets);
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->read_ahead_packets = (guint) read_ahead_packets;
+	}
+
+	/* read-ahead-method parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"read-ahead-method");
+	if (value) {
+		const char *method = bt_value_string_get(value);
+
+		if (strcmp(method, "auto") == 0) {
+			ctf_fs->read_ahead_method = CTF_FS_READ_AHEAD_METHOD_AUTO;
+		} else if (strcmp(method, "pread") == 0) {
+			ctf_fs->read_ahead_method = CTF_FS_READ_AHEAD_METHOD_PREAD;
+		} else if (strcmp(method, "io-uring") == 0) {
+			if (!ctf_fs_read_ahead_has_io_uring()) {
+				BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+					self_comp_class,
+					"Invalid `read-ahead-method` parameter: "
+					"io_uring support is not available.");
+				ret = false;
+				goto end;
+			}
+
+			ctf_fs->read_ahead_method =
+				CTF_FS_READ_AHEAD_METHOD_IO_URING;
+		} else {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `read-ahead-method` parameter: "
+				"expecting `auto`, `pread`, or `io-uring`: "
+				"value=\"%s\"", method);
+			ret = false;
+			goto end;
+		}
+	}
+
+	/* metadata-cache-directory parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"metadata-cache-directory");
+	if (value) {
+		ctf_fs->metadata_cache_dir = g_string_new(
+			bt_value_string_get(value));
+		if (!ctf_fs->metadata_cache_dir) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class, "Failed to allocate a GString.");
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->metadata_config.trace_class_cache_dir =
+			ctf_fs->metadata_cache_dir->str;
+	}
+
+	/* max-open-files parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"max-open-files");
+	if (value) {
+		bt_fd_cache_set_max_open_fds(&ctf_fs->fd_cache,
+			bt_value_integer_unsigned_get(value));
+	}
+
+	/* mmap-window-size parameter */
+	value = bt_value_map_borrow_entry_value_const(params,
+		"mmap-window-size");
+	if (value) {
+		uint64_t mmap_window_size = bt_value_integer_unsigned_get(value);
+
+		if (mmap_window_size > SIZE_MAX / 2) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Invalid `mmap-window-size` parameter: "
+				"expecting a value less than or equal to %zu: "
+				"value=%" PRIu64, (size_t) SIZE_MAX / 2,
+				mmap_window_size);
+			ret = false;
+			goto end;
+		}
+
+		ctf_fs->mmap_window_size = mmap_window_size;
+	}
+
+	/* begin parameter */
+	value = bt_value_map_borrow_entry_value_const(params, "begin");
+	if (value) {
+		ctf_fs->begin_ns = bt_value_integer_signed_get(value);
+	}
+
+	/* end parameter */
+	value = bt_value_map_borrow_entry_value_const(params, "end");
+	if (value) {
+		ctf_fs->end_ns = bt_value_integer_signed_get(value);
+	}
+
+	if (ctf_fs->begin_ns > ctf_fs->end_ns) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+			self_comp_class,
+			"Invalid `begin` and `end` parameters: "
+			"beginning time is greater than end time: "
+			"begin=%" PRId64 ", end=%" PRId64,
+			ctf_fs->begin_ns, ctf_fs->end_ns);
+		ret = false;
+		goto end;
+	}
+
 	/* trace-name parameter */
 	*trace_name = bt_value_map_borrow_entry_value_const(params, "trace-name");
 
@@ -2417,6 +3337,8 @@ struct ctf_fs_component *ctf_fs_create(
 		goto error;
 	}
 
+	prune_ds_file_groups(ctf_fs);
+
 	if (create_streams_for_trace(ctf_fs->trace)) {
 		goto error;
 	}
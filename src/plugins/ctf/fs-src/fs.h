@@ -29,8 +29,10 @@
  */
 
 #include <stdbool.h>
+#include <time.h>
 #include "common/macros.h"
 #include <babeltrace2/babeltrace.h>
+#include "fd-cache/fd-cache.h"
 #include "data-stream-file.h"
 #include "metadata.h"
 #include "../common/metadata/decoder.h"
@@ -38,6 +40,12 @@
 BT_HIDDEN
 extern bool ctf_fs_debug;
 
+/*
+ * Number of message batches which the decoding thread of a message
+ * iterator (see the `decode-threads` parameter) queues at most.
+ */
+#define CTF_FS_DECODE_QUEUE_SIZE	8
+
 struct ctf_fs_file {
 	bt_logging_level log_level;
 
@@ -50,7 +58,22 @@ struct ctf_fs_file {
 	/* Owned by this */
 	FILE *fp;
 
+	/*
+	 * Weak: cache from which to get `fd_handle` when the file is
+	 * opened with ctf_fs_file_open_from_cache(), or `NULL`.
+	 */
+	struct bt_fd_cache *fd_cache;
+
+	/* Owned by this (see ctf_fs_file_acquire_fd()), or `NULL` */
+	struct bt_fd_cache_handle *fd_handle;
+
 	off_t size;
+
+	/*
+	 * Last modification time of the file when it was opened, in
+	 * nanoseconds since the Epoch
+	 */
+	int64_t mtime_ns;
 };
 
 struct ctf_fs_metadata {
@@ -79,6 +102,62 @@ struct ctf_fs_component {
 	struct ctf_fs_trace *trace;
 
 	struct ctf_fs_metadata_config metadata_config;
+
+	/*
+	 * Directory of the packet index cache, owned by this, or `NULL`
+	 * if the index cache is disabled.
+	 */
+	GString *index_cache_dir;
+
+	/*
+	 * Owned by this: directory of the trace class cache, or `NULL`
+	 * if the trace class cache is disabled.
+	 */
+	GString *metadata_cache_dir;
+
+	/* Maximum number of threads to use to build the packet indexes */
+	guint indexing_threads;
+
+	/*
+	 * Maximum size of the memory mappings of the data stream files,
+	 * or `CTF_FS_DS_FILE_MMAP_WINDOW_WHOLE_FILE`.
+	 */
+	uint64_t mmap_window_size;
+
+	/*
+	 * Number of packets that the read-ahead thread of each message
+	 * iterator reads ahead of the decoding, or 0 to disable
+	 * read-ahead.
+	 */
+	guint read_ahead_packets;
+
+	/* How the read-ahead threads read the packets */
+	enum ctf_fs_read_ahead_method read_ahead_method;
+
+	/*
+	 * True to only decode the payload field of an event when it's
+	 * first borrowed, when possible.
+	 */
+	bool lazy_event_payloads;
+
+	/* True to decode each data stream in a dedicated thread */
+	bool decode_threads;
+
+	/*
+	 * Event classes of which to emit the events, owned by this, or
+	 * `NULL` to emit all the events.
+	 */
+	struct ctf_event_class_filter *ec_filter;
+
+	/* Shared by all the data stream files of the component */
+	struct bt_fd_cache fd_cache;
+
+	/*
+	 * Time range, in nanoseconds from origin, of the packets to
+	 * read: INT64_MIN and INT64_MAX when not limited.
+	 */
+	int64_t begin_ns;
+	int64_t end_ns;
 };
 
 struct ctf_fs_trace {
@@ -106,8 +185,32 @@ struct ctf_fs_trace {
 
 	/* Next automatic stream ID when not provided by packet header */
 	uint64_t next_stream_id;
+
+	/*
+	 * Weak, belongs to component: directory of the packet index
+	 * cache, or `NULL` if the index cache is disabled.
+	 */
+	const char *index_cache_dir;
+
+	/* Maximum number of threads to use to build the packet indexes */
+	guint indexing_threads;
+
+	/*
+	 * Maximum size of the memory mappings of the data stream files,
+	 * or `CTF_FS_DS_FILE_MMAP_WINDOW_WHOLE_FILE`.
+	 */
+	uint64_t mmap_window_size;
+
+	/* Weak, belongs to component: cache of data stream file FDs */
+	struct bt_fd_cache *fd_cache;
 };
 
+/*
+ * Packet index entry, as a standalone value.
+ *
+ * A `struct ctf_fs_ds_index` doesn't contain such structures: use
+ * ctf_fs_ds_index_append_entry() to add one to its columns.
+ */
 struct ctf_fs_ds_index_entry {
 	/* Weak, belongs to ctf_fs_ds_file_info. */
 	const char *path;
@@ -130,17 +233,75 @@ struct ctf_fs_ds_index_entry {
 	 */
 	int64_t timestamp_begin_ns, timestamp_end_ns;
 
+	/*
+	 * `timestamp_begin` and `timestamp_end` as read from the packet
+	 * context or from the LTTng index, before fixing up any tracer
+	 * bug. Two entries with the same original time bounds describe
+	 * the same packet.
+	 */
+	uint64_t orig_timestamp_begin, orig_timestamp_end;
+
 	/*
 	 * Packet sequence number, or UINT64_MAX if not present in the index.
 	 */
 	uint64_t packet_seq_num;
 };
 
+/*
+ * Packet index, sorted by packet beginning time.
+ *
+ * The index is stored by column: the element at rank `i` of each array
+ * below is an attribute of the entry at rank `i`, with the same meaning
+ * as the corresponding member of `struct ctf_fs_ds_index_entry`. This
+ * keeps millions of entries compact and makes searching by time only
+ * touch the time columns.
+ */
 struct ctf_fs_ds_index {
-	/* Array of pointer to struct ctf_fs_ds_index_entry. */
-	GPtrArray *entries;
+	/* Number of entries */
+	guint len;
+
+	/* Number of allocated elements of each column */
+	guint capacity;
+
+	/* Rank, within `paths`, of the entry's data stream file path */
+	guint32 *path_ids;
+
+	uint64_t *offsets;
+	uint64_t *packet_sizes;
+	uint64_t *timestamps_begin;
+	uint64_t *timestamps_end;
+	int64_t *timestamps_begin_ns;
+	int64_t *timestamps_end_ns;
+	uint64_t *orig_timestamps_begin;
+	uint64_t *orig_timestamps_end;
+	uint64_t *packet_seq_nums;
+
+	/*
+	 * Offset and size, within the data stream file as stored, of the
+	 * bytes to read to get the packet: the packet itself if the file
+	 * is not compressed, or the zstd frames which contain exactly the
+	 * packet otherwise.
+	 */
+	uint64_t *frame_offsets;
+	uint64_t *frame_sizes;
+
+	/*
+	 * Interned data stream file paths (`const char *`, weak, belong
+	 * to ctf_fs_ds_file_info), compared by address.
+	 */
+	GPtrArray *paths;
 };
 
+/*
+ * Returns the data stream file path of the entry at rank `i` of `index`.
+ */
+static inline
+const char *ctf_fs_ds_index_get_path(const struct ctf_fs_ds_index *index,
+		guint i)
+{
+	return g_ptr_array_index(index->paths, index->path_ids[i]);
+}
+
 struct ctf_fs_ds_file_group {
 	/*
 	 * Array of struct ctf_fs_ds_file_info, owned by this.
@@ -202,6 +363,14 @@ struct ctf_fs_msg_iter_data {
 	bt_message_iterator_class_next_method_status next_saved_status;
 	const struct bt_error *next_saved_error;
 
+	/*
+	 * Messages (`const bt_message *`, owned by this) to return before
+	 * getting new ones from `msg_iter`. A "seek nanoseconds from
+	 * origin" operation fills this queue with the messages which
+	 * bring the stream to its state at the seeking time.
+	 */
+	GQueue *pending_msgs;
+
 	struct ctf_fs_ds_group_medops_data *msg_iter_medops_data;
 };
 
@@ -240,6 +409,16 @@ BT_HIDDEN
 bt_message_iterator_class_seek_beginning_method_status ctf_fs_iterator_seek_beginning(
 		bt_self_message_iterator *message_iterator);
 
+BT_HIDDEN
+bt_message_iterator_class_seek_ns_from_origin_method_status ctf_fs_iterator_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin);
+
+BT_HIDDEN
+bt_message_iterator_class_can_seek_ns_from_origin_method_status ctf_fs_iterator_can_seek_ns_from_origin(
+		bt_self_message_iterator *message_iterator,
+		int64_t ns_from_origin, bt_bool *can_seek);
+
 /* Create and initialize a new, empty ctf_fs_component. */
 
 BT_HIDDEN
@@ -0,0 +1,426 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (self_comp)
+#define BT_LOG_OUTPUT_LEVEL (log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/INDEX-CACHE"
+#include "logging/comp-logging.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include "common/uuid.h"
+#include "file.h"
+#include "fs.h"
+#include "index-cache.h"
+#include "../common/metadata/ctf-meta.h"
+
+#define INDEX_CACHE_MAGIC	0xC1F1CAC5
+#define INDEX_CACHE_VERSION	2
+#define INDEX_CACHE_FILE_SUFFIX	".bt2idx"
+
+/*
+ * Header at the beginning of each cache file, followed by the data
+ * stream file's path (`path_len` bytes, without a terminating null
+ * character) and then by `entry_count` entries.
+ */
+struct index_cache_file_hdr {
+	uint32_t magic;
+	uint32_t version;
+
+	/* Size of struct index_cache_entry, in bytes */
+	uint32_t entry_size;
+
+	uint32_t path_len;
+	uint8_t uuid[BT_UUID_LEN];
+	uint64_t file_size;
+	int64_t file_mtime_ns;
+	uint64_t entry_count;
+} __attribute__((__packed__));
+
+struct index_cache_entry {
+	uint64_t offset;
+	uint64_t packet_size;
+	uint64_t packet_seq_num;
+	uint64_t orig_timestamp_begin;
+	uint64_t orig_timestamp_end;
+
+	/* After fixing up any tracer bug */
+	uint64_t timestamp_begin;
+	uint64_t timestamp_end;
+} __attribute__((__packed__));
+
+static
+gchar *get_cache_file_path(const char *cache_dir, const char *ds_file_path)
+{
+	gchar *checksum;
+	gchar *basename = NULL;
+	gchar *path = NULL;
+
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA256,
+		ds_file_path, -1);
+	if (!checksum) {
+		goto end;
+	}
+
+	basename = g_strconcat(checksum, INDEX_CACHE_FILE_SUFFIX, NULL);
+	path = g_build_filename(cache_dir, basename, NULL);
+
+end:
+	g_free(checksum);
+	g_free(basename);
+	return path;
+}
+
+static
+void set_hdr_uuid(struct index_cache_file_hdr *hdr, struct ctf_trace_class *tc)
+{
+	if (tc->is_uuid_set) {
+		bt_uuid_copy(hdr->uuid, tc->uuid);
+	} else {
+		memset(hdr->uuid, 0, sizeof(hdr->uuid));
+	}
+}
+
+static
+int cycles_to_ns(struct ctf_clock_class *default_cc, uint64_t cycles,
+		int64_t *ns)
+{
+	int ret = 0;
+
+	if (cycles == UINT64_C(-1)) {
+		/* No time bound: see init_index_entry() */
+		*ns = UINT64_C(-1);
+		goto end;
+	}
+
+	if (!default_cc) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_util_clock_cycles_to_ns_from_origin(cycles,
+		default_cc->frequency, default_cc->offset_seconds,
+		default_cc->offset_cycles, ns);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_index_cache_load(const char *cache_dir,
+		struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_file_info *ds_file_info,
+		struct ctf_clock_class *default_cc)
+{
+	gchar *cache_file_path = NULL;
+	gchar *contents = NULL;
+	gsize contents_len;
+	const char *pos;
+	struct index_cache_file_hdr hdr;
+	struct index_cache_file_hdr expected_hdr;
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_index_entry index_entry;
+	const char *ds_file_path = ds_file_info->path->str;
+	uint64_t i;
+	bt_self_component *self_comp = ds_file->self_comp;
+	bt_logging_level log_level = ds_file->log_level;
+
+	cache_file_path = get_cache_file_path(cache_dir, ds_file_path);
+	if (!cache_file_path) {
+		BT_COMP_LOGE("Cannot get index cache file path: "
+			"ds-file-path=\"%s\"", ds_file_path);
+		goto error;
+	}
+
+	/* Read the whole cache file at once. */
+	if (!g_file_get_contents(cache_file_path, &contents, &contents_len,
+			NULL)) {
+		BT_COMP_LOGD("Cannot read index cache file: path=\"%s\"",
+			cache_file_path);
+		goto error;
+	}
+
+	if (contents_len < sizeof(hdr)) {
+		BT_COMP_LOGW("Invalid index cache file: "
+			"file size (%zu bytes) < header size (%zu bytes): "
+			"path=\"%s\"", (size_t) contents_len, sizeof(hdr),
+			cache_file_path);
+		goto error;
+	}
+
+	/*
+	 * Everything in the header but the entry count identifies the
+	 * data stream file and the format: compare it as a whole.
+	 */
+	memcpy(&hdr, contents, sizeof(hdr));
+	memset(&expected_hdr, 0, sizeof(expected_hdr));
+	expected_hdr.magic = INDEX_CACHE_MAGIC;
+	expected_hdr.version = INDEX_CACHE_VERSION;
+	expected_hdr.entry_size = sizeof(struct index_cache_entry);
+	expected_hdr.path_len = strlen(ds_file_path);
+	set_hdr_uuid(&expected_hdr, ds_file->metadata->tc);
+	expected_hdr.file_size = ds_file->file->size;
+	expected_hdr.file_mtime_ns = ds_file->file->mtime_ns;
+	expected_hdr.entry_count = hdr.entry_count;
+
+	if (memcmp(&hdr, &expected_hdr, sizeof(hdr)) != 0) {
+		BT_COMP_LOGI("Index cache file is stale or invalid: "
+			"path=\"%s\", ds-file-path=\"%s\"", cache_file_path,
+			ds_file_path);
+		goto error;
+	}
+
+	if (hdr.entry_count == 0 ||
+			contents_len < sizeof(hdr) + hdr.path_len ||
+			(contents_len - sizeof(hdr) - hdr.path_len) !=
+				hdr.entry_count * sizeof(struct index_cache_entry)) {
+		BT_COMP_LOGW("Invalid index cache file: unexpected size: "
+			"path=\"%s\", file-size=%zu, entry-count=%" PRIu64,
+			cache_file_path, (size_t) contents_len, hdr.entry_count);
+		goto error;
+	}
+
+	pos = contents + sizeof(hdr);
+
+	/* The checksum could collide: also compare the complete path. */
+	if (strncmp(pos, ds_file_path, hdr.path_len) != 0) {
+		BT_COMP_LOGI("Index cache file is for another data stream file: "
+			"path=\"%s\", ds-file-path=\"%s\"", cache_file_path,
+			ds_file_path);
+		goto error;
+	}
+
+	pos += hdr.path_len;
+	index = ctf_fs_ds_index_create(log_level, self_comp);
+	if (!index) {
+		goto error;
+	}
+
+	for (i = 0; i < hdr.entry_count; i++) {
+		struct index_cache_entry cache_entry;
+
+		memcpy(&cache_entry, pos, sizeof(cache_entry));
+		pos += sizeof(cache_entry);
+		ctf_fs_ds_index_entry_init(&index_entry);
+		index_entry.path = ds_file_path;
+		index_entry.offset = cache_entry.offset;
+		index_entry.packet_size = cache_entry.packet_size;
+		index_entry.packet_seq_num = cache_entry.packet_seq_num;
+		index_entry.orig_timestamp_begin =
+			cache_entry.orig_timestamp_begin;
+		index_entry.orig_timestamp_end = cache_entry.orig_timestamp_end;
+		index_entry.timestamp_begin = cache_entry.timestamp_begin;
+		index_entry.timestamp_end = cache_entry.timestamp_end;
+
+		/*
+		 * Convert the time bounds now as the clock class offset
+		 * can depend on the component's parameters.
+		 */
+		if (cycles_to_ns(default_cc, index_entry.timestamp_begin,
+					&index_entry.timestamp_begin_ns) ||
+				cycles_to_ns(default_cc,
+					index_entry.timestamp_end,
+					&index_entry.timestamp_end_ns)) {
+			BT_COMP_LOGI("Cannot convert cached packet time bounds "
+				"to nanoseconds from origin: path=\"%s\"",
+				cache_file_path);
+			goto error;
+		}
+
+		ctf_fs_ds_index_append_entry(index, &index_entry);
+	}
+
+	BT_COMP_LOGI("Loaded index from index cache: path=\"%s\", "
+		"ds-file-path=\"%s\", entry-count=%" PRIu64,
+		cache_file_path, ds_file_path, hdr.entry_count);
+	goto end;
+
+error:
+	ctf_fs_ds_index_destroy(index);
+	index = NULL;
+
+end:
+	g_free(cache_file_path);
+	g_free(contents);
+	return index;
+}
+
+static
+int save_ds_file_index(const char *cache_dir, struct ctf_fs_trace *trace,
+		struct ctf_fs_ds_file_info *ds_file_info,
+		struct ctf_fs_ds_index *index)
+{
+	int ret = 0;
+	gchar *cache_file_path = NULL;
+	GByteArray *contents = NULL;
+	GError *error = NULL;
+	struct index_cache_file_hdr hdr;
+	const char *ds_file_path = ds_file_info->path->str;
+	guint entry_count = 0;
+	guint i;
+	bt_self_component *self_comp = trace->self_comp;
+	bt_logging_level log_level = trace->log_level;
+
+	cache_file_path = get_cache_file_path(cache_dir, ds_file_path);
+	if (!cache_file_path) {
+		BT_COMP_LOGE("Cannot get index cache file path: "
+			"ds-file-path=\"%s\"", ds_file_path);
+		goto error;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = INDEX_CACHE_MAGIC;
+	hdr.version = INDEX_CACHE_VERSION;
+	hdr.entry_size = sizeof(struct index_cache_entry);
+	hdr.path_len = strlen(ds_file_path);
+	set_hdr_uuid(&hdr, trace->metadata->tc);
+	hdr.file_size = ds_file_info->size;
+	hdr.file_mtime_ns = ds_file_info->mtime_ns;
+	hdr.entry_count = ds_file_info->index_cache_entry_count;
+	contents = g_byte_array_sized_new(sizeof(hdr) + hdr.path_len +
+		hdr.entry_count * sizeof(struct index_cache_entry));
+	if (!contents) {
+		BT_COMP_LOGE_STR("Failed to allocate a GByteArray.");
+		goto error;
+	}
+
+	g_byte_array_append(contents, (const guint8 *) &hdr, sizeof(hdr));
+	g_byte_array_append(contents, (const guint8 *) ds_file_path,
+		hdr.path_len);
+
+	/*
+	 * The entries of this data stream file are the ones of the
+	 * group's index which point to its path, in order.
+	 */
+	for (i = 0; i < index->len; i++) {
+		struct index_cache_entry cache_entry;
+
+		if (ctf_fs_ds_index_get_path(index, i) != ds_file_path) {
+			continue;
+		}
+
+		cache_entry.offset = index->offsets[i];
+		cache_entry.packet_size = index->packet_sizes[i];
+		cache_entry.packet_seq_num = index->packet_seq_nums[i];
+		cache_entry.orig_timestamp_begin =
+			index->orig_timestamps_begin[i];
+		cache_entry.orig_timestamp_end = index->orig_timestamps_end[i];
+		cache_entry.timestamp_begin = index->timestamps_begin[i];
+		cache_entry.timestamp_end = index->timestamps_end[i];
+		g_byte_array_append(contents, (const guint8 *) &cache_entry,
+			sizeof(cache_entry));
+		entry_count++;
+	}
+
+	if (entry_count != ds_file_info->index_cache_entry_count) {
+		/*
+		 * Some entries were merged with identical entries of
+		 * another data stream file: the index of this data
+		 * stream file alone is not complete.
+		 */
+		BT_COMP_LOGI("Not saving incomplete index to index cache: "
+			"ds-file-path=\"%s\", entry-count=%u, "
+			"expected-entry-count=%u", ds_file_path, entry_count,
+			ds_file_info->index_cache_entry_count);
+		goto end;
+	}
+
+	/* g_file_set_contents() atomically replaces the file. */
+	if (!g_file_set_contents(cache_file_path, (const gchar *) contents->data,
+			contents->len, &error)) {
+		BT_COMP_LOGW("Cannot write index cache file: path=\"%s\", "
+			"error=\"%s\"", cache_file_path, error->message);
+		goto error;
+	}
+
+	BT_COMP_LOGI("Saved index to index cache: path=\"%s\", "
+		"ds-file-path=\"%s\", entry-count=%u",
+		cache_file_path, ds_file_path, entry_count);
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_free(cache_file_path);
+
+	if (contents) {
+		g_byte_array_free(contents, TRUE);
+	}
+
+	if (error) {
+		g_error_free(error);
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+void ctf_fs_index_cache_save(const char *cache_dir,
+		struct ctf_fs_trace *trace)
+{
+	guint group_i;
+	bool dir_exists = false;
+	bt_self_component *self_comp = trace->self_comp;
+	bt_logging_level log_level = trace->log_level;
+
+	for (group_i = 0; group_i < trace->ds_file_groups->len; group_i++) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(trace->ds_file_groups, group_i);
+		guint info_i;
+
+		for (info_i = 0; info_i < ds_file_group->ds_file_infos->len;
+				info_i++) {
+			struct ctf_fs_ds_file_info *ds_file_info =
+				g_ptr_array_index(ds_file_group->ds_file_infos,
+					info_i);
+
+			if (ds_file_info->index_cache_entry_count == 0) {
+				continue;
+			}
+
+			if (!dir_exists) {
+				if (g_mkdir_with_parents(cache_dir, 0755)) {
+					BT_COMP_LOGW("Cannot create index cache directory: "
+						"path=\"%s\", errno=%d",
+						cache_dir, errno);
+					goto end;
+				}
+
+				dir_exists = true;
+			}
+
+			/* Errors are logged by save_ds_file_index(). */
+			(void) save_ds_file_index(cache_dir, trace,
+				ds_file_info, ds_file_group->index);
+		}
+	}
+
+end:
+	return;
+}
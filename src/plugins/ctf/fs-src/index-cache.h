@@ -0,0 +1,73 @@
+#ifndef CTF_FS_INDEX_CACHE_H
+#define CTF_FS_INDEX_CACHE_H
+
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * The packet index cache keeps, for each data stream file which has no
+ * LTTng index, the packet index entries built from the data stream
+ * file, including the time bounds after fixing up any tracer bug.
+ *
+ * Each data stream file has its own cache file in the cache directory,
+ * named after the SHA-256 checksum of the data stream file's path. A
+ * cache file is only valid for the exact data stream file path, size,
+ * and last modification time, and trace UUID it records.
+ *
+ * Cache files are stored in the native byte order: they are not meant
+ * to be shared between systems.
+ */
+
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+struct ctf_clock_class;
+struct ctf_fs_ds_file;
+struct ctf_fs_ds_file_info;
+struct ctf_fs_trace;
+
+/*
+ * Loads the cached index of `ds_file` from the cache directory
+ * `cache_dir`, using `default_cc` (may be `NULL`) to convert the
+ * cached time bounds to nanoseconds from origin.
+ *
+ * Returns `NULL` if there's no valid cache file for `ds_file`.
+ */
+BT_HIDDEN
+struct ctf_fs_ds_index *ctf_fs_index_cache_load(const char *cache_dir,
+		struct ctf_fs_ds_file *ds_file,
+		struct ctf_fs_ds_file_info *ds_file_info,
+		struct ctf_clock_class *default_cc);
+
+/*
+ * Saves, to the cache directory `cache_dir`, the index entries of the
+ * data stream files of `trace` which are marked as to be saved.
+ *
+ * Failing to save a cache file is not an error: the index is built
+ * from the data stream file again next time.
+ */
+BT_HIDDEN
+void ctf_fs_index_cache_save(const char *cache_dir,
+		struct ctf_fs_trace *trace);
+
+#endif /* CTF_FS_INDEX_CACHE_H */
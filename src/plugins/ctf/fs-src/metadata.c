@@ -104,6 +104,8 @@ int ctf_fs_metadata_set_trace_class(
 		.force_clock_class_origin_unix_epoch =
 			config ? config->force_clock_class_origin_unix_epoch : false,
 		.create_trace_class = true,
+		.trace_class_cache_dir =
+			config ? config->trace_class_cache_dir : NULL,
 	};
 	bt_logging_level log_level = ctf_fs_trace->log_level;
 
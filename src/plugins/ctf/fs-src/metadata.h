@@ -38,6 +38,12 @@ struct ctf_fs_metadata_config {
 	bool force_clock_class_origin_unix_epoch;
 	int64_t clock_class_offset_s;
 	int64_t clock_class_offset_ns;
+
+	/*
+	 * Weak: directory of the trace class cache, or `NULL` if the
+	 * trace class cache is disabled.
+	 */
+	const char *trace_class_cache_dir;
 };
 
 BT_HIDDEN
@@ -226,29 +226,18 @@ int populate_stream_info(struct ctf_fs_ds_file_group *group,
 {
 	int ret = 0;
 	bt_value_map_insert_entry_status insert_status;
-	struct ctf_fs_ds_index_entry *first_ds_index_entry, *last_ds_index_entry;
 	gchar *port_name = NULL;
 
 	/*
-	 * Since each `struct ctf_fs_ds_file_group` has a sorted array of
-	 * `struct ctf_fs_ds_index_entry`, we can compute the stream range from
-	 * the timestamp_begin of the first index entry and the timestamp_end
-	 * of the last index entry.
+	 * Since each `struct ctf_fs_ds_file_group` has a sorted index, we
+	 * can compute the stream range from the timestamp_begin of the
+	 * first index entry and the timestamp_end of the last index entry.
 	 */
 	BT_ASSERT(group->index);
-	BT_ASSERT(group->index->entries);
-	BT_ASSERT(group->index->entries->len > 0);
-
-	/* First entry. */
-	first_ds_index_entry = (struct ctf_fs_ds_index_entry *) g_ptr_array_index(
-		group->index->entries, 0);
-
-	/* Last entry. */
-	last_ds_index_entry = (struct ctf_fs_ds_index_entry *) g_ptr_array_index(
-		group->index->entries, group->index->entries->len - 1);
-
-	stream_range->begin_ns = first_ds_index_entry->timestamp_begin_ns;
-	stream_range->end_ns = last_ds_index_entry->timestamp_end_ns;
+	BT_ASSERT(group->index->len > 0);
+	stream_range->begin_ns = group->index->timestamps_begin_ns[0];
+	stream_range->end_ns =
+		group->index->timestamps_end_ns[group->index->len - 1];
 
 	/*
 	 * If any of the begin and end timestamps is not set it means that
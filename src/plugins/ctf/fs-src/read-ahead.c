@@ -0,0 +1,929 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (bt_self_message_iterator_borrow_component(self_msg_iter))
+#define BT_LOG_OUTPUT_LEVEL (log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/READ-AHEAD"
+#include "logging/comp-logging.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include "common/align.h"
+#include "common/assert.h"
+#include "fs.h"
+#include "read-ahead.h"
+#include "zstd-file.h"
+
+#ifdef BABELTRACE_HAVE_LIBURING
+# include <liburing.h>
+#endif
+
+struct read_ahead_slot {
+	/* Part which the consumer sees */
+	struct ctf_fs_read_ahead_packet packet;
+
+	/*
+	 * The members below are only accessed by the read-ahead thread,
+	 * except the buffers which the destruction function frees once
+	 * the thread is joined.
+	 */
+
+	/* Allocated size of `packet.buf` */
+	size_t buf_size;
+
+	/*
+	 * Compressed frames of the packet when its data stream file is
+	 * compressed (owned by this), and allocated size of `frame_buf`.
+	 */
+	uint8_t *frame_buf;
+	size_t frame_buf_size;
+
+	/* Rank of the index entry of the packet */
+	guint entry_index;
+
+	/* Size of the packet, according to the index */
+	size_t packet_size;
+
+	/* File descriptor of the data stream file (weak) */
+	int fd;
+
+	/* True if the data stream file is compressed */
+	bool compressed;
+
+	/*
+	 * Destination, size, and offset within the file of the bytes to
+	 * read (the packet or its frames), and number of bytes read so
+	 * far.
+	 */
+	uint8_t *read_buf;
+	size_t read_size;
+	uint64_t read_offset;
+	size_t read_len;
+
+	/* True when the packet is completely read */
+	bool complete;
+};
+
+struct ctf_fs_read_ahead {
+	/* Weak */
+	struct ctf_fs_ds_index *index;
+
+	/* Rank of the first index entry to read */
+	guint first_entry_index;
+
+	/*
+	 * Either `CTF_FS_READ_AHEAD_METHOD_PREAD` or
+	 * `CTF_FS_READ_AHEAD_METHOD_IO_URING`.
+	 */
+	enum ctf_fs_read_ahead_method method;
+
+#ifdef BABELTRACE_HAVE_LIBURING
+	/*
+	 * Only used by the read-ahead thread when `method` is
+	 * `CTF_FS_READ_AHEAD_METHOD_IO_URING`.
+	 */
+	struct io_uring io_uring;
+#endif
+
+	/* Owned by this */
+	GThread *thread;
+
+	/* Protects all the members below */
+	GMutex lock;
+
+	/* Signaled when a packet is added, or when the thread ends */
+	GCond not_empty_cond;
+
+	/* Signaled when a slot is freed, or on cancellation */
+	GCond not_full_cond;
+
+	/*
+	 * Ring of `capacity` slots (owned by this), in index entry order:
+	 *
+	 * * When `consumer_holds` is true, the consumer is decoding the
+	 *   packet of the slot preceding rank `head`.
+	 *
+	 * * `count` ready packets start at rank `head`.
+	 *
+	 * * The read-ahead thread is reading packets into the `filling`
+	 *   following slots.
+	 *
+	 * * The remaining slots are free.
+	 */
+	struct read_ahead_slot *slots;
+	guint capacity;
+	guint head;
+	guint count;
+	guint filling;
+	bool consumer_holds;
+
+	/* True when the thread has no more packets to add */
+	bool done;
+
+	/* True when the consumer asks the thread to stop */
+	bool cancelled;
+
+	/*
+	 * Set by the thread when it fails to read a packet: the consumer
+	 * reports the error once it has removed all the packets which
+	 * the thread read before failing.
+	 */
+	bool failed;
+	guint failed_entry_index;
+	int failed_errno;
+
+	/* Weak: cache from which the thread gets file descriptors */
+	struct bt_fd_cache *fd_cache;
+
+	/* Weak, for logging and appending causes on the consumer's side */
+	bt_self_message_iterator *self_msg_iter;
+	bt_logging_level log_level;
+};
+
+static
+void *aligned_buf_alloc(size_t size)
+{
+	void *buf;
+
+#ifdef __MINGW32__
+	buf = _aligned_malloc(size, CTF_FS_READ_AHEAD_BUF_ALIGN);
+#else
+	if (posix_memalign(&buf, CTF_FS_READ_AHEAD_BUF_ALIGN, size) != 0) {
+		buf = NULL;
+	}
+#endif
+
+	return buf;
+}
+
+static
+void aligned_buf_free(void *buf)
+{
+#ifdef __MINGW32__
+	_aligned_free(buf);
+#else
+	free(buf);
+#endif
+}
+
+/*
+ * Reads up to `size` bytes at offset `offset` of `fd`.
+ *
+ * The file descriptor cache shares `fd` with the other users of the
+ * same file, but they only memory-map it: only the read-ahead thread
+ * uses its file offset.
+ */
+static
+ssize_t read_at(int fd, void *buf, size_t size, uint64_t offset)
+{
+#ifdef __MINGW32__
+	if (lseek(fd, (off_t) offset, SEEK_SET) < 0) {
+		return -1;
+	}
+
+	return read(fd, buf, size);
+#else
+	return pread(fd, buf, size, (off_t) offset);
+#endif
+}
+
+/*
+ * Puts `*fd_handle`, if not `NULL`, and sets it to the handle of the
+ * data stream file `path`, which the read-ahead thread gets from the
+ * file descriptor cache of `read_ahead`.
+ *
+ * Returns the file descriptor, or -1 with `errno` set.
+ */
+static
+int switch_data_stream_file(struct ctf_fs_read_ahead *read_ahead,
+		const char *path, struct bt_fd_cache_handle **fd_handle)
+{
+	if (*fd_handle) {
+		bt_fd_cache_put_handle(read_ahead->fd_cache, *fd_handle);
+	}
+
+	errno = 0;
+	*fd_handle = bt_fd_cache_get_handle(read_ahead->fd_cache, path);
+	if (!*fd_handle) {
+		if (errno == 0) {
+			errno = ENOMEM;
+		}
+
+		return -1;
+	}
+
+	return bt_fd_cache_handle_get_fd(*fd_handle);
+}
+
+/*
+ * Claims the next free slot of `read_ahead` for the read-ahead thread
+ * and sets `*slot` to it. If `wait` is true, waits for a free slot.
+ *
+ * Returns 1 when claimed, 0 when there's no free slot and `wait` is
+ * false, or -1 if the consumer cancelled the read-ahead thread.
+ */
+static
+int claim_slot(struct ctf_fs_read_ahead *read_ahead, bool wait,
+		struct read_ahead_slot **slot)
+{
+	int ret;
+
+	g_mutex_lock(&read_ahead->lock);
+
+	for (;;) {
+		guint used = read_ahead->count + read_ahead->filling +
+			(read_ahead->consumer_holds ? 1 : 0);
+
+		if (read_ahead->cancelled) {
+			ret = -1;
+			goto end;
+		}
+
+		if (used < read_ahead->capacity) {
+			*slot = &read_ahead->slots[(read_ahead->head +
+				read_ahead->count + read_ahead->filling) %
+				read_ahead->capacity];
+			read_ahead->filling++;
+			ret = 1;
+			goto end;
+		}
+
+		if (!wait) {
+			ret = 0;
+			goto end;
+		}
+
+		g_cond_wait(&read_ahead->not_full_cond, &read_ahead->lock);
+	}
+
+end:
+	g_mutex_unlock(&read_ahead->lock);
+	return ret;
+}
+
+/*
+ * Makes the complete slots which follow the ready packets of
+ * `read_ahead` ready, in order.
+ */
+static
+void publish_complete_slots(struct ctf_fs_read_ahead *read_ahead)
+{
+	guint published = 0;
+
+	g_mutex_lock(&read_ahead->lock);
+
+	while (read_ahead->filling > 0) {
+		struct read_ahead_slot *slot = &read_ahead->slots[
+			(read_ahead->head + read_ahead->count) %
+			read_ahead->capacity];
+
+		if (!slot->complete) {
+			break;
+		}
+
+		slot->complete = false;
+		read_ahead->count++;
+		read_ahead->filling--;
+		published++;
+	}
+
+	if (published > 0) {
+		g_cond_signal(&read_ahead->not_empty_cond);
+	}
+
+	g_mutex_unlock(&read_ahead->lock);
+}
+
+static
+void mark_done(struct ctf_fs_read_ahead *read_ahead, bool failed,
+		guint failed_entry_index, int failed_errno)
+{
+	g_mutex_lock(&read_ahead->lock);
+	read_ahead->done = true;
+	read_ahead->failed = failed;
+	read_ahead->failed_entry_index = failed_entry_index;
+	read_ahead->failed_errno = failed_errno;
+	g_cond_signal(&read_ahead->not_empty_cond);
+	g_mutex_unlock(&read_ahead->lock);
+}
+
+/*
+ * Prepares `slot` to receive the packet of the index entry at rank
+ * `entry_index` from `fd`, growing its buffers if needed.
+ *
+ * Returns 0 or `ENOMEM`.
+ */
+static
+int prepare_slot(struct ctf_fs_read_ahead *read_ahead,
+		struct read_ahead_slot *slot, guint entry_index, int fd,
+		bool compressed)
+{
+	int ret = 0;
+
+	slot->entry_index = entry_index;
+	slot->packet_size = (size_t) read_ahead->index->packet_sizes[entry_index];
+	slot->packet.size = 0;
+	slot->fd = fd;
+	slot->compressed = compressed;
+	slot->read_size = (size_t) read_ahead->index->frame_sizes[entry_index];
+	slot->read_offset = read_ahead->index->frame_offsets[entry_index];
+	slot->read_len = 0;
+	slot->complete = false;
+
+	if (compressed && slot->frame_buf_size < slot->read_size) {
+		g_free(slot->frame_buf);
+		slot->frame_buf_size = 0;
+		slot->frame_buf = g_try_malloc(slot->read_size);
+		if (!slot->frame_buf) {
+			ret = ENOMEM;
+			goto end;
+		}
+
+		slot->frame_buf_size = slot->read_size;
+	}
+
+	if (slot->buf_size < slot->packet_size) {
+		size_t buf_size = ALIGN(slot->packet_size,
+			CTF_FS_READ_AHEAD_BUF_ALIGN);
+
+		aligned_buf_free(slot->packet.buf);
+		slot->buf_size = 0;
+		slot->packet.buf = aligned_buf_alloc(buf_size);
+		if (!slot->packet.buf) {
+			ret = ENOMEM;
+			goto end;
+		}
+
+		slot->buf_size = buf_size;
+	}
+
+	slot->read_buf = compressed ? slot->frame_buf : slot->packet.buf;
+
+end:
+	return ret;
+}
+
+/*
+ * Makes the packet of `slot`, which the read-ahead thread completely
+ * read, ready to publish, decompressing it if needed.
+ *
+ * Returns 0 or `EIO` if the frames are invalid.
+ */
+static
+int finish_slot(struct read_ahead_slot *slot, struct ZSTD_DCtx_s **dctx)
+{
+	int ret = 0;
+
+	if (!slot->compressed) {
+		slot->packet.size = slot->read_len;
+		goto end;
+	}
+
+	if (ctf_fs_zstd_decompress(dctx, slot->packet.buf, slot->packet_size,
+			slot->frame_buf, slot->read_len)) {
+		ret = EIO;
+		goto end;
+	}
+
+	slot->packet.size = slot->packet_size;
+
+end:
+	slot->complete = ret == 0;
+	return ret;
+}
+
+/*
+ * Body of the read-ahead thread with `CTF_FS_READ_AHEAD_METHOD_PREAD`.
+ *
+ * This function (as well as the io_uring version) only uses the
+ * standard C library, POSIX, GLib, and the file descriptor cache,
+ * which is thread-safe: it must not log with the component, nor append
+ * error causes, nor touch any library object.
+ */
+static
+gpointer pread_thread_func(gpointer user_data)
+{
+	struct ctf_fs_read_ahead *read_ahead = user_data;
+	struct ZSTD_DCtx_s *dctx = NULL;
+	struct bt_fd_cache_handle *fd_handle = NULL;
+	int fd = -1;
+	const char *fd_path = NULL;
+	bool fd_compressed = false;
+	guint i;
+
+	for (i = read_ahead->first_entry_index; i < read_ahead->index->len;
+			i++) {
+		const char *path = ctf_fs_ds_index_get_path(read_ahead->index,
+			i);
+		struct read_ahead_slot *slot;
+		int ret;
+
+		if (fd < 0 || strcmp(fd_path, path) != 0) {
+			fd = switch_data_stream_file(read_ahead, path,
+				&fd_handle);
+			if (fd < 0) {
+				mark_done(read_ahead, true, i, errno);
+				goto end;
+			}
+
+			fd_path = path;
+			fd_compressed = ctf_fs_zstd_file_is_compressed_path(path);
+		}
+
+		if (claim_slot(read_ahead, true, &slot) < 0) {
+			/* Cancelled */
+			break;
+		}
+
+		ret = prepare_slot(read_ahead, slot, i, fd, fd_compressed);
+		if (ret) {
+			mark_done(read_ahead, true, i, ret);
+			goto end;
+		}
+
+		while (slot->read_len < slot->read_size) {
+			ssize_t len = read_at(fd,
+				slot->read_buf + slot->read_len,
+				slot->read_size - slot->read_len,
+				slot->read_offset + slot->read_len);
+
+			if (len < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				mark_done(read_ahead, true, i, errno);
+				goto end;
+			}
+
+			/*
+			 * Like when memory-mapping the file, a packet which
+			 * goes beyond the end of a truncated file ends with
+			 * the file: the decoder reports the truncation, if
+			 * needed.
+			 */
+			if (len == 0) {
+				break;
+			}
+
+			slot->read_len += (size_t) len;
+		}
+
+		ret = finish_slot(slot, &dctx);
+		if (ret) {
+			mark_done(read_ahead, true, i, ret);
+			goto end;
+		}
+
+		publish_complete_slots(read_ahead);
+	}
+
+	mark_done(read_ahead, false, 0, 0);
+
+end:
+	if (fd_handle) {
+		bt_fd_cache_put_handle(read_ahead->fd_cache, fd_handle);
+	}
+
+	ctf_fs_zstd_dctx_destroy(dctx);
+	return NULL;
+}
+
+#ifdef BABELTRACE_HAVE_LIBURING
+
+/*
+ * Queues a read of the remaining bytes of `slot`.
+ */
+static
+void queue_slot_read(struct ctf_fs_read_ahead *read_ahead,
+		struct read_ahead_slot *slot)
+{
+	struct io_uring_sqe *sqe = io_uring_get_sqe(&read_ahead->io_uring);
+
+	/*
+	 * The submission queue has one entry per slot, and there's at
+	 * most one pending read per slot.
+	 */
+	BT_ASSERT(sqe);
+	io_uring_prep_read(sqe, slot->fd, slot->read_buf + slot->read_len,
+		(unsigned int) MIN(slot->read_size - slot->read_len,
+			(size_t) UINT_MAX),
+		slot->read_offset + slot->read_len);
+	io_uring_sqe_set_data(sqe, slot);
+}
+
+/*
+ * Waits for the `in_flight` pending reads of the read-ahead thread,
+ * discarding their results, so that their buffers may be released.
+ */
+static
+void drain_reads(struct ctf_fs_read_ahead *read_ahead, guint in_flight)
+{
+	while (in_flight > 0) {
+		struct io_uring_cqe *cqe;
+		int ret = io_uring_wait_cqe(&read_ahead->io_uring, &cqe);
+
+		if (ret == -EINTR) {
+			continue;
+		}
+
+		if (ret < 0) {
+			break;
+		}
+
+		io_uring_cqe_seen(&read_ahead->io_uring, cqe);
+		in_flight--;
+	}
+}
+
+/*
+ * Body of the read-ahead thread with
+ * `CTF_FS_READ_AHEAD_METHOD_IO_URING`.
+ *
+ * The thread keeps one read per free slot in flight. The reads of a
+ * given data stream file complete before the thread reads the next
+ * file, so that it only needs one file descriptor.
+ */
+static
+gpointer io_uring_thread_func(gpointer user_data)
+{
+	struct ctf_fs_read_ahead *read_ahead = user_data;
+	struct ZSTD_DCtx_s *dctx = NULL;
+	struct bt_fd_cache_handle *fd_handle = NULL;
+	int fd = -1;
+	const char *fd_path = NULL;
+	bool fd_compressed = false;
+	guint next_i = read_ahead->first_entry_index;
+	guint in_flight = 0;
+	bool failed = false;
+	guint failed_entry_index = 0;
+	int failed_errno = 0;
+
+	for (;;) {
+		struct io_uring_cqe *cqe;
+		struct read_ahead_slot *slot;
+		int ret;
+
+		/* Queue reads into the free slots. */
+		while (next_i < read_ahead->index->len) {
+			const char *path = ctf_fs_ds_index_get_path(
+				read_ahead->index, next_i);
+
+			if (fd < 0 || strcmp(fd_path, path) != 0) {
+				if (in_flight > 0) {
+					break;
+				}
+
+				fd = switch_data_stream_file(read_ahead, path,
+					&fd_handle);
+				if (fd < 0) {
+					failed = true;
+					failed_entry_index = next_i;
+					failed_errno = errno;
+					goto end;
+				}
+
+				fd_path = path;
+				fd_compressed =
+					ctf_fs_zstd_file_is_compressed_path(path);
+			}
+
+			ret = claim_slot(read_ahead, in_flight == 0, &slot);
+			if (ret < 0) {
+				/* Cancelled */
+				goto end;
+			} else if (ret == 0) {
+				break;
+			}
+
+			ret = prepare_slot(read_ahead, slot, next_i, fd,
+				fd_compressed);
+			if (ret) {
+				failed = true;
+				failed_entry_index = next_i;
+				failed_errno = ret;
+				goto end;
+			}
+
+			queue_slot_read(read_ahead, slot);
+			in_flight++;
+			next_i++;
+		}
+
+		if (in_flight == 0) {
+			/* All the packets are read. */
+			goto end;
+		}
+
+		ret = io_uring_submit(&read_ahead->io_uring);
+		if (ret < 0 && ret != -EINTR && ret != -EAGAIN &&
+				ret != -EBUSY) {
+			failed = true;
+			failed_entry_index = next_i - 1;
+			failed_errno = -ret;
+			goto end;
+		}
+
+		ret = io_uring_wait_cqe(&read_ahead->io_uring, &cqe);
+		if (ret == -EINTR) {
+			continue;
+		} else if (ret < 0) {
+			failed = true;
+			failed_entry_index = next_i - 1;
+			failed_errno = -ret;
+			goto end;
+		}
+
+		slot = io_uring_cqe_get_data(cqe);
+		ret = cqe->res;
+		io_uring_cqe_seen(&read_ahead->io_uring, cqe);
+
+		if (ret == -EINTR || ret == -EAGAIN) {
+			/* Retry. */
+			queue_slot_read(read_ahead, slot);
+			continue;
+		} else if (ret < 0) {
+			in_flight--;
+			failed = true;
+			failed_entry_index = slot->entry_index;
+			failed_errno = -ret;
+			goto end;
+		}
+
+		slot->read_len += (size_t) ret;
+
+		if (ret > 0 && slot->read_len < slot->read_size) {
+			/* Short read: read the rest. */
+			queue_slot_read(read_ahead, slot);
+			continue;
+		}
+
+		/*
+		 * Complete packet, or packet ending with a truncated file
+		 * (see pread_thread_func()).
+		 */
+		in_flight--;
+		ret = finish_slot(slot, &dctx);
+		if (ret) {
+			failed = true;
+			failed_entry_index = slot->entry_index;
+			failed_errno = ret;
+			goto end;
+		}
+
+		publish_complete_slots(read_ahead);
+	}
+
+end:
+	drain_reads(read_ahead, in_flight);
+	mark_done(read_ahead, failed, failed_entry_index, failed_errno);
+
+	if (fd_handle) {
+		bt_fd_cache_put_handle(read_ahead->fd_cache, fd_handle);
+	}
+
+	ctf_fs_zstd_dctx_destroy(dctx);
+	return NULL;
+}
+
+#endif /* BABELTRACE_HAVE_LIBURING */
+
+BT_HIDDEN
+bool ctf_fs_read_ahead_has_io_uring(void)
+{
+#ifdef BABELTRACE_HAVE_LIBURING
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Sets up io_uring for `read_ahead` if `method` asks for it and the
+ * system supports it, falling back to pread() with
+ * `CTF_FS_READ_AHEAD_METHOD_AUTO`.
+ *
+ * Returns 0 on success, or -1 if io_uring is required and unavailable.
+ */
+static
+int init_method(struct ctf_fs_read_ahead *read_ahead,
+		enum ctf_fs_read_ahead_method method)
+{
+	bt_self_message_iterator *self_msg_iter = read_ahead->self_msg_iter;
+	bt_logging_level log_level = read_ahead->log_level;
+	int ret = 0;
+
+	read_ahead->method = CTF_FS_READ_AHEAD_METHOD_PREAD;
+
+	if (method == CTF_FS_READ_AHEAD_METHOD_PREAD) {
+		goto end;
+	}
+
+#ifdef BABELTRACE_HAVE_LIBURING
+	ret = io_uring_queue_init(read_ahead->capacity, &read_ahead->io_uring,
+		0);
+	if (ret == 0) {
+		read_ahead->method = CTF_FS_READ_AHEAD_METHOD_IO_URING;
+		goto end;
+	}
+
+	if (method == CTF_FS_READ_AHEAD_METHOD_IO_URING) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"Cannot initialize io_uring: %s", g_strerror(-ret));
+		ret = -1;
+		goto end;
+	}
+
+	BT_COMP_LOGI("Cannot initialize io_uring: falling back to pread(): "
+		"%s", g_strerror(-ret));
+	ret = 0;
+#else
+	if (method == CTF_FS_READ_AHEAD_METHOD_IO_URING) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"io_uring support is not available.");
+		ret = -1;
+		goto end;
+	}
+#endif
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct ctf_fs_read_ahead *ctf_fs_read_ahead_create(
+		struct ctf_fs_ds_index *index,
+		guint first_entry_index, guint depth,
+		enum ctf_fs_read_ahead_method method,
+		struct bt_fd_cache *fd_cache,
+		bt_self_message_iterator *self_msg_iter,
+		bt_logging_level log_level)
+{
+	struct ctf_fs_read_ahead *read_ahead;
+	GThreadFunc thread_func = pread_thread_func;
+	GError *error = NULL;
+
+	BT_ASSERT(index);
+	BT_ASSERT(depth > 0);
+	BT_ASSERT(fd_cache);
+
+	read_ahead = g_new0(struct ctf_fs_read_ahead, 1);
+	read_ahead->index = index;
+	read_ahead->first_entry_index = first_entry_index;
+
+	/* `depth` packets ahead of the one which the consumer holds */
+	read_ahead->capacity = depth + 1;
+	read_ahead->slots = g_new0(struct read_ahead_slot,
+		read_ahead->capacity);
+	read_ahead->fd_cache = fd_cache;
+	read_ahead->self_msg_iter = self_msg_iter;
+	read_ahead->log_level = log_level;
+	g_mutex_init(&read_ahead->lock);
+	g_cond_init(&read_ahead->not_empty_cond);
+	g_cond_init(&read_ahead->not_full_cond);
+
+	if (init_method(read_ahead, method)) {
+		goto error;
+	}
+
+#ifdef BABELTRACE_HAVE_LIBURING
+	if (read_ahead->method == CTF_FS_READ_AHEAD_METHOD_IO_URING) {
+		thread_func = io_uring_thread_func;
+	}
+#endif
+
+	read_ahead->thread = g_thread_try_new("ctf-fs-read-ahead",
+		thread_func, read_ahead, &error);
+	if (!read_ahead->thread) {
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"Cannot create read-ahead thread: %s",
+			error ? error->message : "unknown error");
+		goto error;
+	}
+
+	BT_COMP_LOGD("Started read-ahead thread: first-entry-index=%u, "
+		"entry-count=%u, depth=%u, method=%s", first_entry_index,
+		index->len, depth,
+		read_ahead->method == CTF_FS_READ_AHEAD_METHOD_IO_URING ?
+			"io_uring" : "pread");
+	goto end;
+
+error:
+	ctf_fs_read_ahead_destroy(read_ahead);
+	read_ahead = NULL;
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+
+	return read_ahead;
+}
+
+BT_HIDDEN
+enum ctf_msg_iter_medium_status ctf_fs_read_ahead_next_packet(
+		struct ctf_fs_read_ahead *read_ahead,
+		const struct ctf_fs_read_ahead_packet **packet)
+{
+	enum ctf_msg_iter_medium_status status;
+	bt_self_message_iterator *self_msg_iter = read_ahead->self_msg_iter;
+	bt_logging_level log_level = read_ahead->log_level;
+
+	g_mutex_lock(&read_ahead->lock);
+
+	if (read_ahead->consumer_holds) {
+		/* Give the previous packet's slot back. */
+		read_ahead->consumer_holds = false;
+		g_cond_signal(&read_ahead->not_full_cond);
+	}
+
+	while (read_ahead->count == 0 && !read_ahead->done) {
+		g_cond_wait(&read_ahead->not_empty_cond, &read_ahead->lock);
+	}
+
+	if (read_ahead->count > 0) {
+		*packet = &read_ahead->slots[read_ahead->head].packet;
+		read_ahead->head = (read_ahead->head + 1) % read_ahead->capacity;
+		read_ahead->count--;
+		read_ahead->consumer_holds = true;
+		status = CTF_MSG_ITER_MEDIUM_STATUS_OK;
+	} else if (read_ahead->failed) {
+		const guint i = read_ahead->failed_entry_index;
+
+		BT_MSG_ITER_LOGE_APPEND_CAUSE(self_msg_iter,
+			"Cannot read packet: path=\"%s\", offset=%" PRIu64 ", "
+			"size=%" PRIu64 ": %s",
+			ctf_fs_ds_index_get_path(read_ahead->index, i),
+			read_ahead->index->offsets[i],
+			read_ahead->index->packet_sizes[i],
+			g_strerror(read_ahead->failed_errno));
+		status = CTF_MSG_ITER_MEDIUM_STATUS_ERROR;
+	} else {
+		status = CTF_MSG_ITER_MEDIUM_STATUS_EOF;
+	}
+
+	g_mutex_unlock(&read_ahead->lock);
+	return status;
+}
+
+BT_HIDDEN
+void ctf_fs_read_ahead_destroy(struct ctf_fs_read_ahead *read_ahead)
+{
+	guint i;
+
+	if (!read_ahead) {
+		goto end;
+	}
+
+	if (read_ahead->thread) {
+		g_mutex_lock(&read_ahead->lock);
+		read_ahead->cancelled = true;
+		g_cond_signal(&read_ahead->not_full_cond);
+		g_mutex_unlock(&read_ahead->lock);
+		g_thread_join(read_ahead->thread);
+	}
+
+#ifdef BABELTRACE_HAVE_LIBURING
+	if (read_ahead->method == CTF_FS_READ_AHEAD_METHOD_IO_URING) {
+		io_uring_queue_exit(&read_ahead->io_uring);
+	}
+#endif
+
+	for (i = 0; i < read_ahead->capacity; i++) {
+		aligned_buf_free(read_ahead->slots[i].packet.buf);
+		g_free(read_ahead->slots[i].frame_buf);
+	}
+
+	g_free(read_ahead->slots);
+	g_cond_clear(&read_ahead->not_full_cond);
+	g_cond_clear(&read_ahead->not_empty_cond);
+	g_mutex_clear(&read_ahead->lock);
+	g_free(read_ahead);
+
+end:
+	return;
+}
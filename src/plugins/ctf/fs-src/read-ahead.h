@@ -0,0 +1,141 @@
+#ifndef CTF_FS_READ_AHEAD_H
+#define CTF_FS_READ_AHEAD_H
+
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+#include "../common/msg-iter/msg-iter.h"
+#include "fd-cache/fd-cache.h"
+
+/* Maximum read-ahead depth, in packets */
+#define CTF_FS_MAX_READ_AHEAD_PACKETS	1024
+
+/* Alignment of the packet buffers, in bytes */
+#define CTF_FS_READ_AHEAD_BUF_ALIGN	4096
+
+/*
+ * How a read-ahead thread reads the packets.
+ */
+enum ctf_fs_read_ahead_method {
+	/* io_uring if available, pread() otherwise */
+	CTF_FS_READ_AHEAD_METHOD_AUTO,
+
+	/* One pread() at a time */
+	CTF_FS_READ_AHEAD_METHOD_PREAD,
+
+	/* Up to the read-ahead depth concurrent io_uring reads */
+	CTF_FS_READ_AHEAD_METHOD_IO_URING,
+};
+
+/*
+ * Packet read ahead by a read-ahead thread.
+ */
+struct ctf_fs_read_ahead_packet {
+	/*
+	 * Aligned to `CTF_FS_READ_AHEAD_BUF_ALIGN` bytes, owned by the
+	 * read-ahead object
+	 */
+	uint8_t *buf;
+
+	/* Number of bytes of the packet in `buf` */
+	size_t size;
+};
+
+/*
+ * A read-ahead thread reads, in order, the packets described by a range
+ * of index entries into memory, staying at most a fixed number of
+ * packets ahead of its consumer.
+ *
+ * The producer (the read-ahead thread) and the single consumer exchange
+ * packets through a bounded ring of reusable buffers: the thread never
+ * touches any library object, so that the consumer can decode the
+ * packets it gets on the graph's thread.
+ */
+struct ctf_fs_read_ahead;
+
+struct ctf_fs_ds_index;
+
+/*
+ * Returns whether or not this build supports
+ * `CTF_FS_READ_AHEAD_METHOD_IO_URING`.
+ */
+BT_HIDDEN
+bool ctf_fs_read_ahead_has_io_uring(void);
+
+/*
+ * Creates and starts a read-ahead thread which reads, with `method`,
+ * the packets described by the entries of `index` starting at rank
+ * `first_entry_index`, staying at most `depth` packets ahead of its
+ * consumer.
+ *
+ * With `CTF_FS_READ_AHEAD_METHOD_AUTO`, this function falls back to
+ * pread() if the system doesn't support io_uring.
+ *
+ * The read-ahead thread gets the file descriptors of the data stream
+ * files from `fd_cache`, which must exist until you destroy the
+ * returned object.
+ *
+ * `index` must remain unchanged until you destroy the returned object.
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+struct ctf_fs_read_ahead *ctf_fs_read_ahead_create(
+		struct ctf_fs_ds_index *index,
+		guint first_entry_index, guint depth,
+		enum ctf_fs_read_ahead_method method,
+		struct bt_fd_cache *fd_cache,
+		bt_self_message_iterator *self_msg_iter,
+		bt_logging_level log_level);
+
+/*
+ * Gives the packet previously returned by this function back to
+ * `read_ahead`, waits for the read-ahead thread to read the next packet
+ * if needed, and sets `*packet` to it.
+ *
+ * `*packet` remains valid until the next call to this function or until
+ * you destroy `read_ahead`.
+ *
+ * Returns `CTF_MSG_ITER_MEDIUM_STATUS_EOF` when there are no more
+ * packets to read, or `CTF_MSG_ITER_MEDIUM_STATUS_ERROR` if the
+ * read-ahead thread failed to read the next packet.
+ */
+BT_HIDDEN
+enum ctf_msg_iter_medium_status ctf_fs_read_ahead_next_packet(
+		struct ctf_fs_read_ahead *read_ahead,
+		const struct ctf_fs_read_ahead_packet **packet);
+
+/*
+ * Stops the read-ahead thread of `read_ahead`, without waiting for it
+ * to read its pending packets, and destroys `read_ahead`.
+ */
+BT_HIDDEN
+void ctf_fs_read_ahead_destroy(struct ctf_fs_read_ahead *read_ahead);
+
+#endif /* CTF_FS_READ_AHEAD_H */
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (self_comp)
+#define BT_LOG_OUTPUT_LEVEL (log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/WORKER-POOL"
+#include "logging/comp-logging.h"
+
+#include <glib.h>
+#include "common/assert.h"
+#include "worker-pool.h"
+
+static
+void run_job_in_worker(gpointer data, gpointer user_data)
+{
+	struct ctf_fs_worker_job *job = data;
+
+	job->ret = job->func(job->data);
+
+	/*
+	 * The worker thread's error would be lost: keep it so that
+	 * ctf_fs_worker_pool_run_jobs() can move it to its caller's
+	 * thread. Worker threads are reused: don't leave any error
+	 * behind, even on success.
+	 */
+	if (job->ret) {
+		job->error = bt_current_thread_take_error();
+	} else {
+		bt_current_thread_clear_error();
+	}
+}
+
+BT_HIDDEN
+int ctf_fs_worker_pool_run_jobs(struct ctf_fs_worker_job *jobs,
+		guint job_count, guint max_threads,
+		bt_logging_level log_level, bt_self_component *self_comp,
+		bt_self_component_class *self_comp_class)
+{
+	int ret = 0;
+	GThreadPool *pool = NULL;
+	GError *error = NULL;
+	guint i;
+
+	BT_ASSERT(max_threads > 0);
+
+	if (max_threads == 1 || job_count <= 1) {
+		for (i = 0; i < job_count; i++) {
+			jobs[i].ret = jobs[i].func(jobs[i].data);
+			if (jobs[i].ret) {
+				ret = -1;
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
+	BT_COMP_OR_COMP_CLASS_LOGD(self_comp, self_comp_class,
+		"Running jobs with worker threads: job-count=%u, "
+		"max-thread-count=%u", job_count, MIN(max_threads, job_count));
+	pool = g_thread_pool_new(run_job_in_worker, NULL,
+		(gint) MIN(max_threads, job_count), FALSE, &error);
+	if (!pool) {
+		BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp, self_comp_class,
+			"Cannot create thread pool: %s",
+			error ? error->message : "unknown error");
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < job_count; i++) {
+		g_thread_pool_push(pool, &jobs[i], &error);
+		if (error) {
+			BT_COMP_OR_COMP_CLASS_LOGE_APPEND_CAUSE(self_comp,
+				self_comp_class,
+				"Cannot push job to thread pool: %s",
+				error->message);
+			ret = -1;
+			break;
+		}
+	}
+
+	/* Wait for all the pushed jobs to complete. */
+	g_thread_pool_free(pool, FALSE, TRUE);
+	pool = NULL;
+
+	if (ret) {
+		/* The causes explaining the push error come first. */
+		for (i = 0; i < job_count; i++) {
+			if (jobs[i].error) {
+				bt_error_release(jobs[i].error);
+				jobs[i].error = NULL;
+			}
+		}
+
+		goto end;
+	}
+
+	for (i = 0; i < job_count; i++) {
+		if (!jobs[i].ret) {
+			continue;
+		}
+
+		if (!ret) {
+			/* First failed job: report its error. */
+			if (jobs[i].error) {
+				bt_current_thread_move_error(jobs[i].error);
+				jobs[i].error = NULL;
+			}
+
+			ret = -1;
+		} else if (jobs[i].error) {
+			bt_error_release(jobs[i].error);
+			jobs[i].error = NULL;
+		}
+	}
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+
+	return ret;
+}
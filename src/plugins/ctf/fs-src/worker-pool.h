@@ -0,0 +1,71 @@
+#ifndef CTF_FS_WORKER_POOL_H
+#define CTF_FS_WORKER_POOL_H
+
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/*
+ * A job to run with ctf_fs_worker_pool_run_jobs().
+ *
+ * `func` must only access data which no other job of the same run
+ * modifies.
+ */
+struct ctf_fs_worker_job {
+	/* Returns 0 on success, or a negative value on error */
+	int (*func)(void *data);
+
+	/* Weak */
+	void *data;
+
+	/* Set by ctf_fs_worker_pool_run_jobs() */
+	int ret;
+
+	/*
+	 * Owned by this: error of the worker thread which ran `func`, if
+	 * it failed.
+	 */
+	const bt_error *error;
+};
+
+/*
+ * Runs the `job_count` jobs of `jobs` using at most `max_threads`
+ * worker threads, and waits for all of them to complete.
+ *
+ * If `max_threads` is 1, or if there's a single job, this function
+ * runs the jobs in order on the current thread.
+ *
+ * Returns 0 if all the jobs succeed. Otherwise, this function moves the
+ * error of the first failed job, in the order of `jobs`, to the current
+ * thread and returns -1: this makes the reported error independent from
+ * the scheduling of the jobs.
+ */
+BT_HIDDEN
+int ctf_fs_worker_pool_run_jobs(struct ctf_fs_worker_job *jobs,
+		guint job_count, guint max_threads,
+		bt_logging_level log_level, bt_self_component *self_comp,
+		bt_self_component_class *self_comp_class);
+
+#endif /* CTF_FS_WORKER_POOL_H */
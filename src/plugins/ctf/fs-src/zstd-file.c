@@ -0,0 +1,510 @@
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_COMP_LOG_SELF_COMP (zstd_file->self_comp)
+#define BT_LOG_OUTPUT_LEVEL (zstd_file->log_level)
+#define BT_LOG_TAG "PLUGIN/SRC.CTF.FS/ZSTD"
+#include "logging/comp-logging.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <glib.h>
+#include "common/assert.h"
+#include "compat/endian.h"
+#include "compat/mman.h"
+#include "zstd-file.h"
+
+#ifdef BABELTRACE_HAVE_LIBZSTD
+# include <zstd.h>
+#endif
+
+/* Magic numbers of the zstd seekable format */
+#define SEEK_TABLE_SKIPPABLE_MAGIC	0x184D2A5EU
+#define SEEK_TABLE_FOOTER_MAGIC		0x8F92EAB1U
+#define SEEK_TABLE_FOOTER_SIZE		9
+#define SEEK_TABLE_CHECKSUM_FLAG	0x80
+#define SEEK_TABLE_RESERVED_MASK	0x7c
+
+/* Any skippable frame has a magic number matching this one */
+#define SKIPPABLE_MAGIC_MASK		0xfffffff0U
+#define SKIPPABLE_MAGIC			0x184D2A50U
+#define SKIPPABLE_HEADER_SIZE		8
+
+BT_HIDDEN
+bool ctf_fs_zstd_file_is_compressed_path(const char *path)
+{
+	return g_str_has_suffix(path, CTF_FS_ZSTD_FILE_SUFFIX);
+}
+
+static inline
+uint32_t read_le32(const uint8_t *addr)
+{
+	uint32_t v;
+
+	memcpy(&v, addr, sizeof(v));
+	return le32toh(v);
+}
+
+#ifdef BABELTRACE_HAVE_LIBZSTD
+
+static
+void append_frame(struct ctf_fs_zstd_file *zstd_file, uint64_t comp_offset,
+		uint64_t comp_size, uint64_t size)
+{
+	struct ctf_fs_zstd_frame frame;
+
+	if (size == 0) {
+		/* Nothing to find in this frame */
+		goto end;
+	}
+
+	frame.comp_offset = comp_offset;
+	frame.comp_size = comp_size;
+	frame.offset = zstd_file->size;
+	frame.size = size;
+	g_array_append_val(zstd_file->frames, frame);
+	zstd_file->size += size;
+
+end:
+	return;
+}
+
+/*
+ * Indexes the frames of `zstd_file` from its seek table.
+ *
+ * Returns 1 if there's no seek table, 0 on success, or -1 on error.
+ */
+static
+int index_frames_from_seek_table(struct ctf_fs_zstd_file *zstd_file)
+{
+	const uint8_t *addr = zstd_file->addr;
+	const uint8_t *footer;
+	uint32_t frame_count;
+	uint8_t descriptor;
+	uint64_t entry_size;
+	uint64_t table_size;
+	uint64_t table_offset;
+	uint64_t comp_offset = 0;
+	uint32_t i;
+	int ret = 0;
+
+	if (zstd_file->len < SKIPPABLE_HEADER_SIZE + SEEK_TABLE_FOOTER_SIZE) {
+		ret = 1;
+		goto end;
+	}
+
+	footer = &addr[zstd_file->len - SEEK_TABLE_FOOTER_SIZE];
+	if (read_le32(&footer[5]) != SEEK_TABLE_FOOTER_MAGIC) {
+		ret = 1;
+		goto end;
+	}
+
+	frame_count = read_le32(footer);
+	descriptor = footer[4];
+	if (descriptor & SEEK_TABLE_RESERVED_MASK) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Invalid zstd seek table: reserved bits are set: "
+			"path=\"%s\", descriptor=%#x", zstd_file->path->str,
+			(unsigned int) descriptor);
+		ret = -1;
+		goto end;
+	}
+
+	entry_size = (descriptor & SEEK_TABLE_CHECKSUM_FLAG) ? 12 : 8;
+	table_size = (uint64_t) frame_count * entry_size +
+		SEEK_TABLE_FOOTER_SIZE;
+	if (table_size + SKIPPABLE_HEADER_SIZE > zstd_file->len) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Invalid zstd seek table: table is larger than the file: "
+			"path=\"%s\", frame-count=%" PRIu32,
+			zstd_file->path->str, frame_count);
+		ret = -1;
+		goto end;
+	}
+
+	table_offset = zstd_file->len - table_size - SKIPPABLE_HEADER_SIZE;
+	if (read_le32(&addr[table_offset]) != SEEK_TABLE_SKIPPABLE_MAGIC ||
+			read_le32(&addr[table_offset + 4]) != table_size) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Invalid zstd seek table: unexpected skippable frame header: "
+			"path=\"%s\"", zstd_file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < frame_count; i++) {
+		const uint8_t *entry = &addr[table_offset +
+			SKIPPABLE_HEADER_SIZE + i * entry_size];
+		const uint32_t comp_size = read_le32(entry);
+
+		append_frame(zstd_file, comp_offset, comp_size,
+			read_le32(&entry[4]));
+		comp_offset += comp_size;
+	}
+
+	if (comp_offset != table_offset) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Invalid zstd seek table: frames don't end where the table begins: "
+			"path=\"%s\", frames-end-offset=%" PRIu64 ", "
+			"table-offset=%" PRIu64, zstd_file->path->str,
+			comp_offset, table_offset);
+		ret = -1;
+		goto end;
+	}
+
+	BT_COMP_LOGD("Indexed zstd frames from seek table: path=\"%s\", "
+		"frame-count=%" PRIu32, zstd_file->path->str, frame_count);
+
+end:
+	return ret;
+}
+
+/*
+ * Indexes the frames of `zstd_file` by walking their headers.
+ *
+ * Returns 0 on success, or -1 on error.
+ */
+static
+int index_frames_from_headers(struct ctf_fs_zstd_file *zstd_file)
+{
+	const uint8_t *addr = zstd_file->addr;
+	uint64_t comp_offset = 0;
+	int ret = 0;
+
+	while (comp_offset < zstd_file->len) {
+		const size_t avail = zstd_file->len - comp_offset;
+		size_t comp_size;
+		unsigned long long size;
+
+		if (avail >= SKIPPABLE_HEADER_SIZE &&
+				(read_le32(&addr[comp_offset]) &
+					SKIPPABLE_MAGIC_MASK) == SKIPPABLE_MAGIC) {
+			comp_offset += SKIPPABLE_HEADER_SIZE +
+				read_le32(&addr[comp_offset + 4]);
+			continue;
+		}
+
+		comp_size = ZSTD_findFrameCompressedSize(&addr[comp_offset],
+			avail);
+		if (ZSTD_isError(comp_size)) {
+			BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+				"Invalid zstd frame: path=\"%s\", offset=%" PRIu64 ": %s",
+				zstd_file->path->str, comp_offset,
+				ZSTD_getErrorName(comp_size));
+			ret = -1;
+			goto end;
+		}
+
+		size = ZSTD_getFrameContentSize(&addr[comp_offset], avail);
+		if (size == ZSTD_CONTENTSIZE_UNKNOWN ||
+				size == ZSTD_CONTENTSIZE_ERROR) {
+			BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+				"zstd frame header doesn't contain the frame's content size "
+				"and there's no seek table: path=\"%s\", "
+				"offset=%" PRIu64, zstd_file->path->str,
+				comp_offset);
+			ret = -1;
+			goto end;
+		}
+
+		append_frame(zstd_file, comp_offset, comp_size, size);
+		comp_offset += comp_size;
+	}
+
+	BT_COMP_LOGD("Indexed zstd frames from frame headers: path=\"%s\", "
+		"frame-count=%u", zstd_file->path->str,
+		zstd_file->frames->len);
+
+end:
+	return ret;
+}
+
+/*
+ * Maps the `size` bytes of `fd` and indexes the frames of `zstd_file`.
+ *
+ * Returns 0 on success, or -1 on error.
+ */
+static
+int map_and_index_frames(struct ctf_fs_zstd_file *zstd_file, int fd,
+		uint64_t size)
+{
+	int ret = 0;
+
+	if (size > SIZE_MAX) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Compressed data stream file is too large: "
+			"path=\"%s\", size=%" PRIu64, zstd_file->path->str,
+			size);
+		ret = -1;
+		goto end;
+	}
+
+	zstd_file->len = (size_t) size;
+
+	if (zstd_file->len > 0) {
+		zstd_file->addr = bt_mmap(NULL, zstd_file->len, PROT_READ,
+			MAP_PRIVATE, fd, 0, zstd_file->log_level);
+		if (zstd_file->addr == MAP_FAILED) {
+			BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+				"Cannot memory-map compressed data stream file: "
+				"path=\"%s\", size=%zu: %s", zstd_file->path->str,
+				zstd_file->len, g_strerror(errno));
+			zstd_file->addr = NULL;
+			ret = -1;
+			goto end;
+		}
+
+		(void) bt_madvise(zstd_file->addr, zstd_file->len,
+			BT_MADV_SEQUENTIAL);
+	}
+
+	ret = index_frames_from_seek_table(zstd_file);
+	if (ret == 1) {
+		ret = index_frames_from_headers(zstd_file);
+	}
+
+end:
+	return ret;
+}
+
+#endif /* BABELTRACE_HAVE_LIBZSTD */
+
+BT_HIDDEN
+struct ctf_fs_zstd_file *ctf_fs_zstd_file_create(int fd, const char *path,
+		uint64_t size, bt_self_component *self_comp,
+		bt_logging_level log_level)
+{
+	struct ctf_fs_zstd_file *zstd_file = g_new0(struct ctf_fs_zstd_file, 1);
+	int ret;
+
+	zstd_file->log_level = log_level;
+	zstd_file->self_comp = self_comp;
+	zstd_file->path = g_string_new(path);
+	zstd_file->frames = g_array_new(FALSE, FALSE,
+		sizeof(struct ctf_fs_zstd_frame));
+	zstd_file->buf_frame_index = G_MAXUINT;
+
+#ifdef BABELTRACE_HAVE_LIBZSTD
+	ret = map_and_index_frames(zstd_file, fd, size);
+#else
+	BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+		"Cannot read compressed data stream file: "
+		"zstd support is not available: path=\"%s\"", path);
+	ret = -1;
+#endif
+	if (ret) {
+		goto error;
+	}
+
+	BT_COMP_LOGI("Opened compressed data stream file: path=\"%s\", "
+		"compressed-size=%zu, size=%" PRIu64 ", frame-count=%u",
+		path, zstd_file->len, zstd_file->size,
+		zstd_file->frames->len);
+	goto end;
+
+error:
+	ctf_fs_zstd_file_destroy(zstd_file);
+	zstd_file = NULL;
+
+end:
+	return zstd_file;
+}
+
+BT_HIDDEN
+void ctf_fs_zstd_file_destroy(struct ctf_fs_zstd_file *zstd_file)
+{
+	if (!zstd_file) {
+		goto end;
+	}
+
+	if (zstd_file->addr) {
+		if (bt_munmap(zstd_file->addr, zstd_file->len)) {
+			BT_COMP_LOGE_ERRNO("Cannot memory-unmap compressed file",
+				": path=\"%s\"", zstd_file->path->str);
+		}
+	}
+
+	ctf_fs_zstd_dctx_destroy(zstd_file->dctx);
+	g_free(zstd_file->buf);
+	g_array_free(zstd_file->frames, TRUE);
+	g_string_free(zstd_file->path, TRUE);
+	g_free(zstd_file);
+
+end:
+	return;
+}
+
+BT_HIDDEN
+guint ctf_fs_zstd_file_find_frame(struct ctf_fs_zstd_file *zstd_file,
+		uint64_t offset)
+{
+	guint low = 0;
+	guint high = zstd_file->frames->len;
+
+	BT_ASSERT(offset < zstd_file->size);
+
+	/* Find the last frame which begins at or before `offset`. */
+	while (high - low > 1) {
+		const guint mid = low + (high - low) / 2;
+
+		if (g_array_index(zstd_file->frames, struct ctf_fs_zstd_frame,
+				mid).offset <= offset) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+BT_HIDDEN
+int ctf_fs_zstd_file_decompress_frame(struct ctf_fs_zstd_file *zstd_file,
+		guint frame_index)
+{
+	const struct ctf_fs_zstd_frame *frame;
+	int ret = 0;
+
+	BT_ASSERT(frame_index < zstd_file->frames->len);
+
+	if (frame_index == zstd_file->buf_frame_index) {
+		goto end;
+	}
+
+	frame = &g_array_index(zstd_file->frames, struct ctf_fs_zstd_frame,
+		frame_index);
+	if (frame->size > SIZE_MAX) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"zstd frame content is too large: path=\"%s\", "
+			"size=%" PRIu64, zstd_file->path->str, frame->size);
+		ret = -1;
+		goto end;
+	}
+
+	if (zstd_file->buf_size < frame->size) {
+		g_free(zstd_file->buf);
+		zstd_file->buf_size = 0;
+		zstd_file->buf = g_try_malloc((gsize) frame->size);
+		if (!zstd_file->buf) {
+			BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+				"Failed to allocate zstd frame content buffer: "
+				"size=%" PRIu64, frame->size);
+			ret = -1;
+			goto end;
+		}
+
+		zstd_file->buf_size = (size_t) frame->size;
+	}
+
+	zstd_file->buf_frame_index = G_MAXUINT;
+	ret = ctf_fs_zstd_decompress(&zstd_file->dctx, zstd_file->buf,
+		(size_t) frame->size,
+		(const uint8_t *) zstd_file->addr + frame->comp_offset,
+		(size_t) frame->comp_size);
+	if (ret) {
+		BT_COMP_LOGE_APPEND_CAUSE(zstd_file->self_comp,
+			"Cannot decompress zstd frame: path=\"%s\", "
+			"comp-offset=%" PRIu64 ", comp-size=%" PRIu64 ", "
+			"size=%" PRIu64, zstd_file->path->str,
+			frame->comp_offset, frame->comp_size, frame->size);
+		goto end;
+	}
+
+	zstd_file->buf_frame_index = frame_index;
+	BT_COMP_LOGD("Decompressed zstd frame: path=\"%s\", index=%u, "
+		"offset=%" PRIu64 ", size=%" PRIu64, zstd_file->path->str,
+		frame_index, frame->offset, frame->size);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_zstd_file_find_frames(struct ctf_fs_zstd_file *zstd_file,
+		uint64_t offset, uint64_t size, uint64_t *comp_offset,
+		uint64_t *comp_size)
+{
+	const struct ctf_fs_zstd_frame *first;
+	const struct ctf_fs_zstd_frame *last;
+	guint i;
+	int ret = 0;
+
+	if (size == 0 || offset + size > zstd_file->size) {
+		ret = -1;
+		goto end;
+	}
+
+	i = ctf_fs_zstd_file_find_frame(zstd_file, offset);
+	first = &g_array_index(zstd_file->frames, struct ctf_fs_zstd_frame, i);
+	if (first->offset != offset) {
+		ret = -1;
+		goto end;
+	}
+
+	i = ctf_fs_zstd_file_find_frame(zstd_file, offset + size - 1);
+	last = &g_array_index(zstd_file->frames, struct ctf_fs_zstd_frame, i);
+	if (last->offset + last->size != offset + size) {
+		ret = -1;
+		goto end;
+	}
+
+	*comp_offset = first->comp_offset;
+	*comp_size = last->comp_offset + last->comp_size - first->comp_offset;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_zstd_decompress(struct ZSTD_DCtx_s **dctx, uint8_t *dst,
+		size_t dst_size, const uint8_t *src, size_t src_size)
+{
+#ifdef BABELTRACE_HAVE_LIBZSTD
+	size_t ret;
+
+	if (!*dctx) {
+		*dctx = ZSTD_createDCtx();
+		if (!*dctx) {
+			return -1;
+		}
+	}
+
+	/* This decompresses all the frames, skipping skippable ones. */
+	ret = ZSTD_decompressDCtx(*dctx, dst, dst_size, src, src_size);
+	if (ZSTD_isError(ret) || ret != dst_size) {
+		return -1;
+	}
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+BT_HIDDEN
+void ctf_fs_zstd_dctx_destroy(struct ZSTD_DCtx_s *dctx)
+{
+#ifdef BABELTRACE_HAVE_LIBZSTD
+	ZSTD_freeDCtx(dctx);
+#endif
+}
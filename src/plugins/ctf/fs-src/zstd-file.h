@@ -0,0 +1,166 @@
+#ifndef CTF_FS_ZSTD_FILE_H
+#define CTF_FS_ZSTD_FILE_H
+
+/*
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <glib.h>
+#include "common/macros.h"
+#include <babeltrace2/babeltrace.h>
+
+/* Name suffix of a zstd-compressed data stream file */
+#define CTF_FS_ZSTD_FILE_SUFFIX	".zst"
+
+struct ZSTD_DCtx_s;
+
+/*
+ * zstd frame of a compressed data stream file.
+ */
+struct ctf_fs_zstd_frame {
+	/* Offset and size of the frame within the compressed file */
+	uint64_t comp_offset;
+	uint64_t comp_size;
+
+	/* Offset and size of the frame's content within the stream data */
+	uint64_t offset;
+	uint64_t size;
+};
+
+/*
+ * zstd-compressed data stream file.
+ *
+ * Such a file is a sequence of zstd frames, each one containing one or
+ * more whole packets, optionally followed by the seek table of the zstd
+ * seekable format. Without a seek table, each frame header must contain
+ * the frame's content size.
+ */
+struct ctf_fs_zstd_file {
+	bt_logging_level log_level;
+
+	/* Weak */
+	bt_self_component *self_comp;
+
+	/* Path of the compressed file, for logging (owned by this) */
+	GString *path;
+
+	/* Memory mapping of the whole compressed file, or `NULL` if empty */
+	void *addr;
+	size_t len;
+
+	/*
+	 * Array of struct ctf_fs_zstd_frame, sorted by offset, without
+	 * empty frames.
+	 */
+	GArray *frames;
+
+	/* Size of the stream data, that is, of all the frame contents */
+	uint64_t size;
+
+	/* Owned by this */
+	struct ZSTD_DCtx_s *dctx;
+
+	/*
+	 * Content of the frame at rank `buf_frame_index` (`G_MAXUINT` if
+	 * none) of `frames`, and allocated size of `buf`.
+	 */
+	uint8_t *buf;
+	size_t buf_size;
+	guint buf_frame_index;
+};
+
+/*
+ * Returns whether or not `path` is the path of a compressed data stream
+ * file.
+ */
+BT_HIDDEN
+bool ctf_fs_zstd_file_is_compressed_path(const char *path);
+
+/*
+ * Creates a compressed data stream file object from the `size` bytes
+ * of the file descriptor `fd` opened from `path`, indexing its frames.
+ *
+ * Returns `NULL` on error, appending an error cause for `self_comp`.
+ */
+BT_HIDDEN
+struct ctf_fs_zstd_file *ctf_fs_zstd_file_create(int fd, const char *path,
+		uint64_t size, bt_self_component *self_comp,
+		bt_logging_level log_level);
+
+BT_HIDDEN
+void ctf_fs_zstd_file_destroy(struct ctf_fs_zstd_file *zstd_file);
+
+/*
+ * Returns the rank of the frame of `zstd_file` which contains the byte
+ * at offset `offset`, which must be less than `zstd_file->size`, of
+ * the stream data.
+ */
+BT_HIDDEN
+guint ctf_fs_zstd_file_find_frame(struct ctf_fs_zstd_file *zstd_file,
+		uint64_t offset);
+
+/*
+ * Decompresses the frame at rank `frame_index` of `zstd_file` into
+ * `zstd_file->buf`, unless it's already there.
+ *
+ * Returns 0 on success, or -1 on error, appending an error cause.
+ */
+BT_HIDDEN
+int ctf_fs_zstd_file_decompress_frame(struct ctf_fs_zstd_file *zstd_file,
+		guint frame_index);
+
+/*
+ * Sets `*comp_offset` and `*comp_size` to the offset and size, within
+ * the compressed file, of the frames which contain the `size` bytes of
+ * stream data at offset `offset` (typically, a packet).
+ *
+ * Returns -1 if the range doesn't begin and end at frame boundaries.
+ */
+BT_HIDDEN
+int ctf_fs_zstd_file_find_frames(struct ctf_fs_zstd_file *zstd_file,
+		uint64_t offset, uint64_t size, uint64_t *comp_offset,
+		uint64_t *comp_size);
+
+/*
+ * Decompresses the `src_size` bytes of consecutive frames at `src` into
+ * `dst`, which must contain exactly `dst_size` bytes once decompressed,
+ * creating `*dctx` if it's `NULL`.
+ *
+ * Unlike the other functions of this file, this one doesn't log nor
+ * append error causes: any thread may call it.
+ *
+ * Returns 0 on success, or -1 if the frames are invalid.
+ */
+BT_HIDDEN
+int ctf_fs_zstd_decompress(struct ZSTD_DCtx_s **dctx, uint8_t *dst,
+		size_t dst_size, const uint8_t *src, size_t src_size);
+
+/*
+ * Destroys a context which ctf_fs_zstd_decompress() created.
+ */
+BT_HIDDEN
+void ctf_fs_zstd_dctx_destroy(struct ZSTD_DCtx_s *dctx);
+
+#endif /* CTF_FS_ZSTD_FILE_H */
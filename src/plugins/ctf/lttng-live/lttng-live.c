@@ -55,6 +55,7 @@
 #define URL_PARAM			    "url"
 #define INPUTS_PARAM			    "inputs"
 #define SESS_NOT_FOUND_ACTION_PARAM	    "session-not-found-action"
+#define EVENT_CLASSES_PARAM		    "event-classes"
 #define SESS_NOT_FOUND_ACTION_CONTINUE_STR  "continue"
 #define SESS_NOT_FOUND_ACTION_FAIL_STR	    "fail"
 #define SESS_NOT_FOUND_ACTION_END_STR	    "end"
@@ -1867,6 +1868,7 @@ void lttng_live_component_destroy_data(struct lttng_live_component *lttng_live)
 	if (lttng_live->params.url) {
 		g_string_free(lttng_live->params.url, TRUE);
 	}
+	ctf_event_class_filter_destroy(lttng_live->params.ec_filter);
 	g_free(lttng_live);
 }
 
@@ -1905,6 +1907,10 @@ static struct bt_param_validation_value_descr inputs_elem_descr = {
 	.type = BT_VALUE_TYPE_STRING,
 };
 
+static struct bt_param_validation_value_descr event_classes_elem_descr = {
+	.type = BT_VALUE_TYPE_STRING,
+};
+
 static const char *sess_not_found_action_choices[] = {
 	SESS_NOT_FOUND_ACTION_CONTINUE_STR,
 	SESS_NOT_FOUND_ACTION_FAIL_STR,
@@ -1920,6 +1926,11 @@ static struct bt_param_validation_map_value_entry_descr params_descr[] = {
 	{ SESS_NOT_FOUND_ACTION_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_STRING, .string = {
 		.choices = sess_not_found_action_choices,
 	} } },
+	{ EVENT_CLASSES_PARAM, BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { BT_VALUE_TYPE_ARRAY, .array = {
+		.min_length = 0,
+		.max_length = BT_PARAM_VALIDATION_INFINITE,
+		.element_type = &event_classes_elem_descr,
+	} } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -1986,6 +1997,19 @@ bt_component_class_initialize_method_status lttng_live_component_create(
 			SESSION_NOT_FOUND_ACTION_CONTINUE;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params,
+		EVENT_CLASSES_PARAM);
+	if (value) {
+		lttng_live->params.ec_filter =
+			ctf_event_class_filter_create(value);
+		if (!lttng_live->params.ec_filter) {
+			BT_COMP_LOGE_APPEND_CAUSE(self_comp,
+				"Failed to create an event class filter.");
+			status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+			goto error;
+		}
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 	goto end;
 
@@ -224,6 +224,12 @@ struct lttng_live_component {
 	struct {
 		GString *url;
 		enum session_not_found_action sess_not_found_act;
+
+		/*
+		 * Event classes of which to emit the events, owned by
+		 * this, or `NULL` to emit all the events.
+		 */
+		struct ctf_event_class_filter *ec_filter;
 	} params;
 
 	size_t max_query_size;
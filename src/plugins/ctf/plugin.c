@@ -57,6 +57,9 @@ BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_FINALIZE_METHOD(fs,
 	ctf_fs_iterator_finalize);
 BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_BEGINNING_METHODS(fs,
 	ctf_fs_iterator_seek_beginning, NULL);
+BT_PLUGIN_SOURCE_COMPONENT_CLASS_MESSAGE_ITERATOR_CLASS_SEEK_NS_FROM_ORIGIN_METHODS(fs,
+	ctf_fs_iterator_seek_ns_from_origin,
+	ctf_fs_iterator_can_seek_ns_from_origin);
 
 /* ctf.fs sink */
 BT_PLUGIN_SINK_COMPONENT_CLASS(fs, ctf_fs_sink_consume);
@@ -138,6 +138,7 @@ void bin_info_destroy(struct bin_info *bin)
 	}
 
 	dwarf_end(bin->dwarf_info);
+	elf_end(bin->dwarf_elf_file);
 
 	g_free(bin->debug_info_dir);
 	g_free(bin->elf_path);
@@ -146,11 +147,58 @@ void bin_info_destroy(struct bin_info *bin)
 	g_free(bin->dbg_link_filename);
 
 	elf_end(bin->elf_file);
+	g_free(bin);
+}
+
+/**
+ * Opens the ELF file at `path` through the file descriptor cache of
+ * `bin`.
+ *
+ * The returned libelf object reads a memory mapping (or an in-memory
+ * copy) of the file: it doesn't need its file descriptor anymore, so
+ * that this function puts it back into the cache. This makes the
+ * cache's budget (see bt_fd_cache_set_max_open_fds()) bound the
+ * number of files which the bin_info instances keep open.
+ *
+ * @param bin	bin_info instance
+ * @param path	Path of the ELF file to open
+ * @returns	libelf object, or NULL on failure
+ */
+static
+Elf *open_elf_file(struct bin_info *bin, const char *path)
+{
+	struct bt_fd_cache_handle *handle;
+	Elf *elf_file = NULL;
 
-	bt_fd_cache_put_handle(bin->fd_cache, bin->elf_handle);
-	bt_fd_cache_put_handle(bin->fd_cache, bin->dwarf_handle);
+	handle = bt_fd_cache_get_handle(bin->fd_cache, path);
+	if (!handle) {
+		BT_COMP_LOGI("Failed to open %s", path);
+		goto end;
+	}
 
-	g_free(bin);
+	elf_file = elf_begin(bt_fd_cache_handle_get_fd(handle),
+		ELF_C_READ_MMAP, NULL);
+	if (!elf_file) {
+		BT_COMP_LOGI("elf_begin failed: path=\"%s\", msg=\"%s\"",
+			path, elf_errmsg(-1));
+		goto end;
+	}
+
+	/*
+	 * If libelf could not map the file, read it all now. Either
+	 * way, libelf does not use the file descriptor after this
+	 * (`ELF_C_FDREAD` implies `ELF_C_FDDONE`).
+	 */
+	if (elf_cntl(elf_file, ELF_C_FDREAD)) {
+		BT_COMP_LOGI("elf_cntl failed: path=\"%s\", msg=\"%s\"",
+			path, elf_errmsg(-1));
+		elf_end(elf_file);
+		elf_file = NULL;
+	}
+
+end:
+	bt_fd_cache_put_handle(bin->fd_cache, handle);
+	return elf_file;
 }
 
 /**
@@ -162,41 +210,27 @@ void bin_info_destroy(struct bin_info *bin)
 static
 int bin_info_set_elf_file(struct bin_info *bin)
 {
-	struct bt_fd_cache_handle *elf_handle = NULL;
 	Elf *elf_file = NULL;
 	int ret;
 
 	BT_ASSERT(bin);
 
-	elf_handle = bt_fd_cache_get_handle(bin->fd_cache, bin->elf_path);
-	if (!elf_handle) {
-		BT_COMP_LOGI("Failed to open %s", bin->elf_path);
-		goto error;
-	}
-	bin->elf_handle = elf_handle;
-
-	elf_file = elf_begin(bt_fd_cache_handle_get_fd(bin->elf_handle),
-		ELF_C_READ, NULL);
+	elf_file = open_elf_file(bin, bin->elf_path);
 	if (!elf_file) {
-		BT_COMP_LOGE_APPEND_CAUSE(bin->self_comp,
-			"elf_begin failed: %s", elf_errmsg(-1));
 		goto error;
 	}
 
-	bin->elf_file = elf_file;
-
 	if (elf_kind(elf_file) != ELF_K_ELF) {
 		BT_COMP_LOGE_APPEND_CAUSE(bin->self_comp,
 			"Error: %s is not an ELF object", bin->elf_path);
 		goto error;
 	}
 
-
+	bin->elf_file = elf_file;
 	ret = 0;
 	goto end;
 
 error:
-	bt_fd_cache_put_handle(bin->fd_cache, elf_handle);
 	elf_end(elf_file);
 	ret = -1;
 
@@ -454,7 +488,7 @@ static
 int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 {
 	int ret = 0;
-	struct bt_fd_cache_handle *dwarf_handle = NULL;
+	Elf *dwarf_elf_file = NULL;
 	struct bt_dwarf_cu *cu = NULL;
 	Dwarf *dwarf_info = NULL;
 
@@ -462,13 +496,12 @@ int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 		goto error;
 	}
 
-	dwarf_handle = bt_fd_cache_get_handle(bin->fd_cache, path);
-	if (!dwarf_handle) {
+	dwarf_elf_file = open_elf_file(bin, path);
+	if (!dwarf_elf_file) {
 		goto error;
 	}
 
-	dwarf_info = dwarf_begin(bt_fd_cache_handle_get_fd(dwarf_handle),
-		DWARF_C_READ);
+	dwarf_info = dwarf_begin_elf(dwarf_elf_file, DWARF_C_READ, NULL);
 	if (!dwarf_info) {
 		goto error;
 	}
@@ -487,22 +520,19 @@ int bin_info_set_dwarf_info_from_path(struct bin_info *bin, char *path)
 		goto error;
 	}
 
-	bin->dwarf_handle = dwarf_handle;
 	bin->dwarf_path = g_strdup(path);
 	if (!bin->dwarf_path) {
 		goto error;
 	}
 	bin->dwarf_info = dwarf_info;
+	bin->dwarf_elf_file = dwarf_elf_file;
 	free(cu);
 
 	return 0;
 
 error:
-	if (bin) {
-		bt_fd_cache_put_handle(bin->fd_cache, dwarf_handle);
-	}
 	dwarf_end(dwarf_info);
-	g_free(dwarf_info);
+	elf_end(dwarf_elf_file);
 	free(cu);
 
 	return -1;
@@ -56,9 +56,16 @@ struct bin_info {
 	/* Paths to ELF and DWARF files. */
 	gchar *elf_path;
 	gchar *dwarf_path;
-	/* libelf and libdw objects representing the files. */
+	/*
+	 * libelf and libdw objects representing the files, and libelf
+	 * object of the file which `dwarf_info` reads.
+	 *
+	 * They read memory mappings of the files: they don't keep any
+	 * file descriptor open.
+	 */
 	Elf *elf_file;
 	Dwarf *dwarf_info;
+	Elf *dwarf_elf_file;
 	/* Optional build ID info. */
 	uint8_t *build_id;
 	size_t build_id_len;
@@ -66,9 +73,6 @@ struct bin_info {
 	/* Optional debug link info. */
 	gchar *dbg_link_filename;
 	uint32_t dbg_link_crc;
-	/* fd cache handles to ELF and DWARF files. */
-	struct bt_fd_cache_handle *elf_handle;
-	struct bt_fd_cache_handle *dwarf_handle;
 	/* Configuration. */
 	gchar *debug_info_dir;
 	/* Denotes whether the executable is position independent code. */
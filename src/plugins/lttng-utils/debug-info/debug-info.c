@@ -67,6 +67,7 @@ struct debug_info_component {
 	gchar *arg_debug_info_field_name;
 	gchar *arg_target_prefix;
 	bt_bool arg_full_path;
+	uint64_t arg_max_open_files;
 };
 
 struct debug_info_msg_iter {
@@ -1711,6 +1712,7 @@ struct bt_param_validation_map_value_entry_descr debug_info_params[] = {
 	{ "debug-info-dir", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "target-prefix", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_STRING } },
 	{ "full-path", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_BOOL } },
+	{ "max-open-files", BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_OPTIONAL, { .type = BT_VALUE_TYPE_UNSIGNED_INTEGER } },
 	BT_PARAM_VALIDATION_MAP_VALUE_ENTRY_END
 };
 
@@ -1773,6 +1775,15 @@ bt_component_class_initialize_method_status init_from_params(
 		debug_info_component->arg_full_path = BT_FALSE;
 	}
 
+	value = bt_value_map_borrow_entry_value_const(params, "max-open-files");
+	if (value) {
+		debug_info_component->arg_max_open_files =
+			bt_value_integer_unsigned_get(value);
+	} else {
+		/* No limit */
+		debug_info_component->arg_max_open_files = 0;
+	}
+
 	status = BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
 
 end:
@@ -2056,6 +2067,9 @@ bt_message_iterator_class_initialize_method_status debug_info_msg_iter_init(
 		goto error;
 	}
 
+	bt_fd_cache_set_max_open_fds(&debug_info_msg_iter->fd_cache,
+		debug_info_msg_iter->debug_info_component->arg_max_open_files);
+
 	bt_self_message_iterator_configuration_set_can_seek_forward(config,
 		bt_message_iterator_can_seek_forward(
 			debug_info_msg_iter->msg_iter));
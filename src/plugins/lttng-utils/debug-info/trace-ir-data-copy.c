@@ -29,7 +29,9 @@
 #include "logging/comp-logging.h"
 
 #include <inttypes.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "common/assert.h"
 #include "common/common.h"
@@ -266,6 +268,63 @@ end:
 	return status;
 }
 
+/*
+ * Copies the `array_len` element values of the array field `in_field`
+ * to the array field `out_field` at once if their element fields are
+ * boolean, integer, or real fields.
+ *
+ * Returns whether or not this function copied the values.
+ */
+static
+bool copy_array_field_values(const bt_field *in_field, bt_field *out_field,
+		uint64_t array_len)
+{
+	const bt_field_class *in_elem_fc;
+	bt_field_class_type in_elem_fc_type;
+	bool copied = true;
+
+	in_elem_fc = bt_field_class_array_borrow_element_field_class_const(
+		bt_field_borrow_class_const(in_field));
+	in_elem_fc_type = bt_field_class_get_type(in_elem_fc);
+
+	if (in_elem_fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		if (array_len > 0) {
+			memcpy(bt_field_array_borrow_bool_values(out_field),
+				bt_field_array_borrow_bool_values_const(in_field),
+				array_len * sizeof(bt_bool));
+		}
+	} else if (bt_field_class_type_is(in_elem_fc_type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		if (array_len > 0) {
+			memcpy(bt_field_array_borrow_unsigned_integer_values(
+					out_field),
+				bt_field_array_borrow_unsigned_integer_values_const(
+					in_field),
+				array_len * sizeof(uint64_t));
+		}
+	} else if (bt_field_class_type_is(in_elem_fc_type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		if (array_len > 0) {
+			memcpy(bt_field_array_borrow_signed_integer_values(
+					out_field),
+				bt_field_array_borrow_signed_integer_values_const(
+					in_field),
+				array_len * sizeof(int64_t));
+		}
+	} else if (bt_field_class_type_is(in_elem_fc_type,
+			BT_FIELD_CLASS_TYPE_REAL)) {
+		if (array_len > 0) {
+			memcpy(bt_field_array_borrow_real_values(out_field),
+				bt_field_array_borrow_real_values_const(in_field),
+				array_len * sizeof(double));
+		}
+	} else {
+		copied = false;
+	}
+
+	return copied;
+}
+
 BT_HIDDEN
 enum debug_info_trace_ir_mapping_status copy_field_content(
 		const bt_field *in_field, bt_field *out_field,
@@ -380,6 +439,11 @@ enum debug_info_trace_ir_mapping_status copy_field_content(
 			}
 		}
 
+		if (copy_array_field_values(in_field, out_field, array_len)) {
+			status = DEBUG_INFO_TRACE_IR_MAPPING_STATUS_OK;
+			goto end;
+		}
+
 		for (i = 0; i < array_len; i++) {
 			in_element_field =
 				bt_field_array_borrow_element_field_by_index_const(
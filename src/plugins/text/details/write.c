@@ -1783,6 +1783,109 @@ end:
 	return ret;
 }
 
+/*
+ * Writes the integer value `value` (the two's complement of the value
+ * if `fc` is a signed integer field class) of an integer field of which
+ * the class is `fc`.
+ */
+static
+void write_integer_value(struct details_write_ctx *ctx,
+		const bt_field_class *fc, uint64_t value)
+{
+	unsigned int fmt_base;
+	bt_field_class_integer_preferred_display_base base;
+	char buf[64];
+
+	base = bt_field_class_integer_get_preferred_display_base(fc);
+
+	switch (base) {
+	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_DECIMAL:
+		fmt_base = 10;
+		break;
+	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_OCTAL:
+		fmt_base = 8;
+		break;
+	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_BINARY:
+		fmt_base = 2;
+		break;
+	case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_HEXADECIMAL:
+		fmt_base = 16;
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	if (bt_field_class_type_is(bt_field_class_get_type(fc),
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		format_uint(buf, value, fmt_base);
+		write_sp(ctx);
+		write_uint_str_prop_value(ctx, buf);
+	} else {
+		format_int(buf, (int64_t) value, fmt_base);
+		write_sp(ctx);
+		write_int_str_prop_value(ctx, buf);
+	}
+}
+
+/*
+ * Borrows the packed element values of the array field `field` if its
+ * element field class `elem_fc` is a boolean, integer, or real field
+ * class, or returns `NULL`.
+ */
+static
+const void *borrow_packed_array_values(const bt_field *field,
+		const bt_field_class *elem_fc)
+{
+	bt_field_class_type elem_fc_type = bt_field_class_get_type(elem_fc);
+	const void *values = NULL;
+
+	if (elem_fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		values = bt_field_array_borrow_bool_values_const(field);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		values = bt_field_array_borrow_unsigned_integer_values_const(
+			field);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		values = bt_field_array_borrow_signed_integer_values_const(
+			field);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_REAL)) {
+		values = bt_field_array_borrow_real_values_const(field);
+	}
+
+	return values;
+}
+
+/*
+ * Writes the element `i` of the packed element values `values` (from
+ * borrow_packed_array_values()) of which the field class is `elem_fc`.
+ */
+static
+void write_packed_array_value(struct details_write_ctx *ctx,
+		const bt_field_class *elem_fc, const void *values, uint64_t i)
+{
+	bt_field_class_type elem_fc_type = bt_field_class_get_type(elem_fc);
+
+	if (elem_fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		write_sp(ctx);
+		write_bool_prop_value(ctx, ((const bt_bool *) values)[i]);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_INTEGER)) {
+		write_integer_value(ctx, elem_fc,
+			((const uint64_t *) values)[i]);
+	} else if (elem_fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		write_sp(ctx);
+		write_float_prop_value(ctx,
+			(float) ((const double *) values)[i]);
+	} else {
+		BT_ASSERT_DBG(elem_fc_type ==
+			BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL);
+		write_sp(ctx);
+		write_float_prop_value(ctx, ((const double *) values)[i]);
+	}
+}
+
 static
 void write_field(struct details_write_ctx *ctx, const bt_field *field,
 		const char *name)
@@ -1808,43 +1911,18 @@ void write_field(struct details_write_ctx *ctx, const bt_field *field,
 		write_uint_str_prop_value(ctx, buf);
 	} else if (bt_field_class_type_is(fc_type,
 			BT_FIELD_CLASS_TYPE_INTEGER)) {
-		unsigned int fmt_base;
-		bt_field_class_integer_preferred_display_base base;
-
-		fc = bt_field_borrow_class_const(field);
-		base = bt_field_class_integer_get_preferred_display_base(fc);
-
-		switch (base) {
-		case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_DECIMAL:
-			fmt_base = 10;
-			break;
-		case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_OCTAL:
-			fmt_base = 8;
-			break;
-		case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_BINARY:
-			fmt_base = 2;
-			break;
-		case BT_FIELD_CLASS_INTEGER_PREFERRED_DISPLAY_BASE_HEXADECIMAL:
-			fmt_base = 16;
-			break;
-		default:
-			bt_common_abort();
-		}
+		uint64_t value;
 
 		if (bt_field_class_type_is(fc_type,
 				BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
-			format_uint(buf,
-				bt_field_integer_unsigned_get_value(field),
-				fmt_base);
-			write_sp(ctx);
-			write_uint_str_prop_value(ctx, buf);
+			value = bt_field_integer_unsigned_get_value(field);
 		} else {
-			format_int(buf,
-				bt_field_integer_signed_get_value(field),
-				fmt_base);
-			write_sp(ctx);
-			write_int_str_prop_value(ctx, buf);
+			value = (uint64_t)
+				bt_field_integer_signed_get_value(field);
 		}
+
+		write_integer_value(ctx, bt_field_borrow_class_const(field),
+			value);
 	} else if (fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
 		write_sp(ctx);
 		write_float_prop_value(ctx, bt_field_real_single_precision_get_value(field));
@@ -1883,6 +1961,8 @@ void write_field(struct details_write_ctx *ctx, const bt_field *field,
 		}
 	} else if (bt_field_class_type_is(fc_type, BT_FIELD_CLASS_TYPE_ARRAY)) {
 		uint64_t length = bt_field_array_get_length(field);
+		const bt_field_class *elem_fc;
+		const void *values = NULL;
 
 		if (length == 0) {
 			write_sp(ctx);
@@ -1893,16 +1973,29 @@ void write_field(struct details_write_ctx *ctx, const bt_field *field,
 			g_string_append_c(ctx->str, ':');
 		}
 
+		fc = bt_field_borrow_class_const(field);
+		elem_fc = bt_field_class_array_borrow_element_field_class_const(
+			fc);
+
+		if (length > 0) {
+			values = borrow_packed_array_values(field, elem_fc);
+		}
+
 		incr_indent(ctx);
 
 		for (i = 0; i < length; i++) {
-			const bt_field *elem_field =
-				bt_field_array_borrow_element_field_by_index_const(
-					field, i);
-
 			write_nl(ctx);
 			write_array_index(ctx, i, color_fg_cyan(ctx));
-			write_field(ctx, elem_field, NULL);
+
+			if (values) {
+				write_packed_array_value(ctx, elem_fc, values,
+					i);
+			} else {
+				write_field(ctx,
+					bt_field_array_borrow_element_field_by_index_const(
+						field, i),
+					NULL);
+			}
 		}
 
 		decr_indent(ctx);
@@ -514,13 +514,17 @@ end:
 	return ret;
 }
 
+/*
+ * Prints the integer value `value` (the two's complement of the value
+ * if `int_fc` is a signed integer field class) of an integer field of
+ * which the class is `int_fc`.
+ */
 static
-int print_integer(struct pretty_component *pretty,
-		const bt_field *field)
+int print_integer_value(struct pretty_component *pretty,
+		const bt_field_class *int_fc, uint64_t value)
 {
 	int ret = 0;
 	bt_field_class_integer_preferred_display_base base;
-	const bt_field_class *int_fc;
 	union {
 		uint64_t u;
 		int64_t s;
@@ -528,15 +532,9 @@ int print_integer(struct pretty_component *pretty,
 	bool rst_color = false;
 	bt_field_class_type ft_type;
 
-	int_fc = bt_field_borrow_class_const(field);
 	BT_ASSERT_DBG(int_fc);
-	ft_type = bt_field_get_class_type(field);
-	if (bt_field_class_type_is(ft_type,
-			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
-		v.u = bt_field_integer_unsigned_get_value(field);
-	} else {
-		v.s = bt_field_integer_signed_get_value(field);
-	}
+	ft_type = bt_field_class_get_type(int_fc);
+	v.u = value;
 
 	if (pretty->use_colors) {
 		bt_common_g_string_append(pretty->string, color_number_value);
@@ -614,6 +612,23 @@ end:
 	return ret;
 }
 
+static
+int print_integer(struct pretty_component *pretty,
+		const bt_field *field)
+{
+	uint64_t value;
+
+	if (bt_field_class_type_is(bt_field_get_class_type(field),
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		value = bt_field_integer_unsigned_get_value(field);
+	} else {
+		value = (uint64_t) bt_field_integer_signed_get_value(field);
+	}
+
+	return print_integer_value(pretty, bt_field_borrow_class_const(field),
+		value);
+}
+
 static
 void print_escape_string(struct pretty_component *pretty, const char *str)
 {
@@ -682,30 +697,35 @@ void print_escape_string(struct pretty_component *pretty, const char *str)
 	bt_common_g_string_append_c(pretty->string, '"');
 }
 
+/*
+ * Prints the integer value `value` (the two's complement of the value
+ * if `enumeration_field_class` is a signed enumeration field class) of
+ * an enumeration field of which the class is `enumeration_field_class`.
+ */
 static
-int print_enum(struct pretty_component *pretty,
-		const bt_field *field)
+int print_enum_value(struct pretty_component *pretty,
+		const bt_field_class *enumeration_field_class, uint64_t value)
 {
 	int ret = 0;
-	const bt_field_class *enumeration_field_class = NULL;
 	bt_field_class_enumeration_mapping_label_array label_array;
 	uint64_t label_count;
 	uint64_t i;
 
-	enumeration_field_class = bt_field_borrow_class_const(field);
 	if (!enumeration_field_class) {
 		ret = -1;
 		goto end;
 	}
 
-	switch (bt_field_get_class_type(field)) {
+	switch (bt_field_class_get_type(enumeration_field_class)) {
 	case BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION:
-		ret = bt_field_enumeration_unsigned_get_mapping_labels(field,
-			&label_array, &label_count);
+		ret = bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+			enumeration_field_class, value, &label_array,
+			&label_count);
 		break;
 	case BT_FIELD_CLASS_TYPE_SIGNED_ENUMERATION:
-		ret = bt_field_enumeration_signed_get_mapping_labels(field,
-			&label_array, &label_count);
+		ret = bt_field_class_enumeration_signed_get_mapping_labels_for_value(
+			enumeration_field_class, (int64_t) value, &label_array,
+			&label_count);
 		break;
 	default:
 		bt_common_abort();
@@ -743,7 +763,7 @@ int print_enum(struct pretty_component *pretty,
 	}
 skip_loop:
 	bt_common_g_string_append(pretty->string, " : container = ");
-	ret = print_integer(pretty, field);
+	ret = print_integer_value(pretty, enumeration_field_class, value);
 	if (ret != 0) {
 		goto end;
 	}
@@ -752,6 +772,54 @@ end:
 	return ret;
 }
 
+static
+int print_enum(struct pretty_component *pretty,
+		const bt_field *field)
+{
+	uint64_t value;
+
+	if (bt_field_get_class_type(field) ==
+			BT_FIELD_CLASS_TYPE_UNSIGNED_ENUMERATION) {
+		value = bt_field_integer_unsigned_get_value(field);
+	} else {
+		value = (uint64_t) bt_field_integer_signed_get_value(field);
+	}
+
+	return print_enum_value(pretty, bt_field_borrow_class_const(field),
+		value);
+}
+
+static
+void print_bool(struct pretty_component *pretty, bt_bool v)
+{
+	const char *text;
+
+	if (pretty->use_colors) {
+		bt_common_g_string_append(pretty->string, color_number_value);
+	}
+	if (v) {
+		text = "true";
+	} else {
+		text = "false";
+	}
+	bt_common_g_string_append(pretty->string, text);
+	if (pretty->use_colors) {
+		bt_common_g_string_append(pretty->string, color_rst);
+	}
+}
+
+static
+void print_real(struct pretty_component *pretty, double v)
+{
+	if (pretty->use_colors) {
+		bt_common_g_string_append(pretty->string, color_number_value);
+	}
+	bt_common_g_string_append_printf(pretty->string, "%g", v);
+	if (pretty->use_colors) {
+		bt_common_g_string_append(pretty->string, color_rst);
+	}
+}
+
 static
 int print_struct_field(struct pretty_component *pretty,
 		const bt_field *_struct,
@@ -821,9 +889,74 @@ end:
 	return ret;
 }
 
+/*
+ * Borrows the packed element values of the array field `array` if its
+ * element field class is a boolean, integer, or real field class, or
+ * returns `NULL`.
+ */
+static
+const void *borrow_packed_array_values(const bt_field *array)
+{
+	const bt_field_class *elem_fc =
+		bt_field_class_array_borrow_element_field_class_const(
+			bt_field_borrow_class_const(array));
+	bt_field_class_type elem_fc_type = bt_field_class_get_type(elem_fc);
+	const void *values = NULL;
+
+	if (elem_fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		values = bt_field_array_borrow_bool_values_const(array);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_UNSIGNED_INTEGER)) {
+		values = bt_field_array_borrow_unsigned_integer_values_const(
+			array);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_SIGNED_INTEGER)) {
+		values = bt_field_array_borrow_signed_integer_values_const(
+			array);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_REAL)) {
+		values = bt_field_array_borrow_real_values_const(array);
+	}
+
+	return values;
+}
+
+/*
+ * Prints the element `i` of the packed element values `values` (from
+ * borrow_packed_array_values()) of which the field class is `elem_fc`.
+ */
+static
+int print_packed_array_value(struct pretty_component *pretty,
+		const bt_field_class *elem_fc, const void *values, uint64_t i)
+{
+	bt_field_class_type elem_fc_type = bt_field_class_get_type(elem_fc);
+	int ret = 0;
+
+	if (elem_fc_type == BT_FIELD_CLASS_TYPE_BOOL) {
+		print_bool(pretty, ((const bt_bool *) values)[i]);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_ENUMERATION)) {
+		ret = print_enum_value(pretty, elem_fc,
+			((const uint64_t *) values)[i]);
+	} else if (bt_field_class_type_is(elem_fc_type,
+			BT_FIELD_CLASS_TYPE_INTEGER)) {
+		ret = print_integer_value(pretty, elem_fc,
+			((const uint64_t *) values)[i]);
+	} else if (elem_fc_type == BT_FIELD_CLASS_TYPE_SINGLE_PRECISION_REAL) {
+		print_real(pretty, (float) ((const double *) values)[i]);
+	} else {
+		BT_ASSERT_DBG(elem_fc_type ==
+			BT_FIELD_CLASS_TYPE_DOUBLE_PRECISION_REAL);
+		print_real(pretty, ((const double *) values)[i]);
+	}
+
+	return ret;
+}
+
 static
 int print_array_field(struct pretty_component *pretty,
-		const bt_field *array, uint64_t i, bool print_names)
+		const bt_field *array, const void *values, uint64_t i,
+		bool print_names)
 {
 	const bt_field *field = NULL;
 
@@ -836,6 +969,13 @@ int print_array_field(struct pretty_component *pretty,
 		bt_common_g_string_append_printf(pretty->string, "[%" PRIu64 "] = ", i);
 	}
 
+	if (values) {
+		return print_packed_array_value(pretty,
+			bt_field_class_array_borrow_element_field_class_const(
+				bt_field_borrow_class_const(array)),
+			values, i);
+	}
+
 	field = bt_field_array_borrow_element_field_by_index_const(array, i);
 	BT_ASSERT_DBG(field);
 	return print_field(pretty, field, print_names);
@@ -847,6 +987,7 @@ int print_array(struct pretty_component *pretty,
 {
 	int ret = 0;
 	const bt_field_class *array_class = NULL;
+	const void *values;
 	uint64_t len;
 	uint64_t i;
 
@@ -856,10 +997,12 @@ int print_array(struct pretty_component *pretty,
 		goto end;
 	}
 	len = bt_field_array_get_length(array);
+	values = borrow_packed_array_values(array);
 	bt_common_g_string_append(pretty->string, "[");
 	pretty->depth++;
 	for (i = 0; i < len; i++) {
-		ret = print_array_field(pretty, array, i, print_names);
+		ret = print_array_field(pretty, array, values, i,
+			print_names);
 		if (ret != 0) {
 			goto end;
 		}
@@ -873,7 +1016,8 @@ end:
 
 static
 int print_sequence_field(struct pretty_component *pretty,
-		const bt_field *seq, uint64_t i, bool print_names)
+		const bt_field *seq, const void *values, uint64_t i,
+		bool print_names)
 {
 	const bt_field *field = NULL;
 
@@ -886,6 +1030,13 @@ int print_sequence_field(struct pretty_component *pretty,
 		bt_common_g_string_append_printf(pretty->string, "[%" PRIu64 "] = ", i);
 	}
 
+	if (values) {
+		return print_packed_array_value(pretty,
+			bt_field_class_array_borrow_element_field_class_const(
+				bt_field_borrow_class_const(seq)),
+			values, i);
+	}
+
 	field = bt_field_array_borrow_element_field_by_index_const(seq, i);
 	BT_ASSERT_DBG(field);
 	return print_field(pretty, field, print_names);
@@ -896,15 +1047,18 @@ int print_sequence(struct pretty_component *pretty,
 		const bt_field *seq, bool print_names)
 {
 	int ret = 0;
+	const void *values;
 	uint64_t len;
 	uint64_t i;
 
 	len = bt_field_array_get_length(seq);
+	values = borrow_packed_array_values(seq);
 	bt_common_g_string_append(pretty->string, "[");
 
 	pretty->depth++;
 	for (i = 0; i < len; i++) {
-		ret = print_sequence_field(pretty, seq, i, print_names);
+		ret = print_sequence_field(pretty, seq, values, i,
+			print_names);
 		if (ret != 0) {
 			goto end;
 		}
@@ -979,22 +1133,7 @@ int print_field(struct pretty_component *pretty,
 
 	class_id = bt_field_get_class_type(field);
 	if (class_id == BT_FIELD_CLASS_TYPE_BOOL) {
-		bt_bool v;
-		const char *text;
-
-		v = bt_field_bool_get_value(field);
-		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_number_value);
-		}
-		if (v) {
-			text = "true";
-		} else {
-			text = "false";
-		}
-		bt_common_g_string_append(pretty->string, text);
-		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_rst);
-		}
+		print_bool(pretty, bt_field_bool_get_value(field));
 		return 0;
 	} else if (class_id == BT_FIELD_CLASS_TYPE_BIT_ARRAY) {
 		uint64_t v = bt_field_bit_array_get_value_as_integer(field);
@@ -1025,13 +1164,7 @@ int print_field(struct pretty_component *pretty,
 			v = bt_field_real_double_precision_get_value(field);
 		}
 
-		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_number_value);
-		}
-		bt_common_g_string_append_printf(pretty->string, "%g", v);
-		if (pretty->use_colors) {
-			bt_common_g_string_append(pretty->string, color_rst);
-		}
+		print_real(pretty, v);
 		return 0;
 	} else if (class_id == BT_FIELD_CLASS_TYPE_STRING) {
 		const char *str;
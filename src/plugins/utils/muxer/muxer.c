@@ -35,6 +35,7 @@
 #include "common/common.h"
 #include <stdlib.h>
 #include <string.h>
+#include "lib/prio-heap/prio-heap.h"
 
 #include "plugins/common/muxing/muxing.h"
 #include "plugins/common/param-validation/param-validation.h"
@@ -60,6 +61,20 @@ struct muxer_upstream_msg_iter {
 
 	/* Contains `const bt_message *`, owned by this */
 	GQueue *msgs;
+
+	/*
+	 * Timestamp (ns from origin) of the head message of `msgs`,
+	 * computed when it becomes the head message. Only valid when
+	 * this is part of its muxer message iterator's `heap`.
+	 */
+	int64_t head_ts_ns;
+
+	/*
+	 * True if the head message of `msgs` has no timestamp: in this
+	 * case, `head_ts_ns` is the muxer message iterator's last
+	 * returned timestamp at the time it was computed.
+	 */
+	bool head_ts_is_last_returned;
 };
 
 enum muxer_msg_iter_clock_class_expectation {
@@ -79,13 +94,36 @@ struct muxer_msg_iter {
 	/*
 	 * Array of struct muxer_upstream_msg_iter * (owned by this).
 	 *
-	 * NOTE: This array is searched in linearly to find the youngest
-	 * current message. Keep this until benchmarks confirm that
-	 * another data structure is faster than this for our typical
-	 * use cases.
+	 * Each element of this array is either part of `heap` or of
+	 * `to_validate_muxer_upstream_msg_iters`.
 	 */
 	GPtrArray *active_muxer_upstream_msg_iters;
 
+	/*
+	 * Priority heap of struct muxer_upstream_msg_iter * (weak):
+	 * active upstream message iterators which have at least one
+	 * queued message, the maximum being the one of which the head
+	 * message is the youngest.
+	 *
+	 * Selecting the youngest message is O(1) and updating the heap
+	 * after consuming it is O(log n), n being the number of active
+	 * upstream message iterators.
+	 */
+	struct ptr_heap heap;
+
+	/*
+	 * True if a message was consumed from the head of the maximum
+	 * of `heap` since the last time it was rebalanced.
+	 */
+	bool heap_max_needs_update;
+
+	/*
+	 * Array of struct muxer_upstream_msg_iter * (weak): active
+	 * upstream message iterators which have no queued message, to
+	 * validate before selecting the next message.
+	 */
+	GPtrArray *to_validate_muxer_upstream_msg_iters;
+
 	/*
 	 * Array of struct muxer_upstream_msg_iter * (owned by this).
 	 *
@@ -179,6 +217,8 @@ int muxer_msg_iter_add_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
 
 	g_ptr_array_add(muxer_msg_iter->active_muxer_upstream_msg_iters,
 		muxer_upstream_msg_iter);
+	g_ptr_array_add(muxer_msg_iter->to_validate_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
 	BT_COMP_LOGD("Added muxer's upstream message iterator wrapper: "
 		"addr=%p, muxer-msg-iter-addr=%p, msg-iter-addr=%p",
 		muxer_upstream_msg_iter, muxer_msg_iter,
@@ -470,7 +510,7 @@ static
 int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		struct muxer_msg_iter *muxer_msg_iter,
 		const bt_message *msg, int64_t last_returned_ts_ns,
-		int64_t *ts_ns)
+		int64_t *ts_ns, bool *is_last_returned_ts)
 {
 	const bt_clock_snapshot *clock_snapshot = NULL;
 	int ret = 0;
@@ -479,6 +519,8 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 
 	BT_ASSERT_DBG(msg);
 	BT_ASSERT_DBG(ts_ns);
+	BT_ASSERT_DBG(is_last_returned_ts);
+	*is_last_returned_ts = false;
 	BT_COMP_LOGD("Getting message's timestamp: "
 		"muxer-msg-iter-addr=%p, msg-addr=%p, "
 		"last-returned-ts=%" PRId64,
@@ -487,6 +529,7 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 	if (G_UNLIKELY(muxer_msg_iter->clock_class_expectation ==
 			MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_NONE)) {
 		*ts_ns = last_returned_ts_ns;
+		*is_last_returned_ts = true;
 		goto end;
 	}
 
@@ -587,6 +630,7 @@ int get_msg_ts_ns(struct muxer_comp *muxer_comp,
 		/* All the other messages have a higher priority */
 		BT_COMP_LOGD_STR("Message has no timestamp: using the last returned timestamp.");
 		*ts_ns = last_returned_ts_ns;
+		*is_last_returned_ts = true;
 		goto end;
 	}
 
@@ -603,6 +647,7 @@ no_clock_snapshot:
 	BT_COMP_LOGD_STR("Message's default clock snapshot is missing: "
 		"using the last returned timestamp.");
 	*ts_ns = last_returned_ts_ns;
+	*is_last_returned_ts = true;
 	goto end;
 
 error:
@@ -778,6 +823,89 @@ end:
 	return ret;
 }
 
+/*
+ * Heap comparison function: returns true if the head message of the
+ * upstream message iterator `a` must go before the one of `b`.
+ */
+static
+int muxer_upstream_msg_iter_is_younger(void *a, void *b)
+{
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_a = a;
+	struct muxer_upstream_msg_iter *muxer_upstream_msg_iter_b = b;
+
+	if (muxer_upstream_msg_iter_a->head_ts_ns !=
+			muxer_upstream_msg_iter_b->head_ts_ns) {
+		return muxer_upstream_msg_iter_a->head_ts_ns <
+			muxer_upstream_msg_iter_b->head_ts_ns;
+	}
+
+	/*
+	 * Both head messages have the exact same timestamp: order them
+	 * in an arbitrary but deterministic way.
+	 */
+	return common_muxing_compare_messages(
+		g_queue_peek_head(muxer_upstream_msg_iter_a->msgs),
+		g_queue_peek_head(muxer_upstream_msg_iter_b->msgs)) < 0;
+}
+
+/*
+ * Computes the timestamp of the head message of
+ * `muxer_upstream_msg_iter`, validating its clock class on the way.
+ *
+ * This function must be called once each time an upstream message
+ * iterator gets a new head message, before adding it to the heap (or
+ * rebalancing the heap).
+ */
+static
+int update_muxer_upstream_msg_iter_head_ts(
+		struct muxer_comp *muxer_comp,
+		struct muxer_msg_iter *muxer_msg_iter,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	const bt_message *msg;
+	int ret;
+
+	BT_ASSERT_DBG(muxer_upstream_msg_iter->msgs->length > 0);
+	msg = g_queue_peek_head(muxer_upstream_msg_iter->msgs);
+	BT_ASSERT_DBG(msg);
+
+	if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
+		ret = validate_new_stream_clock_class(
+			muxer_msg_iter, muxer_comp,
+			bt_message_stream_beginning_borrow_stream_const(
+				msg));
+		if (ret) {
+			/*
+			 * validate_new_stream_clock_class() logs
+			 * errors.
+			 */
+			goto end;
+		}
+	} else if (G_UNLIKELY(bt_message_get_type(msg) ==
+			BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
+		const bt_clock_snapshot *cs;
+
+		cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
+			msg);
+		ret = validate_clock_class(muxer_msg_iter, muxer_comp,
+			bt_clock_snapshot_borrow_clock_class_const(cs));
+		if (ret) {
+			/* validate_clock_class() logs errors */
+			goto end;
+		}
+	}
+
+	/* get_msg_ts_ns() logs errors */
+	ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
+		muxer_msg_iter->last_returned_ts_ns,
+		&muxer_upstream_msg_iter->head_ts_ns,
+		&muxer_upstream_msg_iter->head_ts_is_last_returned);
+
+end:
+	return ret;
+}
+
 /*
  * This function finds the youngest available message amongst the
  * non-ended upstream message iterators and returns the upstream
@@ -802,128 +930,45 @@ muxer_msg_iter_youngest_upstream_msg_iter(
 		struct muxer_upstream_msg_iter **muxer_upstream_msg_iter,
 		int64_t *ts_ns)
 {
-	size_t i;
-	int ret;
-	int64_t youngest_ts_ns = INT64_MAX;
 	bt_message_iterator_class_next_method_status status =
 		BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
 	BT_ASSERT_DBG(muxer_comp);
 	BT_ASSERT_DBG(muxer_msg_iter);
 	BT_ASSERT_DBG(muxer_upstream_msg_iter);
-	*muxer_upstream_msg_iter = NULL;
-
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
-		const bt_message *msg;
-		struct muxer_upstream_msg_iter *cur_muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-		int64_t msg_ts_ns;
-
-		if (!cur_muxer_upstream_msg_iter->msg_iter) {
-			/* This upstream message iterator is ended */
-			BT_COMP_LOGT("Skipping ended upstream message iterator: "
-				"muxer-upstream-msg-iter-wrap-addr=%p",
-				cur_muxer_upstream_msg_iter);
-			continue;
-		}
-
-		BT_ASSERT_DBG(cur_muxer_upstream_msg_iter->msgs->length > 0);
-		msg = g_queue_peek_head(cur_muxer_upstream_msg_iter->msgs);
-		BT_ASSERT_DBG(msg);
-
-		if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_STREAM_BEGINNING)) {
-			ret = validate_new_stream_clock_class(
-				muxer_msg_iter, muxer_comp,
-				bt_message_stream_beginning_borrow_stream_const(
-					msg));
-			if (ret) {
-				/*
-				 * validate_new_stream_clock_class() logs
-				 * errors.
-				 */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		} else if (G_UNLIKELY(bt_message_get_type(msg) ==
-				BT_MESSAGE_TYPE_MESSAGE_ITERATOR_INACTIVITY)) {
-			const bt_clock_snapshot *cs;
-
-			cs = bt_message_message_iterator_inactivity_borrow_clock_snapshot_const(
-				msg);
-			ret = validate_clock_class(muxer_msg_iter, muxer_comp,
-				bt_clock_snapshot_borrow_clock_class_const(cs));
-			if (ret) {
-				/* validate_clock_class() logs errors */
-				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
-				goto end;
-			}
-		}
+	BT_ASSERT_DBG(!muxer_msg_iter->heap_max_needs_update);
 
-		ret = get_msg_ts_ns(muxer_comp, muxer_msg_iter, msg,
-			muxer_msg_iter->last_returned_ts_ns, &msg_ts_ns);
-		if (ret) {
-			/* get_msg_ts_ns() logs errors */
-			*muxer_upstream_msg_iter = NULL;
-			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+	for (;;) {
+		*muxer_upstream_msg_iter = bt_heap_maximum(&muxer_msg_iter->heap);
+		if (!*muxer_upstream_msg_iter) {
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+			*ts_ns = INT64_MIN;
 			goto end;
 		}
 
 		/*
-		 * Update the current message iterator if it has not been set
-		 * yet, or if its current message has a timestamp smaller than
-		 * the previously selected youngest message.
+		 * The timestamp of a message without a timestamp is
+		 * the last returned timestamp, which can have changed
+		 * since it was computed. The timestamp of any other
+		 * message of the heap is at least the last returned
+		 * timestamp, so the one of an outdated maximum can only
+		 * increase: update it and rebalance the heap until the
+		 * maximum is up to date.
 		 */
-		if (G_UNLIKELY(*muxer_upstream_msg_iter == NULL) ||
-				msg_ts_ns < youngest_ts_ns) {
-			*muxer_upstream_msg_iter =
-				cur_muxer_upstream_msg_iter;
-			youngest_ts_ns = msg_ts_ns;
-			*ts_ns = youngest_ts_ns;
-		} else if (msg_ts_ns == youngest_ts_ns) {
-			/*
-			 * The currently selected message to be sent downstream
-			 * next has the exact same timestamp that of the
-			 * current candidate message. We must break the tie
-			 * in a predictable manner.
-			 */
-			const bt_message *selected_msg = g_queue_peek_head(
-				(*muxer_upstream_msg_iter)->msgs);
-			BT_COMP_LOGD_STR("Two of the next message candidates have the same timestamps, pick one deterministically.");
-
-			/*
-			 * Order the messages in an arbitrary but determinitic
-			 * way.
-			 */
-			ret = common_muxing_compare_messages(msg, selected_msg);
-			if (ret < 0) {
-				/*
-				 * The `msg` should go first. Update the next
-				 * iterator and the current timestamp.
-				 */
-				*muxer_upstream_msg_iter =
-					cur_muxer_upstream_msg_iter;
-				youngest_ts_ns = msg_ts_ns;
-				*ts_ns = youngest_ts_ns;
-			} else if (ret == 0) {
-				/* Unable to pick which one should go first. */
-				BT_COMP_LOGW("Cannot deterministically pick next upstream message iterator because they have identical next messages: "
-					"muxer-upstream-msg-iter-wrap-addr=%p"
-					"cur-muxer-upstream-msg-iter-wrap-addr=%p",
-					*muxer_upstream_msg_iter,
-					cur_muxer_upstream_msg_iter);
-			}
+		if (G_LIKELY(!(*muxer_upstream_msg_iter)->head_ts_is_last_returned ||
+				(*muxer_upstream_msg_iter)->head_ts_ns ==
+					muxer_msg_iter->last_returned_ts_ns)) {
+			break;
 		}
-	}
 
-	if (!*muxer_upstream_msg_iter) {
-		status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
-		*ts_ns = INT64_MIN;
+		(*muxer_upstream_msg_iter)->head_ts_ns =
+			muxer_msg_iter->last_returned_ts_ns;
+		(void) bt_heap_replace_max(&muxer_msg_iter->heap,
+			*muxer_upstream_msg_iter);
 	}
 
+	*ts_ns = (*muxer_upstream_msg_iter)->head_ts_ns;
+
 end:
 	return status;
 }
@@ -959,25 +1004,92 @@ end:
 	return status;
 }
 
+/*
+ * Moves the active upstream message iterator `muxer_upstream_msg_iter`
+ * to the array of ended iterators.
+ */
+static
+void end_muxer_upstream_msg_iter(struct muxer_msg_iter *muxer_msg_iter,
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter)
+{
+	GPtrArray *active = muxer_msg_iter->active_muxer_upstream_msg_iters;
+	guint i;
+
+	for (i = 0; i < active->len; i++) {
+		if (active->pdata[i] == muxer_upstream_msg_iter) {
+			break;
+		}
+	}
+
+	BT_ASSERT(i < active->len);
+	g_ptr_array_add(muxer_msg_iter->ended_muxer_upstream_msg_iters,
+		muxer_upstream_msg_iter);
+	active->pdata[i] = NULL;
+
+	/*
+	 * Use g_ptr_array_remove_fast() because the order of those
+	 * elements is not important.
+	 */
+	g_ptr_array_remove_index_fast(active, i);
+}
+
+/*
+ * Makes sure that each active upstream message iterator has at least
+ * one queued message, and that the heap is up to date.
+ *
+ * Only the upstream message iterator of which the head message was
+ * just consumed and the ones which had no queued message are
+ * considered: the head message of any other upstream message iterator
+ * is already part of the heap.
+ */
 static
 bt_message_iterator_class_next_method_status
 validate_muxer_upstream_msg_iters(
 		struct muxer_msg_iter *muxer_msg_iter)
 {
 	struct muxer_comp *muxer_comp = muxer_msg_iter->muxer_comp;
+	GPtrArray *to_validate =
+		muxer_msg_iter->to_validate_muxer_upstream_msg_iters;
 	bt_message_iterator_class_next_method_status status;
 	size_t i;
 
 	BT_COMP_LOGD("Validating muxer's upstream message iterator wrappers: "
 		"muxer-msg-iter-addr=%p", muxer_msg_iter);
 
-	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
-			i++) {
+	if (muxer_msg_iter->heap_max_needs_update) {
+		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
+			bt_heap_maximum(&muxer_msg_iter->heap);
+
+		BT_ASSERT(muxer_upstream_msg_iter);
+
+		if (muxer_upstream_msg_iter->msgs->length > 0) {
+			if (update_muxer_upstream_msg_iter_head_ts(muxer_comp,
+					muxer_msg_iter, muxer_upstream_msg_iter)) {
+				BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+					"Cannot get the timestamp of muxer's upstream message iterator wrapper's next message: "
+					"muxer-msg-iter-addr=%p, "
+					"muxer-upstream-msg-iter-wrap-addr=%p",
+					muxer_msg_iter,
+					muxer_upstream_msg_iter);
+				status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+				goto end;
+			}
+
+			/* Rebalance the heap with the new timestamp */
+			(void) bt_heap_replace_max(&muxer_msg_iter->heap,
+				muxer_upstream_msg_iter);
+		} else {
+			(void) bt_heap_remove(&muxer_msg_iter->heap);
+			g_ptr_array_add(to_validate, muxer_upstream_msg_iter);
+		}
+
+		muxer_msg_iter->heap_max_needs_update = false;
+	}
+
+	for (i = 0; i < to_validate->len; i++) {
 		bool is_ended = false;
 		struct muxer_upstream_msg_iter *muxer_upstream_msg_iter =
-			g_ptr_array_index(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
+			g_ptr_array_index(to_validate, i);
 
 		status = validate_muxer_upstream_msg_iter(
 			muxer_upstream_msg_iter, &is_ended);
@@ -997,7 +1109,7 @@ validate_muxer_upstream_msg_iters(
 					muxer_upstream_msg_iter);
 			}
 
-			goto end;
+			goto remove_validated;
 		}
 
 		/*
@@ -1009,24 +1121,47 @@ validate_muxer_upstream_msg_iters(
 				"muxer-msg-iter-addr=%p, "
 				"muxer-upstream-msg-iter-wrap-addr=%p",
 				muxer_msg_iter, muxer_upstream_msg_iter);
-			g_ptr_array_add(
-				muxer_msg_iter->ended_muxer_upstream_msg_iters,
+			end_muxer_upstream_msg_iter(muxer_msg_iter,
 				muxer_upstream_msg_iter);
-			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i] = NULL;
+			continue;
+		}
 
-			/*
-			 * Use g_ptr_array_remove_fast() because the
-			 * order of those elements is not important.
-			 */
-			g_ptr_array_remove_index_fast(
-				muxer_msg_iter->active_muxer_upstream_msg_iters,
-				i);
-			i--;
+		if (update_muxer_upstream_msg_iter_head_ts(muxer_comp,
+				muxer_msg_iter, muxer_upstream_msg_iter)) {
+			BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+				"Cannot get the timestamp of muxer's upstream message iterator wrapper's next message: "
+				"muxer-msg-iter-addr=%p, "
+				"muxer-upstream-msg-iter-wrap-addr=%p",
+				muxer_msg_iter,
+				muxer_upstream_msg_iter);
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_ERROR;
+			goto remove_validated;
+		}
+
+		if (bt_heap_insert(&muxer_msg_iter->heap,
+				muxer_upstream_msg_iter)) {
+			BT_COMP_LOGE_APPEND_CAUSE(muxer_comp->self_comp,
+				"Failed to insert muxer's upstream message iterator wrapper into heap: "
+				"muxer-msg-iter-addr=%p, "
+				"muxer-upstream-msg-iter-wrap-addr=%p",
+				muxer_msg_iter,
+				muxer_upstream_msg_iter);
+			status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_MEMORY_ERROR;
+			goto remove_validated;
 		}
 	}
 
 	status = BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
 
+remove_validated:
+	/*
+	 * GLib < 2.48.0 asserts when g_ptr_array_remove_range() is
+	 * called on an empty range.
+	 */
+	if (i > 0) {
+		g_ptr_array_remove_range(to_validate, 0, i);
+	}
+
 end:
 	return status;
 }
@@ -1099,6 +1234,12 @@ bt_message_iterator_class_next_method_status muxer_msg_iter_do_next_one(
 	BT_ASSERT_DBG(*msg);
 	muxer_msg_iter->last_returned_ts_ns = next_return_ts;
 
+	/*
+	 * The next call to validate_muxer_upstream_msg_iters() updates
+	 * the heap with this upstream message iterator's next message.
+	 */
+	muxer_msg_iter->heap_max_needs_update = true;
+
 end:
 	return status;
 }
@@ -1178,6 +1319,14 @@ void destroy_muxer_msg_iter(struct muxer_msg_iter *muxer_msg_iter)
 	BT_COMP_LOGD("Destroying muxer component's message iterator: "
 		"muxer-msg-iter-addr=%p", muxer_msg_iter);
 
+	bt_heap_free(&muxer_msg_iter->heap);
+
+	if (muxer_msg_iter->to_validate_muxer_upstream_msg_iters) {
+		g_ptr_array_free(
+			muxer_msg_iter->to_validate_muxer_upstream_msg_iters,
+			TRUE);
+	}
+
 	if (muxer_msg_iter->active_muxer_upstream_msg_iters) {
 		BT_COMP_LOGD_STR("Destroying muxer's active upstream message iterator wrappers.");
 		g_ptr_array_free(
@@ -1332,6 +1481,21 @@ bt_message_iterator_class_initialize_method_status muxer_msg_iter_init(
 		goto error;
 	}
 
+	muxer_msg_iter->to_validate_muxer_upstream_msg_iters =
+		g_ptr_array_new();
+	if (!muxer_msg_iter->to_validate_muxer_upstream_msg_iters) {
+		BT_COMP_LOGE_STR("Failed to allocate a GPtrArray.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
+	if (bt_heap_init(&muxer_msg_iter->heap, 0,
+			muxer_upstream_msg_iter_is_younger)) {
+		BT_COMP_LOGE_STR("Failed to initialize a priority heap.");
+		status = BT_MESSAGE_ITERATOR_CLASS_INITIALIZE_METHOD_STATUS_MEMORY_ERROR;
+		goto error;
+	}
+
 	status = muxer_msg_iter_init_upstream_iterators(muxer_comp,
 		muxer_msg_iter, config);
 	if (status) {
@@ -1570,6 +1734,27 @@ bt_message_iterator_class_seek_beginning_method_status muxer_msg_iter_seek_begin
 		g_ptr_array_remove_range(muxer_msg_iter->ended_muxer_upstream_msg_iters,
 			0, muxer_msg_iter->ended_muxer_upstream_msg_iters->len);
 	}
+
+	/* All the active upstream iterators need to be validated again */
+	while (bt_heap_maximum(&muxer_msg_iter->heap)) {
+		(void) bt_heap_remove(&muxer_msg_iter->heap);
+	}
+
+	muxer_msg_iter->heap_max_needs_update = false;
+
+	if (muxer_msg_iter->to_validate_muxer_upstream_msg_iters->len > 0) {
+		g_ptr_array_remove_range(
+			muxer_msg_iter->to_validate_muxer_upstream_msg_iters, 0,
+			muxer_msg_iter->to_validate_muxer_upstream_msg_iters->len);
+	}
+
+	for (i = 0; i < muxer_msg_iter->active_muxer_upstream_msg_iters->len;
+			i++) {
+		g_ptr_array_add(
+			muxer_msg_iter->to_validate_muxer_upstream_msg_iters,
+			muxer_msg_iter->active_muxer_upstream_msg_iters->pdata[i]);
+	}
+
 	muxer_msg_iter->last_returned_ts_ns = INT64_MIN;
 	muxer_msg_iter->clock_class_expectation =
 		MUXER_MSG_ITER_CLOCK_CLASS_EXPECTATION_ANY;
@@ -0,0 +1,162 @@
+/*
+ * bench_bitfield.c
+ *
+ * BabelTrace - bitfield read micro-benchmark
+ *
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Compares, for byte-aligned 8-bit, 16-bit, 32-bit, and 64-bit
+ * little-endian and big-endian integers, the generic
+ * bt_bitfield_read_le()/bt_bitfield_read_be() macros with a single
+ * load followed by a byte swap when needed, which is what the CTF
+ * binary field class reader does for such integers.
+ *
+ * Usage: bench_bitfield [ITERATIONS]
+ */
+
+#include "compat/bitfield.h"
+#include "compat/endian.h"
+#include <glib.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Buffer size, in bytes */
+#define BUF_LEN 4096
+
+static uint8_t buf[BUF_LEN + sizeof(uint64_t)];
+
+/* Prevents the compiler from optimizing the reads away */
+static volatile uint64_t sink;
+
+static inline
+uint64_t read_aligned_word(const uint8_t *addr, unsigned int size, int le)
+{
+	switch (size) {
+	case 8:
+		return *addr;
+	case 16:
+	{
+		uint16_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return le ? le16toh(v) : be16toh(v);
+	}
+	case 32:
+	{
+		uint32_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return le ? le32toh(v) : be32toh(v);
+	}
+	default:
+	{
+		uint64_t v;
+
+		memcpy(&v, addr, sizeof(v));
+		return le ? le64toh(v) : be64toh(v);
+	}
+	}
+}
+
+static
+double bench_macro(unsigned int size, int le, unsigned long iterations)
+{
+	unsigned long i;
+	size_t at;
+	uint64_t acc = 0;
+	gint64 begin = g_get_monotonic_time();
+
+	for (i = 0; i < iterations; i++) {
+		for (at = 0; at < BUF_LEN * CHAR_BIT; at += size) {
+			uint64_t v;
+
+			if (le) {
+				bt_bitfield_read_le(buf, uint8_t, at, size, &v);
+			} else {
+				bt_bitfield_read_be(buf, uint8_t, at, size, &v);
+			}
+
+			acc += v;
+		}
+	}
+
+	sink = acc;
+	return (double) (g_get_monotonic_time() - begin) * 1000. /
+		((double) iterations * (BUF_LEN * CHAR_BIT / size));
+}
+
+static
+double bench_aligned_word(unsigned int size, int le,
+		unsigned long iterations)
+{
+	unsigned long i;
+	size_t at;
+	uint64_t acc = 0;
+	gint64 begin = g_get_monotonic_time();
+
+	for (i = 0; i < iterations; i++) {
+		for (at = 0; at < BUF_LEN * CHAR_BIT; at += size) {
+			acc += read_aligned_word(&buf[at / CHAR_BIT], size, le);
+		}
+	}
+
+	sink = acc;
+	return (double) (g_get_monotonic_time() - begin) * 1000. /
+		((double) iterations * (BUF_LEN * CHAR_BIT / size));
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long iterations = 20000;
+	unsigned int sizes[] = { 8, 16, 32, 64 };
+	size_t i;
+	int le;
+
+	if (argc > 1) {
+		iterations = strtoul(argv[1], NULL, 10);
+	}
+
+	if (iterations == 0) {
+		fprintf(stderr, "Invalid iteration count\n");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t) (i * 31 + 7);
+	}
+
+	printf("%-6s %-4s %14s %14s %8s\n", "order", "size",
+		"macro (ns)", "load (ns)", "speedup");
+
+	for (le = 1; le >= 0; le--) {
+		for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+			double macro_ns = bench_macro(sizes[i], le, iterations);
+			double word_ns = bench_aligned_word(sizes[i], le,
+				iterations);
+
+			printf("%-6s %-4u %14.3f %14.3f %7.2fx\n",
+				le ? "le" : "be", sizes[i], macro_ns, word_ns,
+				macro_ns / word_ns);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test the label lookup of enumeration field classes against a linear
+ * scan of their mappings.
+ *
+ * The test creates pseudo-random enumeration field classes (with a
+ * fixed seed) having overlapping, nested, and disjoint ranges, and
+ * looks up values around the boundaries of all their ranges as well
+ * as random values.
+ *
+ * The source component runs all the tests when it initializes, as it
+ * only needs a trace class.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 11
+
+#define RANDOM_SEED		UINT64_C(0x9e3779b97f4a7c15)
+#define ENUM_COUNT_PER_KIND	32
+#define MAX_MAPPING_COUNT	48
+#define MAX_RANGE_COUNT		6
+#define RANDOM_PROBE_COUNT	256
+
+/*
+ * Number of nested mappings of the enumerations of which the label
+ * lookup index would be too large.
+ */
+#define DEEP_NESTING_MAPPING_COUNT	512
+
+enum range_kind {
+	/* All the ranges within fewer than 4096 values */
+	RANGE_KIND_SMALL,
+
+	/* Ranges anywhere in the value space */
+	RANGE_KIND_WIDE,
+
+	/* Ranges with the same center */
+	RANGE_KIND_NESTED,
+
+	/* Ranges at the minimum and maximum values */
+	RANGE_KIND_EDGES,
+};
+
+struct test_range {
+	/* Value bits: cast to `int64_t` if the enumeration is signed */
+	uint64_t lower;
+	uint64_t upper;
+};
+
+struct test_mapping {
+	gchar *label;
+	uint64_t range_count;
+	struct test_range ranges[MAX_RANGE_COUNT];
+};
+
+struct test_enum {
+	bool is_signed;
+	uint64_t mapping_count;
+	struct test_mapping *mappings;
+	bt_field_class *fc;
+};
+
+static uint64_t random_state = RANDOM_SEED;
+
+/* xorshift64* */
+static
+uint64_t random_u64(void)
+{
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return random_state * UINT64_C(2685821657736338717);
+}
+
+static
+uint64_t random_below(uint64_t max)
+{
+	return random_u64() % max;
+}
+
+static
+bool value_le(bool is_signed, uint64_t a, uint64_t b)
+{
+	return is_signed ? (int64_t) a <= (int64_t) b : a <= b;
+}
+
+static
+uint64_t min_value(bool is_signed)
+{
+	return is_signed ? (uint64_t) INT64_MIN : 0;
+}
+
+static
+uint64_t max_value(bool is_signed)
+{
+	return is_signed ? (uint64_t) INT64_MAX : UINT64_MAX;
+}
+
+static
+struct test_range make_range(bool is_signed, uint64_t a, uint64_t b)
+{
+	struct test_range range;
+
+	if (value_le(is_signed, a, b)) {
+		range.lower = a;
+		range.upper = b;
+	} else {
+		range.lower = b;
+		range.upper = a;
+	}
+
+	return range;
+}
+
+static
+struct test_range random_range(bool is_signed, enum range_kind kind,
+		uint64_t center, uint64_t mapping_index)
+{
+	const uint64_t min = min_value(is_signed);
+	const uint64_t max = max_value(is_signed);
+	uint64_t a, b, radius;
+
+	switch (kind) {
+	case RANGE_KIND_SMALL:
+		/* Within [-1024, 3071] (signed) or [0, 4095] (unsigned) */
+		a = random_below(4096 - 16);
+		b = a + random_below(16);
+
+		if (is_signed) {
+			a -= 1024;
+			b -= 1024;
+		}
+
+		return make_range(is_signed, a, b);
+	case RANGE_KIND_WIDE:
+		return make_range(is_signed, random_u64(), random_u64());
+	case RANGE_KIND_NESTED:
+		/*
+		 * The later mappings are the inner ones, but some
+		 * random ranges partially overlap the others.
+		 */
+		radius = (UINT64_C(1) << 40) >> (mapping_index % 32);
+
+		if (random_below(4) == 0) {
+			a = center + random_below(radius);
+			return make_range(is_signed, a,
+				a + random_below(radius));
+		}
+
+		return make_range(is_signed, center - radius,
+			center + radius);
+	case RANGE_KIND_EDGES:
+		switch (random_below(5)) {
+		case 0:
+			return make_range(is_signed, max - random_below(64),
+				max);
+		case 1:
+			return make_range(is_signed, min,
+				min + random_below(64));
+		case 2:
+			return make_range(is_signed, max, max);
+		case 3:
+			return make_range(is_signed, min, min);
+		default:
+			return make_range(is_signed, min, max);
+		}
+	default:
+		abort();
+	}
+}
+
+static
+void add_mapping(struct test_enum *test_enum, const struct test_mapping *mapping)
+{
+	bt_field_class_enumeration_add_mapping_status add_status;
+	uint64_t i;
+
+	if (test_enum->is_signed) {
+		bt_integer_range_set_signed *range_set =
+			bt_integer_range_set_signed_create();
+
+		BT_ASSERT(range_set);
+
+		for (i = 0; i < mapping->range_count; i++) {
+			bt_integer_range_set_add_range_status status =
+				bt_integer_range_set_signed_add_range(
+					range_set,
+					(int64_t) mapping->ranges[i].lower,
+					(int64_t) mapping->ranges[i].upper);
+
+			BT_ASSERT(status ==
+				BT_INTEGER_RANGE_SET_ADD_RANGE_STATUS_OK);
+		}
+
+		add_status = bt_field_class_enumeration_signed_add_mapping(
+			test_enum->fc, mapping->label, range_set);
+		bt_integer_range_set_signed_put_ref(range_set);
+	} else {
+		bt_integer_range_set_unsigned *range_set =
+			bt_integer_range_set_unsigned_create();
+
+		BT_ASSERT(range_set);
+
+		for (i = 0; i < mapping->range_count; i++) {
+			bt_integer_range_set_add_range_status status =
+				bt_integer_range_set_unsigned_add_range(
+					range_set, mapping->ranges[i].lower,
+					mapping->ranges[i].upper);
+
+			BT_ASSERT(status ==
+				BT_INTEGER_RANGE_SET_ADD_RANGE_STATUS_OK);
+		}
+
+		add_status = bt_field_class_enumeration_unsigned_add_mapping(
+			test_enum->fc, mapping->label, range_set);
+		bt_integer_range_set_unsigned_put_ref(range_set);
+	}
+
+	BT_ASSERT(add_status == BT_FIELD_CLASS_ENUMERATION_ADD_MAPPING_STATUS_OK);
+}
+
+static
+void init_test_enum(struct test_enum *test_enum,
+		bt_trace_class *trace_class, bool is_signed,
+		uint64_t mapping_count)
+{
+	test_enum->is_signed = is_signed;
+	test_enum->mapping_count = 0;
+	test_enum->mappings = g_new0(struct test_mapping, mapping_count + 1);
+	BT_ASSERT(test_enum->mappings);
+	test_enum->fc = is_signed ?
+		bt_field_class_enumeration_signed_create(trace_class) :
+		bt_field_class_enumeration_unsigned_create(trace_class);
+	BT_ASSERT(test_enum->fc);
+}
+
+static
+void append_test_mapping(struct test_enum *test_enum,
+		const struct test_range *ranges, uint64_t range_count)
+{
+	struct test_mapping *mapping =
+		&test_enum->mappings[test_enum->mapping_count];
+
+	BT_ASSERT(range_count <= MAX_RANGE_COUNT);
+	mapping->label = g_strdup_printf("m%" PRIu64,
+		test_enum->mapping_count);
+	BT_ASSERT(mapping->label);
+	mapping->range_count = range_count;
+	memcpy(mapping->ranges, ranges, sizeof(*ranges) * range_count);
+	test_enum->mapping_count++;
+	add_mapping(test_enum, mapping);
+}
+
+static
+void fini_test_enum(struct test_enum *test_enum)
+{
+	uint64_t i;
+
+	for (i = 0; i < test_enum->mapping_count; i++) {
+		g_free(test_enum->mappings[i].label);
+	}
+
+	g_free(test_enum->mappings);
+	bt_field_class_put_ref(test_enum->fc);
+}
+
+/*
+ * Checks that the label lookup of `value` gives the labels of the
+ * mappings containing it, in mapping order.
+ */
+static
+bool check_lookup(const struct test_enum *test_enum, uint64_t value)
+{
+	bt_field_class_enumeration_mapping_label_array labels;
+	bt_field_class_enumeration_get_mapping_labels_for_value_status status;
+	uint64_t count;
+	uint64_t label_i = 0;
+	uint64_t i, j;
+
+	if (test_enum->is_signed) {
+		status = bt_field_class_enumeration_signed_get_mapping_labels_for_value(
+			test_enum->fc, (int64_t) value, &labels, &count);
+	} else {
+		status = bt_field_class_enumeration_unsigned_get_mapping_labels_for_value(
+			test_enum->fc, value, &labels, &count);
+	}
+
+	if (status != BT_FIELD_CLASS_ENUMERATION_GET_MAPPING_LABELS_BY_VALUE_STATUS_OK) {
+		diag("Lookup failed: value=%" PRIu64, value);
+		return false;
+	}
+
+	for (i = 0; i < test_enum->mapping_count; i++) {
+		const struct test_mapping *mapping = &test_enum->mappings[i];
+
+		for (j = 0; j < mapping->range_count; j++) {
+			if (value_le(test_enum->is_signed,
+						mapping->ranges[j].lower, value) &&
+					value_le(test_enum->is_signed, value,
+						mapping->ranges[j].upper)) {
+				break;
+			}
+		}
+
+		if (j == mapping->range_count) {
+			continue;
+		}
+
+		if (label_i >= count ||
+				strcmp(labels[label_i], mapping->label) != 0) {
+			diag("Missing label `%s`: value=%" PRIu64 ", signed=%d",
+				mapping->label, value, test_enum->is_signed);
+			return false;
+		}
+
+		label_i++;
+	}
+
+	if (label_i != count) {
+		diag("Unexpected labels: value=%" PRIu64 ", signed=%d, "
+			"expected-count=%" PRIu64 ", count=%" PRIu64,
+			value, test_enum->is_signed, label_i, count);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Checks the lookup of the values around the boundaries of all the
+ * ranges of `test_enum`, of the extreme values, and of random values.
+ */
+static
+bool check_lookups(const struct test_enum *test_enum)
+{
+	const uint64_t extremes[] = {
+		0, 1, UINT64_MAX, UINT64_MAX - 1,
+		(uint64_t) INT64_MIN, (uint64_t) INT64_MAX,
+	};
+	uint64_t i, j;
+	int delta;
+
+	for (i = 0; i < G_N_ELEMENTS(extremes); i++) {
+		if (!check_lookup(test_enum, extremes[i])) {
+			return false;
+		}
+	}
+
+	for (i = 0; i < test_enum->mapping_count; i++) {
+		const struct test_mapping *mapping = &test_enum->mappings[i];
+
+		for (j = 0; j < mapping->range_count; j++) {
+			for (delta = -1; delta <= 1; delta++) {
+				/* Wrapping around is fine here */
+				if (!check_lookup(test_enum,
+						mapping->ranges[j].lower + delta) ||
+						!check_lookup(test_enum,
+							mapping->ranges[j].upper + delta)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < RANDOM_PROBE_COUNT; i++) {
+		uint64_t value = random_u64();
+
+		/* Also probe small values, where most ranges are */
+		if (!check_lookup(test_enum, value) ||
+				!check_lookup(test_enum,
+					(value % 8192) - 2048)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static
+void test_random_enums(bt_trace_class *trace_class, bool is_signed,
+		enum range_kind kind, const char *kind_name)
+{
+	bool success = true;
+	uint64_t enum_i;
+
+	for (enum_i = 0; enum_i < ENUM_COUNT_PER_KIND && success; enum_i++) {
+		struct test_enum test_enum;
+		uint64_t mapping_count = 1 + random_below(MAX_MAPPING_COUNT);
+		uint64_t center = random_u64();
+		uint64_t mapping_i;
+
+		init_test_enum(&test_enum, trace_class, is_signed,
+			mapping_count);
+
+		for (mapping_i = 0; mapping_i < mapping_count; mapping_i++) {
+			struct test_range ranges[MAX_RANGE_COUNT];
+			uint64_t range_count = 1 + random_below(MAX_RANGE_COUNT);
+			uint64_t range_i;
+
+			for (range_i = 0; range_i < range_count; range_i++) {
+				ranges[range_i] = random_range(is_signed, kind,
+					center, mapping_i);
+			}
+
+			append_test_mapping(&test_enum, ranges, range_count);
+		}
+
+		success = check_lookups(&test_enum);
+		fini_test_enum(&test_enum);
+	}
+
+	ok(success, "Label lookup of random %s enumerations with %s ranges "
+		"matches a linear scan",
+		is_signed ? "signed" : "unsigned", kind_name);
+}
+
+/*
+ * Tests an enumeration of which each mapping contains the next one, so
+ * that the number of labels of all the segments exceeds the maximum
+ * label count of a label lookup index.
+ */
+static
+void test_deep_nesting(bt_trace_class *trace_class, bool is_signed)
+{
+	const uint64_t center = is_signed ? 0 : UINT64_C(1) << 63;
+	struct test_enum test_enum;
+	struct test_range range;
+	uint64_t i;
+	bool success;
+
+	init_test_enum(&test_enum, trace_class, is_signed,
+		DEEP_NESTING_MAPPING_COUNT);
+
+	for (i = 0; i < DEEP_NESTING_MAPPING_COUNT; i++) {
+		const uint64_t radius = DEEP_NESTING_MAPPING_COUNT - i;
+
+		range = make_range(is_signed, center - radius,
+			center + radius);
+		append_test_mapping(&test_enum, &range, 1);
+	}
+
+	success = check_lookups(&test_enum);
+	ok(success, "Label lookup of a deeply nested %s enumeration "
+		"matches a linear scan", is_signed ? "signed" : "unsigned");
+	fini_test_enum(&test_enum);
+}
+
+/*
+ * Tests that adding a mapping after a lookup gives its label to the
+ * next lookups.
+ */
+static
+void test_add_mapping_after_lookup(bt_trace_class *trace_class)
+{
+	struct test_enum test_enum;
+	struct test_range range;
+	bool success;
+
+	init_test_enum(&test_enum, trace_class, false, 2);
+	range = make_range(false, 10, 20);
+	append_test_mapping(&test_enum, &range, 1);
+	success = check_lookups(&test_enum);
+	range = make_range(false, 15, UINT64_MAX);
+	append_test_mapping(&test_enum, &range, 1);
+	success = success && check_lookups(&test_enum);
+	ok(success, "Label lookup after adding a mapping gives its label");
+	fini_test_enum(&test_enum);
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_trace_class *trace_class = bt_trace_class_create(
+		bt_self_component_source_as_self_component(self_comp_src));
+	unsigned int i;
+
+	BT_ASSERT(trace_class);
+
+	for (i = 0; i < 2; i++) {
+		const bool is_signed = i == 1;
+
+		test_random_enums(trace_class, is_signed, RANGE_KIND_SMALL,
+			"small");
+		test_random_enums(trace_class, is_signed, RANGE_KIND_WIDE,
+			"wide");
+		test_random_enums(trace_class, is_signed, RANGE_KIND_NESTED,
+			"nested");
+		test_random_enums(trace_class, is_signed, RANGE_KIND_EDGES,
+			"edge");
+		test_deep_nesting(trace_class, is_signed);
+	}
+
+	test_add_mapping_after_lookup(trace_class);
+	bt_trace_class_put_ref(trace_class);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+int main(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_set_method_status set_method_status;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph *graph;
+
+	plan_tests(NR_TESTS);
+	diag("Random seed: 0x%" PRIx64, RANDOM_SEED);
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	set_method_status = bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	add_comp_status = bt_graph_add_source_component(graph, src_comp_cls,
+		"src", NULL, BT_LOGGING_LEVEL_NONE, NULL);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return exit_status();
+}
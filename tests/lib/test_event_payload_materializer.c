@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test that the library calls the payload field materializer of an
+ * event when its payload field is first borrowed, and that it always
+ * finalizes it once, even when the event is recycled before its
+ * payload field is borrowed.
+ *
+ * Many threads also borrow the payload field of the same const event,
+ * which materializes it once.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 12
+
+#define CONCURRENT_READERS	8
+
+enum {
+	/* Payload field borrowed twice */
+	EVENT_BORROWED,
+
+	/* Payload field never borrowed */
+	EVENT_NOT_BORROWED,
+
+	/* Materializer replaced before emitting the message */
+	EVENT_REPLACED,
+
+	/* Payload field borrowed by many threads at the same time */
+	EVENT_CONCURRENT,
+
+	EVENT_COUNT,
+
+	/* Data of the materializer which `EVENT_REPLACED` replaces */
+	REPLACED_MATERIALIZER = EVENT_COUNT,
+};
+
+static unsigned int materialize_counts[EVENT_COUNT + 1];
+static unsigned int finalize_counts[EVENT_COUNT + 1];
+
+static bt_trace_class *trace_class;
+static bt_event_class *event_class;
+static bt_trace *trace;
+static bt_stream *stream;
+
+/* Number of messages which the source emitted so far */
+static uint64_t src_msg_count;
+
+/* Number of event messages which the sink consumed so far */
+static uint64_t sink_event_count;
+
+static
+uint64_t materialized_value(uintptr_t index)
+{
+	return 1000 + index;
+}
+
+static
+void materialize(bt_field *payload_field, void *data)
+{
+	uintptr_t index = (uintptr_t) data;
+	bt_field *value_field =
+		bt_field_structure_borrow_member_field_by_index(
+			payload_field, 0);
+
+	if (index == EVENT_CONCURRENT) {
+		/* Give the other readers time to wait for this one */
+		g_usleep(10000);
+	}
+
+	/* The payload field must be writable here */
+	bt_field_integer_unsigned_set_value(value_field,
+		materialized_value(index));
+	materialize_counts[index]++;
+}
+
+static
+void finalize(void *data)
+{
+	finalize_counts[(uintptr_t) data]++;
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	bt_stream_class *stream_class;
+	bt_field_class *payload_fc;
+	bt_field_class *value_fc;
+	bt_self_component_add_port_status add_port_status;
+	bt_field_class_structure_append_member_status append_status;
+	bt_event_class_set_field_class_status set_fc_status;
+
+	trace_class = bt_trace_class_create(self_comp);
+	BT_ASSERT(trace_class);
+	stream_class = bt_stream_class_create(trace_class);
+	BT_ASSERT(stream_class);
+	event_class = bt_event_class_create(stream_class);
+	BT_ASSERT(event_class);
+	payload_fc = bt_field_class_structure_create(trace_class);
+	BT_ASSERT(payload_fc);
+	value_fc = bt_field_class_integer_unsigned_create(trace_class);
+	BT_ASSERT(value_fc);
+	append_status = bt_field_class_structure_append_member(payload_fc,
+		"value", value_fc);
+	BT_ASSERT(append_status ==
+		BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK);
+	set_fc_status = bt_event_class_set_payload_field_class(event_class,
+		payload_fc);
+	BT_ASSERT(set_fc_status == BT_EVENT_CLASS_SET_FIELD_CLASS_STATUS_OK);
+	trace = bt_trace_create(trace_class);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(stream_class, trace);
+	BT_ASSERT(stream);
+	bt_field_class_put_ref(value_fc);
+	bt_field_class_put_ref(payload_fc);
+	bt_stream_class_put_ref(stream_class);
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	BT_ASSERT(add_port_status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp_src)
+{
+	BT_STREAM_PUT_REF_AND_RESET(stream);
+	BT_TRACE_PUT_REF_AND_RESET(trace);
+	BT_EVENT_CLASS_PUT_REF_AND_RESET(event_class);
+	BT_TRACE_CLASS_PUT_REF_AND_RESET(trace_class);
+}
+
+static
+bt_message *create_event_msg(bt_self_message_iterator *self_msg_iter,
+		uintptr_t index)
+{
+	bt_message *msg = bt_message_event_create(self_msg_iter, event_class,
+		stream);
+	bt_event *event;
+
+	BT_ASSERT(msg);
+	event = bt_message_event_borrow_event(msg);
+
+	if (index == EVENT_REPLACED) {
+		bt_event_set_payload_field_materializer(event, materialize,
+			finalize, (void *) (uintptr_t) REPLACED_MATERIALIZER);
+	}
+
+	bt_event_set_payload_field_materializer(event, materialize, finalize,
+		(void *) index);
+	return msg;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	bt_message *msg;
+
+	if (src_msg_count == 0) {
+		msg = bt_message_stream_beginning_create(self_msg_iter,
+			stream);
+	} else if (src_msg_count <= EVENT_COUNT) {
+		msg = create_event_msg(self_msg_iter, src_msg_count - 1);
+	} else if (src_msg_count == EVENT_COUNT + 1) {
+		msg = bt_message_stream_end_create(self_msg_iter, stream);
+	} else {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	BT_ASSERT(msg);
+	src_msg_count++;
+	msgs[0] = msg;
+	*count = 1;
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+uint64_t borrow_value(const bt_event *event)
+{
+	const bt_field *payload_field =
+		bt_event_borrow_payload_field_const(event);
+
+	return bt_field_integer_unsigned_get_value(
+		bt_field_structure_borrow_member_field_by_index_const(
+			payload_field, 0));
+}
+
+static
+gpointer concurrent_reader(gpointer data)
+{
+	const bt_event *event = data;
+
+	return GUINT_TO_POINTER(borrow_value(event) ==
+		materialized_value(EVENT_CONCURRENT));
+}
+
+static
+void test_concurrent_borrows(const bt_event *event)
+{
+	GThread *threads[CONCURRENT_READERS];
+	bool success = true;
+	unsigned int i;
+
+	for (i = 0; i < CONCURRENT_READERS; i++) {
+		threads[i] = g_thread_new("reader", concurrent_reader,
+			(gpointer) event);
+		BT_ASSERT(threads[i]);
+	}
+
+	for (i = 0; i < CONCURRENT_READERS; i++) {
+		if (!g_thread_join(threads[i])) {
+			success = false;
+		}
+	}
+
+	ok(success, "Concurrent readers all get the materialized payload field");
+	ok(materialize_counts[EVENT_CONCURRENT] == 1 &&
+		finalize_counts[EVENT_CONCURRENT] == 1,
+		"Concurrent readers materialize the payload field once");
+}
+
+static
+void consume_event_msg(const bt_message *msg)
+{
+	const bt_event *event = bt_message_event_borrow_event_const(msg);
+
+	switch (sink_event_count) {
+	case EVENT_BORROWED:
+		ok(materialize_counts[EVENT_BORROWED] == 0 &&
+			finalize_counts[EVENT_BORROWED] == 0,
+			"Materializer is not called before borrowing the payload field");
+		ok(borrow_value(event) == materialized_value(EVENT_BORROWED),
+			"Borrowing the payload field materializes it");
+		ok(materialize_counts[EVENT_BORROWED] == 1 &&
+			finalize_counts[EVENT_BORROWED] == 1,
+			"Materializer is called and finalized once");
+		ok(borrow_value(event) == materialized_value(EVENT_BORROWED) &&
+			materialize_counts[EVENT_BORROWED] == 1,
+			"Borrowing the payload field again doesn't materialize it again");
+		bt_message_put_ref(msg);
+		ok(finalize_counts[EVENT_BORROWED] == 1,
+			"Recycling a materialized event doesn't finalize its materializer again");
+		break;
+	case EVENT_NOT_BORROWED:
+		bt_message_put_ref(msg);
+		ok(materialize_counts[EVENT_NOT_BORROWED] == 0,
+			"Recycling an event doesn't materialize its payload field");
+		ok(finalize_counts[EVENT_NOT_BORROWED] == 1,
+			"Recycling an event finalizes its pending materializer");
+		break;
+	case EVENT_REPLACED:
+		ok(materialize_counts[REPLACED_MATERIALIZER] == 0 &&
+			finalize_counts[REPLACED_MATERIALIZER] == 1,
+			"Replacing a materializer finalizes the previous one");
+		ok(borrow_value(event) == materialized_value(EVENT_REPLACED) &&
+			materialize_counts[EVENT_REPLACED] == 1,
+			"Replacing materializer is called");
+		bt_message_put_ref(msg);
+		ok(materialize_counts[REPLACED_MATERIALIZER] == 0 &&
+			finalize_counts[REPLACED_MATERIALIZER] == 1,
+			"Replaced materializer is not called again");
+		break;
+	case EVENT_CONCURRENT:
+		test_concurrent_borrows(event);
+		bt_message_put_ref(msg);
+		break;
+	default:
+		bt_common_abort();
+	}
+
+	sink_event_count++;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_iterator_next_status next_status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	next_status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_AGAIN;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (bt_message_get_type(msgs[i]) == BT_MESSAGE_TYPE_EVENT) {
+			consume_event_msg(msgs[i]);
+		} else {
+			bt_message_put_ref(msgs[i]);
+		}
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+int main(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_set_method_status set_method_status;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+
+	plan_tests(NR_TESTS);
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	set_method_status = bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	set_method_status = bt_component_class_source_set_finalize_method(
+		src_comp_cls, src_finalize);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	add_comp_status = bt_graph_add_source_component(graph, src_comp_cls,
+		"src", NULL, BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(graph, "sink",
+		NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0),
+		NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+	run_status = bt_graph_run(graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	BT_ASSERT(sink_event_count == EVENT_COUNT);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return exit_status();
+}
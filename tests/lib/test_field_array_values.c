@@ -0,0 +1,510 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test the packed element values of numeric array fields, mixing them
+ * with the element fields.
+ *
+ * The source message iterator creates event messages and tests their
+ * payload fields without emitting them.
+ *
+ * In developer mode, getting the value of an element field which is
+ * not set aborts: the "is set" tests only pass by not aborting.
+ *
+ * Many threads also borrow the values and the element fields of the
+ * same const array fields, which converts their values once.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 14
+
+#define UINTS_LENGTH	4
+#define SINTS_CONCURRENT_LENGTH	1000
+#define CONCURRENT_READERS	8
+
+static bt_event_class *event_class;
+static bt_stream *stream;
+
+static
+bt_field_class *create_payload_fc(bt_trace_class *trace_class)
+{
+	bt_field_class *payload_fc;
+	bt_field_class *elem_fc;
+	bt_field_class *array_fc;
+	bt_field_class_structure_append_member_status append_status;
+
+	payload_fc = bt_field_class_structure_create(trace_class);
+	BT_ASSERT(payload_fc);
+
+	elem_fc = bt_field_class_integer_unsigned_create(trace_class);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_static_create(trace_class, elem_fc,
+		UINTS_LENGTH);
+	BT_ASSERT(array_fc);
+	append_status = bt_field_class_structure_append_member(payload_fc,
+		"uints", array_fc);
+	BT_ASSERT(append_status ==
+		BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK);
+	bt_field_class_put_ref(array_fc);
+	bt_field_class_put_ref(elem_fc);
+
+	elem_fc = bt_field_class_integer_signed_create(trace_class);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_dynamic_create(trace_class, elem_fc,
+		NULL);
+	BT_ASSERT(array_fc);
+	append_status = bt_field_class_structure_append_member(payload_fc,
+		"sints", array_fc);
+	BT_ASSERT(append_status ==
+		BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK);
+	bt_field_class_put_ref(array_fc);
+	bt_field_class_put_ref(elem_fc);
+
+	elem_fc = bt_field_class_bool_create(trace_class);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_static_create(trace_class, elem_fc, 3);
+	BT_ASSERT(array_fc);
+	append_status = bt_field_class_structure_append_member(payload_fc,
+		"bools", array_fc);
+	BT_ASSERT(append_status ==
+		BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK);
+	bt_field_class_put_ref(array_fc);
+	bt_field_class_put_ref(elem_fc);
+
+	elem_fc = bt_field_class_real_double_precision_create(trace_class);
+	BT_ASSERT(elem_fc);
+	array_fc = bt_field_class_array_static_create(trace_class, elem_fc, 2);
+	BT_ASSERT(array_fc);
+	append_status = bt_field_class_structure_append_member(payload_fc,
+		"reals", array_fc);
+	BT_ASSERT(append_status ==
+		BT_FIELD_CLASS_STRUCTURE_APPEND_MEMBER_STATUS_OK);
+	bt_field_class_put_ref(array_fc);
+	bt_field_class_put_ref(elem_fc);
+	return payload_fc;
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	bt_trace_class *trace_class;
+	bt_stream_class *stream_class;
+	bt_field_class *payload_fc;
+	bt_trace *trace;
+	bt_event_class_set_field_class_status set_fc_status;
+	bt_self_component_add_port_status add_port_status;
+
+	trace_class = bt_trace_class_create(self_comp);
+	BT_ASSERT(trace_class);
+	stream_class = bt_stream_class_create(trace_class);
+	BT_ASSERT(stream_class);
+	event_class = bt_event_class_create(stream_class);
+	BT_ASSERT(event_class);
+	payload_fc = create_payload_fc(trace_class);
+	set_fc_status = bt_event_class_set_payload_field_class(event_class,
+		payload_fc);
+	BT_ASSERT(set_fc_status == BT_EVENT_CLASS_SET_FIELD_CLASS_STATUS_OK);
+	bt_field_class_put_ref(payload_fc);
+	trace = bt_trace_create(trace_class);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(stream_class, trace);
+	BT_ASSERT(stream);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(stream_class);
+	bt_trace_class_put_ref(trace_class);
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	BT_ASSERT(add_port_status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp_src)
+{
+	BT_STREAM_PUT_REF_AND_RESET(stream);
+	BT_EVENT_CLASS_PUT_REF_AND_RESET(event_class);
+}
+
+static
+bt_field *borrow_payload_member(bt_message *msg, const char *name)
+{
+	bt_field *field = bt_field_structure_borrow_member_field_by_name(
+		bt_event_borrow_payload_field(
+			bt_message_event_borrow_event(msg)),
+		name);
+
+	BT_ASSERT(field);
+	return field;
+}
+
+static
+uint64_t get_uint_elem(bt_field *array, uint64_t index)
+{
+	return bt_field_integer_unsigned_get_value(
+		bt_field_array_borrow_element_field_by_index(array, index));
+}
+
+static
+int64_t get_sint_elem(bt_field *array, uint64_t index)
+{
+	return bt_field_integer_signed_get_value(
+		bt_field_array_borrow_element_field_by_index(array, index));
+}
+
+static
+void test_mixed_access(bt_message *msg)
+{
+	bt_field *uints = borrow_payload_member(msg, "uints");
+	bt_field *bools = borrow_payload_member(msg, "bools");
+	bt_field *reals = borrow_payload_member(msg, "reals");
+	bt_field *elem_field;
+	uint64_t *uint_values;
+	const uint64_t *const_uint_values;
+	const bt_bool *bool_values;
+	double *real_values;
+	uint64_t i;
+
+	uint_values = bt_field_array_borrow_unsigned_integer_values(uints);
+
+	for (i = 0; i < UINTS_LENGTH; i++) {
+		uint_values[i] = i + 1;
+	}
+
+	ok(get_uint_elem(uints, 2) == 3,
+		"Element field has the value written to the packed values");
+
+	bt_field_integer_unsigned_set_value(
+		bt_field_array_borrow_element_field_by_index(uints, 1), 20);
+	const_uint_values =
+		bt_field_array_borrow_unsigned_integer_values_const(uints);
+	ok(const_uint_values[0] == 1 && const_uint_values[1] == 20,
+		"Packed values include a value set through an element field");
+
+	/* Borrowing the values for writing makes them current */
+	elem_field = bt_field_array_borrow_element_field_by_index(uints, 3);
+	bt_field_integer_unsigned_set_value(elem_field, 40);
+	uint_values = bt_field_array_borrow_unsigned_integer_values(uints);
+	uint_values[0] = 10;
+	ok(get_uint_elem(uints, 0) == 10 && get_uint_elem(uints, 1) == 20 &&
+		get_uint_elem(uints, 3) == 40,
+		"Element fields have the values of the packed values after writing them");
+
+	for (i = 0; i < 3; i++) {
+		bt_field_bool_set_value(
+			bt_field_array_borrow_element_field_by_index(bools, i),
+			i != 1);
+	}
+
+	bool_values = bt_field_array_borrow_bool_values_const(bools);
+	ok(bool_values[0] && !bool_values[1] && bool_values[2],
+		"Packed boolean values are the values of the element fields");
+
+	real_values = bt_field_array_borrow_real_values(reals);
+	real_values[0] = 1.5;
+	real_values[1] = -2.25;
+	ok(bt_field_real_double_precision_get_value(
+			bt_field_array_borrow_element_field_by_index(reals, 0)) == 1.5 &&
+		bt_field_real_double_precision_get_value(
+			bt_field_array_borrow_element_field_by_index(reals, 1)) == -2.25,
+		"Real element fields have the packed real values");
+}
+
+static
+void test_dynamic_growth(bt_message *msg)
+{
+	bt_field *sints = borrow_payload_member(msg, "sints");
+	int64_t *values;
+	const int64_t *const_values;
+	bt_field_array_dynamic_set_length_status set_length_status;
+	uint64_t i;
+
+	set_length_status = bt_field_array_dynamic_set_length(sints, 2);
+	BT_ASSERT(set_length_status ==
+		BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK);
+	values = bt_field_array_borrow_signed_integer_values(sints);
+	values[0] = -1;
+	values[1] = -2;
+	set_length_status = bt_field_array_dynamic_set_length(sints, 100);
+	BT_ASSERT(set_length_status ==
+		BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK);
+	values = bt_field_array_borrow_signed_integer_values(sints);
+	ok(values[0] == -1 && values[1] == -2,
+		"Growing a dynamic array field keeps the packed values");
+
+	for (i = 0; i < 100; i++) {
+		values[i] = -((int64_t) i + 1);
+	}
+
+	ok(get_sint_elem(sints, 99) == -100 && get_sint_elem(sints, 50) == -51,
+		"Element fields of a grown dynamic array field have the packed values");
+
+	/* The element fields hold the current values from now on */
+	set_length_status = bt_field_array_dynamic_set_length(sints, 200);
+	BT_ASSERT(set_length_status ==
+		BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK);
+	bt_field_integer_signed_set_value(
+		bt_field_array_borrow_element_field_by_index(sints, 150), -151);
+	const_values = bt_field_array_borrow_signed_integer_values_const(sints);
+	ok(const_values[150] == -151 && const_values[50] == -51,
+		"Growing a dynamic array field keeps the element field values");
+
+	set_length_status = bt_field_array_dynamic_set_length(sints, 1);
+	BT_ASSERT(set_length_status ==
+		BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK);
+	const_values = bt_field_array_borrow_signed_integer_values_const(sints);
+	ok(bt_field_array_get_length(sints) == 1 && const_values[0] == -1,
+		"Shrinking a dynamic array field keeps the remaining values");
+}
+
+static
+void test_is_set(bt_message *msg)
+{
+	bt_field *uints = borrow_payload_member(msg, "uints");
+	bt_field *bools = borrow_payload_member(msg, "bools");
+	uint64_t *uint_values;
+	bt_bool *bool_values;
+	uint64_t i;
+
+	/*
+	 * The event of `msg` is recycled: the element fields of `uints`
+	 * held the current values before.
+	 */
+	uint_values = bt_field_array_borrow_unsigned_integer_values(uints);
+
+	for (i = 0; i < UINTS_LENGTH; i++) {
+		uint_values[i] = i + 5;
+	}
+
+	ok(get_uint_elem(uints, 0) == 5 && get_uint_elem(uints, 3) == 8,
+		"Recycled array field: element fields are set from the packed values");
+
+	bool_values = bt_field_array_borrow_bool_values(bools);
+
+	for (i = 0; i < 3; i++) {
+		bool_values[i] = BT_TRUE;
+	}
+
+	ok(bt_field_bool_get_value(
+			bt_field_array_borrow_element_field_by_index(bools, 1)),
+		"Array field written through its packed values: element fields are set");
+
+	/* Writing an element field keeps the others set */
+	bt_field_bool_set_value(
+		bt_field_array_borrow_element_field_by_index(bools, 0),
+		BT_FALSE);
+	bool_values = bt_field_array_borrow_bool_values(bools);
+	ok(!bool_values[0] && bool_values[2] &&
+		bt_field_bool_get_value(
+			bt_field_array_borrow_element_field_by_index(bools, 2)),
+		"Array field written through an element field: other element fields stay set");
+}
+
+struct concurrent_reader_data {
+	const bt_field *uints;
+	const bt_field *sints;
+	bool uints_ok;
+	bool sints_ok;
+};
+
+static
+gpointer concurrent_reader(gpointer data)
+{
+	struct concurrent_reader_data *reader_data = data;
+	const int64_t *sint_values;
+	uint64_t i;
+
+	/* Packed values are current: creates the element fields */
+	reader_data->uints_ok = true;
+
+	for (i = 0; i < UINTS_LENGTH; i++) {
+		const bt_field *elem_field =
+			bt_field_array_borrow_element_field_by_index_const(
+				reader_data->uints, i);
+
+		if (bt_field_integer_unsigned_get_value(elem_field) != i * 3) {
+			reader_data->uints_ok = false;
+		}
+	}
+
+	/* Element fields are current: packs their values */
+	sint_values = bt_field_array_borrow_signed_integer_values_const(
+		reader_data->sints);
+	reader_data->sints_ok = true;
+
+	for (i = 0; i < SINTS_CONCURRENT_LENGTH; i++) {
+		if (sint_values[i] != -((int64_t) i)) {
+			reader_data->sints_ok = false;
+		}
+	}
+
+	return NULL;
+}
+
+static
+void test_concurrent_const_borrows(bt_message *msg)
+{
+	bt_field *uints = borrow_payload_member(msg, "uints");
+	bt_field *sints = borrow_payload_member(msg, "sints");
+	struct concurrent_reader_data reader_data[CONCURRENT_READERS];
+	GThread *threads[CONCURRENT_READERS];
+	bt_field_array_dynamic_set_length_status set_length_status;
+	uint64_t *uint_values;
+	bool uints_ok = true;
+	bool sints_ok = true;
+	uint64_t i;
+
+	uint_values = bt_field_array_borrow_unsigned_integer_values(uints);
+
+	for (i = 0; i < UINTS_LENGTH; i++) {
+		uint_values[i] = i * 3;
+	}
+
+	set_length_status = bt_field_array_dynamic_set_length(sints,
+		SINTS_CONCURRENT_LENGTH);
+	BT_ASSERT(set_length_status ==
+		BT_FIELD_DYNAMIC_ARRAY_SET_LENGTH_STATUS_OK);
+
+	for (i = 0; i < SINTS_CONCURRENT_LENGTH; i++) {
+		bt_field_integer_signed_set_value(
+			bt_field_array_borrow_element_field_by_index(sints, i),
+			-((int64_t) i));
+	}
+
+	for (i = 0; i < CONCURRENT_READERS; i++) {
+		reader_data[i].uints = uints;
+		reader_data[i].sints = sints;
+		threads[i] = g_thread_new("reader", concurrent_reader,
+			&reader_data[i]);
+	}
+
+	for (i = 0; i < CONCURRENT_READERS; i++) {
+		g_thread_join(threads[i]);
+		uints_ok = uints_ok && reader_data[i].uints_ok;
+		sints_ok = sints_ok && reader_data[i].sints_ok;
+	}
+
+	ok(uints_ok,
+		"Concurrent readers get the packed values from the element fields");
+	ok(sints_ok,
+		"Concurrent readers get the element field values from the packed values");
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	bt_message *msg;
+
+	msg = bt_message_event_create(self_msg_iter, event_class, stream);
+	BT_ASSERT(msg);
+	test_mixed_access(msg);
+	test_dynamic_growth(msg);
+
+	/* Recycles the event */
+	bt_message_put_ref(msg);
+
+	msg = bt_message_event_create(self_msg_iter, event_class, stream);
+	BT_ASSERT(msg);
+	test_is_set(msg);
+	bt_message_put_ref(msg);
+
+	msg = bt_message_event_create(self_msg_iter, event_class, stream);
+	BT_ASSERT(msg);
+	test_concurrent_const_borrows(msg);
+	bt_message_put_ref(msg);
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_iterator_next_status next_status;
+	bt_message_array_const msgs;
+	uint64_t count;
+
+	next_status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+}
+
+int main(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_set_method_status set_method_status;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+
+	plan_tests(NR_TESTS);
+
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	set_method_status = bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	set_method_status = bt_component_class_source_set_finalize_method(
+		src_comp_cls, src_finalize);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	add_comp_status = bt_graph_add_source_component(graph, src_comp_cls,
+		"src", NULL, BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(graph, "sink",
+		NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0),
+		NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+	run_status = bt_graph_run(graph);
+	BT_ASSERT(run_status == BT_GRAPH_RUN_STATUS_OK);
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+	return exit_status();
+}
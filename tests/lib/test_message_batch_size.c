@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test the capacity which bt_message_iterator_next() passes to the
+ * "next" method of a source message iterator, depending on the message
+ * batch sizes of the graph, following a script of "next" method
+ * results.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 18
+
+enum step_action {
+	/* Fill the whole batch */
+	STEP_ACTION_FULL,
+
+	/* Return a single message */
+	STEP_ACTION_PARTIAL,
+
+	/* Return "try again later" */
+	STEP_ACTION_AGAIN,
+};
+
+struct step {
+	/* Capacity which the "next" method expects */
+	uint64_t capacity;
+
+	enum step_action action;
+};
+
+/* Initial size 2, maximum size 16 */
+static const struct step adaptive_steps[] = {
+	{ 2, STEP_ACTION_FULL },
+	{ 4, STEP_ACTION_FULL },
+	{ 8, STEP_ACTION_FULL },
+	{ 16, STEP_ACTION_FULL },
+	{ 16, STEP_ACTION_FULL },
+	{ 16, STEP_ACTION_PARTIAL },
+	{ 16, STEP_ACTION_AGAIN },
+	{ 2, STEP_ACTION_PARTIAL },
+	{ 2, STEP_ACTION_FULL },
+	{ 4, STEP_ACTION_AGAIN },
+	{ 2, STEP_ACTION_FULL },
+	{ 4, STEP_ACTION_PARTIAL },
+};
+
+/* Initial and maximum size 3 */
+static const struct step fixed_steps[] = {
+	{ 3, STEP_ACTION_FULL },
+	{ 3, STEP_ACTION_FULL },
+	{ 3, STEP_ACTION_AGAIN },
+	{ 3, STEP_ACTION_PARTIAL },
+};
+
+static const struct step *steps;
+static size_t step_count;
+
+/* Capacities which the "next" method got, one per step */
+static uint64_t capacities[G_N_ELEMENTS(adaptive_steps)];
+
+/* Index of the current step */
+static size_t cur_step;
+
+static bt_event_class *event_class;
+static bt_stream *stream;
+
+/* Whether or not the source emitted the stream beginning message */
+static bool emitted_stream_beginning;
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	bt_trace_class *trace_class;
+	bt_stream_class *stream_class;
+	bt_trace *trace;
+	bt_self_component_add_port_status add_port_status;
+
+	trace_class = bt_trace_class_create(self_comp);
+	BT_ASSERT(trace_class);
+	stream_class = bt_stream_class_create(trace_class);
+	BT_ASSERT(stream_class);
+	event_class = bt_event_class_create(stream_class);
+	BT_ASSERT(event_class);
+	trace = bt_trace_create(trace_class);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(stream_class, trace);
+	BT_ASSERT(stream);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(stream_class);
+	bt_trace_class_put_ref(trace_class);
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	BT_ASSERT(add_port_status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp_src)
+{
+	BT_STREAM_PUT_REF_AND_RESET(stream);
+	BT_EVENT_CLASS_PUT_REF_AND_RESET(event_class);
+}
+
+static
+bt_message *create_msg(bt_self_message_iterator *self_msg_iter,
+		bool is_last)
+{
+	bt_message *msg;
+
+	if (!emitted_stream_beginning) {
+		msg = bt_message_stream_beginning_create(self_msg_iter,
+			stream);
+		emitted_stream_beginning = true;
+	} else if (is_last) {
+		msg = bt_message_stream_end_create(self_msg_iter, stream);
+	} else {
+		msg = bt_message_event_create(self_msg_iter, event_class,
+			stream);
+	}
+
+	BT_ASSERT(msg);
+	return msg;
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	const struct step *step;
+	uint64_t i;
+
+	if (cur_step == step_count) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	step = &steps[cur_step];
+	capacities[cur_step] = capacity;
+	cur_step++;
+
+	switch (step->action) {
+	case STEP_ACTION_FULL:
+		*count = capacity;
+		break;
+	case STEP_ACTION_PARTIAL:
+		*count = 1;
+		break;
+	case STEP_ACTION_AGAIN:
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_AGAIN;
+	default:
+		bt_common_abort();
+	}
+
+	/* The last message of the last step ends the stream */
+	for (i = 0; i < *count; i++) {
+		msgs[i] = create_msg(self_msg_iter,
+			cur_step == step_count && i == *count - 1);
+	}
+
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_iterator_next_status next_status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	next_status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_AGAIN;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		bt_message_put_ref(msgs[i]);
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+/*
+ * Runs a graph with the message batch sizes `size` and `max_size`
+ * until the source follows all the steps of `test_steps`, then checks
+ * the capacity of each step.
+ */
+static
+void test_batch_size(const char *mode, uint64_t size, uint64_t max_size,
+		const struct step *test_steps, size_t test_step_count)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_set_method_status set_method_status;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+	size_t i;
+
+	BT_ASSERT(test_step_count <= G_N_ELEMENTS(capacities));
+	steps = test_steps;
+	step_count = test_step_count;
+	cur_step = 0;
+	emitted_stream_beginning = false;
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	set_method_status = bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	set_method_status = bt_component_class_source_set_finalize_method(
+		src_comp_cls, src_finalize);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	bt_graph_set_message_batch_size(graph, size, max_size);
+	add_comp_status = bt_graph_add_source_component(graph, src_comp_cls,
+		"src", NULL, BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(graph, "sink",
+		NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0),
+		NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+
+	/* A single sink: bt_graph_run() returns on "try again later" */
+	do {
+		run_status = bt_graph_run(graph);
+	} while (run_status == BT_GRAPH_RUN_STATUS_AGAIN);
+
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK && cur_step == step_count,
+		"%s: graph runs through all the steps", mode);
+
+	for (i = 0; i < step_count; i++) {
+		ok(capacities[i] == steps[i].capacity,
+			"%s: step %zu: capacity is %" PRIu64 " (got %" PRIu64 ")",
+			mode, i, steps[i].capacity, capacities[i]);
+	}
+
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+
+	/*
+	 * Adaptive: grows on full batches, is capped at the maximum
+	 * size, stays the same on partial batches, and goes back to the
+	 * initial size on "try again later".
+	 */
+	test_batch_size("Adaptive", 2, 16, adaptive_steps,
+		G_N_ELEMENTS(adaptive_steps));
+
+	/* Fixed: never changes */
+	test_batch_size("Fixed", 3, 3, fixed_steps,
+		G_N_ELEMENTS(fixed_steps));
+	return exit_status();
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test the object pool statistics which
+ * bt_util_get_object_pool_statistics() returns, for live and finalized
+ * object pools, that an object pool destroys the recycled objects of a
+ * burst once it's over, and that bt_graph_set_message_pool_max_size()
+ * destroys the excess recycled messages.
+ *
+ * The sink keeps the first `BURST_EVENT_COUNT` event messages before
+ * releasing them all at once, then releases each message as soon as it
+ * gets it.
+ */
+
+#include <babeltrace2/babeltrace.h>
+#include "common/assert.h"
+#include "common/common.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 13
+
+/*
+ * Enough events so that the event message pool reaches the end of at
+ * least two trimming windows after the burst.
+ */
+#define EVENT_COUNT		10000
+#define BURST_EVENT_COUNT	1000
+
+static bt_event_class *event_class;
+static bt_stream *stream;
+
+/* Number of messages which the source emitted so far */
+static uint64_t src_msg_count;
+
+/* Event messages which the sink keeps during the burst */
+static GPtrArray *burst_msgs;
+
+/* Number of event messages which the sink consumed so far */
+static uint64_t sink_event_count;
+
+struct pool_stats {
+	uint64_t alloc_count;
+	uint64_t recycle_count;
+	uint64_t miss_count;
+	uint64_t discard_count;
+};
+
+static
+void get_pool_stats(bt_util_object_pool_type type, struct pool_stats *stats)
+{
+	bt_util_get_object_pool_statistics(type, &stats->alloc_count,
+		&stats->recycle_count, &stats->miss_count,
+		&stats->discard_count);
+}
+
+static
+bool pool_stats_are_zero(bt_util_object_pool_type type)
+{
+	struct pool_stats stats;
+
+	get_pool_stats(type, &stats);
+	return stats.alloc_count == 0 && stats.recycle_count == 0 &&
+		stats.miss_count == 0 && stats.discard_count == 0;
+}
+
+static
+bt_component_class_initialize_method_status src_init(
+		bt_self_component_source *self_comp_src,
+		bt_self_component_source_configuration *config,
+		const bt_value *params, void *init_method_data)
+{
+	bt_self_component *self_comp =
+		bt_self_component_source_as_self_component(self_comp_src);
+	bt_trace_class *trace_class;
+	bt_stream_class *stream_class;
+	bt_trace *trace;
+	bt_self_component_add_port_status add_port_status;
+
+	trace_class = bt_trace_class_create(self_comp);
+	BT_ASSERT(trace_class);
+	stream_class = bt_stream_class_create(trace_class);
+	BT_ASSERT(stream_class);
+	event_class = bt_event_class_create(stream_class);
+	BT_ASSERT(event_class);
+	trace = bt_trace_create(trace_class);
+	BT_ASSERT(trace);
+	stream = bt_stream_create(stream_class, trace);
+	BT_ASSERT(stream);
+	bt_trace_put_ref(trace);
+	bt_stream_class_put_ref(stream_class);
+	bt_trace_class_put_ref(trace_class);
+
+	add_port_status = bt_self_component_source_add_output_port(
+		self_comp_src, "out", NULL, NULL);
+	BT_ASSERT(add_port_status == BT_SELF_COMPONENT_ADD_PORT_STATUS_OK);
+	return BT_COMPONENT_CLASS_INITIALIZE_METHOD_STATUS_OK;
+}
+
+static
+void src_finalize(bt_self_component_source *self_comp_src)
+{
+	BT_STREAM_PUT_REF_AND_RESET(stream);
+	BT_EVENT_CLASS_PUT_REF_AND_RESET(event_class);
+}
+
+static
+bt_message_iterator_class_next_method_status src_iter_next(
+		bt_self_message_iterator *self_msg_iter,
+		bt_message_array_const msgs, uint64_t capacity,
+		uint64_t *count)
+{
+	uint64_t i;
+
+	for (i = 0; i < capacity; i++) {
+		bt_message *msg;
+
+		if (src_msg_count == 0) {
+			msg = bt_message_stream_beginning_create(
+				self_msg_iter, stream);
+		} else if (src_msg_count <= EVENT_COUNT) {
+			msg = bt_message_event_create(self_msg_iter,
+				event_class, stream);
+		} else if (src_msg_count == EVENT_COUNT + 1) {
+			msg = bt_message_stream_end_create(self_msg_iter,
+				stream);
+		} else {
+			break;
+		}
+
+		BT_ASSERT(msg);
+		msgs[i] = msg;
+		src_msg_count++;
+	}
+
+	if (i == 0) {
+		return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_END;
+	}
+
+	*count = i;
+	return BT_MESSAGE_ITERATOR_CLASS_NEXT_METHOD_STATUS_OK;
+}
+
+static
+void consume_event_msg(const bt_message *msg)
+{
+	sink_event_count++;
+
+	if (sink_event_count > BURST_EVENT_COUNT) {
+		bt_message_put_ref(msg);
+		return;
+	}
+
+	g_ptr_array_add(burst_msgs, (void *) msg);
+
+	if (sink_event_count == BURST_EVENT_COUNT) {
+		/* End of burst: recycle all the kept messages */
+		g_ptr_array_remove_range(burst_msgs, 0, burst_msgs->len);
+	}
+}
+
+static
+bt_graph_simple_sink_component_consume_func_status sink_consume(
+		bt_message_iterator *msg_iter, void *data)
+{
+	bt_message_iterator_next_status next_status;
+	bt_message_array_const msgs;
+	uint64_t count;
+	uint64_t i;
+
+	next_status = bt_message_iterator_next(msg_iter, &msgs, &count);
+	switch (next_status) {
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_OK:
+		break;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_END:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_END;
+	case BT_MESSAGE_ITERATOR_NEXT_STATUS_AGAIN:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_AGAIN;
+	default:
+		return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (bt_message_get_type(msgs[i]) == BT_MESSAGE_TYPE_EVENT) {
+			consume_event_msg(msgs[i]);
+		} else {
+			bt_message_put_ref(msgs[i]);
+		}
+	}
+
+	return BT_GRAPH_SIMPLE_SINK_COMPONENT_CONSUME_FUNC_STATUS_OK;
+}
+
+int main(void)
+{
+	bt_message_iterator_class *msg_iter_cls;
+	bt_component_class_source *src_comp_cls;
+	bt_component_class_set_method_status set_method_status;
+	const bt_component_source *src_comp;
+	const bt_component_sink *sink_comp;
+	bt_graph_add_component_status add_comp_status;
+	bt_graph_connect_ports_status connect_status;
+	bt_graph_run_status run_status;
+	bt_graph *graph;
+	struct pool_stats msg_stats;
+	struct pool_stats event_stats;
+	struct pool_stats live_msg_stats;
+
+	plan_tests(NR_TESTS);
+
+	burst_msgs = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_message_put_ref);
+	BT_ASSERT(burst_msgs);
+	msg_iter_cls = bt_message_iterator_class_create(src_iter_next);
+	BT_ASSERT(msg_iter_cls);
+	src_comp_cls = bt_component_class_source_create("src", msg_iter_cls);
+	BT_ASSERT(src_comp_cls);
+	set_method_status = bt_component_class_source_set_initialize_method(
+		src_comp_cls, src_init);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	set_method_status = bt_component_class_source_set_finalize_method(
+		src_comp_cls, src_finalize);
+	BT_ASSERT(set_method_status == BT_COMPONENT_CLASS_SET_METHOD_STATUS_OK);
+	graph = bt_graph_create(0);
+	BT_ASSERT(graph);
+	add_comp_status = bt_graph_add_source_component(graph, src_comp_cls,
+		"src", NULL, BT_LOGGING_LEVEL_NONE, &src_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	add_comp_status = bt_graph_add_simple_sink_component(graph, "sink",
+		NULL, sink_consume, NULL, NULL, &sink_comp);
+	BT_ASSERT(add_comp_status == BT_GRAPH_ADD_COMPONENT_STATUS_OK);
+	connect_status = bt_graph_connect_ports(graph,
+		bt_component_source_borrow_output_port_by_index_const(
+			src_comp, 0),
+		bt_component_sink_borrow_input_port_by_index_const(
+			sink_comp, 0),
+		NULL);
+	BT_ASSERT(connect_status == BT_GRAPH_CONNECT_PORTS_STATUS_OK);
+	run_status = bt_graph_run(graph);
+	ok(run_status == BT_GRAPH_RUN_STATUS_OK &&
+		sink_event_count == EVENT_COUNT,
+		"Graph consumes all the event messages");
+	get_pool_stats(BT_UTIL_OBJECT_POOL_TYPE_MESSAGE, &live_msg_stats);
+	ok(live_msg_stats.alloc_count == EVENT_COUNT,
+		"Statistics include the pools which are not finalized yet (%" PRIu64 ")",
+		live_msg_stats.alloc_count);
+
+	/* The graph is idle: its message pools keep their messages */
+	bt_graph_set_message_pool_max_size(graph, 0);
+	get_pool_stats(BT_UTIL_OBJECT_POOL_TYPE_MESSAGE, &msg_stats);
+	ok(msg_stats.discard_count > live_msg_stats.discard_count &&
+		msg_stats.discard_count - live_msg_stats.discard_count <=
+			msg_stats.recycle_count,
+		"Setting the maximum size of the message pools discards their messages (%" PRIu64 ")",
+		msg_stats.discard_count - live_msg_stats.discard_count);
+	ok(pool_stats_are_zero(BT_UTIL_OBJECT_POOL_TYPE_PACKET),
+		"Packet pools: no packets while the graph exists");
+
+	/* Finalizes all the object pools */
+	bt_graph_put_ref(graph);
+	bt_component_class_source_put_ref(src_comp_cls);
+	bt_message_iterator_class_put_ref(msg_iter_cls);
+
+	get_pool_stats(BT_UTIL_OBJECT_POOL_TYPE_MESSAGE, &msg_stats);
+	get_pool_stats(BT_UTIL_OBJECT_POOL_TYPE_EVENT, &event_stats);
+	ok(msg_stats.alloc_count == EVENT_COUNT,
+		"Message pools: allocation count is the number of event messages (%" PRIu64 ")",
+		msg_stats.alloc_count);
+	ok(msg_stats.miss_count >= BURST_EVENT_COUNT &&
+		msg_stats.miss_count < EVENT_COUNT,
+		"Message pools: burst misses the pool, but not the other messages (%" PRIu64 ")",
+		msg_stats.miss_count);
+	ok(msg_stats.recycle_count > 0 &&
+		msg_stats.recycle_count <= EVENT_COUNT,
+		"Message pools: messages are recycled (%" PRIu64 ")",
+		msg_stats.recycle_count);
+	ok(msg_stats.discard_count > 0,
+		"Message pools: recycled messages of the burst are discarded (%" PRIu64 ")",
+		msg_stats.discard_count);
+	ok(event_stats.alloc_count == EVENT_COUNT,
+		"Event pools: allocation count is the number of events (%" PRIu64 ")",
+		event_stats.alloc_count);
+	ok(event_stats.miss_count >= BURST_EVENT_COUNT &&
+		event_stats.miss_count < EVENT_COUNT,
+		"Event pools: burst misses the pool, but not the other events (%" PRIu64 ")",
+		event_stats.miss_count);
+	ok(event_stats.discard_count > 0,
+		"Event pools: recycled events of the burst are discarded (%" PRIu64 ")",
+		event_stats.discard_count);
+	ok(pool_stats_are_zero(BT_UTIL_OBJECT_POOL_TYPE_PACKET) &&
+		pool_stats_are_zero(BT_UTIL_OBJECT_POOL_TYPE_PACKET_CONTEXT_FIELD),
+		"Packet pools: no packets");
+	ok(pool_stats_are_zero(BT_UTIL_OBJECT_POOL_TYPE_CLOCK_SNAPSHOT),
+		"Clock snapshot pools: no clock snapshots");
+	g_ptr_array_free(burst_msgs, TRUE);
+	return exit_status();
+}
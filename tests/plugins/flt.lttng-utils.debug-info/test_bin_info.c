@@ -37,7 +37,7 @@
 
 #include "tap/tap.h"
 
-#define NR_TESTS 57
+#define NR_TESTS 58
 
 #define SO_NAME "libhello_so"
 #define DEBUG_NAME "libhello_so.debug"
@@ -255,6 +255,9 @@ void test_bin_info_build_id(const char *bin_info_dir)
 				       opt_func_foo_printf_line_no,
 				       FUNC_FOO_FILENAME);
 
+	/* The ELF and DWARF files are mapped: no file remains open */
+	ok(fdc.open_fds == 0, "bin_info keeps no file open");
+
 	bin_info_destroy(bin);
 	bt_fd_cache_fini(&fdc);
 	g_free(data_dir);
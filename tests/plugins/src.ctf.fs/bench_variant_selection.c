@@ -0,0 +1,208 @@
+/*
+ * bench_variant_selection.c
+ *
+ * BabelTrace - CTF variant option selection micro-benchmark
+ *
+ * Copyright 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Compares, for CTF variant field classes having 8, 64, and 1024
+ * options, a linear scan of the variant's tag ranges with
+ * ctf_field_class_variant_find_option_index(), which is what the CTF
+ * message iterator uses to select an option.
+ *
+ * The "dense" variants map the tag values 0 to N - 1 (direct table
+ * lookup) while the "sparse" variants map every 1000th tag value,
+ * some of them signed (sorted segment lookup).
+ *
+ * `test_variant_selection` checks that both select the same options.
+ *
+ * Usage: bench_variant_selection [ITERATIONS]
+ */
+
+#include "plugins/ctf/common/metadata/ctf-meta.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Number of tag values to select an option for per iteration */
+#define TAG_COUNT 4096
+
+static uint64_t tags[TAG_COUNT];
+
+/* Prevents the compiler from optimizing the lookups away */
+static volatile int64_t sink;
+
+static
+struct ctf_field_class_variant *create_variant_fc(
+		struct ctf_field_class_enum *tag_fc, unsigned int option_count,
+		int64_t stride)
+{
+	struct ctf_field_class_variant *var_fc =
+		ctf_field_class_variant_create();
+	GString *label = g_string_new(NULL);
+	unsigned int i;
+
+	BT_ASSERT(var_fc);
+	BT_ASSERT(label);
+
+	for (i = 0; i < option_count; i++) {
+		/* Center sparse tag values around 0 */
+		int64_t val = stride == 1 ? (int64_t) i :
+			((int64_t) i - (int64_t) option_count / 2) * stride;
+
+		g_string_printf(label, "opt%u", i);
+		ctf_field_class_enum_map_range(tag_fc, label->str,
+			(uint64_t) val, (uint64_t) val);
+		ctf_field_class_variant_append_option(var_fc, label->str,
+			NULL);
+	}
+
+	ctf_field_class_variant_set_tag_field_class(var_fc, tag_fc);
+	g_string_free(label, TRUE);
+	return var_fc;
+}
+
+/* Option selection before the option index */
+static
+int64_t find_option_index_linear(struct ctf_field_class_variant *var_fc,
+		uint64_t tag_u)
+{
+	uint64_t i;
+	int64_t tag_i = (int64_t) tag_u;
+
+	for (i = 0; i < var_fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(var_fc, i);
+
+		if (var_fc->tag_fc->base.is_signed) {
+			if (tag_i >= range->range.lower.i &&
+					tag_i <= range->range.upper.i) {
+				return (int64_t) range->option_index;
+			}
+		} else if (tag_u >= range->range.lower.u &&
+				tag_u <= range->range.upper.u) {
+			return (int64_t) range->option_index;
+		}
+	}
+
+	return -1;
+}
+
+static
+double bench_linear(struct ctf_field_class_variant *var_fc,
+		unsigned long iterations)
+{
+	unsigned long i;
+	size_t t;
+	int64_t acc = 0;
+	gint64 begin = g_get_monotonic_time();
+
+	for (i = 0; i < iterations; i++) {
+		for (t = 0; t < TAG_COUNT; t++) {
+			acc += find_option_index_linear(var_fc, tags[t]);
+		}
+	}
+
+	sink = acc;
+	return (double) (g_get_monotonic_time() - begin) * 1000. /
+		((double) iterations * TAG_COUNT);
+}
+
+static
+double bench_index(struct ctf_field_class_variant *var_fc,
+		unsigned long iterations)
+{
+	unsigned long i;
+	size_t t;
+	int64_t acc = 0;
+	gint64 begin = g_get_monotonic_time();
+
+	for (i = 0; i < iterations; i++) {
+		for (t = 0; t < TAG_COUNT; t++) {
+			acc += ctf_field_class_variant_find_option_index(
+				var_fc, tags[t]);
+		}
+	}
+
+	sink = acc;
+	return (double) (g_get_monotonic_time() - begin) * 1000. /
+		((double) iterations * TAG_COUNT);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long iterations = 200;
+	unsigned int option_counts[] = { 8, 64, 1024 };
+	int sparse;
+	size_t i;
+	size_t t;
+
+	if (argc > 1) {
+		iterations = strtoul(argv[1], NULL, 10);
+	}
+
+	if (iterations == 0) {
+		fprintf(stderr, "Invalid iteration count\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%-7s %-7s %14s %14s %8s\n", "tags", "options",
+		"linear (ns)", "index (ns)", "speedup");
+
+	for (sparse = 0; sparse <= 1; sparse++) {
+		for (i = 0; i < sizeof(option_counts) /
+				sizeof(option_counts[0]); i++) {
+			unsigned int option_count = option_counts[i];
+			int64_t stride = sparse ? 1000 : 1;
+			struct ctf_field_class_enum *tag_fc =
+				ctf_field_class_enum_create();
+			struct ctf_field_class_variant *var_fc;
+			double linear_ns, index_ns;
+
+			BT_ASSERT(tag_fc);
+			tag_fc->base.is_signed = sparse;
+			var_fc = create_variant_fc(tag_fc, option_count,
+				stride);
+
+			/*
+			 * Pseudo-random tag values, including some which
+			 * select no option.
+			 */
+			for (t = 0; t < TAG_COUNT; t++) {
+				int64_t n = (int64_t) ((t * 2654435761U) %
+					(option_count + option_count / 8));
+
+				tags[t] = (uint64_t) (sparse ?
+					(n - (int64_t) option_count / 2) * stride :
+					n);
+			}
+
+			linear_ns = bench_linear(var_fc, iterations);
+			index_ns = bench_index(var_fc, iterations);
+			printf("%-7s %-7u %14.3f %14.3f %7.2fx\n",
+				sparse ? "sparse" : "dense", option_count,
+				linear_ns, index_ns, linear_ns / index_ns);
+			ctf_field_class_destroy((void *) var_fc);
+			ctf_field_class_destroy((void *) tag_fc);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
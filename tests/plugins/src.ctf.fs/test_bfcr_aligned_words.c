@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test that the binary field class reader, when it reads integers
+ * which are byte-aligned words (single integer fields as well as
+ * static array elements), reads the same values as the generic
+ * bt_bitfield_read_le() and bt_bitfield_read_be(), for every word
+ * size, byte order, signedness, and byte offset within a word.
+ */
+
+#include "plugins/ctf/common/metadata/ctf-meta.h"
+#include "plugins/ctf/common/bfcr/bfcr.h"
+#include "compat/bitfield.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+/* 4 sizes x 2 byte orders x 2 signednesses x 2 paths */
+#define NR_TESTS 32
+
+/* Number of elements of the static array field classes */
+#define ARRAY_LEN 16
+
+/* Largest byte offset at which to read */
+#define MAX_BYTE_OFFSET 7
+
+#define BUF_SIZE (MAX_BYTE_OFFSET + ARRAY_LEN * 8)
+
+struct read_values {
+	uint64_t values[ARRAY_LEN];
+	size_t count;
+
+	/* Number of calls to the integer array callbacks */
+	size_t run_count;
+};
+
+static
+enum bt_bfcr_status unsigned_int_cb(uint64_t value,
+		struct ctf_field_class *fc, void *data)
+{
+	struct read_values *read_values = data;
+
+	BT_ASSERT(read_values->count < ARRAY_LEN);
+	read_values->values[read_values->count++] = value;
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status signed_int_cb(int64_t value,
+		struct ctf_field_class *fc, void *data)
+{
+	return unsigned_int_cb((uint64_t) value, fc, data);
+}
+
+static
+enum bt_bfcr_status unsigned_int_array_cb(const uint64_t *values,
+		size_t count, struct ctf_field_class *fc, void *data)
+{
+	struct read_values *read_values = data;
+	size_t i;
+
+	read_values->run_count++;
+
+	for (i = 0; i < count; i++) {
+		unsigned_int_cb(values[i], fc, data);
+	}
+
+	return BT_BFCR_STATUS_OK;
+}
+
+static
+enum bt_bfcr_status signed_int_array_cb(const int64_t *values,
+		size_t count, struct ctf_field_class *fc, void *data)
+{
+	return unsigned_int_array_cb((const uint64_t *) values, count, fc,
+		data);
+}
+
+/*
+ * Reads the `size`-bit integer at the bit offset `at` of `buf` with the
+ * generic bitfield reader.
+ */
+static
+uint64_t read_expected(const uint8_t *buf, size_t at, unsigned int size,
+		enum ctf_byte_order bo, bool is_signed)
+{
+	uint64_t u;
+	int64_t s;
+
+	if (is_signed) {
+		if (bo == CTF_BYTE_ORDER_LITTLE) {
+			bt_bitfield_read_le(buf, uint8_t, at, size, &s);
+		} else {
+			bt_bitfield_read_be(buf, uint8_t, at, size, &s);
+		}
+
+		return (uint64_t) s;
+	}
+
+	if (bo == CTF_BYTE_ORDER_LITTLE) {
+		bt_bitfield_read_le(buf, uint8_t, at, size, &u);
+	} else {
+		bt_bitfield_read_be(buf, uint8_t, at, size, &u);
+	}
+
+	return u;
+}
+
+/*
+ * Decodes `fc` at each byte offset of `buf` from 0 to
+ * `MAX_BYTE_OFFSET`, and checks that each read value matches what the
+ * generic bitfield reader reads.
+ *
+ * When `expected_count` is greater than one (array field class), also
+ * checks that the reader reads the elements as runs.
+ */
+static
+bool check_reads(struct bt_bfcr *bfcr, struct read_values *read_values,
+		struct ctf_field_class *fc, const uint8_t *buf,
+		unsigned int size, enum ctf_byte_order bo, bool is_signed,
+		size_t expected_count)
+{
+	size_t byte_offset;
+	bool ret = true;
+
+	for (byte_offset = 0; byte_offset <= MAX_BYTE_OFFSET; byte_offset++) {
+		enum bt_bfcr_status status;
+		size_t consumed;
+		size_t i;
+
+		read_values->count = 0;
+		read_values->run_count = 0;
+		consumed = bt_bfcr_start(bfcr, fc, buf, byte_offset * 8, 0,
+			BUF_SIZE, &status);
+		if (status != BT_BFCR_STATUS_OK ||
+				consumed != expected_count * size ||
+				read_values->count != expected_count ||
+				(expected_count > 1) != (read_values->run_count > 0)) {
+			diag("Unexpected decoding result: byte-offset=%zu, "
+				"status=%s, consumed-bits=%zu, value-count=%zu, "
+				"run-count=%zu",
+				byte_offset, bt_bfcr_status_string(status),
+				consumed, read_values->count,
+				read_values->run_count);
+			ret = false;
+			continue;
+		}
+
+		for (i = 0; i < expected_count; i++) {
+			size_t at = byte_offset * 8 + i * size;
+			uint64_t expected = read_expected(buf, at, size, bo,
+				is_signed);
+
+			if (read_values->values[i] != expected) {
+				diag("Value mismatch: byte-offset=%zu, index=%zu, "
+					"expected=%" PRIx64 ", got=%" PRIx64,
+					byte_offset, i, expected,
+					read_values->values[i]);
+				ret = false;
+			}
+		}
+	}
+
+	return ret;
+}
+
+static
+struct ctf_field_class_int *create_int_fc(unsigned int size,
+		enum ctf_byte_order bo, bool is_signed)
+{
+	struct ctf_field_class_int *int_fc = ctf_field_class_int_create();
+
+	BT_ASSERT(int_fc);
+	int_fc->base.base.alignment = 8;
+	int_fc->base.size = size;
+	int_fc->base.byte_order = bo;
+	int_fc->is_signed = is_signed;
+	ctf_field_class_bit_array_update_is_aligned_word(&int_fc->base);
+	BT_ASSERT(int_fc->base.is_aligned_word);
+	return int_fc;
+}
+
+static
+void test_size(struct bt_bfcr *bfcr, struct read_values *read_values,
+		const uint8_t *buf, unsigned int size, enum ctf_byte_order bo,
+		bool is_signed)
+{
+	const char *bo_str = bo == CTF_BYTE_ORDER_LITTLE ? "LE" : "BE";
+	const char *sign_str = is_signed ? "signed" : "unsigned";
+	struct ctf_field_class_int *int_fc = create_int_fc(size, bo,
+		is_signed);
+	struct ctf_field_class_array *array_fc =
+		ctf_field_class_array_create();
+
+	ok(check_reads(bfcr, read_values, (void *) int_fc, buf, size, bo,
+		is_signed, 1),
+		"%u-bit %s %s integer fields are read like bitfields",
+		size, bo_str, sign_str);
+	ctf_field_class_destroy((void *) int_fc);
+
+	BT_ASSERT(array_fc);
+	array_fc->base.elem_fc = (void *) create_int_fc(size, bo, is_signed);
+	array_fc->length = ARRAY_LEN;
+	ok(check_reads(bfcr, read_values, (void *) array_fc, buf, size, bo,
+		is_signed, ARRAY_LEN),
+		"%u-bit %s %s integer array elements are read like bitfields",
+		size, bo_str, sign_str);
+	ctf_field_class_destroy((void *) array_fc);
+}
+
+int main(void)
+{
+	static const unsigned int sizes[] = { 8, 16, 32, 64 };
+	static const enum ctf_byte_order bos[] = {
+		CTF_BYTE_ORDER_LITTLE,
+		CTF_BYTE_ORDER_BIG,
+	};
+	struct bt_bfcr_cbs cbs = { 0 };
+	struct read_values read_values;
+	struct bt_bfcr *bfcr;
+	uint8_t buf[BUF_SIZE];
+	uint64_t state = 0x2545f4914f6cdd1d;
+	size_t i, j;
+
+	plan_tests(NR_TESTS);
+
+	/*
+	 * Fill the buffer with xorshift64 output so that the sign bit
+	 * is set in some of the words and not in others.
+	 */
+	for (i = 0; i < BUF_SIZE; i++) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		buf[i] = (uint8_t) state;
+	}
+
+	cbs.classes.unsigned_int = unsigned_int_cb;
+	cbs.classes.signed_int = signed_int_cb;
+	cbs.classes.unsigned_int_array = unsigned_int_array_cb;
+	cbs.classes.signed_int_array = signed_int_array_cb;
+	bfcr = bt_bfcr_create(cbs, &read_values, BT_LOGGING_LEVEL_NONE,
+		NULL);
+	BT_ASSERT(bfcr);
+
+	for (i = 0; i < G_N_ELEMENTS(sizes); i++) {
+		for (j = 0; j < G_N_ELEMENTS(bos); j++) {
+			test_size(bfcr, &read_values, buf, sizes[i], bos[j],
+				false);
+			test_size(bfcr, &read_values, buf, sizes[i], bos[j],
+				true);
+		}
+	}
+
+	bt_bfcr_destroy(bfcr);
+	return exit_status();
+}
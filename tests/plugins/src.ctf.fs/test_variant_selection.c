@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2020 EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test that ctf_field_class_variant_find_option_index(), which the CTF
+ * message iterator uses to select a variant field's option, selects
+ * the same option as a linear scan of the variant's tag ranges, which
+ * selects the option of the first matching range.
+ */
+
+#include "plugins/ctf/common/metadata/ctf-meta.h"
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 21
+
+struct test_range {
+	const char *label;
+	int64_t lower;
+	int64_t upper;
+};
+
+static
+int64_t find_option_index_linear(struct ctf_field_class_variant *var_fc,
+		uint64_t tag_u)
+{
+	uint64_t i;
+	int64_t tag_i = (int64_t) tag_u;
+
+	for (i = 0; i < var_fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(var_fc, i);
+
+		if (var_fc->tag_fc->base.is_signed) {
+			if (tag_i >= range->range.lower.i &&
+					tag_i <= range->range.upper.i) {
+				return (int64_t) range->option_index;
+			}
+		} else if (tag_u >= range->range.lower.u &&
+				tag_u <= range->range.upper.u) {
+			return (int64_t) range->option_index;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Creates a variant field class and its tag field class from
+ * `ranges`: each distinct label is an option, in order of first
+ * appearance.
+ */
+static
+struct ctf_field_class_variant *create_variant_fc(bool is_signed,
+		const struct test_range *ranges, size_t range_count)
+{
+	struct ctf_field_class_enum *tag_fc = ctf_field_class_enum_create();
+	struct ctf_field_class_variant *var_fc =
+		ctf_field_class_variant_create();
+	size_t i;
+
+	BT_ASSERT(tag_fc);
+	BT_ASSERT(var_fc);
+	tag_fc->base.is_signed = is_signed;
+
+	for (i = 0; i < range_count; i++) {
+		ctf_field_class_enum_map_range(tag_fc, ranges[i].label,
+			(uint64_t) ranges[i].lower, (uint64_t) ranges[i].upper);
+
+		if (!ctf_field_class_variant_borrow_option_by_name(var_fc,
+				ranges[i].label)) {
+			ctf_field_class_variant_append_option(var_fc,
+				ranges[i].label, NULL);
+		}
+	}
+
+	ctf_field_class_variant_set_tag_field_class(var_fc, tag_fc);
+	return var_fc;
+}
+
+/*
+ * Creates a variant field class of `option_count` options, each one
+ * selected by a single tag value, the tag values being `stride` apart
+ * (centered around 0 if `is_signed` is true).
+ */
+static
+struct ctf_field_class_variant *create_regular_variant_fc(bool is_signed,
+		unsigned int option_count, int64_t stride)
+{
+	struct ctf_field_class_variant *var_fc;
+	struct test_range *ranges = g_new0(struct test_range, option_count);
+	GPtrArray *labels = g_ptr_array_new_with_free_func(g_free);
+	unsigned int i;
+
+	BT_ASSERT(ranges);
+	BT_ASSERT(labels);
+
+	for (i = 0; i < option_count; i++) {
+		int64_t val = is_signed ?
+			((int64_t) i - (int64_t) option_count / 2) * stride :
+			(int64_t) i * stride;
+		char *label = g_strdup_printf("opt%u", i);
+
+		BT_ASSERT(label);
+		g_ptr_array_add(labels, label);
+		ranges[i].label = label;
+		ranges[i].lower = val;
+		ranges[i].upper = val;
+	}
+
+	var_fc = create_variant_fc(is_signed, ranges, option_count);
+	g_ptr_array_free(labels, TRUE);
+	g_free(ranges);
+	return var_fc;
+}
+
+static
+void destroy_variant_fc(struct ctf_field_class_variant *var_fc)
+{
+	struct ctf_field_class_enum *tag_fc = var_fc->tag_fc;
+
+	ctf_field_class_destroy((void *) var_fc);
+	ctf_field_class_destroy((void *) tag_fc);
+}
+
+static
+bool option_index_matches_linear(struct ctf_field_class_variant *var_fc,
+		uint64_t tag)
+{
+	int64_t expected = find_option_index_linear(var_fc, tag);
+	int64_t index = ctf_field_class_variant_find_option_index(var_fc, tag);
+
+	if (index != expected) {
+		diag("Option index mismatch: tag=%" PRIu64 " (%" PRId64 "), "
+			"expected-option-index=%" PRId64 ", option-index=%" PRId64,
+			tag, (int64_t) tag, expected, index);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Checks that the option index of `var_fc` selects the same option as
+ * a linear scan for the tag values around the bounds of each range and
+ * of the direct table, for the extreme tag values, and for every tag
+ * value covered by the direct table.
+ */
+static
+bool option_index_matches_linear_at_bounds(
+		struct ctf_field_class_variant *var_fc)
+{
+	static const uint64_t extreme_tags[] = {
+		0, 1, UINT64_MAX, UINT64_MAX - 1,
+		(uint64_t) INT64_MAX, (uint64_t) INT64_MIN,
+	};
+	bool matches = true;
+	uint64_t i;
+
+	for (i = 0; i < G_N_ELEMENTS(extreme_tags); i++) {
+		matches = option_index_matches_linear(var_fc,
+			extreme_tags[i]) && matches;
+	}
+
+	for (i = 0; i < var_fc->ranges->len; i++) {
+		struct ctf_field_class_variant_range *range =
+			ctf_field_class_variant_borrow_range_by_index(var_fc, i);
+
+		/* Wraps around at the extremes, which is fine */
+		matches = option_index_matches_linear(var_fc,
+			range->range.lower.u - 1) && matches;
+		matches = option_index_matches_linear(var_fc,
+			range->range.lower.u) && matches;
+		matches = option_index_matches_linear(var_fc,
+			range->range.upper.u) && matches;
+		matches = option_index_matches_linear(var_fc,
+			range->range.upper.u + 1) && matches;
+	}
+
+	if (var_fc->option_table) {
+		uint64_t first_tag = var_fc->table_first_key;
+
+		if (var_fc->tag_fc->base.is_signed) {
+			first_tag ^= UINT64_C(1) << 63;
+		}
+
+		for (i = 0; i <= var_fc->table_len + 1; i++) {
+			matches = option_index_matches_linear(var_fc,
+				first_tag - 1 + i) && matches;
+		}
+	}
+
+	return matches;
+}
+
+static
+void test_regular(void)
+{
+	static const unsigned int option_counts[] = { 8, 64, 1024 };
+	size_t i;
+
+	for (i = 0; i < G_N_ELEMENTS(option_counts); i++) {
+		struct ctf_field_class_variant *var_fc;
+
+		/* Direct table */
+		var_fc = create_regular_variant_fc(false, option_counts[i], 1);
+		ok(var_fc->option_table,
+			"Dense tags, %u options: option index has a direct table",
+			option_counts[i]);
+		ok(option_index_matches_linear_at_bounds(var_fc),
+			"Dense tags, %u options: option index matches linear scan",
+			option_counts[i]);
+		destroy_variant_fc(var_fc);
+
+		/* Sorted segments */
+		var_fc = create_regular_variant_fc(true, option_counts[i],
+			1000);
+		ok(!var_fc->option_table &&
+			option_index_matches_linear_at_bounds(var_fc),
+			"Sparse signed tags, %u options: option index matches linear scan",
+			option_counts[i]);
+		destroy_variant_fc(var_fc);
+	}
+}
+
+static
+void test_overlapping_ranges(void)
+{
+	static const struct test_range ranges[] = {
+		{ "a", 0, 10 },
+		{ "b", 5, 15 },
+		{ "c", 8, 8 },
+		{ "b", 20, 20 },
+	};
+	struct ctf_field_class_variant *var_fc =
+		create_variant_fc(false, ranges, G_N_ELEMENTS(ranges));
+
+	ok(ctf_field_class_variant_find_option_index(var_fc, 5) == 0 &&
+		ctf_field_class_variant_find_option_index(var_fc, 8) == 0 &&
+		ctf_field_class_variant_find_option_index(var_fc, 10) == 0,
+		"Overlapping ranges: first matching range wins");
+	ok(ctf_field_class_variant_find_option_index(var_fc, 11) == 1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 15) == 1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 20) == 1,
+		"Overlapping ranges: rest of a partially shadowed range");
+	ok(ctf_field_class_variant_find_option_index(var_fc, 16) == -1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 21) == -1,
+		"Overlapping ranges: no option out of the ranges");
+	ok(option_index_matches_linear_at_bounds(var_fc),
+		"Overlapping ranges: option index matches linear scan");
+	destroy_variant_fc(var_fc);
+}
+
+static
+void test_signed_tags(void)
+{
+	static const struct test_range ranges[] = {
+		{ "neg", -10, -5 },
+		{ "zero", -2, 2 },
+		{ "max", INT64_MAX - 1, INT64_MAX },
+		{ "min", INT64_MIN, INT64_MIN + 1 },
+	};
+	struct ctf_field_class_variant *var_fc =
+		create_variant_fc(true, ranges, G_N_ELEMENTS(ranges));
+
+	ok(ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) -7) == 0 &&
+		ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) -2) == 1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 2) == 1,
+		"Signed tags: negative tag values");
+	ok(ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) INT64_MAX) == 2 &&
+		ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) INT64_MIN) == 3,
+		"Signed tags: extreme tag values");
+	ok(ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) -4) == -1 &&
+		ctf_field_class_variant_find_option_index(var_fc,
+			(uint64_t) -100) == -1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 3) == -1,
+		"Signed tags: no option between the ranges");
+	ok(option_index_matches_linear_at_bounds(var_fc),
+		"Signed tags: option index matches linear scan");
+	destroy_variant_fc(var_fc);
+}
+
+static
+void test_segment_merging(void)
+{
+	static const struct test_range ranges[] = {
+		{ "a", 0, 3 },
+		{ "a", 4, 7 },
+		{ "b", 2, 5 },
+		{ "a", 8, 8 },
+		{ "b", 9, 9 },
+	};
+	static const struct test_range max_ranges[] = {
+		{ "a", 0, 0 },
+		{ "b", (int64_t) (UINT64_MAX - 5), (int64_t) UINT64_MAX },
+	};
+	struct ctf_field_class_variant *var_fc =
+		create_variant_fc(false, ranges, G_N_ELEMENTS(ranges));
+
+	/* `a` for 0 to 8, `b` for 9, none from 10 */
+	ok(var_fc->segs->len == 3,
+		"Segment merging: adjacent and shadowed ranges make a single segment");
+	ok(option_index_matches_linear_at_bounds(var_fc),
+		"Segment merging: option index matches linear scan");
+	destroy_variant_fc(var_fc);
+
+	/* The last segment selects an option: no direct table */
+	var_fc = create_variant_fc(false, max_ranges,
+		G_N_ELEMENTS(max_ranges));
+	ok(!var_fc->option_table &&
+		ctf_field_class_variant_find_option_index(var_fc,
+			UINT64_MAX) == 1 &&
+		ctf_field_class_variant_find_option_index(var_fc, 1) == -1,
+		"Range reaching the maximum tag value: option index has no direct table");
+	ok(option_index_matches_linear_at_bounds(var_fc),
+		"Range reaching the maximum tag value: option index matches linear scan");
+	destroy_variant_fc(var_fc);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_regular();
+	test_overlapping_ranges();
+	test_signed_tags();
+	test_segment_merging();
+	return exit_status();
+}